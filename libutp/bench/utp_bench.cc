@@ -0,0 +1,520 @@
+/*************************************************************************
+    > File Name: utp_bench.cc
+    > Author: eular
+    > Brief: ACK/丢包处理热路径微基准, 输出 ns/op 与 allocs/op
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <event/loop.h>
+#include <utils/CLI11.hpp>
+
+#define private public
+#include "context/context_impl.h"
+#include "context/send_ctl.h"
+#include "context/stream_impl.h"
+#undef private
+
+#include "proto/frame/ack.h"
+#include "proto/proto.h"
+#include "util/ack_info.h"
+#include "util/receive_history.h"
+#include "util/time.h"
+
+// 分配计数: glibc 下拦截 malloc 族 (覆盖 new 与内存池的 malloc), 其他平台只统计 operator new
+namespace {
+uint64_t g_allocCount = 0;
+uint64_t g_allocBytes = 0;
+} // namespace
+
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size)
+{
+    ++g_allocCount;
+    g_allocBytes += size;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    ++g_allocCount;
+    g_allocBytes += count * size;
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    ++g_allocCount;
+    g_allocBytes += size;
+    return __libc_realloc(ptr, size);
+}
+} // extern "C"
+#else
+void *operator new(size_t size)
+{
+    ++g_allocCount;
+    g_allocBytes += size;
+    void *ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+#endif
+
+using eular::utp::AckInfo;
+using eular::utp::Config;
+using eular::utp::ConnectionImpl;
+using eular::utp::ContextImpl;
+using eular::utp::FrameAck;
+using eular::utp::PacketOut;
+using eular::utp::ReceiveHistory;
+using eular::utp::RecvFragment;
+using eular::utp::Status;
+using eular::utp::StreamImpl;
+using eular::utp::TransportParams;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchResult {
+    std::string name;
+    std::string param;
+    uint64_t    ops{0};
+    double      nsPerOp{0};
+    double      allocsPerOp{0};
+    double      bytesPerOp{0};
+};
+
+/**
+ * @brief 累计计时区间, 只把热路径本身计入 ns/op 与 allocs/op
+ */
+class Meter
+{
+public:
+    void begin()
+    {
+        m_allocCount = g_allocCount;
+        m_allocBytes = g_allocBytes;
+        m_start = Clock::now();
+    }
+
+    void end(uint64_t ops)
+    {
+        const Clock::time_point stop = Clock::now();
+        m_ns += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - m_start).count());
+        m_allocs += g_allocCount - m_allocCount;
+        m_bytes += g_allocBytes - m_allocBytes;
+        m_ops += ops;
+    }
+
+    uint64_t ops() const { return m_ops; }
+    uint64_t elapsedNs() const { return m_ns; }
+
+    BenchResult result(const std::string &name, const std::string &param) const
+    {
+        BenchResult r;
+        r.name = name;
+        r.param = param;
+        r.ops = m_ops;
+        if (m_ops > 0) {
+            r.nsPerOp = static_cast<double>(m_ns) / static_cast<double>(m_ops);
+            r.allocsPerOp = static_cast<double>(m_allocs) / static_cast<double>(m_ops);
+            r.bytesPerOp = static_cast<double>(m_bytes) / static_cast<double>(m_ops);
+        }
+        return r;
+    }
+
+private:
+    Clock::time_point m_start;
+    uint64_t          m_allocCount{0};
+    uint64_t          m_allocBytes{0};
+    uint64_t          m_ns{0};
+    uint64_t          m_allocs{0};
+    uint64_t          m_bytes{0};
+    uint64_t          m_ops{0};
+};
+
+struct BenchOptions {
+    uint64_t minTimeNs{200ull * 1000 * 1000};
+    uint32_t seed{1};
+};
+
+struct ConnFixture {
+    Config         cfg;
+    ev::EventLoop  loop;
+    ContextImpl    ctx;
+    ConnectionImpl conn;
+
+    ConnFixture() : ctx(loop.loop(), &cfg), conn(&ctx, nullptr, 4242)
+    {
+        conn.m_state = ConnectionImpl::kStateConnected;
+    }
+};
+
+PacketOut *SendOne(ConnectionImpl &conn, utp_packno_t packno, utp_time_t sentUs)
+{
+    constexpr uint32_t kPayload = 1200;
+    PacketOut *pkt = conn.m_mm.getPacketOut(UTP_HEADER_SIZE + kPayload);
+    if (pkt == nullptr) {
+        std::fprintf(stderr, "out of memory\n");
+        std::exit(1);
+    }
+    pkt->data_size = static_cast<uint16_t>(UTP_HEADER_SIZE + kPayload);
+    pkt->packno = packno;
+    pkt->sent_time = sentUs;
+    pkt->frame_types = 1u << static_cast<uint32_t>(eular::utp::kFramePing);
+    conn.m_sendCtl->packetSent(pkt);
+    return pkt;
+}
+
+AckInfo AckRange(utp_packno_t low, utp_packno_t high)
+{
+    AckInfo ack;
+    ack.largest_ack_packno = high;
+    ack.range_size = 1;
+    ack.ack_ranges[0].low = low;
+    ack.ack_ranges[0].high = high;
+    return ack;
+}
+
+/**
+ * @brief 维持 inflight 个在途包的滑动窗口, 每个 ACK 确认最早的两个包后补发两个
+ *
+ * @param reordered 为 true 时先确认第二个再确认第一个, 制造一个包号空洞
+ */
+BenchResult BenchOnAckReceived(const BenchOptions &opts, uint32_t inflight, bool reordered)
+{
+    ConnFixture fixture;
+    ConnectionImpl &conn = fixture.conn;
+    utp_time_t nowUs = eular::utp::time::MonotonicUs();
+    utp_packno_t nextPn = 1;
+    for (uint32_t i = 0; i < inflight; ++i) {
+        SendOne(conn, nextPn++, nowUs);
+    }
+
+    Meter meter;
+    utp_packno_t base = 1;
+    while (meter.elapsedNs() < opts.minTimeNs) {
+        nowUs += 10;
+        AckInfo first = reordered ? AckRange(base + 1, base + 1) : AckRange(base, base + 1);
+        meter.begin();
+        conn.m_sendCtl->onAckReceived(first, nowUs);
+        meter.end(1);
+        if (reordered) {
+            AckInfo second = AckRange(base, base + 1);
+            meter.begin();
+            conn.m_sendCtl->onAckReceived(second, nowUs);
+            meter.end(1);
+        }
+        base += 2;
+        SendOne(conn, nextPn++, nowUs);
+        SendOne(conn, nextPn++, nowUs);
+    }
+
+    return meter.result(reordered ? "send_ctl.on_ack_received.reordered" : "send_ctl.on_ack_received",
+                        "inflight=" + std::to_string(inflight));
+}
+
+/**
+ * @brief 生成带随机丢包与窗口内乱序的包号序列
+ */
+std::vector<utp_packno_t> MakeArrivals(std::mt19937 &rng, size_t count, uint32_t lossPermille, uint32_t reorderWindow)
+{
+    std::vector<utp_packno_t> arrivals;
+    arrivals.reserve(count);
+    std::uniform_int_distribution<uint32_t> permille(0, 999);
+    for (utp_packno_t pn = 1; arrivals.size() < count; ++pn) {
+        if (permille(rng) >= lossPermille) {
+            arrivals.push_back(pn);
+        }
+    }
+    if (reorderWindow > 1) {
+        for (size_t i = 0; i < arrivals.size(); i += reorderWindow) {
+            const size_t end = std::min(arrivals.size(), i + reorderWindow);
+            std::shuffle(arrivals.begin() + static_cast<std::ptrdiff_t>(i),
+                         arrivals.begin() + static_cast<std::ptrdiff_t>(end), rng);
+        }
+    }
+    return arrivals;
+}
+
+BenchResult BenchReceiveHistoryInsert(const BenchOptions &opts, uint32_t lossPermille, uint32_t reorderWindow)
+{
+    constexpr size_t kBatch = 64 * 1024;
+    std::mt19937 rng(opts.seed);
+    const std::vector<utp_packno_t> arrivals = MakeArrivals(rng, kBatch, lossPermille, reorderWindow);
+
+    ReceiveHistory history;
+    Meter meter;
+    utp_time_t nowUs = eular::utp::time::MonotonicUs();
+    while (meter.elapsedNs() < opts.minTimeNs) {
+        history.clear();
+        meter.begin();
+        for (utp_packno_t pn : arrivals) {
+            history.insert(pn, nowUs);
+        }
+        meter.end(arrivals.size());
+        nowUs += 1000;
+    }
+
+    return meter.result("receive_history.insert",
+                        "loss=" + std::to_string(lossPermille / 10.0).substr(0, 4) + "%,reorder=" +
+                            std::to_string(reorderWindow));
+}
+
+// 每隔一个包号丢一个, 得到 ranges 个互不相邻的区间
+void FillHistory(ReceiveHistory &history, uint32_t ranges, utp_time_t nowUs)
+{
+    history.clear();
+    for (uint32_t i = 0; i < ranges; ++i) {
+        history.insert(static_cast<utp_packno_t>(1 + i * 2), nowUs);
+    }
+}
+
+BenchResult BenchAckEncode(const BenchOptions &opts, uint32_t ranges)
+{
+    Config cfg;
+    cfg.max_ack_range_size = static_cast<uint8_t>(std::min<uint32_t>(ranges, UINT8_MAX));
+    TransportParams params;
+    params.ack_delay_exponent = cfg.ack_delay_exponent;
+    ReceiveHistory history(std::max<uint32_t>(ranges, 1));
+    const utp_time_t nowUs = eular::utp::time::MonotonicUs();
+    FillHistory(history, ranges, nowUs);
+
+    FrameAck ack;
+    ack._history = &history;
+    ack._config = &cfg;
+    ack._params = &params;
+    ack._now = nowUs + 100;
+    std::vector<uint8_t> buffer(static_cast<size_t>(ack.frameSize()));
+
+    constexpr uint32_t kBatch = 1024;
+    Meter meter;
+    Status st;
+    while (meter.elapsedNs() < opts.minTimeNs) {
+        meter.begin();
+        for (uint32_t i = 0; i < kBatch; ++i) {
+            if (ack.encode(buffer.data(), buffer.size(), st) <= 0) {
+                std::fprintf(stderr, "ack encode failed: %s\n", st.message());
+                std::exit(1);
+            }
+        }
+        meter.end(kBatch);
+    }
+    return meter.result("ack_frame.encode", "ranges=" + std::to_string(ranges));
+}
+
+BenchResult BenchAckDecode(const BenchOptions &opts, uint32_t ranges)
+{
+    Config cfg;
+    cfg.max_ack_range_size = static_cast<uint8_t>(std::min<uint32_t>(ranges, UINT8_MAX));
+    TransportParams params;
+    params.ack_delay_exponent = cfg.ack_delay_exponent;
+    ReceiveHistory history(std::max<uint32_t>(ranges, 1));
+    const utp_time_t nowUs = eular::utp::time::MonotonicUs();
+    FillHistory(history, ranges, nowUs);
+
+    FrameAck encoder;
+    encoder._history = &history;
+    encoder._config = &cfg;
+    encoder._params = &params;
+    encoder._now = nowUs + 100;
+    std::vector<uint8_t> wire(static_cast<size_t>(encoder.frameSize()));
+    Status st;
+    const int32_t wireLen = encoder.encode(wire.data(), wire.size(), st);
+    if (wireLen <= 0) {
+        std::fprintf(stderr, "ack encode failed: %s\n", st.message());
+        std::exit(1);
+    }
+
+    AckInfo info;
+    FrameAck decoder;
+    decoder._ackInfo = &info;
+    decoder._params = &params;
+
+    constexpr uint32_t kBatch = 1024;
+    Meter meter;
+    while (meter.elapsedNs() < opts.minTimeNs) {
+        meter.begin();
+        for (uint32_t i = 0; i < kBatch; ++i) {
+            if (decoder.decode(wire.data(), static_cast<size_t>(wireLen), st) < 0) {
+                std::fprintf(stderr, "ack decode failed: %s\n", st.message());
+                std::exit(1);
+            }
+        }
+        meter.end(kBatch);
+    }
+    return meter.result("ack_frame.decode", "ranges=" + std::to_string(ranges));
+}
+
+/**
+ * @brief 以 1200 字节分片在 reorderWindow 窗口内乱序插入接收红黑树
+ */
+BenchResult BenchInsertRecvFragment(const BenchOptions &opts, uint32_t reorderWindow)
+{
+    constexpr size_t   kFragments = 1024;
+    constexpr uint16_t kFragmentLen = 1200;
+    static uint8_t payload[kFragmentLen];
+
+    ConnFixture fixture;
+    StreamImpl stream(&fixture.conn, 1);
+    std::mt19937 rng(opts.seed);
+    std::vector<uint64_t> offsets(kFragments);
+    for (size_t i = 0; i < kFragments; ++i) {
+        offsets[i] = static_cast<uint64_t>(i) * kFragmentLen;
+    }
+    for (size_t i = 0; reorderWindow > 1 && i < offsets.size(); i += reorderWindow) {
+        const size_t end = std::min(offsets.size(), i + reorderWindow);
+        std::shuffle(offsets.begin() + static_cast<std::ptrdiff_t>(i),
+                     offsets.begin() + static_cast<std::ptrdiff_t>(end), rng);
+    }
+
+    std::vector<RecvFragment *> fragments(kFragments);
+    Meter meter;
+    while (meter.elapsedNs() < opts.minTimeNs) {
+        for (size_t i = 0; i < kFragments; ++i) {
+            RecvFragment *fragment = fixture.conn.m_mm.getRecvFragment();
+            fragment->data = payload;
+            fragment->len = kFragmentLen;
+            fragment->offset = offsets[i];
+            fragments[i] = fragment;
+        }
+
+        meter.begin();
+        for (RecvFragment *fragment : fragments) {
+            stream.insertRecvFragment(fragment);
+        }
+        meter.end(kFragments);
+        stream.clearRecvFragments();
+    }
+    return meter.result("stream.insert_recv_fragment", "reorder=" + std::to_string(reorderWindow));
+}
+
+void PrintText(const std::vector<BenchResult> &results)
+{
+    std::printf("%-38s %-24s %12s %12s %12s %12s\n", "benchmark", "param", "ops", "ns/op", "allocs/op", "bytes/op");
+    for (const BenchResult &r : results) {
+        std::printf("%-38s %-24s %12llu %12.1f %12.3f %12.1f\n", r.name.c_str(), r.param.c_str(),
+                    static_cast<unsigned long long>(r.ops), r.nsPerOp, r.allocsPerOp, r.bytesPerOp);
+    }
+}
+
+void PrintCsv(const std::vector<BenchResult> &results)
+{
+    std::printf("benchmark,param,ops,ns_per_op,allocs_per_op,bytes_per_op\n");
+    for (const BenchResult &r : results) {
+        std::printf("%s,\"%s\",%llu,%.3f,%.4f,%.2f\n", r.name.c_str(), r.param.c_str(),
+                    static_cast<unsigned long long>(r.ops), r.nsPerOp, r.allocsPerOp, r.bytesPerOp);
+    }
+}
+
+void PrintJson(const std::vector<BenchResult> &results)
+{
+    std::printf("[\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult &r = results[i];
+        std::printf("  {\"benchmark\": \"%s\", \"param\": \"%s\", \"ops\": %llu, \"ns_per_op\": %.3f, "
+                    "\"allocs_per_op\": %.4f, \"bytes_per_op\": %.2f}%s\n",
+                    r.name.c_str(), r.param.c_str(), static_cast<unsigned long long>(r.ops), r.nsPerOp,
+                    r.allocsPerOp, r.bytesPerOp, i + 1 < results.size() ? "," : "");
+    }
+    std::printf("]\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::string format = "text";
+    std::string filter;
+    uint32_t minTimeMs = 200;
+    uint32_t seed = 1;
+
+    CLI::App app{"libutp ACK/loss hot-path benchmarks"};
+    app.add_option("--format", format, "Output format")->check(CLI::IsMember({"text", "csv", "json"}));
+    app.add_option("--filter", filter, "Only run benchmarks whose name contains this string");
+    app.add_option("--min-time-ms", minTimeMs, "Minimum measured time per benchmark (ms)")->check(CLI::Range(1u, 60000u));
+    app.add_option("--seed", seed, "Seed for synthetic loss/reordering traces");
+    CLI11_PARSE(app, argc, argv);
+
+    BenchOptions opts;
+    opts.minTimeNs = static_cast<uint64_t>(minTimeMs) * 1000 * 1000;
+    opts.seed = seed;
+
+    using Runner = std::function<BenchResult()>;
+    std::vector<std::pair<std::string, Runner>> benches;
+    const uint32_t inflights[] = {1000, 10000, 100000};
+    for (uint32_t inflight : inflights) {
+        benches.emplace_back("send_ctl.on_ack_received", [&opts, inflight] () {
+            return BenchOnAckReceived(opts, inflight, false);
+        });
+        benches.emplace_back("send_ctl.on_ack_received.reordered", [&opts, inflight] () {
+            return BenchOnAckReceived(opts, inflight, true);
+        });
+    }
+
+    const std::pair<uint32_t, uint32_t> traces[] = {{0, 1}, {10, 1}, {10, 16}, {50, 64}};
+    for (const auto &trace : traces) {
+        benches.emplace_back("receive_history.insert", [&opts, trace] () {
+            return BenchReceiveHistoryInsert(opts, trace.first, trace.second);
+        });
+    }
+
+    const uint32_t rangeCounts[] = {1, 16, Config().max_ack_range_size};
+    for (uint32_t ranges : rangeCounts) {
+        benches.emplace_back("ack_frame.encode", [&opts, ranges] () { return BenchAckEncode(opts, ranges); });
+        benches.emplace_back("ack_frame.decode", [&opts, ranges] () { return BenchAckDecode(opts, ranges); });
+    }
+
+    const uint32_t windows[] = {1, 8, 64, 1024};
+    for (uint32_t window : windows) {
+        benches.emplace_back("stream.insert_recv_fragment", [&opts, window] () {
+            return BenchInsertRecvFragment(opts, window);
+        });
+    }
+
+    std::vector<BenchResult> results;
+    for (const auto &bench : benches) {
+        if (!filter.empty() && bench.first.find(filter) == std::string::npos) {
+            continue;
+        }
+        results.push_back(bench.second());
+    }
+
+    if (format == "csv") {
+        PrintCsv(results);
+    } else if (format == "json") {
+        PrintJson(results);
+    } else {
+        PrintText(results);
+    }
+    return 0;
+}
@@ -37,6 +37,15 @@ enum StreamSchedulerMode : uint8_t {
     kStreamSchedulerDrr = 2,       ///< 赤字轮询 (DRR) 调度，保证公平性
 };
 
+/**
+ * @enum StreamRecvMode
+ * @brief 流接收重组方式
+ */
+enum StreamRecvMode : uint8_t {
+    kStreamRecvFragment = 0,  ///< 乱序数据以分片挂在红黑树上, 零拷贝引用收包缓冲区
+    kStreamRecvRing = 1,      ///< 按偏移直接写入流控窗口大小的环形缓冲区, 位图记录已填充区间
+};
+
 /**
  * @enum ConnectionSchedulerMode
  * @brief 连接级调度模式（多连接 flush 场景）
@@ -57,10 +66,11 @@ public:
     // --- DPLPMTUD (数据路径包最大传输单元探测) ---
     bool     enable_dplpmtud = true;               ///< 是否开启 DPLPMTUD
     uint16_t mtu_min = 1280;                       ///< MTU 下探的最小值 (IPv6 最小要求为 1280)
-    uint16_t mtu_max = 1500;                       ///< MTU 上探的最大值 (通常为以太网的 1500)
+    uint16_t mtu_max = 1500;                       ///< MTU 上探的最大值 (通常为以太网的 1500, 巨帧局域网最大可设为 9000)
     uint16_t mtu_base = 1400;                      ///< 初始 MTU 估值
     uint32_t mtu_probe_interval = 300;             ///< 探测间隔时间 (秒)，默认 5 分钟
-    uint16_t mtu_probe_step = 16;                  ///< MTU 探测步长
+    uint16_t mtu_probe_step = 16;                  ///< MTU 二分探测收敛阈值
+    std::vector<uint16_t> mtu_probe_ladder = {1380, 1450, 1492, 1500}; ///< 握手完成后依次跳跃探测的候选 MTU (升序), mtu_max 总是作为最后一级
     uint16_t mtu_probe_timeout = 2000;             ///< 单次 MTU 探测超时时间 (ms)
     uint8_t  mtu_blackhole_loss_threshold = 3;     ///< 判定黑洞的连续大包丢失阈值
     uint16_t mtu_blackhole_loss_window_ms = 3000;  ///< 黑洞判定时间窗口 (ms)
@@ -76,17 +86,33 @@ public:
     // --- Token / 0-RTT ---
     uint32_t zero_rtt_token_max_lifetime = 600;  ///< 0-RTT 票据最长时效 (秒)
     uint32_t zero_rtt_replay_window = 10;        ///< 0-RTT 抗重放窗口时间 (秒)
+    uint32_t zero_rtt_replay_filter_rate = 10000; ///< 抗重放过滤器按每秒该数量的 0-RTT 分配容量, 超出后假阳性 (误拒) 概率上升
+    uint32_t retry_pending_threshold = 0;        ///< 待完成握手数不低于该值时, 未携带有效 Retry 令牌的 INITIAL 只回无状态 Retry。0 表示关闭
+    uint32_t retry_token_lifetime = 10;          ///< Retry 令牌有效期 (秒)
 
     // --- Path Migration (路径迁移) ---
     PathMigrationMode path_migration_mode = kPathMigrationConservative;  ///< 路径迁移策略
 
     // --- Socket (内核缓冲区) ---
-    int32_t recv_buf_size = 1024 * 1024;  ///< UDP 接收缓冲区大小
-    int32_t send_buf_size = 1024 * 1024;  ///< UDP 发送缓冲区大小
+    int32_t  recv_buf_size = 1024 * 1024;  ///< UDP 接收缓冲区大小
+    int32_t  send_buf_size = 1024 * 1024;  ///< UDP 发送缓冲区大小
+    bool     enable_zerocopy = false;      ///< 是否启用 MSG_ZEROCOPY 发送 (仅 Linux 4.14+ 有效, 不支持时自动回退)
+    uint32_t zerocopy_min_bytes = 1200;    ///< 单个数据报不小于该值时才走零拷贝发送 (bytes)
+    bool     enable_gso = false;           ///< 是否启用 UDP GSO (UDP_SEGMENT) 合并发送 (需 Linux 4.18+ 与 sendmmsg)
+    bool     enable_gro = false;           ///< 是否启用 UDP GRO 合并接收 (需 Linux 5.0+ 与 recvmmsg, 每个接收槽位 64 KiB)
+    bool     enable_txtime = false;        ///< 是否启用 SO_TXTIME 内核定时发送: Pacer 为每个包计算最早发送时间, 由 fq qdisc 放行 (需 Linux 4.19+, 不支持时回退为用户态 pacing)
+    uint32_t txtime_horizon_us = 4000;     ///< SO_TXTIME 模式下最早发送时间最多领先当前时间多少 (us), 超出后暂停组包, 避免 qdisc 积压
+    bool     enable_ecn = false;           ///< 是否启用 ECN: 发出的数据报标记 ECT(0), ACK 回传 ECN 计数, 收到 CE 反馈时拥塞控制不等丢包即降速 (仅 Linux)
+    bool     enable_reuseport_cbpf = true; ///< ContextGroup 分片时挂载 SO_ATTACH_REUSEPORT_CBPF, 按 CID 将数据报导向所属分片 (仅 Linux)
+    uint32_t reuseport_forward_queue = 4096; ///< ContextGroup 分片间转发队列上限 (包), 超出时丢弃
+
+    // --- Memory (内存池) ---
+    bool     shared_memory_pool = false;   ///< 同一上下文(线程)内所有连接共用包缓冲池, 避免大量空闲连接各自保留池的高水位
+    uint32_t connection_memory_quota = 0;  ///< 共享池模式下单连接可占用的包缓冲上限 (bytes), 0 表示不限; 超出时暂缓组包, 并丢弃待重组保留的收包数据
 
     // --- Congestion Control (拥塞控制) ---
-    int32_t            cc_algorithm = 0;                        ///< 算法选择: 0-默认(BBR), 1-BBR, 2-Cubic
-    uint32_t           clock_granularity_us = 1;                ///< Pacer 时钟粒度 (us)
+    int32_t            cc_algorithm = 0;                        ///< 算法选择: 0-默认(BBR), 1-BBR, 2-Cubic, 3-BBRv2
+    uint32_t           clock_granularity_us = 1;                ///< Pacer 时钟粒度 (us), 同时作为连接定时器时间轮的 tick
     uint32_t           bbr_init_cwnd_mss = 16;                  ///< BBR 初始拥塞窗口 (MSS)
     uint32_t           bbr_min_cwnd_mss = 4;                    ///< BBR 最小拥塞窗口 (MSS)
     float              bbr_startup_high_gain = 2.885f;          ///< BBR STARTUP 阶段增益
@@ -98,10 +124,22 @@ public:
     float              bbr_probe_rtt_multiplier = 0.75f;        ///< BBR ProbeRTT 增益系数
     float              bbr_similar_min_rtt_threshold = 1.125f;  ///< BBR 相似 RTT 判定阈值
     std::vector<float> bbr_pacing_gains = {1.25f, 0.75f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f};  ///< BBR Pacing 周期增益
+    float              bbr2_loss_thresh = 0.02f;                ///< BBRv2 单轮丢包率上限, 超过即收紧 inflight_hi
+    float              bbr2_beta = 0.7f;                        ///< BBRv2 拥塞轮次 bw_lo/inflight_lo 回退系数
+    float              bbr2_headroom = 0.15f;                   ///< BBRv2 CRUISE 阶段在 inflight_hi 之下预留的比例
+    uint32_t           bbr2_startup_full_loss_count = 8;        ///< BBRv2 STARTUP 单轮丢包事件达到该数且丢包率超限时退出
+    uint32_t           bbr2_probe_wait_ms = 2000;               ///< BBRv2 两次带宽探测的基础间隔 (ms), 实际随机取 [1, 1.5] 倍
+    uint32_t           bbr2_probe_max_rounds = 63;              ///< BBRv2 两次带宽探测之间最多等待的轮数
     double             cubic_beta = 0.7;                                                       ///< CUBIC 丢包回退系数
     double             cubic_c = 0.4;                                                          ///< CUBIC 曲线常数
     uint32_t           cubic_init_cwnd_mss = 32;  ///< CUBIC 初始拥塞窗口 (MSS)
     uint32_t           cubic_min_cwnd_mss = 4;    ///< CUBIC 最小拥塞窗口 (MSS)
+    bool               cubic_hystart = false;                   ///< CUBIC 启用 HyStart++ (RFC 9406), 按 RTT 增长提前结束慢启动; 默认关闭以保持原有慢启动行为
+    uint32_t           cubic_hystart_min_rtt_thresh_ms = 4;     ///< HyStart++ RTT 增长判定阈值下限 (ms)
+    uint32_t           cubic_hystart_max_rtt_thresh_ms = 16;    ///< HyStart++ RTT 增长判定阈值上限 (ms)
+    uint32_t           cubic_hystart_rtt_samples = 8;           ///< HyStart++ 每轮至少需要的 RTT 样本数
+    uint32_t           cubic_hystart_css_growth_divisor = 4;    ///< HyStart++ CSS 阶段 cwnd 增速除数
+    uint32_t           cubic_hystart_css_rounds = 5;            ///< HyStart++ CSS 持续轮数, 之后进入拥塞避免
 
     // --- ACK 行为控制 ---
     uint8_t  ack_every_n_packets = 4;   ///< 每收到 N 个包发一次 ACK
@@ -128,15 +166,20 @@ public:
     uint16_t            stream_drr_quantum = 1200;                        ///< DRR 基准量子
     uint32_t            stream_drr_deficit_cap = 128 * 1024;              ///< DRR 赤字上限
     uint32_t            stream_send_buffer_limit = 256 * 1024;            ///< 单流写缓冲区上限
+    uint32_t            stream_send_file_window = 4 * 1024 * 1024;        ///< 单流 sendFile/writev 外部数据 (不经过写缓冲区) 未确认上限 (bytes)
     bool                stream_enable_coalescing = true;                  ///< 是否启用小包聚合发送
     uint16_t            stream_min_payload_before_immediate_send = 1200;  ///< 聚合触发阈值
     uint32_t            stream_coalesce_delay_us = 1000;                  ///< 聚合等待时延 (us)
     uint32_t            stream_unacked_data_limit = 256 * 1024;           ///< 在途未确认数据上限 (bytes)
+    StreamRecvMode      stream_recv_mode = kStreamRecvFragment;           ///< 接收重组方式, 高 BDP 且有丢包时 kStreamRecvRing 开销更低
 
     // --- Connection Scheduler (连接级 WDRR 调度器) ---
     ConnectionSchedulerMode connection_scheduler_mode = kConnectionSchedulerWdrr;  ///< 连接调度模式
     uint32_t                connection_wdrr_quantum = 1200;                        ///< 连接级 WDRR 量子
     uint32_t                connection_wdrr_deficit_cap = 512 * 1024;              ///< 连接级 WDRR 赤字上限
+
+    // --- Trace (事件追踪) ---
+    uint32_t trace_ring_events = 0;     ///< 每连接事件追踪环容量 (条, 每条 32 字节, 向上取整到 2 的幂), 0 表示关闭; 通过 Connection::exportTrace 导出 qlog
 };
 
 }  // namespace utp
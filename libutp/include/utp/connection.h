@@ -90,6 +90,12 @@ public:
         uint64_t        rx_bytes;       ///< 累计接收字节数，单位：bytes
         uint64_t        tx_bytes;       ///< 累计发送字节数（含重传），单位：bytes
         uint64_t        rtx_bytes;      ///< 累计重传字节数，单位：bytes
+        uint64_t        ecn_ce_count;   ///< 对端回传的累计 CE 标记包数 (启用 ECN 且校验通过时有效)
+        uint64_t        ecn_ce_events;  ///< CE 反馈触发拥塞响应的次数
+        uint64_t        ss_exit_cwnd;   ///< 最近一次退出慢启动时的 cwnd，单位：bytes (仍在慢启动时为 0)
+        uint64_t        hystart_css_entries;    ///< HyStart++ 因 RTT 增长进入 CSS 的次数 (仅 Cubic)
+        uint64_t        hystart_css_spurious;   ///< HyStart++ CSS 中 RTT 回落并恢复慢启动的次数
+        uint64_t        hystart_delay_exits;    ///< HyStart++ 完成 CSS、未经丢包进入拥塞避免的次数
 
         // 流调度器指标
         uint64_t        scheduler_select_total;          ///< 总选流次数
@@ -173,6 +179,14 @@ public:
      */
     virtual int32_t     exportSessionResumptionState(std::string &outState) = 0;
 
+    /**
+     * @brief 将事件追踪环导出为 qlog JSON
+     * 需配置 trace_ring_events 开启追踪; 环写满后只保留最近的事件。
+     * @param outQlog [out] 输出字符串
+     * @return 错误码，0 表示成功
+     */
+    virtual int32_t     exportTrace(std::string &outQlog) = 0;
+
     /**
      * @brief 创建一个新的本地发起的流
      * @param streamType 指定流类型
@@ -25,6 +25,7 @@ namespace eular {
 namespace utp {
 
 class ContextImpl;
+class ContextGroupImpl;
 
 /**
  * @class Context
@@ -58,6 +59,13 @@ public:
         kConnectAttemptPassive,         ///< 被动接受的握手
     };
 
+    /**
+     * @enum 密钥对池低水位常量
+     */
+    enum : uint32_t {
+        kKeyPairPoolHalfWatermark = UINT32_MAX,   ///< 取 capacity / 2
+    };
+
     /**
      * @struct Statistic
      * @brief 上下文级别的运行统计信息
@@ -66,11 +74,29 @@ public:
         uint64_t zero_rtt_offered{0};                   ///< 尝试 0-RTT 的次数
         uint64_t zero_rtt_accepted{0};                  ///< 0-RTT 被接受的次数
         uint64_t zero_rtt_rejected{0};                  ///< 0-RTT 被拒绝的次数
-        uint64_t zero_rtt_replay_rejected{0};           ///< 因重放攻击防御被拒绝的次数
+        uint64_t zero_rtt_replay_rejected{0};           ///< 因重放攻击防御被拒绝的次数 (含过滤器假阳性)
+        double   zero_rtt_replay_fp_rate{0.0};          ///< 抗重放过滤器当前估算的假阳性概率
         uint64_t zero_rtt_invalid_ticket_rejected{0};   ///< 因票据无效被拒绝的次数
+        uint64_t retry_sent{0};                         ///< 因待完成握手过多而回复无状态 Retry 的次数
+        uint64_t retry_token_accepted{0};               ///< 携带有效 Retry 令牌的 INITIAL 次数
+        uint64_t retry_token_rejected{0};               ///< Retry 令牌校验失败的次数
+        uint64_t keypair_pool_hits{0};                  ///< 握手时从预生成池取得 X25519 密钥对的次数
+        uint64_t keypair_pool_misses{0};                ///< 启用密钥对池但池已取空, 在事件循环线程现场生成的次数
         uint64_t path_validation_started{0};            ///< 路径验证启动次数
         uint64_t path_validation_succeeded{0};          ///< 路径验证成功次数
         uint64_t path_validation_failed{0};             ///< 路径验证失败次数
+        uint64_t zerocopy_completed{0};                 ///< MSG_ZEROCOPY 发送完成次数
+        uint64_t zerocopy_copied{0};                    ///< 其中内核回退为拷贝发送的次数 (占比高时建议关闭零拷贝)
+        uint64_t gso_batches{0};                        ///< UDP GSO 合并发送次数 (至少 2 段)
+        uint64_t gso_segments{0};                       ///< UDP GSO 合并发送的总段数
+        double   gso_avg_segments_per_batch{0};         ///< 平均每次 GSO 发送的段数
+        uint64_t gro_batches{0};                        ///< 收到的 UDP GRO 合并数据报数量 (至少 2 段)
+        uint64_t gro_segments{0};                       ///< UDP GRO 合并数据报切分出的总段数
+        uint64_t reuseport_forwarded{0};                ///< ContextGroup 分片模式下转发给其他分片的数据报数量
+        uint64_t reuseport_forward_dropped{0};          ///< 因目标分片转发队列已满而丢弃的数据报数量
+        uint64_t mem_pool_bytes_inuse{0};               ///< 共享内存池模式下所有连接占用的包缓冲字节数
+        uint64_t mem_pool_bytes_cached{0};              ///< 共享内存池空闲链表中缓存的包缓冲字节数
+        uint64_t mem_quota_rejected{0};                 ///< 因单连接内存配额被拒绝的包缓冲分配次数
     };
 
     /**
@@ -220,6 +246,15 @@ public:
      */
     void clearResumptionSecret();
 
+    /**
+     * @brief 设置 X25519 临时密钥对池大小
+     * 启用后由辅助线程预生成加密握手所需的密钥对，剩余数量不高于低水位时补满到容量；
+     * 池取空时退回在事件循环线程现场生成。默认关闭。
+     * @param capacity 池容量，0 表示关闭并停止辅助线程
+     * @param lowWatermark 低水位，默认及不小于 capacity 时取 capacity / 2；0 表示仅在池取空后才补充
+     */
+    void setKeyPairPoolSize(uint32_t capacity, uint32_t lowWatermark = kKeyPairPoolHalfWatermark);
+
     /**
      * @brief 使用会话恢复状态发起 0-RTT 建连（支持加密场景）
      * @param info 建连参数
@@ -264,6 +299,7 @@ public:
     int32_t accept();
 
 private:
+    friend class ContextGroupImpl;
     std::shared_ptr<ContextImpl>    m_impl{};
 };
 
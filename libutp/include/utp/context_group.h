@@ -0,0 +1,104 @@
+/*************************************************************************
+    > File Name: context_group.h
+    > Author: eular
+    > Brief: 基于 SO_REUSEPORT 的多线程分片上下文组, 多个 Context 共享同一监听端口。
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#ifndef __UTP_CONTEXT_GROUP_H__
+#define __UTP_CONTEXT_GROUP_H__
+
+#include <string>
+#include <memory>
+#include <functional>
+
+#include <utp/config.h>
+#include <utp/platform.h>
+#include <utp/context.h>
+
+namespace eular {
+namespace utp {
+
+class ContextGroupImpl;
+
+/**
+ * @class ContextGroup
+ * @brief 在 N 个线程上各运行一个 Context, 通过 SO_REUSEPORT 共享同一端口。
+ *
+ * 每个分片分配的本端 CID 高 8 位为分片序号, 连接的后续数据报据此回到建连所在线程:
+ * Linux 下可挂载 SO_ATTACH_REUSEPORT_CBPF 程序由内核按 CID 分发; 未挂载或内核分发不一致时,
+ * 收到不属于本分片的数据报会转发给所属分片处理。
+ *
+ * @note 0-RTT 票据由各分片独立签发与校验, 客户端重连落到其他分片时票据校验失败, 回退为完整握手。
+ */
+class UTP_API ContextGroup {
+    ContextGroup(const ContextGroup &) = delete;
+    ContextGroup &operator=(const ContextGroup &) = delete;
+    ContextGroup(ContextGroup &&) = delete;
+    ContextGroup &operator=(ContextGroup &&) = delete;
+
+public:
+    /**
+     * @brief 分片启动回调, 在分片线程内、事件循环启动前调用
+     * 应在此回调内设置该分片 Context 的各类回调。
+     */
+    using OnShardStart = std::function<void(uint32_t shard, Context &ctx)>;
+
+    /**
+     * @brief 构造函数
+     * @param shards 分片数量 (线程数), 取值范围 [1, 256]
+     * @param config 配置参数，若为 nullptr 则使用默认配置
+     */
+    ContextGroup(uint32_t shards, Config *config = nullptr);
+    ~ContextGroup();
+
+    /**
+     * @brief 设置分片启动回调
+     * @param cb 回调函数
+     */
+    void setOnShardStart(const OnShardStart &cb);
+
+    /**
+     * @brief 按分片顺序绑定同一端口并启动各分片线程
+     * @param ip 监听 IP
+     * @param port 监听端口, 0 表示由第一个分片随机选择
+     * @param ifname 绑定的网卡接口名（可选）
+     * @return 错误码，0 表示成功
+     */
+    int32_t start(const std::string &ip, uint16_t port, const std::string &ifname = "");
+
+    /**
+     * @brief 停止所有分片线程并等待退出, 不可在分片线程内调用
+     */
+    void stop();
+
+    /**
+     * @brief 分片数量
+     */
+    uint32_t shardCount() const;
+
+    /**
+     * @brief 实际监听端口, start 成功后有效
+     */
+    uint16_t port() const;
+
+    /**
+     * @brief 是否已挂载 reuseport cBPF 分发程序
+     */
+    bool cbpfAttached() const;
+
+    /**
+     * @brief 获取指定分片的上下文, 仅可在该分片线程内使用
+     * @param shard 分片序号
+     * @return 越界时返回 nullptr
+     */
+    Context *context(uint32_t shard);
+
+private:
+    std::shared_ptr<ContextGroupImpl>   m_impl{};
+};
+
+} // namespace utp
+} // namespace eular
+
+#endif // __UTP_CONTEXT_GROUP_H__
@@ -41,6 +41,9 @@ public:
     struct ConstBufferView {
         const void *data{nullptr};      ///< 数据指针
         size_t      len{0};             ///< 数据长度
+
+        ConstBufferView() = default;
+        ConstBufferView(const void *d, size_t l) : data(d), len(l) {}
     };
 
     /**
@@ -50,6 +53,9 @@ public:
     struct MutableBufferView {
         void*   data{nullptr};          ///< 数据指针
         size_t  len{0};                 ///< 空间长度
+
+        MutableBufferView() = default;
+        MutableBufferView(void *d, size_t l) : data(d), len(l) {}
     };
 
     /**
@@ -67,6 +73,7 @@ public:
     using OnWritable = std::function<void()>;
     using OnClosed   = std::function<void()>;
     using OnReset    = std::function<void(uint16_t)>;
+    using OnRelease  = std::function<void()>;
 
     Stream() = default;
     virtual ~Stream() = default;
@@ -86,6 +93,31 @@ public:
      */
     virtual int32_t     write(const void *data, size_t len, bool fin = false) = 0;
 
+    /**
+     * @brief 分散写入调用方持有的缓冲区（所有权转移，不拷贝进流发送缓冲区）
+     * 各分片按顺序组成连续的流数据，直到全部被确认（或流被重置/销毁）前调用方不得修改或释放这些缓冲区；
+     * 之后 release 被调用且仅调用一次，调用方可在其中归还缓冲区。写入失败时不会调用 release，所有权仍归调用方。
+     * @param views 分片数组
+     * @param count 分片个数
+     * @param release 缓冲区释放回调，可为空
+     * @param fin 是否在数据后携带 FIN 标志
+     * @return 写入的总字节数（全部接受或返回错误），或错误码（负数）；
+     *         窗口余量不足时为 UTP_ERR_WOULD_BLOCK，总长超过 stream_send_file_window 时为 UTP_ERR_OVERFLOW（需拆分后写入）
+     */
+    virtual int32_t     writev(const ConstBufferView *views, size_t count, const OnRelease &release, bool fin = false) = 0;
+
+    /**
+     * @brief 零拷贝发送文件内容
+     * 文件区间以只读方式映射，STREAM 帧直接从映射页构建，不经过流发送缓冲区；
+     * 区间内数据全部被确认后解除映射。发送完成前文件对应区间不可被截断。
+     * @param fd 已打开的可读普通文件描述符
+     * @param offset 文件内起始偏移
+     * @param len 发送长度
+     * @param fin 是否在数据后携带 FIN 标志（仅在 len 全部被接受时生效）
+     * @return 实际接受的字节数（受 stream_send_file_window 限制，可能小于 len），或错误码（负数）
+     */
+    virtual int32_t     sendFile(int fd, uint64_t offset, size_t len, bool fin = false) = 0;
+
     /**
      * @brief 同步读取数据（拷贝模式）
      * @param buffer 目标缓冲区
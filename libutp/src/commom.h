@@ -62,6 +62,7 @@
     #include <ifaddrs.h>
     #include <linux/errqueue.h>
     #include <netinet/ip_icmp.h>
+    #include <netinet/udp.h>
     #include "queue.h"
 
     #ifndef SO_REUSEPORT
@@ -71,6 +72,42 @@
     #ifndef SO_BINDTODEVICE
     #define SO_BINDTODEVICE	25
     #endif
+
+    #ifndef SO_ZEROCOPY
+    #define SO_ZEROCOPY 60
+    #endif
+
+    #ifndef MSG_ZEROCOPY
+    #define MSG_ZEROCOPY 0x4000000
+    #endif
+
+    #ifndef SO_EE_ORIGIN_ZEROCOPY
+    #define SO_EE_ORIGIN_ZEROCOPY 5
+    #endif
+
+    #ifndef SO_EE_CODE_ZEROCOPY_COPIED
+    #define SO_EE_CODE_ZEROCOPY_COPIED 1
+    #endif
+
+    #ifndef SOL_UDP
+    #define SOL_UDP 17
+    #endif
+
+    #ifndef UDP_SEGMENT
+    #define UDP_SEGMENT 103
+    #endif
+
+    #ifndef UDP_GRO
+    #define UDP_GRO 104
+    #endif
+
+    #ifndef SO_TXTIME
+    #define SO_TXTIME 61
+    #endif
+
+    #ifndef SCM_TXTIME
+    #define SCM_TXTIME SO_TXTIME
+    #endif
 #elif defined(OS_APPLE)
     typedef int32_t     socket_t;
     typedef struct msghdr msghdr_t;
@@ -0,0 +1,241 @@
+/*************************************************************************
+    > File Name: bbr_base.cpp
+    > Author: eular
+    > Brief: BBRv1/BBRv2 共用的带宽与 RTT 模型
+    > Created Time: Sat 17 Oct 2026
+ ************************************************************************/
+
+#include "congestion/bbr_base.h"
+
+#include <inttypes.h>
+
+#include <algorithm>
+
+#include "proto/packet_common.h"
+#include "logger/logger.h"
+
+namespace eular {
+namespace utp {
+
+static const char *mode2str[] = {
+    "StartUp",
+    "Drain",
+    "ProbeBW",
+    "ProbeRTT",
+};
+
+void BbrBase::resetModel(RttStats *stats, uint64_t bwFilterWindow, uint64_t ackHeightWindow)
+{
+    if (stats) {
+        m_rttStats = stats;
+    }
+
+    m_flags = 0;
+    m_mode = Mode::StartUp;
+
+    m_maxBandwidth.init(bwFilterWindow);
+    m_maxAckHeight.init(ackHeightWindow);
+    m_aggregationEpochBytes = 0;
+    m_aggregationEpochStartTime = 0;
+
+    m_lastSentPackNo = 0;
+    m_currentRoundTripEnd = UTP_INVALID_PACKNO;
+    m_roundCount = 0;
+
+    m_minRtt = 0;
+    m_minRttTimestamp = 0;
+    m_minRttSinceLastProbe = UINT64_MAX;
+    m_ackState = AckState();
+}
+
+void BbrBase::onBeginAck(uint64_t ackTimeUs, uint64_t inflight)
+{
+    assert(!(m_flags & BBR_BASE_FLAG_IN_ACK));
+    m_flags |= BBR_BASE_FLAG_IN_ACK;
+    // 丢包检测发生在 onEndAck 之后, 上一次 ACK 之后判定的丢包计入本次 ACK
+    const uint64_t lostBytes = m_ackState.lostBytes;
+    const uint32_t lossEvents = m_ackState.lossEvents;
+    m_ackState = AckState();
+    m_ackState.lostBytes = lostBytes;
+    m_ackState.lossEvents = lossEvents;
+    m_ackState.hasLosses = lossEvents > 0;
+    m_ackState.ackTime = ackTimeUs;
+    m_ackState.maxPackNo = UINT64_MAX;
+    m_ackState.inflightBytes = inflight;
+    m_ackState.totalBytesAckedBefore = m_bwSampler.totalAcked();
+}
+
+void BbrBase::onAck(PacketInfo *packetInfo, uint64_t nowUs, int32_t appLimited)
+{
+    UNUSED(appLimited);
+    assert(m_flags & BBR_BASE_FLAG_IN_ACK);
+    BWSample sample = m_bwSampler.onPacketAcked(packetInfo, nowUs);
+    if (sample.valid()) {
+        m_ackState.sampleList.push_back(sample);
+    }
+
+    if (!IsValidPackNo(m_ackState.maxPackNo) || packetInfo->packetNo > m_ackState.maxPackNo) {
+        m_ackState.maxPackNo = packetInfo->packetNo;
+    }
+    m_ackState.ackedBytes += packetInfo->packetSize;
+}
+
+void BbrBase::onLost(PacketInfo *packetInfo)
+{
+    m_bwSampler.onPacketLost(packetInfo);
+    m_ackState.hasLosses = true;
+    m_ackState.lostBytes += packetInfo->packetSize;
+    ++m_ackState.lossEvents;
+}
+
+void BbrBase::onEcnCe()
+{
+    assert(m_flags & BBR_BASE_FLAG_IN_ACK);
+    m_ackState.hasEcnCe = true;
+}
+
+void BbrBase::onPacketSent(PacketInfo *packetInfo, uint64_t inflight, int32_t isAppLimited)
+{
+    m_bwSampler.onPacketSent(packetInfo, inflight);
+    m_lastSentPackNo = packetInfo->packetNo;
+    if (isAppLimited) {
+        appLimited(inflight);
+    }
+}
+
+void BbrBase::wasQuiet(uint64_t nowUs, uint64_t inflight)
+{
+    UNUSED(nowUs);
+    UNUSED(inflight);
+    UTP_LOGD("BbrBase::wasQuiet called");
+}
+
+uint64_t BbrBase::getMinRtt()
+{
+    if (m_minRtt > 0) {
+        return m_minRtt;
+    }
+
+    uint64_t minRtt = m_rttStats ? m_rttStats->minRTT() : 0;
+    if (minRtt == 0) {
+        minRtt = 25000; // 25ms
+    }
+    return minRtt;
+}
+
+void BbrBase::appLimited(uint64_t inflight)
+{
+    uint64_t cwnd = getCwnd();
+    if (inflight >= cwnd) {
+        return;
+    }
+
+    if (shouldIgnoreAppLimited(inflight)) {
+        return;
+    }
+
+    m_flags |= BBR_BASE_FLAG_APP_LIMITED_SINCE_LAST_PROBE_RTT;
+    m_bwSampler.appLimited();
+    UTP_LOGD("becoming application-limited.  Last sent packet: %" PRIu64 "; CWND: %" PRIu64, m_lastSentPackNo, cwnd);
+}
+
+bool BbrBase::updateRound()
+{
+    bool isRoundStart = m_ackState.maxPackNo > m_currentRoundTripEnd || !IsValidPackNo(m_currentRoundTripEnd);
+    if (isRoundStart) {
+        ++m_roundCount;
+        m_currentRoundTripEnd = m_lastSentPackNo;
+        UTP_LOGD("up round count to %" PRIu64 "; new rt end: %" PRIu64, m_roundCount, m_currentRoundTripEnd);
+    }
+    return isRoundStart;
+}
+
+bool BbrBase::updateBandwidthAndMinRtt(uint64_t filterTime)
+{
+    uint64_t sampleMinRtt = UINT64_MAX;
+    bool minRttExpired = false;
+
+    for (auto it = m_ackState.sampleList.begin(); it != m_ackState.sampleList.end(); ++it) {
+        if (it->isAppLimited) {
+            m_flags |= BBR_BASE_FLAG_LAST_SAMPLE_APP_LIMITED;
+        } else {
+            m_flags &= ~BBR_BASE_FLAG_LAST_SAMPLE_APP_LIMITED;
+            m_flags |=  BBR_BASE_FLAG_HAS_NON_APP_LIMITED;
+        }
+
+        if (sampleMinRtt == UINT64_MAX || static_cast<uint64_t>(it->rtt) < sampleMinRtt) {
+            sampleMinRtt = it->rtt;
+        }
+
+        m_ackState.maxBw = (std::max)(m_ackState.maxBw, BW_VALUE(&it->bandwidth));
+        if (!it->isAppLimited || BW_VALUE(&it->bandwidth) > m_maxBandwidth.get()) {
+            m_maxBandwidth.updateMax(filterTime, BW_VALUE(&it->bandwidth));
+        }
+    }
+
+    if (sampleMinRtt == UINT64_MAX) {
+        return false;
+    }
+
+    m_minRttSinceLastProbe = (std::min)(m_minRttSinceLastProbe, sampleMinRtt);
+    minRttExpired = m_minRtt != 0 && (m_ackState.ackTime > m_minRttTimestamp + m_minRttExpiryUs);
+    if (minRttExpired || sampleMinRtt < m_minRtt || m_minRtt == 0) {
+        if (minRttExpired && shouldExtendMinRttExpiry()) {
+            UTP_LOGD("min rtt expiration extended, stay at: %" PRIu64, m_minRtt);
+            minRttExpired = false;
+        } else {
+            UTP_LOGD("min rtt updated: %" PRIu64 " -> %" PRIu64, m_minRtt, sampleMinRtt);
+            m_minRtt = sampleMinRtt;
+        }
+
+        m_minRttTimestamp = m_ackState.ackTime;
+        m_minRttSinceLastProbe = UINT64_MAX;
+        m_flags &= ~BBR_BASE_FLAG_APP_LIMITED_SINCE_LAST_PROBE_RTT;
+    }
+
+    return minRttExpired;
+}
+
+uint64_t BbrBase::updateAckAggregationBytes(uint64_t bytesAcked)
+{
+    uint64_t ackTime = m_ackState.ackTime;
+    BandWidth bw = BW(m_maxBandwidth.get());
+
+    // 根据估值带宽, 计算预计将传输多少字节; 带宽单位为 bits/s, 时间单位为 us
+    uint64_t expectedBytesAcked = BW_TO_BYTES_PER_SEC(&bw) * (ackTime - m_aggregationEpochStartTime) / 1000000;
+
+    // 一旦ack到达率小于或等于最大带宽, 就重置当前聚合时间。
+    if (m_aggregationEpochBytes <= expectedBytesAcked) {
+        m_aggregationEpochStartTime = ackTime;
+        m_aggregationEpochBytes = bytesAcked;
+        return 0;
+    }
+
+    m_aggregationEpochBytes += bytesAcked;
+    uint64_t diff = m_aggregationEpochBytes - expectedBytesAcked;
+    m_maxAckHeight.updateMax(m_roundCount, diff);
+    return diff;
+}
+
+void BbrBase::finishAck()
+{
+    assert(m_flags & BBR_BASE_FLAG_IN_ACK);
+    m_flags &= ~BBR_BASE_FLAG_IN_ACK;
+    m_ackState.lostBytes = 0;
+    m_ackState.lossEvents = 0;
+    m_ackState.hasLosses = false;
+}
+
+void BbrBase::setMode(Mode newMode)
+{
+    if (m_mode == newMode) {
+        UTP_LOGD("mode remains %s", mode2str[newMode]);
+        return;
+    }
+
+    UTP_LOGD("mode change %s -> %s", mode2str[m_mode], mode2str[newMode]);
+    m_mode = newMode;
+}
+
+} // namespace utp
+} // namespace eular
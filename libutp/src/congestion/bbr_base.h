@@ -0,0 +1,123 @@
+/*************************************************************************
+    > File Name: bbr_base.h
+    > Author: eular
+    > Brief: BBRv1/BBRv2 共用的带宽与 RTT 模型: 带宽采样, max_bw/ack 聚合滤波, 往返轮次与 min_rtt
+    > Created Time: Sat 17 Oct 2026
+ ************************************************************************/
+
+#ifndef __CONGESTION_BBR_BASE_H__
+#define __CONGESTION_BBR_BASE_H__
+
+#include <list>
+
+#include "congestion/congestion.h"
+#include "congestion/rtt.h"
+#include "congestion/bw_sampler.h"
+#include "congestion/minmax.h"
+
+namespace eular {
+namespace utp {
+/**
+ * @brief BBR 模型公共部分
+ *
+ * 负责 ACK 批次的收集 (onBeginAck/onAck/onLost/onEcnCe), 发送记录与 app-limited 标记,
+ * 以及由样本驱动的 max_bw 滤波, min_rtt 和 ack 聚合量. 状态机, pacing/cwnd 计算由派生类实现,
+ * 派生类在 onEndAck 中依次调用 updateRound/updateBandwidthAndMinRtt (BbrV2 还调用 updateAckAggregationBytes),
+ * 最后调用 finishAck.
+ */
+class BbrBase : public Congestion {
+public:
+    enum Mode {
+        StartUp,
+        Drain,
+        ProbeBW,
+        ProbeRTT
+    };
+
+    // 低 4 位由 BbrBase 使用, 派生类的标志从 BBR_BASE_FLAG_END 开始
+    enum BaseFlags {
+        BBR_BASE_FLAG_IN_ACK                    = 1 << 0,   // onBeginAck() 已调用
+        BBR_BASE_FLAG_LAST_SAMPLE_APP_LIMITED   = 1 << 1,
+        BBR_BASE_FLAG_HAS_NON_APP_LIMITED       = 1 << 2,
+        BBR_BASE_FLAG_APP_LIMITED_SINCE_LAST_PROBE_RTT = 1 << 3,
+        BBR_BASE_FLAG_END                       = 1 << 4,
+    };
+
+    struct AckState {
+        std::list<BWSample> sampleList{};
+        uint64_t            ackTime{};
+        uint64_t            maxPackNo{};
+        uint64_t            ackedBytes{};
+        uint64_t            lostBytes{};
+        uint64_t            totalBytesAckedBefore{};
+        uint64_t            inflightBytes{};
+        uint64_t            maxBw{};        // 本次 ACK 中最大的带宽样本 (bits/s)
+        uint32_t            lossEvents{};   // onLost 次数
+        bool                hasLosses{};
+        bool                hasEcnCe{};     // 本次 ACK 带来新的 CE 反馈
+    };
+
+    BbrBase() = default;
+    virtual ~BbrBase() = default;
+
+    virtual void        onBeginAck(uint64_t ackTimeUs, uint64_t inflight) override;
+    virtual void        onAck(PacketInfo *packetInfo, uint64_t nowUs, int32_t appLimited) override;
+    virtual void        onLost(PacketInfo *packetInfo) override;
+    virtual void        onPacketSent(PacketInfo *packetInfo, uint64_t inflight, int32_t isAppLimited) override;
+    virtual void        wasQuiet(uint64_t nowUs, uint64_t inflight) override;
+    virtual void        onEcnCe() override;
+
+    Mode                mode() const { return m_mode; }
+
+protected:
+    /**
+     * @brief 重置模型状态, 派生类的 onInit 调用
+     *
+     * @param stats 连接的 RTT 统计, nullptr 时保留原值
+     * @param bwFilterWindow max_bw 滤波窗口, 单位与 updateBandwidthAndMinRtt 的 filterTime 一致
+     * @param ackHeightWindow ack 聚合滤波窗口 (轮次)
+     */
+    void        resetModel(RttStats *stats, uint64_t bwFilterWindow, uint64_t ackHeightWindow);
+    uint64_t    getMinRtt(); // lsquic get_min_rtt
+    void        appLimited(uint64_t inflight); // lsquic bbr_app_limited
+    /// @brief 判断本次 ACK 是否开始新的往返轮次, 是则推进轮次计数
+    bool        updateRound();
+    /// @brief 用本次 ACK 的样本更新 max_bw 与 min_rtt, 返回 min_rtt 是否过期; filterTime 为 max_bw 滤波器的时间轴
+    bool        updateBandwidthAndMinRtt(uint64_t filterTime); // lsquic update_bandwidth_and_min_rtt
+    uint64_t    updateAckAggregationBytes(uint64_t bytesAcked); // lsquic update_ack_aggregation_bytes
+    /// @brief 结束一次 ACK 处理, 清除已计入本次 ACK 的丢包
+    void        finishAck();
+    void        setMode(Mode newMode); // lsquic set_mode
+
+    /// @brief 即将标记 app-limited 时调用, 返回 true 表示管道已足够满, 不做标记
+    virtual bool        shouldIgnoreAppLimited(uint64_t inflight) { UNUSED(inflight); return false; }
+    /// @brief min_rtt 过期时调用, 返回 true 表示延长当前 min_rtt 的有效期
+    virtual bool        shouldExtendMinRttExpiry() { return false; }
+
+protected:
+    Mode                m_mode{Mode::StartUp};
+    uint64_t            m_flags{0};
+    RttStats*           m_rttStats = nullptr;
+    BandwidthSampler    m_bwSampler;
+    MinMax              m_maxBandwidth;
+    MinMax              m_maxAckHeight; // 用于记录 ACK 聚合的最大值
+
+    uint64_t            m_aggregationEpochStartTime{0}; // 聚合开始时间戳
+    uint64_t            m_aggregationEpochBytes{0}; // 聚合周期内被确认的字节数
+
+    uint64_t            m_lastSentPackNo{0};
+    uint64_t            m_currentRoundTripEnd{0}; // 标记“当前往返轮次”结束的包序号
+    uint64_t            m_roundCount{0}; // 往返轮次计数
+
+    uint64_t            m_minRtt{0}; // 历史观测到的全局最小 RTT 值
+    uint64_t            m_minRttTimestamp{0}; // 记录 m_minRtt 上次更新的时间点
+    uint64_t            m_minRttSinceLastProbe{UINT64_MAX}; // 自上次 PROBE_RTT 之后观测到的最小 RTT 值
+    uint64_t            m_minRttExpiryUs{10000000};
+
+    AckState            m_ackState;
+};
+
+} // namespace utp
+} // namespace eular
+
+#endif // __CONGESTION_BBR_BASE_H__
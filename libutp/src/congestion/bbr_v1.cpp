@@ -9,11 +9,11 @@
 
 #include <inttypes.h>
 
-#include <random>
+#include <limits>
 
 #include "proto/packet_common.h"
 #include "logger/logger.h"
-#include "bbr_v1.h"
+#include "util/random.hpp"
 
 #define ms(val_)    ((val_) * 1000)
 #define sec(val_)   ((val_) * 1000 * 1000)
@@ -152,21 +152,13 @@ BbrV1::BbrV1(const Config *cfg)
 
 void BbrV1::onInit(RttStats *stats)
 {
-    if (stats) {
-        m_rttStats = stats;
-    }
-
-    m_flags = 0;
+    resetModel(stats, 10, 10);
 
-    m_mode = Mode::StartUp;
-    m_roundCount = 0;
+    m_recoveryState = RecoveryState::NotInRecovery;
+    m_endRecoveryAt = 0;
+    m_recoveryWindow = 0;
+    m_startupBytesLost = 0;
 
-    m_maxBandwidth.init(10);
-    m_maxAckHeight.init(10);
-    m_aggregationEpochBytes = 0;
-    m_aggregationEpochStartTime = 0;
-    m_minRtt = 0;
-    m_minRttTimestamp = 0;
     m_initCwnd = m_configInitCwnd;
     m_cwnd = m_configInitCwnd;
     m_maxCwnd = kDefaultMaxCongestionWindowPackets * kDefaultTCPMSS;
@@ -226,50 +218,11 @@ uint64_t BbrV1::getCwnd()
 
 void BbrV1::onBeginAck(uint64_t ackTimeUs, uint64_t inflight)
 {
-    assert(!(m_flags & BBR_FLAG_IN_ACK));
-    m_flags |= BBR_FLAG_IN_ACK;
-    m_ackState = AckState();
-    m_ackState.ackTime = ackTimeUs;
-    m_ackState.maxPackNo = UINT64_MAX;
-    m_ackState.inflightBytes = inflight;
-    m_ackState.totalBytesAckedBefore = m_bwSampler.totalAcked();
-}
-
-void BbrV1::onAck(PacketInfo *packetInfo, uint64_t nowUs, int32_t appLimited)
-{
-    assert(m_flags & BBR_FLAG_IN_ACK);
-    BWSample sample = m_bwSampler.onPacketAcked(packetInfo, nowUs);
-    if (sample.valid()) {
-        m_ackState.sampleList.push_back(sample);
-    }
-
-    if (!IsValidPackNo(m_ackState.maxPackNo) || packetInfo->packetNo > m_ackState.maxPackNo) {
-        m_ackState.maxPackNo = packetInfo->packetNo;
-    }
-    m_ackState.ackedBytes += packetInfo->packetSize;
-}
-
-void BbrV1::onLost(PacketInfo *packetInfo)
-{
-    m_bwSampler.onPacketLost(packetInfo);
-    m_ackState.hasLosses = true;
-    m_ackState.lostBytes += packetInfo->packetSize;
-}
-
-void BbrV1::onPacketSent(PacketInfo *packetInfo, uint64_t inflight, int32_t isAppLimited)
-{
-    m_bwSampler.onPacketSent(packetInfo, inflight);
-    m_lastSentPackNo = packetInfo->packetNo;
-    if (isAppLimited) {
-        appLimited(inflight);
-    }
-}
-
-void BbrV1::wasQuiet(uint64_t nowUs, uint64_t inflight)
-{
-    UNUSED(nowUs);
-    UNUSED(inflight);
-    UTP_LOGD("BbrV1::wasQuiet called");
+    BbrBase::onBeginAck(ackTimeUs, inflight);
+    // BBRv1 只统计本次 ACK 期间报告的丢包, 不接收 BbrBase 结转的上次 ACK 之后的丢包
+    m_ackState.lostBytes = 0;
+    m_ackState.lossEvents = 0;
+    m_ackState.hasLosses = false;
 }
 
 void BbrV1::onEndAck(uint64_t inflight)
@@ -277,30 +230,22 @@ void BbrV1::onEndAck(uint64_t inflight)
     bool isRoundStart;
     bool minRttExpired;
     uint64_t bytesAcked;
-    uint64_t excessAcked;
     uint64_t bytesLost;
+    // BBRv1 的 cwnd 不含 ack 聚合余量, max_ack_height 保持为 0
+    const uint64_t excessAcked = 0;
 
     assert(m_flags & BBR_FLAG_IN_ACK);
-    m_flags &= ~BBR_FLAG_IN_ACK;
 
     UTP_LOGD("end_ack; mode: %s; in_flight: %" PRIu64, mode2str[m_mode], inflight);
 
     bytesAcked = m_bwSampler.totalAcked() - m_ackState.totalBytesAckedBefore;
     if (m_ackState.ackedBytes) {
-        isRoundStart = m_ackState.maxPackNo > m_currentRoundTripEnd || !IsValidPackNo(m_currentRoundTripEnd);
-        if (isRoundStart) {
-            ++m_roundCount;
-            m_currentRoundTripEnd = m_lastSentPackNo;
-            UTP_LOGD("up round count to %" PRIu64 "; new rt end: %" PRIu64, m_roundCount, m_currentRoundTripEnd);
-        }
-
-        minRttExpired = updateBandwidthAndMinRtt();
+        isRoundStart = updateRound();
+        minRttExpired = updateBandwidthAndMinRtt(m_roundCount);
         updateRecoveryState(isRoundStart);
-        excessAcked = updateAckAggregationBytes(bytesAcked);
     } else {
         isRoundStart = false;
         minRttExpired = false;
-        excessAcked = 0;
     }
 
     if (m_mode == Mode::ProbeBW) {
@@ -319,6 +264,7 @@ void BbrV1::onEndAck(uint64_t inflight)
     calculatePacingRate();
     calculateCwnd(bytesAcked, excessAcked);
     calculateRecoveryWindow(bytesAcked, bytesLost, inflight);
+    finishAck();
 }
 
 void BbrV1::setStartupValues()
@@ -327,19 +273,6 @@ void BbrV1::setStartupValues()
     m_cwndGain = m_highCwndGain;
 }
 
-uint64_t BbrV1::getMinRtt()
-{
-    if (m_minRtt > 0 ) {
-        return m_minRtt;
-    }
-
-    uint64_t minRtt = m_rttStats->minRTT();
-    if (minRtt == 0) {
-        minRtt = 25000; // 25ms
-    }
-    return minRtt;
-}
-
 uint64_t BbrV1::getProbeRttCwnd()
 {
     if (m_flags & BBR_FLAG_PROBE_RTT_BASED_ON_BDP) {
@@ -369,20 +302,9 @@ bool BbrV1::inRecovery()
     return m_recoveryState != RecoveryState::NotInRecovery;
 }
 
-void BbrV1::appLimited(uint64_t inflight)
+bool BbrV1::shouldIgnoreAppLimited(uint64_t inflight)
 {
-    uint64_t cwnd = getCwnd();
-    if (inflight >= cwnd) {
-        return;
-    }
-
-    if ((m_flags & BBR_FLAG_FLEXIBLE_APP_LIMITED) && isPipeSufficientlyFull(inflight)) {
-        return;
-    }
-
-    m_flags |= BBR_FLAG_APP_LIMITED_SINCE_LAST_PROBE_RTT;
-    m_bwSampler.appLimited();
-    UTP_LOGD("becoming application-limited.  Last sent packet: %" PRIu64 "; CWND: %" PRIu64, m_lastSentPackNo, cwnd);
+    return (m_flags & BBR_FLAG_FLEXIBLE_APP_LIMITED) && isPipeSufficientlyFull(inflight);
 }
 
 bool BbrV1::isPipeSufficientlyFull(uint64_t inflight)
@@ -401,62 +323,20 @@ bool BbrV1::isPipeSufficientlyFull(uint64_t inflight)
     }
 }
 
-bool BbrV1::updateBandwidthAndMinRtt()
-{
-    uint64_t sampleMinRtt = UINT64_MAX;
-    bool minRttExpired = false;
-
-    for (auto it = m_ackState.sampleList.begin(); it != m_ackState.sampleList.end(); ++it) {
-        if (it->isAppLimited) {
-            m_flags |= BBR_FLAG_LAST_SAMPLE_APP_LIMITED;
-        } else {
-            m_flags &= ~BBR_FLAG_LAST_SAMPLE_APP_LIMITED;
-            m_flags |=  BBR_FLAG_HAS_NON_APP_LIMITED;
-        }
-
-        if (sampleMinRtt == UINT64_MAX || it->rtt < sampleMinRtt) {
-            sampleMinRtt = it->rtt;
-        }
-
-        if (!it->isAppLimited || BW_VALUE(&it->bandwidth) > m_maxBandwidth.get()) {
-            m_maxBandwidth.updateMax(m_roundCount, BW_VALUE(&it->bandwidth));
-        }
-    }
-
-    if (sampleMinRtt == UINT64_MAX) {
-        return false;
-    }
-
-    m_minRttSinceLastProbe = std::min(m_minRttSinceLastProbe, sampleMinRtt);
-    minRttExpired = m_minRtt != 0 && (m_ackState.ackTime > m_minRttTimestamp + m_minRttExpiryUs);
-    if (minRttExpired || sampleMinRtt < m_minRtt || m_minRtt == 0) {
-        if (minRttExpired && shouldExtendMinRttExpiry()) {
-            UTP_LOGD("min rtt expiration extended, stay at: %" PRIu64, m_minRtt);
-            minRttExpired = false;
-        } else {
-            UTP_LOGD("min rtt updated: %" PRIu64 " -> %" PRIu64, m_minRtt, sampleMinRtt);
-            m_minRtt = sampleMinRtt;
-        }
-
-        m_minRttTimestamp = m_ackState.ackTime;
-        m_minRttSinceLastProbe = UINT64_MAX;
-        m_flags &= ~BBR_FLAG_APP_LIMITED_SINCE_LAST_PROBE_RTT;
-    }
-
-    return minRttExpired;
-}
-
 void BbrV1::updateRecoveryState(bool isRoundStart)
 {
+    // CE 反馈与丢包一样进入包守恒, 不必等到队列溢出丢包
+    const bool congested = m_ackState.hasLosses || m_ackState.hasEcnCe;
+
     // 当一轮没有损失时退出丢包恢复模式
-    if (m_ackState.hasLosses) {
+    if (congested) {
         m_endRecoveryAt = m_lastSentPackNo;
     }
 
     switch (m_recoveryState) {
     case NotInRecovery:
         // 丢包后进入保护
-        if (m_ackState.hasLosses) {
+        if (congested) {
             m_recoveryState = RecoveryState::Conservation;
             // m_recoveryWindow 在 calculateRecoveryWindow() 中设置为正确的值
             m_recoveryWindow = 0;
@@ -469,7 +349,7 @@ void BbrV1::updateRecoveryState(bool isRoundStart)
             m_recoveryState = RecoveryState::Growth;
         }
     case Growth:
-        if (!m_ackState.hasLosses && m_ackState.maxPackNo > m_endRecoveryAt) {
+        if (!congested && m_ackState.maxPackNo > m_endRecoveryAt) {
             m_recoveryState = RecoveryState::NotInRecovery;
         }
         break;
@@ -579,26 +459,6 @@ void BbrV1::calculateRecoveryWindow(uint64_t bytesAcked, uint64_t bytestLost, ui
     m_recoveryWindow = (std::max)(m_minCwnd, m_recoveryWindow);
 }
 
-uint64_t BbrV1::updateAckAggregationBytes(uint64_t bytesAcked)
-{
-    uint64_t ackTime = m_ackState.ackTime;
-
-    // 根据估值带宽, 计算预计将传输多少字节
-    uint64_t expectedBytesAcked = m_maxBandwidth.get() * (ackTime - m_aggregationEpochStartTime);
-
-    // 一旦ack到达率小于或等于最大带宽, 就重置当前聚合时间。
-    if (m_aggregationEpochBytes <= expectedBytesAcked) {
-        m_aggregationEpochStartTime = ackTime;
-        m_aggregationEpochBytes = bytesAcked;
-        return 0;
-    }
-
-    m_aggregationEpochBytes += bytesAcked;
-    uint64_t diff = m_aggregationEpochBytes - expectedBytesAcked;
-    m_maxAckHeight.updateMax(m_roundCount, diff);
-    return diff;
-}
-
 void BbrV1::updateGainCyclePhase(uint64_t bytestInflight)
 {
     uint64_t priorInflight = m_ackState.inflightBytes;
@@ -754,27 +614,13 @@ void BbrV1::onExitStartup(uint64_t now)
     // Apparently this method is just to update stats, something that we don't do yet.
 }
 
-void BbrV1::setMode(Mode newMode)
-{
-    if (m_mode == newMode) {
-        UTP_LOGD("mode remains %s", mode2str[newMode]);
-        return;
-    }
-
-    UTP_LOGD("mode change %s -> %s", mode2str[m_mode], mode2str[newMode]);
-    m_mode = newMode;
-}
-
 void BbrV1::enterProbeBWMode(uint64_t now)
 {
     setMode(Mode::ProbeBW);
     m_cwndGain = m_configCwndGain;
 
-    // 使用当前时间作为随机种子
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<unsigned int> dist(0, (std::numeric_limits<uint8_t>::max)());
-    uint8_t randomValue = static_cast<uint8_t>(dist(gen));
+    // 随机选择起始相位, 使用线程内共享的随机数引擎, 不为每次进入 PROBE_BW 构造 random_device
+    uint8_t randomValue = static_cast<uint8_t>(Random<uint32_t>(0, (std::numeric_limits<uint8_t>::max)()));
 
     m_cycleCurrentOffset = randomValue % (m_pacingGains.size() - 1);
     // 跳过1是因为0.75是减小, 当前轮次无法做到后续在增大
@@ -0,0 +1,590 @@
+/*************************************************************************
+    > File Name: bbr_v2.cpp
+    > Author: eular
+    > Brief: BBRv2 拥塞控制, 在 BBRv1 带宽/RTT 模型之上以丢包率和 ECN 约束在途上限
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include "congestion/bbr_v2.h"
+
+#include <inttypes.h>
+
+#include <algorithm>
+
+#include "proto/packet_common.h"
+#include "logger/logger.h"
+#include "util/random.hpp"
+
+#define kDefaultTCPMSS 1460
+#define kMaxSegmentSize kDefaultTCPMSS
+
+#define kDefaultMaxCongestionWindowPackets 2000
+
+// PROBE_BW 各子阶段的 pacing gain
+#define kProbeDownGain      0.9f
+#define kProbeCruiseGain    1.0f
+#define kProbeRefillGain    1.0f
+#define kProbeUpGain        1.25f
+
+// max_bw 滤波窗口: 最近 2 个 PROBE_BW 周期
+#define kMaxBwFilterCycles  2
+// ack 聚合滤波窗口 (轮次)
+#define kAckHeightFilterRounds 10
+
+// PROBE_UP 每轮放宽 inflight_hi 的最大左移位数, 防止溢出
+#define kMaxProbeUpShift    20
+
+// The maximum outgoing packet size allowed.
+#define kMaxOutgoingPacketSize 1452
+
+namespace eular {
+namespace utp {
+
+static const char *mode2str[] = {
+    "StartUp",
+    "Drain",
+    "ProbeBW",
+    "ProbeRTT",
+};
+
+static const char *phase2str[] = {
+    "Down",
+    "Cruise",
+    "Refill",
+    "Up",
+};
+
+BbrV2::BbrV2(const Config *cfg)
+{
+    if (cfg == nullptr) {
+        return;
+    }
+
+    m_configInitCwnd = (std::max<uint64_t>)(1, cfg->bbr_init_cwnd_mss) * kDefaultTCPMSS;
+    m_configMinCwnd = (std::max<uint64_t>)(1, cfg->bbr_min_cwnd_mss) * kDefaultTCPMSS;
+    if (m_configInitCwnd < m_configMinCwnd) {
+        m_configInitCwnd = m_configMinCwnd;
+    }
+
+    if (cfg->bbr_startup_high_gain > 1.0f && cfg->bbr_startup_high_gain <= 4.0f) {
+        m_highGain = cfg->bbr_startup_high_gain;
+    }
+    if (cfg->bbr_cwnd_gain >= 1.0f && cfg->bbr_cwnd_gain <= 4.0f) {
+        m_configCwndGain = cfg->bbr_cwnd_gain;
+    }
+    if (cfg->bbr_startup_growth_target > 1.0f && cfg->bbr_startup_growth_target <= 2.0f) {
+        m_startupGrowthTarget = cfg->bbr_startup_growth_target;
+    }
+    m_startupRounds = (std::max<uint32_t>)(1, cfg->bbr_startup_full_bw_rounds);
+    m_probeRttTimeUs = static_cast<uint64_t>((std::max<uint32_t>)(50, cfg->bbr_probe_rtt_ms)) * 1000ULL;
+    m_minRttExpiryUs = static_cast<uint64_t>((std::max<uint32_t>)(1000, cfg->bbr_min_rtt_expiry_ms)) * 1000ULL;
+    if (cfg->bbr_probe_rtt_multiplier > 0.0f && cfg->bbr_probe_rtt_multiplier <= 1.0f) {
+        m_probeRttMultiplier = cfg->bbr_probe_rtt_multiplier;
+    }
+
+    if (cfg->bbr2_loss_thresh > 0.0f && cfg->bbr2_loss_thresh < 1.0f) {
+        m_lossThresh = cfg->bbr2_loss_thresh;
+    }
+    if (cfg->bbr2_beta > 0.0f && cfg->bbr2_beta < 1.0f) {
+        m_beta = cfg->bbr2_beta;
+    }
+    if (cfg->bbr2_headroom >= 0.0f && cfg->bbr2_headroom < 1.0f) {
+        m_headroom = cfg->bbr2_headroom;
+    }
+    m_startupFullLossCount = (std::max<uint32_t>)(1, cfg->bbr2_startup_full_loss_count);
+    m_probeWaitBaseUs = static_cast<uint64_t>((std::max<uint32_t>)(100, cfg->bbr2_probe_wait_ms)) * 1000ULL;
+    m_probeMaxRounds = (std::max<uint32_t>)(1, cfg->bbr2_probe_max_rounds);
+}
+
+void BbrV2::onInit(RttStats *stats)
+{
+    resetModel(stats, kMaxBwFilterCycles, kAckHeightFilterRounds);
+    m_phase = ProbeBWPhase::Down;
+
+    m_initCwnd = m_configInitCwnd;
+    m_cwnd = m_configInitCwnd;
+    m_minCwnd = m_configMinCwnd;
+    m_maxCwnd = kDefaultMaxCongestionWindowPackets * kDefaultTCPMSS;
+
+    m_inflightHi = UINT64_MAX;
+    m_inflightLo = UINT64_MAX;
+    m_bwLo = UINT64_MAX;
+
+    m_cycleCount = 0;
+    m_round = RoundState();
+
+    m_pacingRate = BW_ZERO();
+    m_pacingGain = m_highGain;
+    m_cwndGain = m_highGain;
+    m_roundWoBwGain = 0;
+    m_bwAtLastRound = BW_ZERO();
+
+    m_cycleStart = 0;
+    m_probeWaitUs = m_probeWaitBaseUs;
+    m_roundsSinceProbe = 0;
+    m_probeUpRounds = 0;
+    m_phaseStart = 0;
+
+    m_exitProbeRttAt = 0;
+    UTP_LOGD("BbrV2::onInit");
+}
+
+uint64_t BbrV2::getPacingRate(int32_t inRecovery)
+{
+    UNUSED(inRecovery);
+    BandWidth bw;
+
+    if (!BW_IS_ZERO(&m_pacingRate)) {
+        bw = m_pacingRate;
+    } else {
+        bw = BW_FROM_BYTES_AND_DELTA(m_initCwnd, getMinRtt());
+        bw = BW_TIMES(&bw, m_highGain);
+    }
+
+    return BW_TO_BYTES_PER_SEC(&bw);
+}
+
+uint64_t BbrV2::getCwnd()
+{
+    uint64_t cwnd = m_cwnd;
+    if (m_mode == Mode::ProbeRTT) {
+        cwnd = (std::min)(cwnd, getProbeRttCwnd());
+    }
+
+    return boundCwnd(cwnd);
+}
+
+void BbrV2::onEndAck(uint64_t inflight)
+{
+    bool isRoundStart = false;
+    bool minRttExpired = false;
+    uint64_t excessAcked = 0;
+    uint64_t bytesAcked;
+
+    assert(m_flags & BBR2_FLAG_IN_ACK);
+
+    UTP_LOGD("end_ack; mode: %s; phase: %s; in_flight: %" PRIu64, mode2str[m_mode], phase2str[m_phase], inflight);
+
+    bytesAcked = m_bwSampler.totalAcked() - m_ackState.totalBytesAckedBefore;
+    if (m_ackState.ackedBytes) {
+        isRoundStart = updateRound();
+        if (isRoundStart) {
+            // 上一轮结束: 按整轮的拥塞信号回退短期下界, 然后开始统计新一轮
+            adaptLowerBounds();
+            m_round = RoundState();
+            m_flags &= ~BBR2_FLAG_LOSS_IN_ROUND;
+            ++m_roundsSinceProbe;
+        }
+
+        minRttExpired = updateBandwidthAndMinRtt(m_cycleCount);
+        m_round.maxBw = (std::max)(m_round.maxBw, m_ackState.maxBw);
+        excessAcked = updateAckAggregationBytes(bytesAcked);
+    }
+
+    m_round.ackedBytes += m_ackState.ackedBytes;
+    m_round.lostBytes += m_ackState.lostBytes;
+    m_round.lossEvents += m_ackState.lossEvents;
+    if (m_ackState.hasEcnCe) {
+        m_round.ecnCe = true;
+    }
+    if (m_ackState.hasLosses || m_ackState.hasEcnCe) {
+        m_flags |= BBR2_FLAG_LOSS_IN_ROUND;
+    }
+
+    if (isInflightTooHigh()) {
+        handleInflightTooHigh();
+    }
+
+    if (m_mode == Mode::ProbeBW) {
+        raiseInflightHi(isRoundStart, inflight);
+        updateProbeBWPhase(isRoundStart, inflight);
+    }
+
+    checkIsFullBwReached(isRoundStart);
+    maybeExitStartupOrDrain(m_ackState.ackTime, inflight);
+    maybeEnterOrExitProbeRtt(m_ackState.ackTime, isRoundStart, minRttExpired, inflight);
+
+    calculatePacingRate();
+    calculateCwnd(bytesAcked, excessAcked);
+    finishAck();
+}
+
+uint64_t BbrV2::getBandwidth()
+{
+    return (std::min)(m_maxBandwidth.get(), m_bwLo);
+}
+
+uint64_t BbrV2::getTargetInflight(float_t gain)
+{
+    BandWidth bw = BW(getBandwidth());
+    uint64_t bdp = getMinRtt() * BW_TO_BYTES_PER_SEC(&bw) / 1000000;
+    uint64_t cwnd = static_cast<uint64_t>(gain * bdp);
+
+    if (cwnd == 0) {
+        cwnd = static_cast<uint64_t>(gain * m_initCwnd);
+    }
+
+    return (std::max)(cwnd, m_minCwnd);
+}
+
+uint64_t BbrV2::getProbeRttCwnd()
+{
+    return getTargetInflight(m_probeRttMultiplier);
+}
+
+uint64_t BbrV2::getInflightWithHeadroom()
+{
+    if (m_inflightHi == UINT64_MAX) {
+        return UINT64_MAX;
+    }
+
+    uint64_t hi = m_inflightHi - static_cast<uint64_t>(m_inflightHi * m_headroom);
+    return (std::max)(hi, m_minCwnd);
+}
+
+uint64_t BbrV2::boundCwnd(uint64_t cwnd)
+{
+    uint64_t cap = UINT64_MAX;
+    if (m_inflightHi != UINT64_MAX) {
+        // CRUISE 与 PROBE_RTT 在 inflight_hi 之下预留余量, 给新加入的流腾出空间
+        if (m_mode == Mode::ProbeRTT || (m_mode == Mode::ProbeBW && m_phase == ProbeBWPhase::Cruise)) {
+            cap = getInflightWithHeadroom();
+        } else {
+            cap = m_inflightHi;
+        }
+    }
+    cap = (std::min)(cap, m_inflightLo);
+    cap = (std::max)(cap, m_minCwnd);
+
+    return (std::min)(cwnd, cap);
+}
+
+bool BbrV2::isInflightTooHigh() const
+{
+    if (m_round.ecnCe) {
+        return true;
+    }
+
+    const uint64_t lost = m_round.lostBytes;
+    if (lost == 0) {
+        return false;
+    }
+    return lost > m_lossThresh * (m_round.ackedBytes + lost);
+}
+
+void BbrV2::handleInflightTooHigh()
+{
+    const uint64_t inflightAtLoss = m_ackState.inflightBytes;
+
+    // STARTUP: 单轮丢包事件足够多(或收到 CE)时直接判定满带宽, 不再等待带宽停止增长
+    if (m_mode == Mode::StartUp) {
+        if (!m_round.ecnCe && m_round.lossEvents < m_startupFullLossCount) {
+            return;
+        }
+        m_flags |= BBR2_FLAG_IS_AT_FULL_BANDWIDTH;
+        m_inflightHi = (std::max)(getTargetInflight(1.0f), inflightAtLoss);
+        UTP_LOGD("loss rate too high in startup, inflight_hi: %" PRIu64, m_inflightHi);
+        return;
+    }
+
+    if (m_mode != Mode::ProbeBW) {
+        return;
+    }
+
+    // app-limited 的样本不能说明路径容量, 只退出探测而不收紧上限
+    if (!(m_flags & BBR2_FLAG_LAST_SAMPLE_APP_LIMITED)) {
+        uint64_t hi = (std::max)(inflightAtLoss, static_cast<uint64_t>(getTargetInflight(1.0f) * m_beta));
+        hi = (std::max)(hi, m_minCwnd);
+        if (hi < m_inflightHi) {
+            UTP_LOGD("inflight too high, inflight_hi: %" PRIu64 " -> %" PRIu64, m_inflightHi, hi);
+            m_inflightHi = hi;
+        }
+    }
+
+    if (m_phase == ProbeBWPhase::Up) {
+        startProbeDown();
+    }
+}
+
+void BbrV2::adaptLowerBounds()
+{
+    if (!(m_flags & BBR2_FLAG_LOSS_IN_ROUND)) {
+        return;
+    }
+    // 探测带宽期间的拥塞信号由 inflight_hi 处理
+    if (m_mode == Mode::StartUp ||
+        (m_mode == Mode::ProbeBW && (m_phase == ProbeBWPhase::Refill || m_phase == ProbeBWPhase::Up))) {
+        return;
+    }
+
+    if (m_bwLo == UINT64_MAX && m_maxBandwidth.get() != 0) {
+        m_bwLo = m_maxBandwidth.get();
+    }
+    if (m_inflightLo == UINT64_MAX) {
+        m_inflightLo = m_cwnd;
+    }
+
+    if (m_bwLo != UINT64_MAX) {
+        m_bwLo = (std::max)(m_round.maxBw, static_cast<uint64_t>(m_bwLo * m_beta));
+    }
+    m_inflightLo = (std::max)(m_round.ackedBytes, static_cast<uint64_t>(m_inflightLo * m_beta));
+    m_inflightLo = (std::max)(m_inflightLo, m_minCwnd);
+    UTP_LOGD("lower bounds adapted, bw_lo: %" PRIu64 "; inflight_lo: %" PRIu64, m_bwLo, m_inflightLo);
+}
+
+void BbrV2::resetLowerBounds()
+{
+    m_bwLo = UINT64_MAX;
+    m_inflightLo = UINT64_MAX;
+}
+
+void BbrV2::raiseInflightHi(bool isRoundStart, uint64_t inflight)
+{
+    UNUSED(inflight);
+    if (m_phase != ProbeBWPhase::Up || !isRoundStart || m_inflightHi == UINT64_MAX) {
+        return;
+    }
+    // 只有 cwnd 确实被 inflight_hi 约束时才放宽, 否则放宽没有被验证
+    if (m_cwnd < m_inflightHi) {
+        return;
+    }
+
+    // 每轮放宽量翻倍: 1, 2, 4 ... 个 MSS
+    const uint32_t shift = (std::min<uint32_t>)(m_probeUpRounds, kMaxProbeUpShift);
+    m_inflightHi += static_cast<uint64_t>(kMaxSegmentSize) << shift;
+    ++m_probeUpRounds;
+    UTP_LOGD("probe up round %" PRIu32 ", inflight_hi raised to %" PRIu64, m_probeUpRounds, m_inflightHi);
+}
+
+void BbrV2::updateProbeBWPhase(bool isRoundStart, uint64_t inflight)
+{
+    const uint64_t now = m_ackState.ackTime;
+
+    switch (m_phase) {
+    case ProbeBWPhase::Down:
+        if (isTimeToProbeBW()) {
+            startProbeRefill();
+            break;
+        }
+        // 排空到 BDP 且低于 inflight_hi 余量线后进入 CRUISE
+        if (inflight <= (std::min)(getTargetInflight(1.0f), getInflightWithHeadroom())) {
+            startProbeCruise();
+        }
+        break;
+    case ProbeBWPhase::Cruise:
+        if (isTimeToProbeBW()) {
+            startProbeRefill();
+        }
+        break;
+    case ProbeBWPhase::Refill:
+        // startProbeRefill 重新开始了一轮, 满一轮后管道已填满
+        if (isRoundStart) {
+            startProbeUp();
+        }
+        break;
+    case ProbeBWPhase::Up:
+        if (now - m_phaseStart >= getMinRtt() && inflight >= getTargetInflight(kProbeUpGain)) {
+            startProbeDown();
+        }
+        break;
+    }
+}
+
+void BbrV2::checkIsFullBwReached(bool isRoundStart)
+{
+    if (!isRoundStart || (m_flags & BBR2_FLAG_IS_AT_FULL_BANDWIDTH)) {
+        return;
+    }
+    if (m_flags & BBR2_FLAG_LAST_SAMPLE_APP_LIMITED) {
+        UTP_LOGD("last sample app limited: full BW not reached");
+        return;
+    }
+
+    BandWidth target = BW_TIMES(&m_bwAtLastRound, m_startupGrowthTarget);
+    BandWidth bw = BW(m_maxBandwidth.get());
+    if (BW_VALUE(&bw) >= BW_VALUE(&target)) {
+        m_bwAtLastRound = bw;
+        m_roundWoBwGain = 0;
+        UTP_LOGD("bandwidth increased to %" PRIu64 "bytes/sec: full BW not reached", BW_TO_BYTES_PER_SEC(&bw));
+        return;
+    }
+
+    ++m_roundWoBwGain;
+    if (m_roundWoBwGain >= m_startupRounds) {
+        m_flags |= BBR2_FLAG_IS_AT_FULL_BANDWIDTH;
+        UTP_LOGD("no bandwidth growth for %" PRIu32 " rounds: full BW reached", m_startupRounds);
+    }
+}
+
+void BbrV2::maybeExitStartupOrDrain(uint64_t now, uint64_t inflight)
+{
+    UNUSED(now);
+    if (m_mode == Mode::StartUp && (m_flags & BBR2_FLAG_IS_AT_FULL_BANDWIDTH)) {
+        setMode(Mode::Drain);
+        m_pacingGain = 1.0f / m_highGain;
+        m_cwndGain = m_highGain;
+    }
+
+    if (m_mode == Mode::Drain) {
+        uint64_t targetCwnd = getTargetInflight(1.0f);
+        UTP_LOGD("bytes in flight: %" PRIu64 "; target cwnd: %" PRIu64, inflight, targetCwnd);
+        if (inflight <= targetCwnd) {
+            enterProbeBWMode();
+        }
+    }
+}
+
+void BbrV2::maybeEnterOrExitProbeRtt(uint64_t now, bool isRoundStart, bool minRttExpired, uint64_t inflight)
+{
+    if (minRttExpired && m_mode != Mode::ProbeRTT) {
+        setMode(Mode::ProbeRTT);
+        m_pacingGain = 1.0f;
+        m_exitProbeRttAt = 0;
+    }
+
+    if (m_mode != Mode::ProbeRTT) {
+        return;
+    }
+
+    m_bwSampler.appLimited();
+    if (m_exitProbeRttAt == 0) {
+        if (inflight < getProbeRttCwnd() + kMaxOutgoingPacketSize) {
+            m_flags &= ~BBR2_FLAG_PROBE_RTT_ROUND_PASSED;
+            m_exitProbeRttAt = now + m_probeRttTimeUs;
+            UTP_LOGD("exit time set to %" PRIu64, m_exitProbeRttAt);
+        }
+        return;
+    }
+
+    if (isRoundStart) {
+        m_flags |= BBR2_FLAG_PROBE_RTT_ROUND_PASSED;
+    }
+    if (now >= m_exitProbeRttAt && (m_flags & BBR2_FLAG_PROBE_RTT_ROUND_PASSED)) {
+        m_minRttTimestamp = now;
+        resetLowerBounds();
+        if (!(m_flags & BBR2_FLAG_IS_AT_FULL_BANDWIDTH)) {
+            enterStartupMode();
+        } else {
+            // 队列已在 PROBE_RTT 中排空, 直接进入 CRUISE
+            enterProbeBWMode();
+            startProbeCruise();
+        }
+    }
+}
+
+void BbrV2::calculatePacingRate()
+{
+    BandWidth bw = BW(getBandwidth());
+    if (BW_IS_ZERO(&bw)) {
+        return;
+    }
+
+    BandWidth targetRate = BW_TIMES(&bw, m_pacingGain);
+    if (m_flags & BBR2_FLAG_IS_AT_FULL_BANDWIDTH) {
+        m_pacingRate = targetRate;
+        return;
+    }
+
+    // RTT测量结果可用后, 以 初始拥塞窗口 / RTT 的速度进行
+    if (BW_IS_ZERO(&m_pacingRate) && m_rttStats != nullptr && 0 != m_rttStats->minRTT()) {
+        m_pacingRate = BW_FROM_BYTES_AND_DELTA(m_initCwnd, m_rttStats->minRTT());
+        return;
+    }
+
+    if (BW_VALUE(&m_pacingRate) < BW_VALUE(&targetRate)) {
+        m_pacingRate = targetRate;
+    }
+}
+
+void BbrV2::calculateCwnd(uint64_t bytesAcked, uint64_t excessAcked)
+{
+    if (m_mode == Mode::ProbeRTT) {
+        return;
+    }
+
+    uint64_t targetWindow = getTargetInflight(m_cwndGain);
+    if (m_flags & BBR2_FLAG_IS_AT_FULL_BANDWIDTH) {
+        targetWindow += m_maxAckHeight.get();
+        m_cwnd = (std::min)(targetWindow, m_cwnd + bytesAcked);
+    } else {
+        UNUSED(excessAcked);
+        if (m_cwnd < targetWindow || m_bwSampler.totalAcked() < m_initCwnd) {
+            m_cwnd += bytesAcked;
+        }
+    }
+
+    m_cwnd = CLAMP(m_cwnd, m_minCwnd, m_maxCwnd);
+    m_cwnd = boundCwnd(m_cwnd);
+}
+
+void BbrV2::setPhase(ProbeBWPhase phase)
+{
+    UTP_LOGD("probe bw phase %s -> %s", phase2str[m_phase], phase2str[phase]);
+    m_phase = phase;
+    m_phaseStart = m_ackState.ackTime;
+}
+
+void BbrV2::enterStartupMode()
+{
+    setMode(Mode::StartUp);
+    m_pacingGain = m_highGain;
+    m_cwndGain = m_highGain;
+}
+
+void BbrV2::enterProbeBWMode()
+{
+    setMode(Mode::ProbeBW);
+    m_cwndGain = m_configCwndGain;
+    startProbeDown();
+}
+
+void BbrV2::startProbeDown()
+{
+    setPhase(ProbeBWPhase::Down);
+    m_pacingGain = kProbeDownGain;
+    m_cycleStart = m_ackState.ackTime;
+    m_roundsSinceProbe = 0;
+    m_probeUpRounds = 0;
+
+    // 下一次探测在 [base, 1.5 * base] 内随机, 避免多条流同步探测
+    m_probeWaitUs = m_probeWaitBaseUs + Random<uint64_t>(0, m_probeWaitBaseUs / 2);
+}
+
+void BbrV2::startProbeCruise()
+{
+    setPhase(ProbeBWPhase::Cruise);
+    m_pacingGain = kProbeCruiseGain;
+}
+
+void BbrV2::startProbeRefill()
+{
+    resetLowerBounds();
+    setPhase(ProbeBWPhase::Refill);
+    m_pacingGain = kProbeRefillGain;
+    m_probeUpRounds = 0;
+    m_currentRoundTripEnd = m_lastSentPackNo;
+}
+
+void BbrV2::startProbeUp()
+{
+    setPhase(ProbeBWPhase::Up);
+    m_pacingGain = kProbeUpGain;
+    m_probeUpRounds = 0;
+    m_currentRoundTripEnd = m_lastSentPackNo;
+    ++m_cycleCount;
+}
+
+bool BbrV2::isTimeToProbeBW()
+{
+    if (m_ackState.ackTime - m_cycleStart >= m_probeWaitUs) {
+        return true;
+    }
+
+    // 与 Reno/CUBIC 共存: 至多等待 min(BDP 包数, probe_max_rounds) 轮
+    uint64_t rounds = getTargetInflight(1.0f) / kMaxSegmentSize;
+    rounds = CLAMP(rounds, static_cast<uint64_t>(1), static_cast<uint64_t>(m_probeMaxRounds));
+    return m_roundsSinceProbe >= rounds;
+}
+
+} // namespace utp
+} // namespace eular
@@ -0,0 +1,145 @@
+/*************************************************************************
+    > File Name: bbr_v2.h
+    > Author: eular
+    > Brief: BBRv2 拥塞控制, 在 BBRv1 带宽/RTT 模型之上以丢包率和 ECN 约束在途上限
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#ifndef __CONGESTION_BBR_V2_H__
+#define __CONGESTION_BBR_V2_H__
+
+#include "congestion/bbr_base.h"
+#include "utp/config.h"
+
+namespace eular {
+namespace utp {
+/**
+ * @brief BBRv2 (参考 Linux tcp_bbr2)
+ *
+ * 与 BbrV1 的差异:
+ * - inflight_hi: 长期在途上限, 单轮丢包率超过 loss_thresh 或收到 CE 时收紧, PROBE_UP 阶段逐轮放宽;
+ * - inflight_lo/bw_lo: 短期下界, 每个发生拥塞信号的轮次按 beta 回退, 进入 REFILL 时清除;
+ * - PROBE_BW 拆分为 DOWN/CRUISE/REFILL/UP 四个子阶段, CRUISE 在 inflight_hi 之下预留 headroom;
+ * - STARTUP 在单轮丢包率过高时直接判定满带宽并退出.
+ *
+ * 丢包率按往返轮次统计 (本轮丢失字节 / 本轮确认与丢失字节之和), 不依赖逐包记录发送时的在途量.
+ * 带宽采样, max_bw/ack 聚合滤波与 min_rtt 由 BbrBase 维护, 本类只实现状态机与丢包/ECN 约束.
+ */
+class BbrV2 : public BbrBase {
+public:
+    enum ProbeBWPhase {
+        Down,       // 排空探测产生的队列, 并在 inflight_hi 之下留出余量
+        Cruise,     // 以估计带宽平稳发送, 等待下一次探测
+        Refill,     // 清除短期下界, 用一轮把管道填满
+        Up,         // 以 1.25 倍带宽探测, 逐轮放宽 inflight_hi
+    };
+
+    enum Flags {
+        BBR2_FLAG_IN_ACK                    = BBR_BASE_FLAG_IN_ACK,
+        BBR2_FLAG_LAST_SAMPLE_APP_LIMITED   = BBR_BASE_FLAG_LAST_SAMPLE_APP_LIMITED,
+        BBR2_FLAG_HAS_NON_APP_LIMITED       = BBR_BASE_FLAG_HAS_NON_APP_LIMITED,
+        BBR2_FLAG_IS_AT_FULL_BANDWIDTH      = BBR_BASE_FLAG_END << 0,
+        BBR2_FLAG_PROBE_RTT_ROUND_PASSED    = BBR_BASE_FLAG_END << 1,
+        BBR2_FLAG_LOSS_IN_ROUND             = BBR_BASE_FLAG_END << 2,   // 本轮出现过丢包或 CE, 轮末回退短期下界
+    };
+
+    /// @brief 单个往返轮次内的拥塞信号统计, 轮次开始时清零
+    struct RoundState {
+        uint64_t            ackedBytes{};
+        uint64_t            lostBytes{};
+        uint32_t            lossEvents{};       // onLost 次数
+        uint64_t            maxBw{};            // 本轮最大带宽样本 (bits/s), 用于回退 bw_lo
+        bool                ecnCe{};
+    };
+
+    explicit BbrV2(const Config *cfg = nullptr);
+    ~BbrV2() = default;
+
+    virtual void        onInit(RttStats *stats) override;
+    virtual uint64_t    getPacingRate(int32_t inRecovery) override;
+    virtual uint64_t    getCwnd() override;
+    virtual void        onEndAck(uint64_t inflight) override;
+
+    ProbeBWPhase        phase() const { return m_phase; }
+    /// @brief 长期在途上限, 未受约束时为 UINT64_MAX
+    uint64_t            inflightHi() const { return m_inflightHi; }
+    /// @brief 短期在途下界, 未受约束时为 UINT64_MAX
+    uint64_t            inflightLo() const { return m_inflightLo; }
+
+protected:
+    uint64_t    getBandwidth(); // min(max_bw, bw_lo), bits/s
+    uint64_t    getTargetInflight(float_t gain);
+    uint64_t    getProbeRttCwnd();
+    uint64_t    getInflightWithHeadroom();
+    uint64_t    boundCwnd(uint64_t cwnd);
+    bool        isInflightTooHigh() const;
+    void        handleInflightTooHigh();
+    void        adaptLowerBounds();
+    void        resetLowerBounds();
+    void        raiseInflightHi(bool isRoundStart, uint64_t inflight);
+    void        updateProbeBWPhase(bool isRoundStart, uint64_t inflight);
+    void        checkIsFullBwReached(bool isRoundStart);
+    void        maybeExitStartupOrDrain(uint64_t now, uint64_t inflight);
+    void        maybeEnterOrExitProbeRtt(uint64_t now, bool isRoundStart, bool minRttExpired, uint64_t inflight);
+    void        calculatePacingRate();
+    void        calculateCwnd(uint64_t bytesAcked, uint64_t excessAcked);
+
+protected:
+    void        setPhase(ProbeBWPhase phase);
+    void        enterStartupMode();
+    void        enterProbeBWMode();
+    void        startProbeDown();
+    void        startProbeCruise();
+    void        startProbeRefill();
+    void        startProbeUp();
+    bool        isTimeToProbeBW();
+
+private:
+    ProbeBWPhase        m_phase;
+
+    uint64_t            m_initCwnd;
+    uint64_t            m_minCwnd;
+    uint64_t            m_maxCwnd;
+    uint64_t            m_cwnd;
+
+    uint64_t            m_inflightHi;           // 长期在途上限
+    uint64_t            m_inflightLo;           // 短期在途下界
+    uint64_t            m_bwLo;                 // 短期带宽下界 (bits/s)
+
+    uint64_t            m_cycleCount;           // 已开始的 PROBE_UP 次数, 作为 max_bw 滤波器的时间轴
+    RoundState          m_round;
+
+    BandWidth           m_pacingRate;
+    float_t             m_pacingGain;
+    float_t             m_cwndGain;
+    uint32_t            m_roundWoBwGain;
+    BandWidth           m_bwAtLastRound;
+
+    uint64_t            m_cycleStart;           // 当前 PROBE_BW 周期 (DOWN 起) 的开始时间
+    uint64_t            m_probeWaitUs;          // 本周期距离下一次探测的等待时间
+    uint32_t            m_roundsSinceProbe;     // 本周期经过的轮次
+    uint32_t            m_probeUpRounds;        // PROBE_UP 已放宽 inflight_hi 的轮数
+    uint64_t            m_phaseStart;           // 当前子阶段开始时间
+
+    uint64_t            m_exitProbeRttAt;
+
+    uint64_t            m_configInitCwnd{16 * 1460ULL};
+    uint64_t            m_configMinCwnd{4 * 1460ULL};
+    float               m_highGain{2.885f};
+    float               m_configCwndGain{2.0f};
+    float               m_startupGrowthTarget{1.25f};
+    uint32_t            m_startupRounds{3};
+    uint64_t            m_probeRttTimeUs{200000};
+    float               m_probeRttMultiplier{0.75f};
+    float               m_lossThresh{0.02f};
+    float               m_beta{0.7f};
+    float               m_headroom{0.15f};
+    uint32_t            m_startupFullLossCount{8};
+    uint64_t            m_probeWaitBaseUs{2000000};
+    uint32_t            m_probeMaxRounds{63};
+};
+
+} // namespace utp
+} // namespace eular
+
+#endif // __CONGESTION_BBR_V2_H__
@@ -24,6 +24,14 @@ struct PacketInfo {
     void*       packetState{nullptr}; // bw_sampler.h BWPacketState
 };
 
+/// @brief 慢启动退出统计 (HyStart++), 不支持的算法全部为 0
+struct SlowStartStats {
+    uint64_t    cssEntries{0};      // RTT 增长触发进入 CSS 的次数
+    uint64_t    cssSpurious{0};     // CSS 中 RTT 回落, 判定为误判并恢复慢启动的次数
+    uint64_t    delayExits{0};      // 完成 CSS 后无丢包进入拥塞避免的次数
+    uint64_t    exitCwnd{0};        // 最近一次离开慢启动时的 cwnd (bytes)
+};
+
 class Congestion {
 public:
     using SP  = std::shared_ptr<Congestion>;
@@ -44,6 +52,9 @@ public:
     virtual void        onEndAck(uint64_t inFlight) = 0;
     virtual void        onLoss() {}
     virtual void        onTimeout() {}
+    /// @brief 对端 ACK 中的 CE 计数增加, 每轮最多调用一次; BBR 类算法须在 onBeginAck/onEndAck 之间调用
+    virtual void        onEcnCe() {}
+    virtual SlowStartStats slowStartStats() const { return SlowStartStats(); }
 };
 
 } // namespace utp
@@ -31,6 +31,14 @@ Cubic::Cubic(const Config *cfg)
     m_minCwnd = std::min<uint64_t>(minCwnd, kMaxCwnd);
     m_initCwnd = std::min<uint64_t>(std::max<uint64_t>(initCwnd, m_minCwnd), kMaxCwnd);
     m_cwnd = m_initCwnd;
+
+    m_hystartEnabled = cfg->cubic_hystart;
+    m_hsMinRttThreshUs = static_cast<uint64_t>(std::max<uint32_t>(1, cfg->cubic_hystart_min_rtt_thresh_ms)) * 1000;
+    m_hsMaxRttThreshUs = static_cast<uint64_t>(cfg->cubic_hystart_max_rtt_thresh_ms) * 1000;
+    m_hsMaxRttThreshUs = std::max<uint64_t>(m_hsMaxRttThreshUs, m_hsMinRttThreshUs);
+    m_hsRttSamples = std::max<uint32_t>(1, cfg->cubic_hystart_rtt_samples);
+    m_hsCssGrowthDivisor = std::max<uint32_t>(2, cfg->cubic_hystart_css_growth_divisor);
+    m_hsCssRounds = std::max<uint32_t>(1, cfg->cubic_hystart_css_rounds);
 }
 
 void Cubic::onInit(RttStats *stats)
@@ -43,6 +51,17 @@ void Cubic::onInit(RttStats *stats)
     m_lastMaxCwnd = 0;
     m_originPointCwnd = 0;
     m_k = 0.0;
+
+    m_hsState = m_hystartEnabled ? HyStartState::SlowStart : HyStartState::Done;
+    m_lastSentPackNo = 0;
+    m_hsWindowEnd = 0;
+    m_hsLastRoundMinRtt = UINT64_MAX;
+    m_hsCurrentRoundMinRtt = UINT64_MAX;
+    m_hsRttSampleCount = 0;
+    m_hsCssBaselineMinRtt = UINT64_MAX;
+    m_hsCssRoundCount = 0;
+    m_hsCssAckedRemainder = 0;
+    m_ssStats = SlowStartStats();
 }
 
 uint64_t Cubic::getPacingRate(int32_t inRecovery)
@@ -76,8 +95,9 @@ void Cubic::onAck(PacketInfo *packetInfo, uint64_t nowUs, int32_t appLimited)
     m_ackedBytes += acked;
 
     if (m_cwnd < m_ssthresh) {
-        // Slow start.
-        m_cwnd = std::min<uint64_t>(m_cwnd + acked, kMaxCwnd);
+        // Slow start. HyStart++ 在 CSS 阶段降低增长速度, 并可能在本次确认中结束慢启动
+        const uint64_t inc = (m_hsState != HyStartState::Done) ? hystartOnAck(packetInfo, nowUs, acked) : acked;
+        m_cwnd = std::min<uint64_t>(m_cwnd + inc, kMaxCwnd);
         return;
     }
 
@@ -92,7 +112,12 @@ void Cubic::onAck(PacketInfo *packetInfo, uint64_t nowUs, int32_t appLimited)
 void Cubic::onLost(PacketInfo *packetInfo)
 {
     (void)packetInfo;
+    hystartExit();
+    multiplicativeDecrease();
+}
 
+void Cubic::multiplicativeDecrease()
+{
     if (m_cwnd < m_lastMaxCwnd) {
         m_lastMaxCwnd = static_cast<uint64_t>((m_cwnd * (2.0 - m_beta)) / 2.0);
     } else {
@@ -106,7 +131,9 @@ void Cubic::onLost(PacketInfo *packetInfo)
 
 void Cubic::onPacketSent(PacketInfo *packetInfo, uint64_t inFlight, int32_t appLimited)
 {
-    (void)packetInfo;
+    if (packetInfo != nullptr && packetInfo->packetNo > m_lastSentPackNo) {
+        m_lastSentPackNo = packetInfo->packetNo;
+    }
     (void)inFlight;
     (void)appLimited;
 }
@@ -124,14 +151,85 @@ void Cubic::onEndAck(uint64_t inFlight)
     (void)inFlight;
 }
 
+void Cubic::onEcnCe()
+{
+    // RFC 9438 4.6: CE 反馈与丢包同样视为拥塞事件, 由 SendControl 保证每轮只降一次
+    hystartExit();
+    multiplicativeDecrease();
+}
+
 void Cubic::onTimeout()
 {
+    hystartExit();
     m_lastMaxCwnd = m_cwnd;
     m_ssthresh = std::max<uint64_t>(static_cast<uint64_t>(m_cwnd * m_beta), m_minCwnd);
     m_cwnd = m_minCwnd;
     resetEpoch();
 }
 
+uint64_t Cubic::hystartOnAck(const PacketInfo *packetInfo, uint64_t nowUs, uint64_t ackedBytes)
+{
+    // 新一轮: 确认了上一轮结束时发出的最大包号之后的包
+    if (m_hsWindowEnd == 0 || packetInfo->packetNo > m_hsWindowEnd) {
+        if (m_hsState == HyStartState::Css && ++m_hsCssRoundCount >= m_hsCssRounds) {
+            // CSS 持续 CSS_ROUNDS 轮仍未回落, 确认已到达瓶颈, 进入拥塞避免
+            m_ssthresh = std::max<uint64_t>(m_cwnd, m_minCwnd);
+            m_hsState = HyStartState::Done;
+            ++m_ssStats.delayExits;
+            m_ssStats.exitCwnd = m_cwnd;
+            return 0;
+        }
+
+        m_hsLastRoundMinRtt = m_hsCurrentRoundMinRtt;
+        m_hsCurrentRoundMinRtt = UINT64_MAX;
+        m_hsRttSampleCount = 0;
+        m_hsWindowEnd = std::max<uint64_t>(m_lastSentPackNo, packetInfo->packetNo);
+    }
+
+    if (nowUs > packetInfo->sendTimeUs) {
+        m_hsCurrentRoundMinRtt = std::min<uint64_t>(m_hsCurrentRoundMinRtt, nowUs - packetInfo->sendTimeUs);
+        ++m_hsRttSampleCount;
+    }
+
+    const bool enoughSamples = m_hsRttSampleCount >= m_hsRttSamples
+        && m_hsCurrentRoundMinRtt != UINT64_MAX && m_hsLastRoundMinRtt != UINT64_MAX;
+    if (m_hsState == HyStartState::SlowStart && enoughSamples) {
+        uint64_t rttThresh = m_hsLastRoundMinRtt / 8;
+        rttThresh = std::min<uint64_t>(std::max<uint64_t>(rttThresh, m_hsMinRttThreshUs), m_hsMaxRttThreshUs);
+        if (m_hsCurrentRoundMinRtt >= m_hsLastRoundMinRtt + rttThresh) {
+            m_hsCssBaselineMinRtt = m_hsCurrentRoundMinRtt;
+            m_hsCssRoundCount = 0;
+            m_hsCssAckedRemainder = 0;
+            m_hsState = HyStartState::Css;
+            ++m_ssStats.cssEntries;
+        }
+    } else if (m_hsState == HyStartState::Css && enoughSamples
+               && m_hsCurrentRoundMinRtt < m_hsCssBaselineMinRtt) {
+        // RTT 回落说明此前的增长只是抖动, 恢复标准慢启动
+        m_hsCssBaselineMinRtt = UINT64_MAX;
+        m_hsState = HyStartState::SlowStart;
+        ++m_ssStats.cssSpurious;
+    }
+
+    if (m_hsState != HyStartState::Css) {
+        return ackedBytes;
+    }
+
+    m_hsCssAckedRemainder += ackedBytes;
+    const uint64_t inc = m_hsCssAckedRemainder / m_hsCssGrowthDivisor;
+    m_hsCssAckedRemainder %= m_hsCssGrowthDivisor;
+    return inc;
+}
+
+void Cubic::hystartExit()
+{
+    // 慢启动 (含 HyStart++ 关闭或 RTO 之后的慢启动) 因拥塞信号结束
+    if (m_cwnd < m_ssthresh) {
+        m_ssStats.exitCwnd = m_cwnd;
+    }
+    m_hsState = HyStartState::Done;
+}
+
 uint64_t Cubic::smoothedRttUs() const
 {
     uint64_t srttUs = 25000;
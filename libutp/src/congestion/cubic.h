@@ -29,6 +29,17 @@ public:
     void        wasQuiet(uint64_t nowUs, uint64_t inFlight) override;
     void        onEndAck(uint64_t inFlight) override;
     void        onTimeout() override;
+    void        onEcnCe() override;
+    SlowStartStats slowStartStats() const override { return m_ssStats; }
+
+    /// @brief HyStart++ 状态 (RFC 9406)
+    enum class HyStartState {
+        SlowStart,      // 标准慢启动, 逐轮比较最小 RTT
+        Css,            // Conservative Slow Start, 增长速度降为 1/divisor
+        Done,           // 已进入拥塞避免或发生丢包, 不再使用 HyStart++
+    };
+
+    HyStartState hystartState() const { return m_hsState; }
 
 private:
     const uint64_t kDefaultMss = 1460;
@@ -51,12 +62,33 @@ private:
     uint64_t    m_initCwnd{kDefaultInitCwnd};
     uint64_t    m_minCwnd{kDefaultMinCwnd};
 
+    // HyStart++
+    bool            m_hystartEnabled{false};
+    uint64_t        m_hsMinRttThreshUs{4000};
+    uint64_t        m_hsMaxRttThreshUs{16000};
+    uint32_t        m_hsRttSamples{8};
+    uint32_t        m_hsCssGrowthDivisor{4};
+    uint32_t        m_hsCssRounds{5};
+    HyStartState    m_hsState{HyStartState::SlowStart};
+    uint64_t        m_lastSentPackNo{0};
+    uint64_t        m_hsWindowEnd{0};                   // 当前轮次结束的包号, 0 表示尚未开始
+    uint64_t        m_hsLastRoundMinRtt{UINT64_MAX};
+    uint64_t        m_hsCurrentRoundMinRtt{UINT64_MAX};
+    uint32_t        m_hsRttSampleCount{0};
+    uint64_t        m_hsCssBaselineMinRtt{UINT64_MAX};
+    uint32_t        m_hsCssRoundCount{0};
+    uint64_t        m_hsCssAckedRemainder{0};           // CSS 中不足 divisor 的确认字节
+    SlowStartStats  m_ssStats{};
+
     uint64_t    smoothedRttUs() const;
     void        resetEpoch();
+    void        multiplicativeDecrease();
     void        ensureEpoch(uint64_t nowUs);
     uint64_t    cubicTargetCwnd(uint64_t nowUs) const;
     uint64_t    cubicIncrement(uint64_t ackedBytes, uint64_t nowUs) const;
     uint64_t    renoIncrement(uint64_t ackedBytes) const;
+    uint64_t    hystartOnAck(const PacketInfo *packetInfo, uint64_t nowUs, uint64_t ackedBytes);
+    void        hystartExit();
 };
 
 } // namespace utp
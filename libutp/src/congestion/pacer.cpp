@@ -109,3 +109,17 @@ bool eular::utp::Pacer::canScheduleProbe(uint64_t inflight, utp_time_t txTime)
 {
     return _burst_tokens > 1 || inflight == 0 || _next_sched > _now + txTime / 2;
 }
+
+uint64_t eular::utp::Pacer::departureGapNs(uint32_t bytes, uint64_t rate)
+{
+    if (rate == 0) {
+        return 0;
+    }
+
+    return static_cast<uint64_t>(bytes) * 1000000000ULL / rate;
+}
+
+void eular::utp::Pacer::onDeparture(uint64_t departureNs, uint32_t bytes, uint64_t rate)
+{
+    _next_departure_ns = std::max(_next_departure_ns, departureNs + departureGapNs(bytes, rate));
+}
@@ -8,6 +8,7 @@
 #ifndef __UTP_CONGESTION_PACER_H__
 #define __UTP_CONGESTION_PACER_H__
 
+#include <algorithm>
 #include <functional>
 
 #include <utp/types.h>
@@ -36,10 +37,26 @@ public:
     utp_time_t nextSched() const { return _next_sched; }
     bool canScheduleProbe(uint64_t inflight, utp_time_t txTime);
 
+    /// @b SO_TXTIME (EDT) 模式: 由内核 fq 按包上的最早发送时间放行, 用户态只负责打时间戳.
+    /// 时间戳以 ns 计, 避免 Gbit 级速率下包间隔被截断为 0 us
+    /**
+     * @brief 下一个包的最早发送时间 (ns), 不早于 nowUs
+     */
+    uint64_t departureTimeNs(utp_time_t nowUs) const { return std::max<uint64_t>(nowUs * 1000, _next_departure_ns); }
+    /**
+     * @brief 按速率 rate (bytes/s) 发送 bytes 字节所占的时间 (ns), rate 为 0 时不限速
+     */
+    static uint64_t departureGapNs(uint32_t bytes, uint64_t rate);
+    /**
+     * @brief 记录一个已交给内核的包, 下一包的最早发送时间顺延一个发送间隔
+     */
+    void onDeparture(uint64_t departureNs, uint32_t bytes, uint64_t rate);
+
 private:
     utp_time_t  _next_sched;    // 下一次调度时间(us)
     utp_time_t  _last_delayed;  // 上次延迟的时间(us)
     utp_time_t  _now;           // 当前时间(us)
+    uint64_t    _next_departure_ns; // EDT 模式下一个包的最早发送时间(ns)
 
     uint32_t    _clock_granularity; // 时钟粒度 (us)
     uint32_t    _burst_tokens;      // 突发令牌数
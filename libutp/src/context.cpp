@@ -96,6 +96,11 @@ void Context::clearResumptionSecret()
     m_impl->clearResumptionSecret();
 }
 
+void Context::setKeyPairPoolSize(uint32_t capacity, uint32_t lowWatermark)
+{
+    m_impl->setKeyPairPoolSize(capacity, lowWatermark);
+}
+
 int32_t Context::connect0RttWithState(const Connect0RttWithStateInfo &info, const std::string &state)
 {
     return NormalizePublicStatus(m_impl->connect0RttWithState(info, state));
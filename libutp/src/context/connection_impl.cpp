@@ -25,10 +25,6 @@
 #include "context/packet_decode_helper.h"
 #include "context/send_ctl.h"
 
-#if defined(UTP_COMPILER_MSVC)
-#include <intrin.h>
-#endif
-
 #include <utils/serialize.hpp>
 
 #include "connection_impl.h"
@@ -53,6 +49,7 @@
 #include "proto/frame/padding.h"
 #include "proto/frame/path.h"
 #include "proto/frame/reset_stream.h"
+#include "proto/frame/retry_token.h"
 #include "proto/frame/session_token.h"
 #include "proto/frame/stream.h"
 #include "proto/frame/stream_data_blocked.h"
@@ -65,6 +62,7 @@
 #include "util/random.hpp"
 #include "util/status.h"
 #include "util/time.h"
+#include "util/util.h"
 #include "utp/errno.h"
 
 namespace {
@@ -121,21 +119,7 @@ FrameType FirstFrameTypeBit(uint32_t frameTypes)
         return eular::utp::kFrameInvalid;
     }
 
-    uint32_t bitIndex = 0;
-#if defined(UTP_COMPILER_MSVC)
-    unsigned long firstSetBit = 0;
-    if (_BitScanForward(&firstSetBit, frameTypes) == 0) {
-        return eular::utp::kFrameInvalid;
-    }
-    bitIndex = static_cast<uint32_t>(firstSetBit);
-#elif defined(UTP_COMPILER_GNU_LIKE)
-    bitIndex = static_cast<uint32_t>(__builtin_ctz(frameTypes));
-#else
-    while (((frameTypes >> bitIndex) & 1u) == 0u) {
-        ++bitIndex;
-    }
-#endif
-
+    const uint32_t bitIndex = eular::utp::Util::CountTrailingZeros(frameTypes);
     if (bitIndex >= static_cast<uint32_t>(eular::utp::kFrameMax)) {
         return eular::utp::kFrameInvalid;
     }
@@ -361,23 +345,58 @@ ConnectionImpl::ConnectionImpl(ContextImpl* ctx, UdpSocket* udpSocket, uint32_t
     m_payloadScratch.reserve(kDefaultPayloadScratchCapacity);
     m_bodyScratch.reserve(kDefaultPayloadScratchCapacity);
 
-    m_connTimer.reset(ctx->loop(), [this]() { onConnTimeout(); });
+    m_connTimer.reset(ctx->timerWheel(), [this]() {
+        traceTimerFired(kTraceTimerConn);
+        onConnTimeout();
+    });
 
-    m_scheduleTimer.reset(ctx->loop(), [this]() { scheduleWrite(); });
+    m_scheduleTimer.reset(ctx->timerWheel(), [this]() {
+        traceTimerFired(kTraceTimerSchedule);
+        scheduleWrite();
+    });
+
+    for (auto& queue : m_activeStreams) {
+        TAILQ_INIT(&queue);
+    }
+    TAILQ_INIT(&m_deferredStreams);
+    m_schedQueueMode = streamSchedulerMode();
 
-    m_pathValidationTimer.reset(ctx->loop(), [this]() { onPathValidationTimeout(); });
+    m_pathValidationTimer.reset(ctx->timerWheel(), [this]() {
+        traceTimerFired(kTraceTimerPathValidation);
+        onPathValidationTimeout();
+    });
 
-    m_handshakeDoneTimer.reset(ctx->loop(), [this]() { onHandshakeDoneTimeout(); });
+    m_handshakeDoneTimer.reset(ctx->timerWheel(), [this]() {
+        traceTimerFired(kTraceTimerHandshakeDone);
+        onHandshakeDoneTimeout();
+    });
 
-    m_ackTimer.reset(ctx->loop(), [this]() { onAckTimeout(); });
+    m_ackTimer.reset(ctx->timerWheel(), [this]() {
+        traceTimerFired(kTraceTimerAck);
+        onAckTimeout();
+    });
 
-    m_keepaliveTimer.reset(ctx->loop(), [this]() { onKeepaliveTimeout(); });
+    m_keepaliveTimer.reset(ctx->timerWheel(), [this]() {
+        traceTimerFired(kTraceTimerKeepalive);
+        onKeepaliveTimeout();
+    });
 
-    m_closeDrainTimer.reset(ctx->loop(), [this]() { onCloseDrainTimeout(); });
+    m_closeDrainTimer.reset(ctx->timerWheel(), [this]() {
+        traceTimerFired(kTraceTimerCloseDrain);
+        onCloseDrainTimeout();
+    });
 
     m_sendCtl = std::make_unique<SendControl>(this, ctx);
+    // 未完成的零拷贝发送在 m_mm 析构时交给 socket, 待完成通知到达后释放
+    m_mm.zc_socket = m_udpSocket;
     if (ctx != nullptr) {
+        if (ctx->config()->trace_ring_events > 0) {
+            m_trace = std::make_unique<TraceRecorder>(ctx->config()->trace_ring_events);
+        }
         m_mtuDiscovery.init(ctx->config(), Address::IPv4);
+        if (ctx->sharedMemoryPool()) {
+            m_mm.attachSharedPool(ctx->sharedMemoryPool(), ctx->config()->connection_memory_quota);
+        }
     }
 
     FrameAckFrequency ackFreq;
@@ -396,7 +415,26 @@ ConnectionImpl::ConnectionImpl(ContextImpl* ctx, UdpSocket* udpSocket, uint32_t
     }
 }
 
-ConnectionImpl::~ConnectionImpl() = default;
+ConnectionImpl::~ConnectionImpl()
+{
+    if (m_writeQueued && m_ctx != nullptr) {
+        m_ctx->removeFromWriteQueue(this);
+    }
+
+    // 应用可能仍持有 stream, 先解除队列挂接, 避免其析构时回访本连接
+    for (auto& queue : m_activeStreams) {
+        StreamImpl* stream = nullptr;
+        while ((stream = TAILQ_FIRST(&queue)) != nullptr) {
+            TAILQ_REMOVE(&queue, stream, m_schedLink);
+            stream->m_schedState = StreamImpl::kSchedIdle;
+        }
+    }
+    StreamImpl* deferred = nullptr;
+    while ((deferred = TAILQ_FIRST(&m_deferredStreams)) != nullptr) {
+        TAILQ_REMOVE(&m_deferredStreams, deferred, m_schedLink);
+        deferred->m_schedState = StreamImpl::kSchedIdle;
+    }
+}
 
 void ConnectionImpl::abortConnection(utp_error_t localErrCode, uint16_t quicTransportErrCode, const char* reason)
 {
@@ -472,18 +510,13 @@ void ConnectionImpl::bootstrapLocalTransportParams()
     m_peerAckMaxDelayMs = cfg->ack_delay;
 
     m_peerMaxData = 0;
-    m_peerMaxStreamData.clear();
     m_localMaxDataAdvertised = m_loaclTP.initial_max_data;
-    m_localMaxStreamDataAdvertised.clear();
     m_localBytesConsumedTotal = 0;
-    m_localStreamBytesConsumed.clear();
     m_streamDataSentTotal = 0;
-    m_streamMaxSentOffset.clear();
+    m_detachedFlowStates.clear();
     m_initialFlowControlAdvertised = false;
     m_lastMaxDataSentUs = 0;
-    m_lastMaxStreamDataSentUs.clear();
     m_lastDataBlockedSentUs = 0;
-    m_lastStreamDataBlockedSentUs.clear();
 }
 
 Status ConnectionImpl::connect(const Context::ConnectInfo& info, const ZeroRttConfig* zeroRtt)
@@ -562,6 +595,7 @@ Status ConnectionImpl::connect(const Context::ConnectInfo& info, const ZeroRttCo
     stopAckTimer();
     m_keepaliveTimer.stop();
     m_handshakeRetryCount = 0;
+    m_retryToken.clear();
     m_connTimer.stop();
 
     m_ctx->wantWrite(this);
@@ -650,6 +684,94 @@ void ConnectionImpl::onUdpPacket(const UdpSocket::MsgMetaInfo& msg, utp_time_t n
         return;
     }
 
+    processUdpPacket(msg, packet.get(), nowUs);
+}
+
+bool ConnectionImpl::stageUdpPacket(const UdpSocket::MsgMetaInfo& msg)
+{
+    m_recvBatchMsgs.push_back(&msg);
+    return m_recvBatchMsgs.size() == 1;
+}
+
+void ConnectionImpl::flushStagedUdpPackets(utp_time_t nowUs)
+{
+    if (m_recvBatchMsgs.empty()) {
+        return;
+    }
+
+    // 阶段二: 整批解密到各自的 PacketIn, 期间不改动连接状态, 密钥上下文保持热
+    m_recvBatchPackets.clear();
+    for (const UdpSocket::MsgMetaInfo* msg : m_recvBatchMsgs) {
+        PacketIn* packet = nullptr;
+        if (msg->data != nullptr && msg->len >= UTP_HEADER_SIZE) {
+            packet = m_mm.getPacketIn(static_cast<uint32_t>(msg->len));
+        }
+        if (packet != nullptr && !detail::DecodeUdpPacketWithOptionalAead(*msg, m_mm, m_aesCtx, *packet)) {
+            m_mm.releasePacketIn(packet);
+            packet = nullptr;
+        }
+        m_recvBatchPackets.push_back(packet);
+    }
+
+    // 阶段三: 逐包解析帧, ACK 与待发流数据推迟到批次末尾
+    m_inRecvBatch = true;
+    for (size_t i = 0; i < m_recvBatchPackets.size(); ++i) {
+        PacketIn* packet = m_recvBatchPackets[i];
+        if (packet == nullptr) {
+            continue;
+        }
+        processUdpPacket(*m_recvBatchMsgs[i], packet, nowUs);
+        m_mm.releasePacketIn(packet);
+    }
+    m_inRecvBatch = false;
+    m_recvBatchMsgs.clear();
+    m_recvBatchPackets.clear();
+
+    finishRecvBatch(nowUs);
+}
+
+void ConnectionImpl::finishRecvBatch(utp_time_t nowUs)
+{
+    const bool ackNow = m_recvBatchAckNow;
+    const bool ackDelayed = m_recvBatchAckDelayed;
+    const bool flushWrites = m_recvBatchFlushWrites;
+    const uint32_t ackRetryMs = m_recvBatchAckRetryMs;
+    m_recvBatchAckNow = false;
+    m_recvBatchAckDelayed = false;
+    m_recvBatchFlushWrites = false;
+    m_recvBatchAckRetryMs = 0;
+
+    if (m_ackElicitingSinceLastAck > 0) {
+        if (ackNow) {
+            if (sendAckPacket(nowUs) != UTP_ERR_OK) {
+                armAckTimer(ackRetryMs);
+            }
+        } else if (ackDelayed) {
+            armAckTimer(m_ackMaxDelayMs);
+        }
+    }
+
+    if (flushWrites && m_state == State::kStateConnected) {
+        flushPendingStreamWrites(nowUs);
+    }
+}
+
+void ConnectionImpl::requestImmediateAck(utp_time_t nowUs, uint32_t retryMs)
+{
+    if (m_inRecvBatch) {
+        // 同一批次内多次达到阈值只回一个 ACK
+        m_recvBatchAckRetryMs = m_recvBatchAckNow ? std::min(m_recvBatchAckRetryMs, retryMs) : retryMs;
+        m_recvBatchAckNow = true;
+        return;
+    }
+
+    if (sendAckPacket(nowUs) != UTP_ERR_OK) {
+        armAckTimer(retryMs);
+    }
+}
+
+void ConnectionImpl::processUdpPacket(const UdpSocket::MsgMetaInfo& msg, PacketIn* packet, utp_time_t nowUs)
+{
     const bool isPassiveInitial =
         (m_state == State::kStateDisconnected) && packet->header.types == UTP_TYPE_INITIAL && packet->header.dcid == 0;
     const bool isPassiveZeroRtt = (m_state == State::kStateConnected) && packet->header.types == UTP_TYPE_0RTT &&
@@ -659,6 +781,12 @@ void ConnectionImpl::onUdpPacket(const UdpSocket::MsgMetaInfo& msg, utp_time_t n
         return;
     }
 
+    // Retry 不属于连接的包序列, 不计入接收历史, 也不能用其 scid 覆盖对端 CID
+    if (packet->header.types == UTP_TYPE_RETRY) {
+        onRetryPacket(packet);
+        return;
+    }
+
     m_bytesIn += msg.len;
     const utp_packno_t packetPn = packet->header.pn;
     const utp_packno_t largestBeforeInsert = m_receiveHistory.largest();
@@ -751,7 +879,7 @@ void ConnectionImpl::onUdpPacket(const UdpSocket::MsgMetaInfo& msg, utp_time_t n
                 FrameStream streamFrame;
                 Status      st;
                 if (streamFrame.decode(frameData, frameLen, st) >= 0) {
-                    const Status streamStatus = ingestStreamFrame(streamFrame, packet.get());
+                    const Status streamStatus = ingestStreamFrame(streamFrame, packet);
                     if (!streamStatus.ok()) {
                         if (streamStatus.code() == UTP_ERR_WOULD_BLOCK) {
                             streamBackpressured = true;
@@ -787,7 +915,8 @@ void ConnectionImpl::onUdpPacket(const UdpSocket::MsgMetaInfo& msg, utp_time_t n
                 handlePathResponseFrame(frameData, frameLen, packetPeerAddress);
                 break;
             }
-            case kFrameAck: {
+            case kFrameAck:
+            case kFrameAckEcn: {
                 AckInfo ackInfo;
                 ackInfo.reset();
 
@@ -851,11 +980,10 @@ void ConnectionImpl::onUdpPacket(const UdpSocket::MsgMetaInfo& msg, utp_time_t n
                 Status                 st;
                 if (frame.decode(frameData, frameLen, st) >= 0) {
                     ensureFlowControlAdvertised(frame.stream_id);
-                    const uint64_t advertised = m_localMaxStreamDataAdvertised.count(frame.stream_id) > 0
-                                                    ? m_localMaxStreamDataAdvertised[frame.stream_id]
-                                                    : (m_loaclTP.initial_max_stream_data_bidi_remote > 0
-                                                           ? m_loaclTP.initial_max_stream_data_bidi_remote
-                                                           : kDefaultInitialMaxStreamData);
+                    const StreamFlowState *flow = findStreamFlowState(frame.stream_id);
+                    const uint64_t advertised = (flow != nullptr && flow->local_max_stream_data > 0)
+                                                    ? flow->local_max_stream_data
+                                                    : localStreamDataWindow();
                     (void)sendMaxStreamDataFrame(frame.stream_id, advertised);
                 }
                 break;
@@ -888,7 +1016,7 @@ void ConnectionImpl::onUdpPacket(const UdpSocket::MsgMetaInfo& msg, utp_time_t n
                 Status st;
                 if (crypto.decode(frameData, frameLen, st) >= 0) {
                     if (!m_x25519) {
-                        m_x25519 = std::make_shared<X25519Wrapper>();
+                        m_x25519 = m_ctx->acquireKeyPair();
                     }
 
                     try {
@@ -994,8 +1122,10 @@ void ConnectionImpl::onUdpPacket(const UdpSocket::MsgMetaInfo& msg, utp_time_t n
         packet->header.types == UTP_TYPE_CONNECTION_CLOSE || packet->hasFrame(kFrameConnectionClose);
     const bool suppressAck = handshakePacket || closePacket || streamBackpressured;
 
+    bool ceMarked = false;
     if (!suppressAck) {
         m_receiveHistory.insert(packetPn, nowUs);
+        ceMarked = noteEcnCodepoint(packet->meta.ecn);
     }
 
     if (!ackOnly && !suppressAck) {
@@ -1004,18 +1134,19 @@ void ConnectionImpl::onUdpPacket(const UdpSocket::MsgMetaInfo& msg, utp_time_t n
 
     if (!suppressAck) {
         if (hasHandshakeDoneFrame && m_ackElicitingSinceLastAck > 0) {
-            if (sendAckPacket(nowUs) != UTP_ERR_OK) {
-                armAckTimer(1);
-            }
+            requestImmediateAck(nowUs, 1);
         } else {
             const uint32_t ackThreshold = std::max<uint32_t>(1, m_ackElicitingThreshold);
             const bool     ackCountReached = m_ackElicitingSinceLastAck >= ackThreshold;
-            if ((ackCountReached || reorderedGap) && m_ackElicitingSinceLastAck > 0) {
-                if (sendAckPacket(nowUs) != UTP_ERR_OK) {
-                    armAckTimer(10);
-                }
+            // CE 标记的包立即确认, 让发送端尽快降速
+            if ((ackCountReached || reorderedGap || ceMarked) && m_ackElicitingSinceLastAck > 0) {
+                requestImmediateAck(nowUs, 10);
             } else if (m_ackElicitingSinceLastAck > 0) {
-                armAckTimer(m_ackMaxDelayMs);
+                if (m_inRecvBatch) {
+                    m_recvBatchAckDelayed = true;
+                } else {
+                    armAckTimer(m_ackMaxDelayMs);
+                }
             }
         }
     }
@@ -1041,7 +1172,11 @@ void ConnectionImpl::onUdpPacket(const UdpSocket::MsgMetaInfo& msg, utp_time_t n
     }
 
     if (m_state == State::kStateConnected) {
-        flushPendingStreamWrites(nowUs);
+        if (m_inRecvBatch) {
+            m_recvBatchFlushWrites = true;
+        } else {
+            flushPendingStreamWrites(nowUs);
+        }
     }
 }
 
@@ -1209,6 +1344,7 @@ Status ConnectionImpl::buildAckPayload(std::vector<uint8_t>& payload, utp_time_t
 
     FrameAck ackFrame;
     ackFrame._history = &m_receiveHistory;
+    ackFrame._ecn = &m_recvEcnCounts;
     ackFrame._params = const_cast<TransportParams*>(&m_loaclTP);
     ackFrame._config = m_ctx->config();
     ackFrame._now = nowUs;
@@ -1256,6 +1392,24 @@ void ConnectionImpl::noteAckElicitingPacket(utp_time_t nowUs)
     ++m_ackElicitingSinceLastAck;
 }
 
+bool ConnectionImpl::noteEcnCodepoint(uint8_t ecn)
+{
+    switch (ecn) {
+        case kEcnEct0:
+            ++m_recvEcnCounts.ect0;
+            break;
+        case kEcnEct1:
+            ++m_recvEcnCounts.ect1;
+            break;
+        case kEcnCe:
+            ++m_recvEcnCounts.ce;
+            return true;
+        default:
+            break;
+    }
+    return false;
+}
+
 void ConnectionImpl::applyAckFrequency(const FrameAckFrequency& ackFreq, utp_time_t nowMs)
 {
     if (m_lastAckFrequencyApplyMs != 0) {
@@ -1484,6 +1638,7 @@ void ConnectionImpl::collectClosedStreams()
         }
 
         if (it->second->state() == Stream::kStateClosed && !it->second->readable()) {
+            deactivateStream(it->second.get());
             it = m_streams.erase(it);
             continue;
         }
@@ -1572,30 +1727,15 @@ void ConnectionImpl::flushPendingStreamWrites(utp_time_t nowUs)
     noteSchedulerModeIfChanged(mode);
 
     auto armDeferredWakeup = [&](utp_time_t baseNowUs) {
-        utp_time_t minRemainUs = 0;
-        for (const auto& entry : m_streams) {
-            if (!entry.second || !entry.second->hasPendingSendWork()) {
-                continue;
-            }
-
-            if (!entry.second->shouldDeferSend(baseNowUs)) {
-                continue;
-            }
-
-            const utp_time_t remainUs = entry.second->coalesceDelayRemainingUs(baseNowUs);
-            if (remainUs == 0) {
-                continue;
-            }
-
-            if (minRemainUs == 0 || remainUs < minRemainUs) {
-                minRemainUs = remainUs;
-            }
+        // 延迟队列按到期时间排序, 队首即最早到期
+        const StreamImpl* head = TAILQ_FIRST(&m_deferredStreams);
+        if (head == nullptr || head->m_deferUntilUs <= baseNowUs) {
+            return;
         }
 
-        if (minRemainUs > 0) {
-            const utp_time_t delayMs = std::max<utp_time_t>(1, (minRemainUs + 999) / 1000);
-            nextScheduleTime(delayMs);
-        }
+        const utp_time_t minRemainUs = head->m_deferUntilUs - baseNowUs;
+        const utp_time_t delayMs = std::max<utp_time_t>(1, (minRemainUs + 999) / 1000);
+        nextScheduleTime(delayMs);
     };
 
     size_t sentBursts = 0;
@@ -1622,11 +1762,13 @@ void ConnectionImpl::flushPendingStreamWrites(utp_time_t nowUs)
             break;
         }
 
-        updateStrictAgingState(stream->id());
+        if (!stream->hasPendingSendWork()) {
+            deactivateStream(stream.get());
+        }
+        updateStrictAgingState(stream.get());
         ++sentBursts;
     }
 
-    pruneSchedulerState();
     collectClosedStreams();
     maybeEmitSchedulerStats(nowUs);
 }
@@ -1744,7 +1886,7 @@ Status ConnectionImpl::sendStreamFrame(uint32_t streamId, uint64_t streamOffset,
             (streamOffset > streamDataLimit) || (static_cast<uint64_t>(len) > (streamDataLimit - streamOffset));
         if (overStreamLimit) {
             const utp_time_t nowUs = time::MonotonicUs();
-            utp_time_t&      lastBlockedUs = m_lastStreamDataBlockedSentUs[streamId];
+            utp_time_t&      lastBlockedUs = streamFlowState(streamId)->last_blocked_us;
             if (lastBlockedUs == 0 ||
                 (nowUs > lastBlockedUs && (nowUs - lastBlockedUs) >= kFlowControlBlockedMinIntervalUs)) {
                 if (sendStreamDataBlockedFrame(streamId, streamDataLimit).ok()) {
@@ -1975,7 +2117,7 @@ void ConnectionImpl::onStreamDataSent(uint32_t streamId, uint64_t streamOffset,
     }
 
     uint64_t  newEndOffset = streamOffset + static_cast<uint64_t>(len);
-    uint64_t& maxSent = m_streamMaxSentOffset[streamId];
+    uint64_t& maxSent = streamFlowState(streamId)->max_sent_offset;
     if (newEndOffset > maxSent) {
         uint64_t delta = newEndOffset - maxSent;
         m_streamDataSentTotal += delta;
@@ -2056,18 +2198,19 @@ void ConnectionImpl::handleMaxDataFrame(uint64_t maximumData)
 
 void ConnectionImpl::handleMaxStreamDataFrame(uint32_t streamId, uint64_t maximumStreamData)
 {
-    auto it = m_peerMaxStreamData.find(streamId);
-    if (it == m_peerMaxStreamData.end()) {
-        m_peerMaxStreamData.emplace(streamId, maximumStreamData);
+    StreamFlowState *flow = streamFlowState(streamId);
+    if (!flow->peer_max_stream_data_known) {
+        flow->peer_max_stream_data_known = true;
+        flow->peer_max_stream_data = maximumStreamData;
         UTP_LOGW("%s flowctl recv MAX_STREAM_DATA sid=%u value=%llu (new)", tag(), streamId,
                  static_cast<ull>(maximumStreamData));
         scheduleWrite();
         return;
     }
 
-    const uint64_t oldValue = it->second;
-    if (maximumStreamData > it->second) {
-        it->second = maximumStreamData;
+    const uint64_t oldValue = flow->peer_max_stream_data;
+    if (maximumStreamData > oldValue) {
+        flow->peer_max_stream_data = maximumStreamData;
         UTP_LOGW("%s flowctl recv MAX_STREAM_DATA sid=%u old=%llu new=%llu", tag(), streamId,
                  static_cast<ull>(oldValue), static_cast<ull>(maximumStreamData));
         scheduleWrite();
@@ -2076,13 +2219,48 @@ void ConnectionImpl::handleMaxStreamDataFrame(uint32_t streamId, uint64_t maximu
 
 uint64_t ConnectionImpl::peerStreamDataLimit(uint32_t streamId) const
 {
-    auto it = m_peerMaxStreamData.find(streamId);
-    if (it == m_peerMaxStreamData.end()) {
+    const StreamFlowState *flow = findStreamFlowState(streamId);
+    if (flow == nullptr || !flow->peer_max_stream_data_known) {
         return m_peerTP.initial_max_stream_data_bidi_local > 0 ? m_peerTP.initial_max_stream_data_bidi_local
                                                                : kDefaultInitialMaxStreamData;
     }
 
-    return it->second;
+    return flow->peer_max_stream_data;
+}
+
+uint64_t ConnectionImpl::localStreamDataWindow() const
+{
+    return m_loaclTP.initial_max_stream_data_bidi_remote > 0 ? m_loaclTP.initial_max_stream_data_bidi_remote
+                                                             : kDefaultInitialMaxStreamData;
+}
+
+StreamFlowState *ConnectionImpl::streamFlowState(uint32_t streamId)
+{
+    auto it = m_streams.find(streamId);
+    if (it != m_streams.end() && it->second) {
+        return &it->second->m_flow;
+    }
+    return &m_detachedFlowStates[streamId];
+}
+
+const StreamFlowState *ConnectionImpl::findStreamFlowState(uint32_t streamId) const
+{
+    auto it = m_streams.find(streamId);
+    if (it != m_streams.end() && it->second) {
+        return &it->second->m_flow;
+    }
+    auto detached = m_detachedFlowStates.find(streamId);
+    return detached != m_detachedFlowStates.end() ? &detached->second : nullptr;
+}
+
+void ConnectionImpl::takeDetachedFlowState(uint32_t streamId, StreamFlowState &flow)
+{
+    auto it = m_detachedFlowStates.find(streamId);
+    if (it == m_detachedFlowStates.end()) {
+        return;
+    }
+    flow = it->second;
+    m_detachedFlowStates.erase(it);
 }
 
 Status ConnectionImpl::sendMaxDataFrame(uint64_t maximumData)
@@ -2123,7 +2301,7 @@ Status ConnectionImpl::sendMaxStreamDataFrame(uint32_t streamId, uint64_t maximu
     const Status sendSt = sendPacket(UTP_TYPE_CTRL, payload.data(), static_cast<size_t>(frameLen), 0, nullptr,
                                      (1u << static_cast<uint32_t>(kFrameMaxStreamData)));
     if (sendSt.ok()) {
-        m_lastMaxStreamDataSentUs[streamId] = time::MonotonicUs();
+        streamFlowState(streamId)->last_max_stream_data_us = time::MonotonicUs();
     }
     return sendSt;
 }
@@ -2171,12 +2349,9 @@ void ConnectionImpl::ensureFlowControlAdvertised(uint32_t streamId)
         return;
     }
 
-    auto it = m_localMaxStreamDataAdvertised.find(streamId);
-    if (it == m_localMaxStreamDataAdvertised.end()) {
-        const uint64_t initialStreamWindow = m_loaclTP.initial_max_stream_data_bidi_remote > 0
-                                                 ? m_loaclTP.initial_max_stream_data_bidi_remote
-                                                 : kDefaultInitialMaxStreamData;
-        m_localMaxStreamDataAdvertised.emplace(streamId, initialStreamWindow);
+    StreamFlowState *flow = streamFlowState(streamId);
+    if (flow->local_max_stream_data == 0) {
+        flow->local_max_stream_data = localStreamDataWindow();
     }
 }
 
@@ -2186,8 +2361,9 @@ void ConnectionImpl::onStreamBytesConsumed(uint32_t streamId, size_t bytes)
         return;
     }
 
+    StreamFlowState *flow = streamFlowState(streamId);
     m_localBytesConsumedTotal += static_cast<uint64_t>(bytes);
-    m_localStreamBytesConsumed[streamId] += static_cast<uint64_t>(bytes);
+    flow->local_bytes_consumed += static_cast<uint64_t>(bytes);
 
     if (m_state != State::kStateConnected || m_peerConnectionID == 0) {
         return;
@@ -2220,12 +2396,10 @@ void ConnectionImpl::onStreamBytesConsumed(uint32_t streamId, size_t bytes)
     }
 
     // 2. Stream level
-    const uint64_t consumedByStream = m_localStreamBytesConsumed[streamId];
-    const uint64_t baseMaxStreamData = m_loaclTP.initial_max_stream_data_bidi_remote > 0
-                                           ? m_loaclTP.initial_max_stream_data_bidi_remote
-                                           : kDefaultInitialMaxStreamData;
+    const uint64_t consumedByStream = flow->local_bytes_consumed;
+    const uint64_t baseMaxStreamData = localStreamDataWindow();
     const uint64_t targetMaxStreamData = baseMaxStreamData + consumedByStream;
-    uint64_t&      advertised = m_localMaxStreamDataAdvertised[streamId];
+    uint64_t&      advertised = flow->local_max_stream_data;
     if (advertised == 0) {
         advertised = baseMaxStreamData;
     }
@@ -2234,15 +2408,14 @@ void ConnectionImpl::onStreamBytesConsumed(uint32_t streamId, size_t bytes)
         const uint64_t delta = targetMaxStreamData - advertised;
         const uint64_t threshold = baseMaxStreamData / 10;
 
-        const utp_time_t lastSentUs =
-            m_lastMaxStreamDataSentUs.count(streamId) > 0 ? m_lastMaxStreamDataSentUs[streamId] : 0;
+        const utp_time_t lastSentUs = flow->last_max_stream_data_us;
         const bool dueBySize = delta >= threshold;
         const bool dueByTime =
             (lastSentUs == 0) || (nowUs > lastSentUs && (nowUs - lastSentUs) >= kFlowControlUpdateMinIntervalUs);
         if (dueBySize || dueByTime) {
             if (sendMaxStreamDataFrame(streamId, targetMaxStreamData).ok()) {
                 advertised = targetMaxStreamData;
-                m_lastMaxStreamDataSentUs[streamId] = nowUs;
+                flow->last_max_stream_data_us = nowUs;
             }
         }
     }
@@ -2344,7 +2517,7 @@ Status ConnectionImpl::sendInitialPacket()
 
     if (m_connectInfo.encrypted != Context::kEncryptionNone) {
         if (!m_x25519) {
-            m_x25519 = std::make_shared<X25519Wrapper>();
+            m_x25519 = m_ctx->acquireKeyPair();
         }
 
         FrameCrypto crypto;
@@ -2375,6 +2548,17 @@ Status ConnectionImpl::sendInitialPacket()
         payloadLen += static_cast<size_t>(tokenLen);
     }
 
+    if (!m_retryToken.empty()) {
+        FrameRetryToken retryToken;
+        retryToken.token = m_retryToken;
+        const int32_t retryLen =
+            retryToken.encode(payload.data() + payloadLen, payload.size() - payloadLen, status);
+        if (!status.ok() || retryLen < 0) {
+            return status;
+        }
+        payloadLen += static_cast<size_t>(retryLen);
+    }
+
     FrameAckFrequency ackFreq;
     const Config*     cfg = (m_ctx != nullptr) ? m_ctx->config() : nullptr;
     ackFreq.ack_eliciting_threshold =
@@ -2411,6 +2595,50 @@ Status ConnectionImpl::sendInitialPacket()
     return sendPacket(UTP_TYPE_INITIAL, segments.data(), 1, PacketOutFlags::kPoHello);
 }
 
+void ConnectionImpl::onRetryPacket(PacketIn* packet)
+{
+    if (m_state != State::kStateInitialSent || !m_retryToken.empty()) {
+        return;
+    }
+
+    size_t frameOffset = 0;
+    while (frameOffset < packet->payload_size) {
+        FrameType      frameType = kFrameInvalid;
+        const uint8_t* frameData = nullptr;
+        size_t         frameLen = 0;
+        Status         nextSt;
+        if (packet->nextFrame(frameOffset, frameType, frameData, frameLen, nextSt) < 0) {
+            return;
+        }
+        if (frameType != kFrameRetryToken) {
+            continue;
+        }
+
+        FrameRetryToken retryToken;
+        Status          st;
+        if (retryToken.decode(frameData, frameLen, st) < 0) {
+            return;
+        }
+        m_retryToken = std::move(retryToken.token);
+        break;
+    }
+    if (m_retryToken.empty()) {
+        return;
+    }
+
+    UTP_LOGD("%s received retry, resend initial with %zu bytes token", tag(), m_retryToken.size());
+    // Retry 证明对端在线, 重发不占用握手重试次数
+    const Status st = sendInitialPacket();
+    if (st.ok()) {
+        (void)armConnectTimerForRound(m_handshakeRetryCount, false);
+        return;
+    }
+
+    // 发送失败时交给连接定时器重发, 新的 INITIAL 同样携带令牌
+    m_connTimer.stop();
+    m_connTimer.start(1);
+}
+
 Status ConnectionImpl::sendHandshakePacket(bool encrypted)
 {
     Status                                status;
@@ -2436,7 +2664,7 @@ Status ConnectionImpl::sendHandshakePacket(bool encrypted)
 
     if (encrypted) {
         if (!m_x25519) {
-            m_x25519 = std::make_shared<X25519Wrapper>();
+            m_x25519 = m_ctx->acquireKeyPair();
         }
 
         FrameCrypto crypto;
@@ -2621,7 +2849,8 @@ Status ConnectionImpl::sendPacket(uint8_t packetType, const PayloadSegment* segm
     }
     packet->sent_time = time::MonotonicUs();
     packet->data_size = static_cast<uint16_t>(packetLen);
-    packet->po_flags |= packetFlags;
+    // kPoSched 表示已在调度队列中, 由 schedulePacket 设置
+    packet->po_flags |= (packetFlags & ~PacketOutFlags::kPoSched);
     packet->slice_count = 0;
     packet->frame_meta_count = 0;
     packet->frame_types = frameTypeBits;
@@ -2762,7 +2991,10 @@ Status ConnectionImpl::sendPacket(uint8_t packetType, const PayloadSegment* segm
         packet->po_flags |= PacketOutFlags::kPoEncrypted;
     }
 
-    if (shouldEncrypt && !useScatterEncryptOnly) {
+    if (shouldEncrypt && !useScatterEncryptOnly && (packetFlags & PacketOutFlags::kPoSched) != 0) {
+        // 调度发送的包推迟到 sendmmsg 批次前由 SendControl 统一加密
+        packet->po_flags |= PacketOutFlags::kPoSealPending;
+    } else if (shouldEncrypt && !useScatterEncryptOnly) {
         Status encSt = m_aesCtx->encrypt(packet);
         if (!encSt.ok()) {
             m_mm.putPacketOut(packet);
@@ -2804,6 +3036,8 @@ Status ConnectionImpl::sendPacket(uint8_t packetType, const PayloadSegment* segm
         }
     }
     msg.metaInfo.peerAddress = sendAddress;
+    msg.zc_packet = packet;
+    msg.zc_owner = &m_mm;
 
     Status  udpSt;
     int32_t sent = m_udpSocket->send(msg, udpSt);
@@ -2819,7 +3053,7 @@ Status ConnectionImpl::sendPacket(uint8_t packetType, const PayloadSegment* segm
     m_bytesOut += packet->data_size;
 
     if (shouldTrackPacket && shouldEncrypt && (packet->po_flags & PacketOutFlags::kPoKeepPlaintext) &&
-        packet->encrypt_data != nullptr && packet->encrypt_data != packet->raw_data) {
+        !packet->zeroCopyPinned() && packet->encrypt_data != nullptr && packet->encrypt_data != packet->raw_data) {
         AesGcmContext::ReleaseEncryptBuffer(packet->encrypt_data, packet->encrypt_data_size);
         packet->encrypt_data = nullptr;
         packet->encrypt_data_size = 0;
@@ -3352,6 +3586,13 @@ Connection::Statistic ConnectionImpl::statistic() const
     stat.rx_bytes = m_bytesIn;
     stat.tx_bytes = m_bytesOut;
     stat.rtx_bytes = m_bytesRetrans;
+    stat.ecn_ce_count = m_sendCtl ? m_sendCtl->peerEcnCounts().ce : 0;
+    stat.ecn_ce_events = m_sendCtl ? m_sendCtl->ecnCeEvents() : 0;
+    const SlowStartStats ssStats = m_sendCtl ? m_sendCtl->slowStartStats() : SlowStartStats();
+    stat.ss_exit_cwnd = ssStats.exitCwnd;
+    stat.hystart_css_entries = ssStats.cssEntries;
+    stat.hystart_css_spurious = ssStats.cssSpurious;
+    stat.hystart_delay_exits = ssStats.delayExits;
     stat.scheduler_select_total = m_schedulerStats.selectTotal;
     stat.scheduler_select_disabled = m_schedulerStats.selectDisabled;
     stat.scheduler_select_strict = m_schedulerStats.selectStrict;
@@ -3405,6 +3646,27 @@ int32_t ConnectionImpl::exportSessionResumptionState(std::string& outState)
     return 0;
 }
 
+int32_t ConnectionImpl::exportTrace(std::string& outQlog)
+{
+    if (!m_trace) {
+        SetLastErrorV(UTP_ERR_INVALID_STATE, "connection {} has no trace recorder (trace_ring_events = 0)",
+                      m_localConnectionID);
+        return -1;
+    }
+
+    const uint64_t written = m_trace->written();
+    const uint64_t dropped = written > m_trace->capacity() ? written - m_trace->capacity() : 0;
+    outQlog = TraceRecorder::ToQlog(m_trace->snapshot(), tag(), m_localConnectionID, dropped);
+    return 0;
+}
+
+void ConnectionImpl::traceTimerFired(TraceTimer timer, uint64_t detail)
+{
+    if (m_trace) {
+        m_trace->record(kTraceTimerFired, time::MonotonicUs(), detail, 0, 0, timer);
+    }
+}
+
 void ConnectionImpl::cacheSessionResumptionState(const CachedResumptionState& info, uint64_t expiresAt)
 {
     if (info.sessionTicket.empty()) {
@@ -3564,35 +3826,178 @@ StreamSchedulerMode ConnectionImpl::streamSchedulerMode() const
     return m_ctx->config()->stream_scheduler_mode;
 }
 
-StreamImpl::SP ConnectionImpl::pickRoundRobinStream(const std::vector<StreamImpl::SP>& candidates, uint32_t& cursor)
+uint8_t ConnectionImpl::schedulerLevel(const StreamImpl* stream, StreamSchedulerMode mode)
 {
-    if (candidates.empty()) {
-        return nullptr;
+    // 只有 STRICT 按优先级分桶; DISABLED/DRR 在单队列内轮转, DRR 的优先级权重体现在 quantum 上
+    if (mode != kStreamSchedulerStrict) {
+        return 0;
     }
+    return std::min<uint8_t>(stream->m_priority, Stream::kPriorityLowest);
+}
 
-    std::vector<uint32_t> ids;
-    ids.reserve(candidates.size());
-    for (const auto& stream : candidates) {
-        if (stream) {
-            ids.push_back(stream->id());
+void ConnectionImpl::activateStream(StreamImpl* stream)
+{
+    if (stream == nullptr || stream->m_schedState != StreamImpl::kSchedIdle) {
+        return;
+    }
+
+    const uint8_t level = schedulerLevel(stream, m_schedQueueMode);
+    TAILQ_INSERT_TAIL(&m_activeStreams[level], stream, m_schedLink);
+    stream->m_schedState = StreamImpl::kSchedActive;
+    stream->m_schedLevel = level;
+    stream->m_schedServedRound = m_schedRound;
+    m_activeStreamLevels |= static_cast<uint8_t>(1u << level);
+    ++m_activeStreamCount;
+}
+
+void ConnectionImpl::deactivateStream(StreamImpl* stream)
+{
+    if (stream == nullptr) {
+        return;
+    }
+
+    if (stream->m_schedState == StreamImpl::kSchedActive) {
+        StreamQueue& queue = m_activeStreams[stream->m_schedLevel];
+        TAILQ_REMOVE(&queue, stream, m_schedLink);
+        if (TAILQ_EMPTY(&queue)) {
+            m_activeStreamLevels &= static_cast<uint8_t>(~(1u << stream->m_schedLevel));
         }
+        --m_activeStreamCount;
+    } else if (stream->m_schedState == StreamImpl::kSchedDeferred) {
+        TAILQ_REMOVE(&m_deferredStreams, stream, m_schedLink);
     }
-    if (ids.empty()) {
-        return nullptr;
+
+    stream->m_schedState = StreamImpl::kSchedIdle;
+    stream->m_drrDeficit = 0;
+}
+
+void ConnectionImpl::onStreamPriorityChanged(StreamImpl* stream)
+{
+    if (stream == nullptr || stream->m_schedState != StreamImpl::kSchedActive) {
+        return;
+    }
+    if (stream->m_schedLevel == schedulerLevel(stream, m_schedQueueMode)) {
+        return;
     }
 
-    std::sort(ids.begin(), ids.end());
-    uint32_t selectedId = ids.front();
-    for (uint32_t id : ids) {
-        if (id > cursor) {
-            selectedId = id;
+    deactivateStream(stream);
+    activateStream(stream);
+}
+
+void ConnectionImpl::rebuildSchedulerQueues(StreamSchedulerMode mode)
+{
+    StreamQueue pending;
+    TAILQ_INIT(&pending);
+    for (auto& queue : m_activeStreams) {
+        TAILQ_CONCAT(&pending, &queue, m_schedLink);
+    }
+
+    m_schedQueueMode = mode;
+    m_activeStreamLevels = 0;
+    m_activeStreamCount = 0;
+
+    StreamImpl* stream = nullptr;
+    while ((stream = TAILQ_FIRST(&pending)) != nullptr) {
+        TAILQ_REMOVE(&pending, stream, m_schedLink);
+        const uint64_t servedRound = stream->m_schedServedRound;
+        stream->m_schedState = StreamImpl::kSchedIdle;
+        activateStream(stream);
+        stream->m_schedServedRound = servedRound;
+    }
+}
+
+void ConnectionImpl::promoteDeferredStreams(utp_time_t nowUs)
+{
+    if (TAILQ_EMPTY(&m_deferredStreams)) {
+        return;
+    }
+
+    // stream 自身的变化 (新数据/FIN) 由 onSendQueued 重新入队; 这里只处理到期, 以及连接层面暂停合并时整体放行
+    const bool releaseAll = !streamCoalescingAllowed();
+    StreamImpl* stream = nullptr;
+    while ((stream = TAILQ_FIRST(&m_deferredStreams)) != nullptr) {
+        if (!releaseAll && stream->m_deferUntilUs > nowUs) {
             break;
         }
+
+        deactivateStream(stream);
+        if (stream->hasPendingSendWork()) {
+            activateStream(stream);
+        }
     }
-    cursor = selectedId;
+}
 
-    auto it = m_streams.find(selectedId);
-    if (it == m_streams.end()) {
+void ConnectionImpl::deferStream(StreamImpl* stream)
+{
+    deactivateStream(stream);
+    stream->m_deferUntilUs = stream->coalesceDeadlineUs();
+
+    // 合并延迟是连接级常量, 截止时刻基本按入队顺序递增, 从队尾向前查找通常一步到位
+    StreamImpl* prev = nullptr;
+    TAILQ_FOREACH_REVERSE(prev, &m_deferredStreams, StreamQueue, m_schedLink) {
+        if (prev->m_deferUntilUs <= stream->m_deferUntilUs) {
+            break;
+        }
+    }
+    if (prev != nullptr) {
+        TAILQ_INSERT_AFTER(&m_deferredStreams, prev, stream, m_schedLink);
+    } else {
+        TAILQ_INSERT_HEAD(&m_deferredStreams, stream, m_schedLink);
+    }
+    stream->m_schedState = StreamImpl::kSchedDeferred;
+}
+
+bool ConnectionImpl::streamCoalescingAllowed() const
+{
+    // Before path validation and HandshakeDone convergence, anti-amplification
+    // credit is tight. Deferring here can accumulate payloads and repeatedly
+    // hit WOULD_BLOCK without making stream-level forward progress.
+    if (m_networkPath.needPathValidation()) {
+        return false;
+    }
+    if (m_handshakeDonePending && !m_handshakeDoneSent) {
+        return false;
+    }
+    if (m_bytesIn < 2048) {
+        return false;
+    }
+
+    const Config *cfg = config();
+    return cfg != nullptr && cfg->stream_enable_coalescing && cfg->stream_coalesce_delay_us != 0;
+}
+
+StreamImpl* ConnectionImpl::readyStreamHead(uint8_t level, utp_time_t nowUs)
+{
+    StreamImpl* stream = nullptr;
+    while ((stream = TAILQ_FIRST(&m_activeStreams[level])) != nullptr) {
+        if (!stream->hasPendingSendWork()) {
+            deactivateStream(stream);
+            continue;
+        }
+        if (stream->shouldDeferSend(nowUs)) {
+            deferStream(stream);
+            continue;
+        }
+        return stream;
+    }
+
+    return nullptr;
+}
+
+void ConnectionImpl::rotateStream(StreamImpl* stream)
+{
+    StreamQueue& queue = m_activeStreams[stream->m_schedLevel];
+    if (TAILQ_NEXT(stream, m_schedLink) == nullptr) {
+        return;
+    }
+    TAILQ_REMOVE(&queue, stream, m_schedLink);
+    TAILQ_INSERT_TAIL(&queue, stream, m_schedLink);
+}
+
+StreamImpl::SP ConnectionImpl::streamRef(const StreamImpl* stream) const
+{
+    auto it = m_streams.find(stream->id());
+    if (it == m_streams.end() || it->second.get() != stream) {
         return nullptr;
     }
     return it->second;
@@ -3600,15 +4005,13 @@ StreamImpl::SP ConnectionImpl::pickRoundRobinStream(const std::vector<StreamImpl
 
 StreamImpl::SP ConnectionImpl::pickNextWritableStreamDisabled(utp_time_t nowUs)
 {
-    std::vector<StreamImpl::SP> candidates;
-    candidates.reserve(m_streams.size());
-    for (const auto& entry : m_streams) {
-        if (entry.second && entry.second->hasPendingSendWork() && !entry.second->shouldDeferSend(nowUs)) {
-            candidates.push_back(entry.second);
-        }
+    StreamImpl* head = readyStreamHead(0, nowUs);
+    if (head == nullptr) {
+        return nullptr;
     }
 
-    StreamImpl::SP selected = pickRoundRobinStream(candidates, m_disabledRrCursor);
+    rotateStream(head);
+    StreamImpl::SP selected = streamRef(head);
     if (selected) {
         onSchedulerStreamSelected(selected, kStreamSchedulerDisabled, false, selected->m_priority, 0, 0, 0);
         UTP_LOGD("connection %u scheduler selected: mode=%s stream=%u prio=%u", m_localConnectionID,
@@ -3621,106 +4024,104 @@ StreamImpl::SP ConnectionImpl::pickNextWritableStreamDisabled(utp_time_t nowUs)
 
 StreamImpl::SP ConnectionImpl::pickNextWritableStreamStrict(utp_time_t nowUs)
 {
-    std::array<std::vector<StreamImpl::SP>, kMaxStreamPriorityLevels> byPriority;
-    for (const auto& entry : m_streams) {
-        if (!entry.second || !entry.second->hasPendingSendWork() || entry.second->shouldDeferSend(nowUs)) {
+    const Config*  cfg = (m_ctx != nullptr) ? m_ctx->config() : nullptr;
+    const uint16_t agingThreshold =
+        (cfg != nullptr && cfg->stream_aging_threshold > 0) ? cfg->stream_aging_threshold : 1;
+    const uint8_t  agingStep = (cfg != nullptr && cfg->stream_aging_step > 0) ? cfg->stream_aging_step : 1;
+
+    // 每个优先级队列内按 FIFO 轮转, 队头即该级等待最久的 stream, 只需比较各级队头
+    StreamImpl* best = nullptr;
+    uint8_t     bestPriority = 0;
+    uint32_t    bestWait = 0;
+    for (uint8_t level = 0; level < kMaxStreamPriorityLevels; ++level) {
+        if ((m_activeStreamLevels & (1u << level)) == 0) {
             continue;
         }
 
-        const uint8_t  basePriority = std::min<uint8_t>(entry.second->m_priority, Stream::kPriorityLowest);
-        const Config*  cfg = (m_ctx != nullptr) ? m_ctx->config() : nullptr;
-        const uint16_t agingThreshold =
-            (cfg != nullptr && cfg->stream_aging_threshold > 0) ? cfg->stream_aging_threshold : 1;
-        const uint8_t  agingStep = (cfg != nullptr && cfg->stream_aging_step > 0) ? cfg->stream_aging_step : 1;
-        const uint32_t promotions = (entry.second->m_schedWaitRounds / agingThreshold) * agingStep;
-        const uint8_t  effectivePriority =
-            (promotions >= basePriority) ? Stream::kPriorityHighest : static_cast<uint8_t>(basePriority - promotions);
-        byPriority[effectivePriority].push_back(entry.second);
-    }
-
-    for (size_t prio = 0; prio < kMaxStreamPriorityLevels; ++prio) {
-        StreamImpl::SP selected = pickRoundRobinStream(byPriority[prio], m_strictRrCursor[prio]);
-        if (selected) {
-            const bool agingPromoted = selected->m_schedWaitRounds > 0 && prio < selected->m_priority;
-            onSchedulerStreamSelected(selected, kStreamSchedulerStrict, agingPromoted, static_cast<uint8_t>(prio), 0, 0,
-                                      0);
-            UTP_LOGD(
-                "connection %u scheduler selected: mode=%s stream=%u base_prio=%u effective_prio=%u wait_rounds=%u",
-                m_localConnectionID, StreamSchedulerModeToString(kStreamSchedulerStrict), selected->id(),
-                static_cast<uint32_t>(selected->m_priority), static_cast<uint32_t>(prio), selected->m_schedWaitRounds);
-            return selected;
+        StreamImpl* head = readyStreamHead(level, nowUs);
+        if (head == nullptr) {
+            continue;
         }
-    }
-
-    return nullptr;
-}
 
-StreamImpl::SP ConnectionImpl::pickNextWritableStreamDrr(utp_time_t nowUs)
-{
-    std::vector<StreamImpl::SP> candidates;
-    candidates.reserve(m_streams.size());
-    for (const auto& entry : m_streams) {
-        if (entry.second && entry.second->hasPendingSendWork() && !entry.second->shouldDeferSend(nowUs)) {
-            candidates.push_back(entry.second);
+        const uint32_t waitRounds = streamWaitRounds(head);
+        const uint32_t promotions = (waitRounds / agingThreshold) * agingStep;
+        const uint8_t  effectivePriority =
+            (promotions >= level) ? static_cast<uint8_t>(Stream::kPriorityHighest) : static_cast<uint8_t>(level - promotions);
+        if (best == nullptr || effectivePriority < bestPriority ||
+            (effectivePriority == bestPriority && waitRounds > bestWait)) {
+            best = head;
+            bestPriority = effectivePriority;
+            bestWait = waitRounds;
         }
     }
 
-    if (candidates.empty()) {
+    if (best == nullptr) {
         return nullptr;
     }
 
-    std::sort(candidates.begin(), candidates.end(),
-              [](const StreamImpl::SP& a, const StreamImpl::SP& b) { return a->id() < b->id(); });
+    rotateStream(best);
+    StreamImpl::SP selected = streamRef(best);
+    if (selected) {
+        const bool agingPromoted = bestWait > 0 && bestPriority < selected->m_priority;
+        onSchedulerStreamSelected(selected, kStreamSchedulerStrict, agingPromoted, bestPriority, 0, 0, 0);
+        UTP_LOGD("connection %u scheduler selected: mode=%s stream=%u base_prio=%u effective_prio=%u wait_rounds=%u",
+                 m_localConnectionID, StreamSchedulerModeToString(kStreamSchedulerStrict), selected->id(),
+                 static_cast<uint32_t>(selected->m_priority), static_cast<uint32_t>(bestPriority), bestWait);
+    }
+
+    return selected;
+}
 
+StreamImpl::SP ConnectionImpl::pickNextWritableStreamDrr(utp_time_t nowUs)
+{
     const Config*  cfg = (m_ctx != nullptr) ? m_ctx->config() : nullptr;
     const uint32_t baseQuantum = (cfg != nullptr && cfg->stream_drr_quantum > 0) ? cfg->stream_drr_quantum : 1200;
     const uint32_t deficitCap =
         (cfg != nullptr && cfg->stream_drr_deficit_cap > 0) ? cfg->stream_drr_deficit_cap : 64 * 1024;
 
-    const size_t size = candidates.size();
-    size_t       startIndex = 0;
-    for (size_t i = 0; i < size; ++i) {
-        if (candidates[i]->id() > m_drrCursor) {
-            startIndex = i;
+    // 每访问一次队头补充一个 quantum, 不足则轮转到队尾; 最多补充两轮
+    size_t visits = m_activeStreamCount * 2;
+    while (visits-- > 0) {
+        StreamImpl* stream = readyStreamHead(0, nowUs);
+        if (stream == nullptr) {
             break;
         }
-    }
 
-    for (size_t pass = 0; pass < 2; ++pass) {
-        for (size_t n = 0; n < size; ++n) {
-            const size_t          idx = (startIndex + n) % size;
-            const StreamImpl::SP& stream = candidates[idx];
-            const uint32_t        priorityWeight = static_cast<uint32_t>(
-                Stream::kPriorityLowest - std::min<uint8_t>(stream->m_priority, Stream::kPriorityLowest) + 1);
-            const uint32_t quantum = baseQuantum * priorityWeight;
+        const uint32_t priorityWeight = static_cast<uint32_t>(
+            Stream::kPriorityLowest - std::min<uint8_t>(stream->m_priority, Stream::kPriorityLowest) + 1);
+        const uint32_t quantum = baseQuantum * priorityWeight;
 
-            uint32_t&      deficit = m_drrDeficit[stream->id()];
-            const uint32_t before = deficit;
-            if (deficit + quantum >= deficitCap) {
-                deficit = deficitCap;
-            } else {
-                deficit += quantum;
-            }
-            ++m_schedulerStats.drrDeficitRefills;
-
-            const uint32_t need = stream->m_sendQueuedBytes > 0
-                                      ? static_cast<uint32_t>(std::min<size_t>(stream->m_sendQueuedBytes, UINT16_MAX))
-                                      : 1u;
-            if (deficit >= need) {
-                const uint32_t afterRefill = deficit;
-                deficit -= need;
-                ++m_schedulerStats.drrDeficitConsumes;
-                m_drrCursor = stream->id();
-                onSchedulerStreamSelected(stream, kStreamSchedulerDrr, false, stream->m_priority, need, before,
-                                          deficit);
-                UTP_LOGD(
-                    "connection %u scheduler selected: mode=%s stream=%u prio=%u need=%u deficit_before=%u "
-                    "deficit_after_refill=%u deficit_after=%u",
-                    m_localConnectionID, StreamSchedulerModeToString(kStreamSchedulerDrr), stream->id(),
-                    static_cast<uint32_t>(stream->m_priority), need, before, afterRefill, deficit);
-                return stream;
-            }
+        uint32_t&      deficit = stream->m_drrDeficit;
+        const uint32_t before = deficit;
+        if (deficit + quantum >= deficitCap) {
+            deficit = deficitCap;
+        } else {
+            deficit += quantum;
+        }
+        ++m_schedulerStats.drrDeficitRefills;
+
+        rotateStream(stream);
+        const uint32_t need = stream->m_sendQueuedBytes > 0
+                                  ? static_cast<uint32_t>(std::min<size_t>(stream->m_sendQueuedBytes, UINT16_MAX))
+                                  : 1u;
+        if (deficit < need) {
+            continue;
+        }
+
+        const uint32_t afterRefill = deficit;
+        deficit -= need;
+        ++m_schedulerStats.drrDeficitConsumes;
+        StreamImpl::SP selected = streamRef(stream);
+        if (selected) {
+            onSchedulerStreamSelected(selected, kStreamSchedulerDrr, false, selected->m_priority, need, before,
+                                      deficit);
+            UTP_LOGD(
+                "connection %u scheduler selected: mode=%s stream=%u prio=%u need=%u deficit_before=%u "
+                "deficit_after_refill=%u deficit_after=%u",
+                m_localConnectionID, StreamSchedulerModeToString(kStreamSchedulerDrr), selected->id(),
+                static_cast<uint32_t>(selected->m_priority), need, before, afterRefill, deficit);
         }
+        return selected;
     }
 
     return nullptr;
@@ -3729,17 +4130,25 @@ StreamImpl::SP ConnectionImpl::pickNextWritableStreamDrr(utp_time_t nowUs)
 StreamImpl::SP ConnectionImpl::pickNextWritableStream(utp_time_t nowUs)
 {
     const StreamSchedulerMode mode = streamSchedulerMode();
+    if (mode != m_schedQueueMode) {
+        rebuildSchedulerQueues(mode);
+    }
+    promoteDeferredStreams(nowUs);
+
+    if (m_activeStreamCount == 0) {
+        return nullptr;
+    }
+
     if (m_streams.size() == 1) {
-        const auto& stream = m_streams.begin()->second;
-        if (stream && stream->hasPendingSendWork()) {
-            if (!stream->shouldDeferSend(nowUs)) {
-                onSchedulerStreamSelected(stream, mode, false, stream->m_priority, 0, 0, 0);
-                UTP_LOGD("connection %u scheduler selected: mode=%s stream=%u prio=%u single_stream=1",
-                         m_localConnectionID, StreamSchedulerModeToString(mode), stream->id(),
-                         static_cast<uint32_t>(stream->m_priority));
-                return stream;
-            }
+        StreamImpl* head = readyStreamHead(static_cast<uint8_t>(Util::CountTrailingZeros(m_activeStreamLevels)), nowUs);
+        StreamImpl::SP stream = (head != nullptr) ? streamRef(head) : nullptr;
+        if (stream) {
+            onSchedulerStreamSelected(stream, mode, false, stream->m_priority, 0, 0, 0);
+            UTP_LOGD("connection %u scheduler selected: mode=%s stream=%u prio=%u single_stream=1",
+                     m_localConnectionID, StreamSchedulerModeToString(mode), stream->id(),
+                     static_cast<uint32_t>(stream->m_priority));
         }
+        return stream;
     }
 
     switch (mode) {
@@ -3753,44 +4162,18 @@ StreamImpl::SP ConnectionImpl::pickNextWritableStream(utp_time_t nowUs)
     }
 }
 
-void ConnectionImpl::updateStrictAgingState(uint32_t selectedStreamId)
+void ConnectionImpl::updateStrictAgingState(StreamImpl* selected)
 {
-    if (streamSchedulerMode() != kStreamSchedulerStrict) {
-        return;
-    }
-    if (m_streams.size() <= 1) {
-        return;
-    }
-
-    for (auto& entry : m_streams) {
-        if (!entry.second || !entry.second->hasPendingSendWork()) {
-            if (entry.second) {
-                entry.second->m_schedWaitRounds = 0;
-            }
-            continue;
-        }
-
-        if (entry.first == selectedStreamId) {
-            entry.second->m_schedWaitRounds = 0;
-            continue;
-        }
-
-        if (entry.second->m_schedWaitRounds < UINT32_MAX) {
-            ++entry.second->m_schedWaitRounds;
-        }
+    ++m_schedRound;
+    if (selected != nullptr) {
+        selected->m_schedServedRound = m_schedRound;
     }
 }
 
-void ConnectionImpl::pruneSchedulerState()
+uint32_t ConnectionImpl::streamWaitRounds(const StreamImpl* stream) const
 {
-    for (auto it = m_drrDeficit.begin(); it != m_drrDeficit.end();) {
-        auto streamIt = m_streams.find(it->first);
-        if (streamIt == m_streams.end() || !streamIt->second || !streamIt->second->hasPendingSendWork()) {
-            it = m_drrDeficit.erase(it);
-            continue;
-        }
-        ++it;
-    }
+    const uint64_t waitRounds = m_schedRound - stream->m_schedServedRound;
+    return static_cast<uint32_t>(std::min<uint64_t>(waitRounds, UINT32_MAX));
 }
 
 void ConnectionImpl::onSchedulerStreamSelected(const StreamImpl::SP& stream, StreamSchedulerMode mode,
@@ -3819,10 +4202,13 @@ void ConnectionImpl::onSchedulerStreamSelected(const StreamImpl::SP& stream, Str
         ++m_schedulerStats.strictAgingPromoted;
     }
 
-    (void)effectivePriority;
+    if (m_trace) {
+        m_trace->record(kTraceStreamScheduled, time::MonotonicUs(), drrDeficitAfter, 0, stream->m_streamId,
+                        static_cast<uint8_t>(mode), effectivePriority);
+    }
+
     (void)drrNeed;
     (void)drrDeficitBefore;
-    (void)drrDeficitAfter;
 }
 
 void ConnectionImpl::noteSchedulerModeIfChanged(StreamSchedulerMode mode)
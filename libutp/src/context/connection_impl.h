@@ -14,8 +14,6 @@
 #include <unordered_map>
 #include <vector>
 
-#include <event/timer.h>
-
 #include "congestion/rtt.h"
 #include "context/stream_impl.h"
 #include "mtu/mtu.h"
@@ -23,8 +21,11 @@
 #include "util/malo.hpp"
 #include "util/mm.h"
 #include "util/network_path.h"
+#include "util/ack_info.h"
 #include "util/receive_history.h"
 #include "util/status.h"
+#include "util/timer_wheel.h"
+#include "util/trace_recorder.h"
 #include "util/transport_param.h"
 #include "utp/connection.h"
 #include "utp/types.h"
@@ -92,6 +93,17 @@ public:
 
     void onUdpPacket(const UdpSocket::MsgMetaInfo &msg);
     void onUdpPacket(const UdpSocket::MsgMetaInfo &msg, utp_time_t nowUs);
+
+    /**
+     * @brief 登记收包批次内属于本连接的数据报, msg 需在 flushStagedUdpPackets 前保持有效
+     *
+     * @return 是否为本批次首个登记的数据报
+     */
+    bool stageUdpPacket(const UdpSocket::MsgMetaInfo &msg);
+    /**
+     * @brief 处理已登记的数据报: 先整批解密, 再逐包解析帧, ACK 与待发流数据在批次末尾只处理一次
+     */
+    void flushStagedUdpPackets(utp_time_t nowUs);
     void onWrite();
 
     // @brief 下一次调度时间(ms), send control触发
@@ -111,6 +123,10 @@ public:
 
     int32_t     exportSessionToken(std::vector<uint8_t> &outToken) override;
     int32_t     exportSessionResumptionState(std::string &outState) override;
+    int32_t     exportTrace(std::string &outQlog) override;
+    /// @brief 事件追踪环, 未开启时为 nullptr
+    TraceRecorder *trace() const { return m_trace.get(); }
+    void        traceTimerFired(TraceTimer timer, uint64_t detail = 0);
 
     int32_t createStream(StreamType streamType) override;
     Stream *getStream(uint32_t streamId) override;
@@ -187,15 +203,27 @@ private:
     void     ensureFlowControlAdvertised(uint32_t streamId);
     void     onStreamBytesConsumed(uint32_t streamId, size_t bytes);
     uint64_t peerStreamDataLimit(uint32_t streamId) const;
+    /// @brief 本端单流接收窗口 (MAX_STREAM_DATA 相对已消费偏移的增量)
+    uint64_t localStreamDataWindow() const;
+    StreamFlowState       *streamFlowState(uint32_t streamId);
+    const StreamFlowState *findStreamFlowState(uint32_t streamId) const;
+    void     takeDetachedFlowState(uint32_t streamId, StreamFlowState &flow);
     Status   sendStreamFrame(uint32_t streamId, uint64_t streamOffset, const uint8_t *data, size_t len, bool fin);
     void     onStreamDataSent(uint32_t streamId, uint64_t streamOffset, size_t len);
     Status   sendHandshakeDonePacket();
     Status   maybeSendSessionTokenPacket();
     Status   sendInitialPacket();
+    /// @brief 处理服务端的无状态 Retry: 记下令牌并立即重发 INITIAL, 每次建连只接受一次
+    void     onRetryPacket(PacketIn *packet);
     Status   sendHandshakePacket(bool encrypted);
     Status   buildAckPayload(std::vector<uint8_t> &payload, utp_time_t nowUs) const;
     Status   sendAckPacket(utp_time_t nowUs);
+    void     requestImmediateAck(utp_time_t nowUs, uint32_t retryMs);
+    void     processUdpPacket(const UdpSocket::MsgMetaInfo &msg, PacketIn *packet, utp_time_t nowUs);
+    void     finishRecvBatch(utp_time_t nowUs);
     void     noteAckElicitingPacket(utp_time_t nowUs);
+    /// @brief 累计收到包的 ECN 码点, CE 时返回 true
+    bool     noteEcnCodepoint(uint8_t ecn);
     void     applyAckFrequency(const FrameAckFrequency &ackFreq, utp_time_t nowMs);
     void     maybeUpdateAckFrequency(utp_time_t nowUs);
     AckFrequencyProfile selectDesiredAckProfile(utp_time_t nowUs);
@@ -258,9 +286,29 @@ private:
     uint8_t defaultStreamPriority() const;
     /// @brief 读取当前调度策略（支持运行时热切换）
     StreamSchedulerMode streamSchedulerMode() const;
-    /// @brief 对候选 stream 做基于 stream_id 的 RR 选取
-    StreamImpl::SP pickRoundRobinStream(const std::vector<StreamImpl::SP> &candidates, uint32_t &cursor);
-    /// @brief DISABLED 模式：按 stream_id RR 选流
+    /// @brief stream 在指定模式下所属的活跃队列下标
+    static uint8_t schedulerLevel(const StreamImpl *stream, StreamSchedulerMode mode);
+    /// @brief 由队列中的裸指针取回 m_streams 持有的引用, 已移出 m_streams 时返回空
+    StreamImpl::SP streamRef(const StreamImpl *stream) const;
+    /// @brief stream 有待发送数据时挂入活跃队列(已在队列中则忽略)
+    void activateStream(StreamImpl *stream);
+    /// @brief 将 stream 从活跃/延迟队列摘除并清零 deficit
+    void deactivateStream(StreamImpl *stream);
+    /// @brief 优先级变化后将活跃 stream 移到对应队列
+    void onStreamPriorityChanged(StreamImpl *stream);
+    /// @brief 调度模式变化后按新模式重新分桶
+    void rebuildSchedulerQueues(StreamSchedulerMode mode);
+    /// @brief 延迟队列中合并窗口已到期的 stream 移回活跃队列, 只弹出队首已到期的部分
+    void promoteDeferredStreams(utp_time_t nowUs);
+    /// @brief stream 移入延迟队列, 到期时间为其合并窗口截止时刻; 从队尾向前找插入点, 保持按到期时间升序
+    void deferStream(StreamImpl *stream);
+    /// @brief 连接层面是否允许合并发送 (路径验证/HandshakeDone/抗放大期间不延迟)
+    bool streamCoalescingAllowed() const;
+    /// @brief 取队列头部第一个可立即发送的 stream, 沿途摘除已无数据/需延迟的 stream
+    StreamImpl *readyStreamHead(uint8_t level, utp_time_t nowUs);
+    /// @brief 将队列中的 stream 移到队尾 (RR 轮转)
+    void rotateStream(StreamImpl *stream);
+    /// @brief DISABLED 模式：单队列 RR 选流
     StreamImpl::SP pickNextWritableStreamDisabled(utp_time_t nowUs);
     /// @brief STRICT+Aging 模式选流
     StreamImpl::SP pickNextWritableStreamStrict(utp_time_t nowUs);
@@ -268,10 +316,10 @@ private:
     StreamImpl::SP pickNextWritableStreamDrr(utp_time_t nowUs);
     /// @brief 按当前模式统一选流入口
     StreamImpl::SP pickNextWritableStream(utp_time_t nowUs);
-    /// @brief STRICT 模式下更新 aging 等待轮次
-    void updateStrictAgingState(uint32_t selectedStreamId);
-    /// @brief 清理无效调度状态（已关闭流/空队列）
-    void pruneSchedulerState();
+    /// @brief 推进调度轮次并记录 stream 的最近服务轮次
+    void updateStrictAgingState(StreamImpl *selected);
+    /// @brief stream 自上次被服务以来等待的调度轮次
+    uint32_t streamWaitRounds(const StreamImpl *stream) const;
     /// @brief 记录一次选流结果并累计指标
     void onSchedulerStreamSelected(const StreamImpl::SP &stream, StreamSchedulerMode mode, bool agingPromoted,
                                    uint8_t effectivePriority, uint32_t drrNeed, uint32_t drrDeficitBefore,
@@ -282,6 +330,7 @@ private:
     void maybeEmitSchedulerStats(utp_time_t nowUs);
 
 private:
+    friend class ContextImpl;
     friend class SendControl;
     friend class StreamImpl;
 
@@ -292,21 +341,18 @@ private:
     TransportParams                        m_loaclTP{};
     TransportParams                        m_peerTP{};
     uint64_t                               m_peerMaxData{0};
-    std::unordered_map<uint32_t, uint64_t> m_peerMaxStreamData;
     uint64_t                               m_localMaxDataAdvertised{0};
-    std::unordered_map<uint32_t, uint64_t> m_localMaxStreamDataAdvertised;
     uint64_t                               m_localBytesConsumedTotal{0};
-    std::unordered_map<uint32_t, uint64_t> m_localStreamBytesConsumed;
     uint64_t                               m_streamDataSentTotal{0};
-    std::unordered_map<uint32_t, uint64_t> m_streamMaxSentOffset;
+    std::unordered_map<uint32_t, StreamFlowState> m_detachedFlowStates;  // 尚无 StreamImpl 的流级流控状态
     bool                                   m_initialFlowControlAdvertised{false};
     MemoryManager                          m_mm;
     RttStats                               m_rttStats;
 
     Context::ConnectInfo        m_connectInfo{};
     Context::ConnectAttemptInfo m_connectAttemptInfo{};
-    ev::EventTimer              m_connTimer;
-    ev::EventTimer              m_scheduleTimer;
+    WheelTimer                  m_connTimer;
+    WheelTimer                  m_scheduleTimer;
 
     uint32_t    m_localConnectionID{};
     uint32_t    m_peerConnectionID{};
@@ -320,6 +366,7 @@ private:
     std::shared_ptr<X25519Wrapper> m_x25519;
     std::shared_ptr<AesGcmContext> m_aesCtx;
     std::unique_ptr<SendControl>   m_sendCtl;
+    std::unique_ptr<TraceRecorder> m_trace;
 
     OnIncomingStream    m_onIncomingStream;
     OnSessionTokenReady m_onSessionTokenReady;
@@ -335,14 +382,15 @@ private:
     mutable std::vector<uint8_t>        m_ackPayloadScratch;
     std::vector<uint8_t>                m_payloadScratch;
     std::vector<uint8_t>                m_bodyScratch;
-    ev::EventTimer                      m_pathValidationTimer;
-    ev::EventTimer                      m_handshakeDoneTimer;
-    ev::EventTimer                      m_ackTimer;
-    ev::EventTimer                      m_keepaliveTimer;
-    ev::EventTimer                      m_closeDrainTimer;
+    WheelTimer                          m_pathValidationTimer;
+    WheelTimer                          m_handshakeDoneTimer;
+    WheelTimer                          m_ackTimer;
+    WheelTimer                          m_keepaliveTimer;
+    WheelTimer                          m_closeDrainTimer;
     ReceiveHistory                      m_receiveHistory;
     MtuDiscovery                        m_mtuDiscovery;
     uint8_t                             m_handshakeRetryCount{0};
+    std::vector<uint8_t>                m_retryToken;           // 服务端 Retry 下发的地址校验令牌, INITIAL 中回显
     bool                                m_handshakeDonePending{false};
     bool                                m_handshakeDoneSent{false};
     utp_packno_t                        m_handshakeDoneLastPacketNo{0};
@@ -364,6 +412,15 @@ private:
     uint32_t                                 m_peerAckMaxDelayMs{UTP_DEFAULT_MAX_ACK_DELAY_MS};
     uint32_t                                 m_ackElicitingSinceLastAck{0};
     utp_time_t                               m_ackPendingSinceUs{0};
+    EcnCounts                                m_recvEcnCounts{};         // 已收包的 ECN 标记计数, 随 ACK 帧回传
+    /// @b 收包批次
+    std::vector<const UdpSocket::MsgMetaInfo *> m_recvBatchMsgs;    // 本批次登记的数据报
+    std::vector<PacketIn *>                  m_recvBatchPackets;        // 与 m_recvBatchMsgs 一一对应, 解密失败为空
+    bool                                     m_inRecvBatch{false};
+    bool                                     m_recvBatchAckNow{false};      // 批次内达到立即 ACK 条件
+    bool                                     m_recvBatchAckDelayed{false};  // 批次内需要延迟 ACK
+    bool                                     m_recvBatchFlushWrites{false};
+    uint32_t                                 m_recvBatchAckRetryMs{0};      // 立即 ACK 失败后的重试延迟
     utp_time_t                               m_lastAckFrequencyApplyMs{0};
     AckFrequencyProfile                      m_ackProfileCurrent{kAckProfileStable};
     AckFrequencyProfile                      m_ackProfileCandidate{kAckProfileStable};
@@ -371,9 +428,7 @@ private:
     utp_time_t                               m_ackProfileLastSentMs{0};
     utp_time_t                               m_ackProfileBaselineSrttUs{0};
     utp_time_t                               m_lastMaxDataSentUs{0};
-    std::unordered_map<uint32_t, utp_time_t> m_lastMaxStreamDataSentUs;
     utp_time_t                               m_lastDataBlockedSentUs{0};
-    std::unordered_map<uint32_t, utp_time_t> m_lastStreamDataBlockedSentUs;
     bool                                     m_isClientInitiator{true};
     int32_t                                  m_lastErrorCode{0};
     std::array<char, kConnectionReasonSize>  m_lastErrorReason{};
@@ -387,10 +442,18 @@ private:
     uint64_t                                 m_cachedResumptionExpiresAt{0};
     ZeroRttConfig                            m_zeroRttConfig{};
     /// @b Stream 调度状态
-    std::array<uint32_t, 8>                m_strictRrCursor{{0}};  // STRICT: 每个优先级桶的 RR 游标
-    uint32_t                               m_disabledRrCursor{0};  // DISABLED: 全局 RR 游标
-    uint32_t                               m_drrCursor{0};         // DRR: 上次命中的 stream_id
-    std::unordered_map<uint32_t, uint32_t> m_drrDeficit;           // DRR: 每个 stream 的 deficit(bytes)
+    TAILQ_HEAD(StreamQueue, StreamImpl);
+    std::array<StreamQueue, 8>             m_activeStreams;          // 有待发数据的 stream; STRICT 按优先级分桶, 其余模式只用 0 号
+    StreamQueue                            m_deferredStreams;        // 合并窗口内暂缓发送的 stream, 按到期时间升序
+    uint8_t                                m_activeStreamLevels{0};  // 非空活跃队列位图
+    size_t                                 m_activeStreamCount{0};
+    StreamSchedulerMode                    m_schedQueueMode{kStreamSchedulerStrict}; // 当前队列分桶所依据的模式
+    uint64_t                               m_schedRound{0};          // 已完成的选流轮次
+
+    /// @b Context 写调度状态, 由 ContextImpl 维护
+    TAILQ_ENTRY(ConnectionImpl)            m_writeLink;
+    bool                                   m_writeQueued{false};
+    uint32_t                               m_wdrrDeficit{0};         // 连接级 WDRR deficit(bytes)
 
     /// @b Stream 调度指标
     struct {
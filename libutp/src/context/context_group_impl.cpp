@@ -0,0 +1,250 @@
+/*************************************************************************
+    > File Name: context_group_impl.cpp
+    > Author: eular
+    > Brief: reuseport 分片上下文组实现
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include "context/context_group_impl.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <event2/event.h>
+
+#include "commom.h"
+#include "context/context_impl.h"
+#include "socket/address.h"
+#include "util/error.h"
+#include "logger/logger.h"
+
+#if defined(OS_LINUX)
+#include <linux/filter.h>
+
+#ifndef SO_ATTACH_REUSEPORT_CBPF
+#define SO_ATTACH_REUSEPORT_CBPF 51
+#endif
+#endif
+
+static eular::utp::Config g_defaultGroupConfig;
+
+namespace eular {
+namespace utp {
+
+ContextGroupImpl::ContextGroupImpl(uint32_t shards, Config *config) :
+    m_config(config ? *config : g_defaultGroupConfig)
+{
+    shards = std::max<uint32_t>(std::min<uint32_t>(shards, ContextImpl::kMaxShards), 1);
+    m_shards.reserve(shards);
+    for (uint32_t i = 0; i < shards; ++i) {
+        std::unique_ptr<Shard> shard(new Shard());
+        shard->index = i;
+        m_shards.emplace_back(std::move(shard));
+    }
+}
+
+ContextGroupImpl::~ContextGroupImpl()
+{
+    stop();
+}
+
+void ContextGroupImpl::setOnShardStart(const ContextGroup::OnShardStart &cb)
+{
+    m_onShardStart = cb;
+}
+
+Context *ContextGroupImpl::context(uint32_t shard)
+{
+    if (shard >= m_shards.size()) {
+        return nullptr;
+    }
+    return m_shards[shard]->context.get();
+}
+
+Status ContextGroupImpl::start(const std::string &ip, uint16_t port, const std::string &ifname)
+{
+    if (m_started) {
+        return Status::ErrorLiteral(UTP_ERR_INVALID_STATE, "context group already started");
+    }
+
+    const uint32_t shards = shardCount();
+    uint16_t bindPort = port;
+    for (auto &shard : m_shards) {
+        Shard *current = shard.get();
+        current->context.reset(new Context(current->loop.loop(), &m_config));
+        std::shared_ptr<ContextImpl> impl = current->context->m_impl;
+        impl->setShard(current->index, shards, [this] (uint32_t target, const UdpSocket::MsgMetaInfo &msg) {
+            return forward(target, msg);
+        });
+
+        // NOTE 套接字在 reuseport 组内的序号即绑定顺序, 与 cBPF 返回的分片序号一一对应
+        Status st = impl->bind(ip, bindPort, ifname);
+        if (!st.ok()) {
+            stop();
+            return st;
+        }
+        if (bindPort == 0) {
+            Address local;
+            local.fromSocket(impl->socketFd());
+            bindPort = local.port();
+        }
+
+        current->async.reset(new ev::SingleAsync(current->loop.loop(), [this, current] () {
+            onShardAsync(*current);
+        }));
+        if (!current->async->start()) {
+            stop();
+            return Status::ErrorLiteral(UTP_ERR_SOCKET_EVENT, "failed to start shard notifier");
+        }
+    }
+    m_port = bindPort;
+
+    m_cbpfAttached = false;
+    if (shards > 1 && m_config.enable_reuseport_cbpf) {
+        Status st = attachReusePortCbpf(m_shards.front()->context->m_impl->socketFd());
+        if (st.ok()) {
+            m_cbpfAttached = true;
+        } else {
+            UTP_LOGW("reuseport cBPF unavailable, fallback to user-space forwarding: %s", st.message());
+        }
+    }
+
+    m_stopping.store(false);
+    m_started = true;
+    for (auto &shard : m_shards) {
+        Shard *current = shard.get();
+        current->thread = std::thread([this, current] () {
+            runShard(*current);
+        });
+    }
+    return Status::OK();
+}
+
+void ContextGroupImpl::stop()
+{
+    m_stopping.store(true);
+    for (auto &shard : m_shards) {
+        if (shard->thread.joinable() && shard->async) {
+            shard->async->notify();
+        }
+    }
+    for (auto &shard : m_shards) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+    for (auto &shard : m_shards) {
+        shard->async.reset();
+        shard->context.reset();
+        std::lock_guard<std::mutex> lock(shard->inboxMutex);
+        shard->inbox.clear();
+    }
+    m_started = false;
+    m_cbpfAttached = false;
+}
+
+void ContextGroupImpl::runShard(Shard &shard)
+{
+    if (m_onShardStart) {
+        m_onShardStart(shard.index, *shard.context);
+    }
+
+    // 启动回调内已投递的数据报需先处理
+    onShardAsync(shard);
+    while (!m_stopping.load()) {
+        if (shard.loop.dispatch(EVLOOP_NO_EXIT_ON_EMPTY) < 0) {
+            break;
+        }
+    }
+}
+
+bool ContextGroupImpl::forward(uint32_t shard, const UdpSocket::MsgMetaInfo &msg)
+{
+    if (shard >= m_shards.size() || m_stopping.load()) {
+        return false;
+    }
+
+    Shard &target = *m_shards[shard];
+    bool wakeup = false;
+    {
+        std::lock_guard<std::mutex> lock(target.inboxMutex);
+        if (target.inbox.size() >= std::max<uint32_t>(m_config.reuseport_forward_queue, 1)) {
+            return false;
+        }
+        wakeup = target.inbox.empty();
+        target.inbox.emplace_back();
+        ForwardedPacket &packet = target.inbox.back();
+        const uint8_t *data = static_cast<const uint8_t *>(msg.data);
+        packet.data.assign(data, data + msg.len);
+        packet.metaInfo = msg.metaInfo;
+    }
+
+    // NOTE 队列由空变非空时才唤醒, 目标线程一次取走全部数据报
+    if (wakeup && target.async) {
+        target.async->notify();
+    }
+    return true;
+}
+
+void ContextGroupImpl::onShardAsync(Shard &shard)
+{
+    if (m_stopping.load()) {
+        shard.loop.breakLoop();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(shard.inboxMutex);
+        shard.draining.swap(shard.inbox);
+    }
+    if (shard.draining.empty() || !shard.context) {
+        return;
+    }
+
+    std::shared_ptr<ContextImpl> impl = shard.context->m_impl;
+    shard.msgScratch.resize(shard.draining.size());
+    for (size_t i = 0; i < shard.draining.size(); ++i) {
+        UdpSocket::MsgMetaInfo &msg = shard.msgScratch[i];
+        msg.data = shard.draining[i].data.data();
+        msg.len = shard.draining[i].data.size();
+        msg.slice_count = 0;
+        msg.metaInfo = shard.draining[i].metaInfo;
+        msg.metaInfo.fd = impl->socketFd();
+    }
+    impl->onForwardedPackets(shard.msgScratch.data(), shard.msgScratch.size());
+    shard.draining.clear();
+}
+
+Status ContextGroupImpl::attachReusePortCbpf(socket_t fd)
+{
+#if defined(OS_LINUX)
+    // NOTE reuseport cBPF 的数据偏移从 UDP 载荷起算, 头部为 scid(0..3) dcid(4..7), 网络字节序.
+    //      逻辑与 ContextImpl::ShardOfPacket 一致, 返回值越界时内核回退为散列选择
+    const uint32_t shards = shardCount();
+    sock_filter code[] = {
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 4),                                  // A = dcid
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0, 3, 0),                           // dcid == 0 -> 按 scid 散列
+        BPF_STMT(BPF_ALU | BPF_RSH | BPF_K, ContextImpl::kShardCidShift),       // A = dcid 高 8 位
+        BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, shards),
+        BPF_STMT(BPF_RET | BPF_A, 0),
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 0),                                  // A = scid
+        BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, shards),
+        BPF_STMT(BPF_RET | BPF_A, 0),
+    };
+    sock_fprog prog;
+    prog.len = static_cast<unsigned short>(sizeof(code) / sizeof(code[0]));
+    prog.filter = code;
+    if (::setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) != 0) {
+        int32_t err = GetSystemLastError();
+        return Status::Error(UTP_ERR_SOCKET_OPTION, fmt::format("setsockopt({}, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF) failed: [{}, {}].",
+                fd, err, GetSystemErrnoMsg(err)));
+    }
+    return Status::OK();
+#else
+    UNUSED(fd);
+    return Status::ErrorLiteral(UTP_ERR_NOT_IMPLEMENTED, "SO_ATTACH_REUSEPORT_CBPF is not supported on this platform.");
+#endif
+}
+
+} // namespace utp
+} // namespace eular
@@ -0,0 +1,85 @@
+/*************************************************************************
+    > File Name: context_group_impl.h
+    > Author: eular
+    > Brief: reuseport 分片上下文组实现
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#ifndef __UTP_CONTEXT_GROUP_IMPL_H__
+#define __UTP_CONTEXT_GROUP_IMPL_H__
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <event/loop.h>
+#include <event/single_async.h>
+#include <utils/utils.h>
+
+#include "utp/context_group.h"
+#include "socket/udp.h"
+#include "util/status.h"
+
+namespace eular {
+namespace utp {
+
+class ContextGroupImpl
+{
+    DISALLOW_COPY_AND_ASSIGN(ContextGroupImpl);
+    DISALLOW_MOVE(ContextGroupImpl);
+
+public:
+    ContextGroupImpl(uint32_t shards, Config *config);
+    ~ContextGroupImpl();
+
+    void setOnShardStart(const ContextGroup::OnShardStart &cb);
+
+    Status start(const std::string &ip, uint16_t port, const std::string &ifname);
+    void stop();
+
+    uint32_t shardCount() const { return static_cast<uint32_t>(m_shards.size()); }
+    uint16_t port() const { return m_port; }
+    bool cbpfAttached() const { return m_cbpfAttached; }
+    Context *context(uint32_t shard);
+
+private:
+    struct ForwardedPacket {
+        std::vector<uint8_t>    data;
+        PacketMetaInfo          metaInfo;
+    };
+
+    // NOTE 成员声明顺序保证析构时先释放 Context 再释放事件循环
+    struct Shard {
+        uint32_t                            index{0};
+        ev::EventLoop                       loop;
+        std::unique_ptr<Context>            context;
+        std::unique_ptr<ev::SingleAsync>    async;
+        std::thread                         thread;
+
+        std::mutex                          inboxMutex;
+        std::vector<ForwardedPacket>        inbox;      // 其他分片投递过来的数据报
+        std::vector<ForwardedPacket>        draining;
+        std::vector<UdpSocket::MsgMetaInfo> msgScratch;
+    };
+
+    bool forward(uint32_t shard, const UdpSocket::MsgMetaInfo &msg);
+    void onShardAsync(Shard &shard);
+    void runShard(Shard &shard);
+    Status attachReusePortCbpf(socket_t fd);
+
+private:
+    Config                              m_config;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    ContextGroup::OnShardStart          m_onShardStart;
+    std::atomic<bool>                   m_stopping{false};
+    bool                                m_started{false};
+    bool                                m_cbpfAttached{false};
+    uint16_t                            m_port{0};
+};
+
+} // namespace utp
+} // namespace eular
+
+#endif // __UTP_CONTEXT_GROUP_IMPL_H__
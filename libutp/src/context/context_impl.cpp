@@ -15,7 +15,6 @@
 #include <cstdlib>
 #include <cstring>
 #include <exception>
-#include <unordered_set>
 #include <vector>
 
 #include <utils/serialize.hpp>
@@ -30,6 +29,7 @@
 #include "proto/frame/handshake_delay.h"
 #include "proto/frame/handshake_done.h"
 #include "proto/frame/handshake_helper.h"
+#include "proto/frame/retry_token.h"
 #include "proto/frame/session_token.h"
 #include "proto/frame/stream.h"
 #include "proto/frame/connection_close.h"
@@ -236,6 +236,47 @@ bool DecodeTokenEncryptionMode(uint8_t modeRaw, eular::utp::Context::EncryptionM
     }
 }
 
+// 令牌只绑定对端 IP, 不含端口, NAT 重绑定后仍可使用
+bool BindTokenPeerAddress(const eular::utp::Address &peerAddress, eular::utp::TokenMeta &meta)
+{
+    meta.family = static_cast<uint16_t>(peerAddress.family());
+    if (peerAddress.isIPv4()) {
+        sockaddr_in addr4{};
+        if (!peerAddress.toSockAddrIn(addr4)) {
+            return false;
+        }
+        meta.host_v4 = addr4.sin_addr;
+        return true;
+    }
+    if (peerAddress.isIPv6()) {
+        sockaddr_in6 addr6{};
+        if (!peerAddress.toSockAddrIn6(addr6)) {
+            return false;
+        }
+        meta.host_v6 = addr6.sin6_addr;
+        return true;
+    }
+    return false;
+}
+
+bool TokenPeerAddressMatches(const eular::utp::Address &peerAddress, const eular::utp::TokenMeta &meta)
+{
+    if (meta.family != static_cast<uint16_t>(peerAddress.family())) {
+        return false;
+    }
+    if (peerAddress.isIPv4()) {
+        sockaddr_in addr4{};
+        return peerAddress.toSockAddrIn(addr4)
+            && std::memcmp(&addr4.sin_addr, &meta.host_v4, sizeof(addr4.sin_addr)) == 0;
+    }
+    if (peerAddress.isIPv6()) {
+        sockaddr_in6 addr6{};
+        return peerAddress.toSockAddrIn6(addr6)
+            && std::memcmp(&addr6.sin6_addr, &meta.host_v6, sizeof(addr6.sin6_addr)) == 0;
+    }
+    return false;
+}
+
 eular::utp::Context::ConnectAttemptInfo MakeConnectAttemptInfo(const eular::utp::Context::ConnectInfo &info)
 {
     eular::utp::Context::ConnectAttemptInfo attempt;
@@ -283,14 +324,24 @@ eular::utp::Context::ConnectAttemptInfo MakeConnectAttemptInfo(const eular::utp:
 
 namespace eular {
 namespace utp {
+
+constexpr uint32_t ContextImpl::kMaxShards;
+constexpr uint32_t ContextImpl::kShardCidShift;
+constexpr uint32_t ContextImpl::kShardCidLowMask;
+
 ContextImpl::ContextImpl(event_base *base, Config *config) :
     m_base(base),
     m_config(config != nullptr ? *config : g_defaultConfig),
-    m_udpSocket(m_config)
+    m_udpSocket(m_config),
+    m_timerWheel(base, m_config.clock_granularity_us)
 {
+    TAILQ_INIT(&m_wantWriteConns);
     m_pendingHandshakeTimer.reset(m_base, [this] () {
         onPendingHandshakeTimeout();
     });
+    if (m_config.shared_memory_pool) {
+        m_sharedMm = std::make_shared<MemoryManager>();
+    }
     m_recvMsgScratch.resize(32);
 
     uint32_t id = g_contextId.fetch_add(1, std::memory_order_relaxed);
@@ -299,6 +350,13 @@ ContextImpl::ContextImpl(event_base *base, Config *config) :
 
 ContextImpl::~ContextImpl()
 {
+    // 连接随 m_connections 析构时会尝试出队, 先整体摘除
+    ConnectionImpl *conn = nullptr;
+    while ((conn = TAILQ_FIRST(&m_wantWriteConns)) != nullptr) {
+        TAILQ_REMOVE(&m_wantWriteConns, conn, m_writeLink);
+        conn->m_writeQueued = false;
+    }
+    m_wantWriteCount = 0;
 }
 
 const std::string &ContextImpl::tag() const
@@ -356,19 +414,29 @@ void ContextImpl::clearResumptionSecret()
     m_hasCustomResumptionSecret = false;
 }
 
+void ContextImpl::setKeyPairPoolSize(uint32_t capacity, uint32_t lowWatermark)
+{
+    m_keyPool.resize(capacity, lowWatermark);
+}
+
+std::shared_ptr<X25519Wrapper> ContextImpl::acquireKeyPair()
+{
+    return m_keyPool.acquire();
+}
+
 void ContextImpl::wantWrite(ConnectionImpl *conn)
 {
     if (conn == nullptr) {
         return;
     }
 
-    if (m_wantWriteConnSet.find(conn) != m_wantWriteConnSet.end()) {
+    if (conn->m_writeQueued) {
         return;
     }
 
-    m_wantWriteConns.push_back(conn);
-    m_wantWriteConnSet.insert(conn);
-    (void)m_wdrrDeficit.emplace(conn, 0u);
+    TAILQ_INSERT_TAIL(&m_wantWriteConns, conn, m_writeLink);
+    conn->m_writeQueued = true;
+    ++m_wantWriteCount;
 
     if (!m_udpSocket.isValid()) {
         return;
@@ -407,9 +475,12 @@ void ContextImpl::removeFromWriteQueue(ConnectionImpl *conn)
         return;
     }
 
-    m_wantWriteConns.remove(conn);
-    m_wantWriteConnSet.erase(conn);
-    m_wdrrDeficit.erase(conn);
+    if (conn->m_writeQueued) {
+        TAILQ_REMOVE(&m_wantWriteConns, conn, m_writeLink);
+        conn->m_writeQueued = false;
+        --m_wantWriteCount;
+    }
+    conn->m_wdrrDeficit = 0;
 }
 
 void ContextImpl::handleConnectionState(ConnectionImpl *conn)
@@ -809,21 +880,7 @@ bool ContextImpl::buildZeroRttSessionToken(const Address &peerAddress,
     meta.encryption_mode = static_cast<uint8_t>(encrypted);
     meta.version = 1;
     meta.secret = 0;
-    meta.family = static_cast<uint16_t>(peerAddress.family());
-
-    if (peerAddress.isIPv4()) {
-        sockaddr_in addr4{};
-        if (!peerAddress.toSockAddrIn(addr4)) {
-            return false;
-        }
-        meta.host_v4 = addr4.sin_addr;
-    } else if (peerAddress.isIPv6()) {
-        sockaddr_in6 addr6{};
-        if (!peerAddress.toSockAddrIn6(addr6)) {
-            return false;
-        }
-        meta.host_v6 = addr6.sin6_addr;
-    } else {
+    if (!BindTokenPeerAddress(peerAddress, meta)) {
         return false;
     }
 
@@ -1151,23 +1208,7 @@ bool ContextImpl::validateZeroRttTicket(const Address &peerAddress,
         return false;
     }
 
-    if (tokenMeta.family != static_cast<uint16_t>(peerAddress.family())) {
-        return false;
-    }
-
-    if (peerAddress.isIPv4()) {
-        sockaddr_in addr4{};
-        if (!peerAddress.toSockAddrIn(addr4)
-            || std::memcmp(&addr4.sin_addr, &tokenMeta.host_v4, sizeof(addr4.sin_addr)) != 0) {
-            return false;
-        }
-    } else if (peerAddress.isIPv6()) {
-        sockaddr_in6 addr6{};
-        if (!peerAddress.toSockAddrIn6(addr6)
-            || std::memcmp(&addr6.sin6_addr, &tokenMeta.host_v6, sizeof(addr6.sin6_addr)) != 0) {
-            return false;
-        }
-    } else {
+    if (!TokenPeerAddressMatches(peerAddress, tokenMeta)) {
         return false;
     }
 
@@ -1196,6 +1237,111 @@ bool ContextImpl::validateZeroRttTicket(const Address &peerAddress,
     return true;
 }
 
+bool ContextImpl::retryRequired() const
+{
+    return m_config.retry_pending_threshold > 0 && m_pendingIncoming.size() >= m_config.retry_pending_threshold;
+}
+
+bool ContextImpl::buildRetryToken(const Address &peerAddress, uint32_t peerCid, std::vector<uint8_t> &outToken)
+{
+    outToken.clear();
+
+    TokenAuth *auth = tokenAuth();
+    if (auth == nullptr || peerCid == 0) {
+        return false;
+    }
+
+    TokenMeta meta;
+    meta.token_type = static_cast<uint8_t>(TokenType::kRetry);
+    meta.timestamp = static_cast<uint32_t>(time::RealtimeMs() / 1000);
+    meta.cid = peerCid;
+    meta.version = UTP_PROTOCOL_VERSION;
+    meta.secret = 0;
+    if (!BindTokenPeerAddress(peerAddress, meta)) {
+        return false;
+    }
+
+    TokenAuth::TokenBuf tokenBuf{};
+    if (!auth->seal(meta, tokenBuf)) {
+        return false;
+    }
+
+    outToken.assign(tokenBuf.begin(), tokenBuf.end());
+    return true;
+}
+
+bool ContextImpl::validateRetryToken(const Address &peerAddress, uint32_t peerCid, const std::vector<uint8_t> &token)
+{
+    if (!peerAddress.isValid() || token.size() != TOKEN_SIZE) {
+        return false;
+    }
+
+    TokenAuth *auth = tokenAuth();
+    if (auth == nullptr) {
+        return false;
+    }
+
+    TokenAuth::TokenBuf tokenBuf{};
+    std::memcpy(tokenBuf.data(), token.data(), tokenBuf.size());
+
+    TokenMeta tokenMeta;
+    if (!auth->open(tokenBuf, tokenMeta, TokenType::kRetry)) {
+        return false;
+    }
+
+    // 令牌绑定发起方 scid, 不能挪用到同一地址的其他握手
+    if (tokenMeta.cid != peerCid || !TokenPeerAddressMatches(peerAddress, tokenMeta)) {
+        return false;
+    }
+
+    const uint64_t nowSec = time::RealtimeMs() / 1000;
+    return nowSec >= tokenMeta.timestamp
+        && (nowSec - tokenMeta.timestamp) <= std::max<uint32_t>(m_config.retry_token_lifetime, 1);
+}
+
+Status ContextImpl::sendRetry(const Address &peerAddress, uint32_t peerCid)
+{
+    FrameRetryToken retry;
+    if (!buildRetryToken(peerAddress, peerCid, retry.token)) {
+        return Status::ErrorLiteral(UTP_ERR_CRYPTO_ENCRYPTION, "build retry token failed");
+    }
+
+    std::array<uint8_t, FRAME_RETRY_TOKEN_HDR_SIZE + TOKEN_SIZE> payload{};
+    Status st;
+    const int32_t frameLen = retry.encode(payload.data(), payload.size(), st);
+    if (!st.ok()) {
+        return st;
+    }
+
+    // 本端不分配 CID 也不保留任何状态, scid 置 0
+    PendingIncomingConnection retryCtx;
+    retryCtx.localCid = 0;
+    retryCtx.peerCid = peerCid;
+    retryCtx.peerAddress = peerAddress;
+    return sendPendingPacket(retryCtx, UTP_TYPE_RETRY, payload.data(), static_cast<size_t>(frameLen));
+}
+
+Context::Statistic ContextImpl::statistic() const
+{
+    Context::Statistic stat = m_stat;
+    stat.gso_batches = m_udpSocket.gsoBatches();
+    stat.gso_segments = m_udpSocket.gsoSegments();
+    stat.gro_batches = m_udpSocket.groBatches();
+    stat.gro_segments = m_udpSocket.groSegments();
+    if (m_sharedMm) {
+        stat.mem_pool_bytes_inuse = m_sharedMm->bytes_inuse;
+        stat.mem_pool_bytes_cached = m_sharedMm->bytesCached();
+        stat.mem_quota_rejected = m_sharedMm->quota_rejected;
+    }
+    if (stat.gso_batches > 0) {
+        stat.gso_avg_segments_per_batch = static_cast<double>(stat.gso_segments) / static_cast<double>(stat.gso_batches);
+    }
+    stat.zero_rtt_replay_fp_rate = m_zeroRttReplayFilter.falsePositiveRate();
+    stat.keypair_pool_hits = m_keyPool.hits();
+    stat.keypair_pool_misses = m_keyPool.misses();
+    return stat;
+}
+
 void ContextImpl::notePathValidationStarted()
 {
     ++m_stat.path_validation_started;
@@ -1216,21 +1362,6 @@ void ContextImpl::noteZeroRttInvalidTicketRejected()
     ++m_stat.zero_rtt_invalid_ticket_rejected;
 }
 
-void ContextImpl::purgeZeroRttReplayCache(uint64_t nowMs)
-{
-    if (m_zeroRttReplayCache.empty()) {
-        return;
-    }
-
-    for (auto it = m_zeroRttReplayCache.begin(); it != m_zeroRttReplayCache.end();) {
-        if (it->second <= nowMs) {
-            it = m_zeroRttReplayCache.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
-
 bool ContextImpl::rememberZeroRttNonce(uint32_t ticketCid, uint64_t nonce, uint64_t nowMs)
 {
     if (ticketCid == 0) {
@@ -1241,28 +1372,27 @@ bool ContextImpl::rememberZeroRttNonce(uint32_t ticketCid, uint64_t nonce, uint6
         nowMs = time::RealtimeMs();
     }
 
-    purgeZeroRttReplayCache(nowMs);
-
-    ZeroRttReplayKey key;
-    key.ticketCid = ticketCid;
-    key.nonce = nonce;
-
-    auto it = m_zeroRttReplayCache.find(key);
-    if (it != m_zeroRttReplayCache.end()) {
-        return false;
+    if (!m_zeroRttReplayFilter.allocated()) {
+        // 每个过滤器覆盖一个重放窗口, 容量按窗口内预期的 0-RTT 数量计算
+        const uint32_t replayWindowS = std::max<uint32_t>(m_config.zero_rtt_replay_window, 1);
+        const uint32_t rate = std::max<uint32_t>(m_config.zero_rtt_replay_filter_rate, 1);
+        m_zeroRttReplayFilter.reset(static_cast<uint64_t>(replayWindowS) * 1000ULL,
+                                    static_cast<size_t>(replayWindowS) * rate,
+                                    rng()());
     }
 
-    const uint32_t replayWindowS = std::max<uint32_t>(m_config.zero_rtt_replay_window, 1);
-    const uint64_t expireAtMs = nowMs + static_cast<uint64_t>(replayWindowS) * 1000ULL;
-    m_zeroRttReplayCache.emplace(key, expireAtMs);
-    return true;
+    return m_zeroRttReplayFilter.checkAndInsert(ticketCid, nonce, nowMs);
 }
 
 bool ContextImpl::allocLocalCid(uint32_t &cid)
 {
     constexpr int32_t kMaxTry = 8;
     for (int32_t i = 0; i < kMaxTry; ++i) {
-        const uint32_t candidate = Random<uint32_t>(1, UINT32_MAX);
+        uint32_t candidate = Random<uint32_t>(1, UINT32_MAX);
+        if (m_shardCount > 1) {
+            // NOTE 分片模式下 CID 高 8 位为分片序号, 供 reuseport cBPF 与转发回退定位所属分片
+            candidate = (m_shardIndex << kShardCidShift) | Random<uint32_t>(1, kShardCidLowMask);
+        }
         if (candidate == 0) {
             continue;
         }
@@ -1280,6 +1410,53 @@ bool ContextImpl::allocLocalCid(uint32_t &cid)
     return false;
 }
 
+uint32_t ContextImpl::ShardOfPacket(uint32_t scid, uint32_t dcid, uint32_t shardCount)
+{
+    if (shardCount <= 1) {
+        return 0;
+    }
+
+    // 客户端首包(INITIAL/0-RTT)尚不知道对端 CID, 按源 CID 散列; 其余按目的 CID 高位的分片序号
+    if (dcid == 0) {
+        return scid % shardCount;
+    }
+    return (dcid >> kShardCidShift) % shardCount;
+}
+
+void ContextImpl::setShard(uint32_t index, uint32_t count, const ShardForwarder &forwarder)
+{
+    m_shardCount = std::max<uint32_t>(std::min<uint32_t>(count, kMaxShards), 1);
+    m_shardIndex = index < m_shardCount ? index : 0;
+    m_shardForwarder = forwarder;
+}
+
+void ContextImpl::onForwardedPackets(const UdpSocket::MsgMetaInfo *msgs, size_t count)
+{
+    processIncomingPackets(msgs, count, true);
+}
+
+bool ContextImpl::forwardToOwnerShard(uint32_t scid, uint32_t dcid, const UdpSocket::MsgMetaInfo &msg)
+{
+    if (m_shardCount <= 1 || !m_shardForwarder) {
+        return false;
+    }
+    if (dcid != 0 && m_pendingIncoming.find(dcid) != m_pendingIncoming.end()) {
+        return false;
+    }
+
+    const uint32_t owner = ShardOfPacket(scid, dcid, m_shardCount);
+    if (owner == m_shardIndex) {
+        return false;
+    }
+
+    if (m_shardForwarder(owner, msg)) {
+        ++m_stat.reuseport_forwarded;
+    } else {
+        ++m_stat.reuseport_forward_dropped;
+    }
+    return true;
+}
+
 void ContextImpl::removePendingIncoming(uint32_t localCid)
 {
     auto it = m_pendingIncoming.find(localCid);
@@ -1412,8 +1589,26 @@ void ContextImpl::onPendingHandshakeTimeout()
     refreshPendingHandshakeTimer();
 }
 
+void ContextImpl::drainSocketErrorQueue()
+{
+    // NOTE 错误队列的就绪以 EPOLLERR 通知, 与读事件共用回调
+    while (true) {
+        UdpSocket::ErrorMsg errMsg;
+        Status errStatus;
+        if (m_udpSocket.recvErrorMsg(errMsg, errStatus) <= 0) {
+            break;
+        }
+        m_stat.zerocopy_completed += errMsg.zc_completed;
+        m_stat.zerocopy_copied += errMsg.zc_copied;
+    }
+}
+
 void ContextImpl::onReadEvent()
 {
+    if (m_udpSocket.zeroCopyEnabled()) {
+        drainSocketErrorQueue();
+    }
+
     processPendingHandshakeTimeouts();
     refreshPendingHandshakeTimer();
 
@@ -1424,544 +1619,630 @@ void ContextImpl::onReadEvent()
             return;
         }
 
-        const utp_time_t nowUs = time::MonotonicUs();
-        for (int32_t i = 0; i < nread; ++i) {
-            const UdpSocket::MsgMetaInfo &msg = m_recvMsgScratch[static_cast<size_t>(i)];
-            if (msg.data == nullptr || msg.len < UTP_HEADER_SIZE) {
-                continue;
-            }
+        processIncomingPackets(m_recvMsgScratch.data(), static_cast<size_t>(nread), false);
+    }
+}
 
-            const uint8_t *offset = static_cast<const uint8_t *>(msg.data);
-            size_t left = msg.len;
-            uint32_t scid = 0;
-            uint32_t dcid = 0;
-            offset = eular::Serialize::DeserializeFrom(offset, left, scid);
-            if (offset == nullptr) {
-                continue;
-            }
+void ContextImpl::flushRecvBatch(utp_time_t nowUs)
+{
+    if (m_recvBatchConns.empty()) {
+        return;
+    }
 
-            offset = eular::Serialize::DeserializeFrom(offset, left, dcid);
-            if (offset == nullptr) {
-                continue;
-            }
+    std::vector<ConnectionImpl::SP> conns;
+    conns.swap(m_recvBatchConns);
+    for (const ConnectionImpl::SP &conn : conns) {
+        conn->flushStagedUdpPackets(nowUs);
+        handleConnectionState(conn.get());
+    }
+    conns.clear();
+    if (m_recvBatchConns.empty()) {
+        m_recvBatchConns.swap(conns);
+    }
+}
 
-            uint64_t pn = 0;
-            uint16_t payloadLen = 0;
-            uint8_t packetType = UTP_TYPE_NONE;
-            uint8_t reserve = 0;
-            offset = eular::Serialize::DeserializeFrom(offset, left, pn);
-            if (offset == nullptr) {
-                continue;
-            }
-            offset = eular::Serialize::DeserializeFrom(offset, left, payloadLen);
-            if (offset == nullptr) {
-                continue;
-            }
-            offset = eular::Serialize::DeserializeFrom(offset, left, packetType);
-            if (offset == nullptr) {
-                continue;
-            }
-            offset = eular::Serialize::DeserializeFrom(offset, left, reserve);
-            if (offset == nullptr) {
-                continue;
-            }
+void ContextImpl::processIncomingPackets(const UdpSocket::MsgMetaInfo *msgs, size_t count, bool forwarded)
+{
+    const utp_time_t nowUs = time::MonotonicUs();
+    ConnectionImpl::SP lastConn;
+    uint32_t lastDcid = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const UdpSocket::MsgMetaInfo &msg = msgs[i];
+        if (msg.data == nullptr || msg.len < UTP_HEADER_SIZE) {
+            continue;
+        }
 
-            auto it = m_connections.find(dcid);
-            if (it != m_connections.end()) {
-                it->second->onUdpPacket(msg, nowUs);
+        const uint8_t *offset = static_cast<const uint8_t *>(msg.data);
+        size_t left = msg.len;
+        uint32_t scid = 0;
+        uint32_t dcid = 0;
+        offset = eular::Serialize::DeserializeFrom(offset, left, scid);
+        if (offset == nullptr) {
+            continue;
+        }
 
-                handleConnectionState(it->second.get());
-                continue;
-            }
+        offset = eular::Serialize::DeserializeFrom(offset, left, dcid);
+        if (offset == nullptr) {
+            continue;
+        }
 
-            if (packetType == UTP_TYPE_0RTT) {
-                auto existingZeroRttConn = std::find_if(m_connections.begin(),
-                                                        m_connections.end(),
-                                                        [&] (const ConnectionMap::value_type &entry) {
-                                                            if (!entry.second) {
-                                                                return false;
-                                                            }
-                                                            const Connection::Description desc = entry.second->description();
-                                                            const Context::ConnectInfo &peerInfo = entry.second->connectInfo();
-                                                            return desc.dcid == scid
-                                                                && peerInfo.port == msg.metaInfo.peerAddress.port()
-                                                                && peerInfo.ip == msg.metaInfo.peerAddress.toIpString();
-                                                        });
-                if (existingZeroRttConn != m_connections.end()) {
-                    existingZeroRttConn->second->onUdpPacket(msg);
-                    handleConnectionState(existingZeroRttConn->second.get());
-                    continue;
+        uint64_t pn = 0;
+        uint16_t payloadLen = 0;
+        uint8_t packetType = UTP_TYPE_NONE;
+        uint8_t reserve = 0;
+        offset = eular::Serialize::DeserializeFrom(offset, left, pn);
+        if (offset == nullptr) {
+            continue;
+        }
+        offset = eular::Serialize::DeserializeFrom(offset, left, payloadLen);
+        if (offset == nullptr) {
+            continue;
+        }
+        offset = eular::Serialize::DeserializeFrom(offset, left, packetType);
+        if (offset == nullptr) {
+            continue;
+        }
+        offset = eular::Serialize::DeserializeFrom(offset, left, reserve);
+        if (offset == nullptr) {
+            continue;
+        }
+
+        // NOTE 阶段一: 已建立连接的数据报按 CID 归类, 同一对端的连续数据报只查一次表;
+        //      握手类数据报可能改变密钥或连接状态, 仍逐个按序处理
+        const bool handshakeClass = packetType == UTP_TYPE_INITIAL || packetType == UTP_TYPE_HANDSHAKE ||
+                                    packetType == UTP_TYPE_0RTT || packetType == UTP_TYPE_RETRY;
+        if (!handshakeClass) {
+            if (!lastConn || dcid != lastDcid) {
+                auto it = m_connections.find(dcid);
+                lastConn = (it != m_connections.end()) ? it->second : nullptr;
+                lastDcid = dcid;
+            }
+            if (lastConn) {
+                if (lastConn->stageUdpPacket(msg)) {
+                    m_recvBatchConns.push_back(lastConn);
                 }
+                continue;
             }
+        }
 
-            auto pendingIt = m_pendingIncoming.find(dcid);
-            UTP_LOGD_FMT("{} received packet with dcid {}, scid {}, pn {}, type {}, pending handshake: {}",
-                      tag(), dcid, scid, pn, packetType, (pendingIt != m_pendingIncoming.end() ? pendingIt->second.handshakeSent : false));
-            if (pendingIt != m_pendingIncoming.end() && pendingIt->second.handshakeSent) {
-                auto packetReleaser = [this] (PacketIn *pkt) {
-                    m_mm.releasePacketIn(pkt);
-                };
-                std::unique_ptr<PacketIn, decltype(packetReleaser)> pendingPacket(
-                    m_mm.getPacketIn(static_cast<uint32_t>(msg.len)), packetReleaser);
-                if (!pendingPacket) {
-                    continue;
-                }
-                bool handshakeDone = false;
-                bool decodeOk = decodeIncomingPendingPacket(msg, pendingIt->second, *pendingPacket);
-                if (decodeOk) {
-                    size_t frameOffset = 0;
-                    while (frameOffset < pendingPacket->payload_size) {
-                        FrameType frameType = kFrameInvalid;
-                        const uint8_t *frameData = nullptr;
-                        size_t frameLen = 0;
-                        Status nextSt;
-                        if (pendingPacket->nextFrame(frameOffset, frameType, frameData, frameLen, nextSt) < 0) {
-                            break;
-                        }
+        // 慢路径可能依赖之前数据报的处理结果, 也可能改动连接表
+        flushRecvBatch(nowUs);
+        lastConn.reset();
 
-                        parsePendingNegotiationFrame(pendingIt->second,
-                                                     static_cast<uint8_t>(frameType),
-                                                     frameData,
-                                                     frameLen);
-
-                        if (frameType == kFrameHandshakeDone) {
-                            FrameHandshakeDone done;
-                            Status st;
-                            done.decode(frameData, frameLen, st);
-                            if (st.ok()
-                                && done.ack_handshake_pn == pendingIt->second.lastHandshakePacketNo) {
-                                handshakeDone = true;
-                            }
-                            break;
-                        }
-                    }
-                }
-                UTP_LOGD_FMT("{} pending packet decode {}, handshake done: {}", tag(), (decodeOk ? "succeeded" : "failed"), handshakeDone);
-
-                if (!handshakeDone) {
-                    if (decodeOk
-                        && msg.data != nullptr
-                        && msg.len >= UTP_HEADER_SIZE
-                        && pendingIt->second.bufferedBeforeHandshakeDone.size() < PendingPreHandshakeBufferMaxPackets(m_config)
-                        && (pendingIt->second.bufferedBeforeHandshakeDoneBytes + static_cast<size_t>(msg.len)) <= PendingPreHandshakeBufferMaxBytes(m_config)) {
-                        const size_t packetLen = static_cast<size_t>(msg.len);
-                        const size_t packetOffset = pendingIt->second.bufferedBeforeHandshakeDoneStorage.size();
-                        pendingIt->second.bufferedBeforeHandshakeDoneStorage.resize(packetOffset + packetLen);
-                        std::memcpy(pendingIt->second.bufferedBeforeHandshakeDoneStorage.data() + packetOffset,
-                                    msg.data,
-                                    packetLen);
-                        pendingIt->second.bufferedBeforeHandshakeDoneBytes += static_cast<size_t>(msg.len);
-                        PendingIncomingConnection::BufferedPendingPacket cached;
-                        cached.offset = static_cast<uint32_t>(packetOffset);
-                        cached.len = static_cast<uint32_t>(packetLen);
-                        pendingIt->second.bufferedBeforeHandshakeDone.emplace_back(cached);
-                    }
-                    continue;
-                }
+        auto it = m_connections.find(dcid);
+        if (it != m_connections.end()) {
+            it->second->onUdpPacket(msg, nowUs);
 
-                PendingIncomingConnection pending = std::move(pendingIt->second);
-
-                Context::ConnectInfo info;
-                info.ip = pending.peerIp;
-                info.port = pending.peerAddress.port();
-                info.timeout = m_config.handshake_timeout;
-                info.encrypted = pending.encrypted;
-
-                ConnectionImpl::SP conn = createAndInsertPassiveConnection(
-                    pending.localCid,
-                    info,
-                    pending.peerAddress,
-                    pending.peerCid,
-                    pending.peerTp,
-                    pending.hasPeerAckFrequency ? &pending.peerAckFrequency : nullptr,
-                    pending.x25519,
-                    pending.aesCtx,
-                    "local cid collision while promoting passive connection");
-                if (!conn) {
-                    continue;
-                }
+            handleConnectionState(it->second.get());
+            continue;
+        }
 
-                removePendingIncoming(dcid);
-                if (m_onConnected) {
-                    m_onConnected(conn);
-                }
-                replayBufferedPendingPackets(conn.get(),
-                                             pending.bufferedBeforeHandshakeDone,
-                                             pending.bufferedBeforeHandshakeDoneStorage,
-                                             msg);
-                conn->onUdpPacket(msg);
+        // NOTE reuseport 分片下未命中本地连接的数据报可能被内核分发错了分片, 交给 CID 所属分片处理
+        if (!forwarded && forwardToOwnerShard(scid, dcid, msg)) {
+            continue;
+        }
+
+        if (packetType == UTP_TYPE_0RTT) {
+            auto existingZeroRttConn = std::find_if(m_connections.begin(),
+                                                    m_connections.end(),
+                                                    [&] (const ConnectionMap::value_type &entry) {
+                                                        if (!entry.second) {
+                                                            return false;
+                                                        }
+                                                        const Connection::Description desc = entry.second->description();
+                                                        const Context::ConnectInfo &peerInfo = entry.second->connectInfo();
+                                                        return desc.dcid == scid
+                                                            && peerInfo.port == msg.metaInfo.peerAddress.port()
+                                                            && peerInfo.ip == msg.metaInfo.peerAddress.toIpString();
+                                                    });
+            if (existingZeroRttConn != m_connections.end()) {
+                existingZeroRttConn->second->onUdpPacket(msg);
+                handleConnectionState(existingZeroRttConn->second.get());
                 continue;
             }
+        }
 
-            if (packetType == UTP_TYPE_0RTT) {
-                auto packetReleaser = [this] (PacketIn *pkt) {
-                    m_mm.releasePacketIn(pkt);
-                };
-                std::unique_ptr<PacketIn, decltype(packetReleaser)> packet(
-                    m_mm.getPacketIn(static_cast<uint32_t>(msg.len)), packetReleaser);
-                if (!packet) {
-                    continue;
-                }
-                if (!detail::DecodeUdpPacketWithOptionalAead(msg, m_mm, nullptr, *packet)) {
-                    continue;
-                }
-
-                FrameSessionToken sessionToken;
-                bool hasSessionToken = false;
+        auto pendingIt = m_pendingIncoming.find(dcid);
+        UTP_LOGD_FMT("{} received packet with dcid {}, scid {}, pn {}, type {}, pending handshake: {}",
+                  tag(), dcid, scid, pn, packetType, (pendingIt != m_pendingIncoming.end() ? pendingIt->second.handshakeSent : false));
+        if (pendingIt != m_pendingIncoming.end() && pendingIt->second.handshakeSent) {
+            auto packetReleaser = [this] (PacketIn *pkt) {
+                m_mm.releasePacketIn(pkt);
+            };
+            std::unique_ptr<PacketIn, decltype(packetReleaser)> pendingPacket(
+                m_mm.getPacketIn(static_cast<uint32_t>(msg.len)), packetReleaser);
+            if (!pendingPacket) {
+                continue;
+            }
+            bool handshakeDone = false;
+            bool decodeOk = decodeIncomingPendingPacket(msg, pendingIt->second, *pendingPacket);
+            if (decodeOk) {
                 size_t frameOffset = 0;
-                while (frameOffset < packet->payload_size) {
+                while (frameOffset < pendingPacket->payload_size) {
                     FrameType frameType = kFrameInvalid;
                     const uint8_t *frameData = nullptr;
                     size_t frameLen = 0;
                     Status nextSt;
-                    if (packet->nextFrame(frameOffset, frameType, frameData, frameLen, nextSt) < 0) {
+                    if (pendingPacket->nextFrame(frameOffset, frameType, frameData, frameLen, nextSt) < 0) {
                         break;
                     }
-                    if (frameType == kFrameSessionToken) {
+
+                    parsePendingNegotiationFrame(pendingIt->second,
+                                                 static_cast<uint8_t>(frameType),
+                                                 frameData,
+                                                 frameLen);
+
+                    if (frameType == kFrameHandshakeDone) {
+                        FrameHandshakeDone done;
                         Status st;
-                        sessionToken.decode(frameData, frameLen, st);
-                        if (st.ok()) {
-                            hasSessionToken = true;
+                        done.decode(frameData, frameLen, st);
+                        if (st.ok()
+                            && done.ack_handshake_pn == pendingIt->second.lastHandshakePacketNo) {
+                            handshakeDone = true;
                         }
                         break;
                     }
                 }
-
-                if (!hasSessionToken) {
-                    continue;
+            }
+            UTP_LOGD_FMT("{} pending packet decode {}, handshake done: {}", tag(), (decodeOk ? "succeeded" : "failed"), handshakeDone);
+
+            if (!handshakeDone) {
+                if (decodeOk
+                    && msg.data != nullptr
+                    && msg.len >= UTP_HEADER_SIZE
+                    && pendingIt->second.bufferedBeforeHandshakeDone.size() < PendingPreHandshakeBufferMaxPackets(m_config)
+                    && (pendingIt->second.bufferedBeforeHandshakeDoneBytes + static_cast<size_t>(msg.len)) <= PendingPreHandshakeBufferMaxBytes(m_config)) {
+                    const size_t packetLen = static_cast<size_t>(msg.len);
+                    const size_t packetOffset = pendingIt->second.bufferedBeforeHandshakeDoneStorage.size();
+                    pendingIt->second.bufferedBeforeHandshakeDoneStorage.resize(packetOffset + packetLen);
+                    std::memcpy(pendingIt->second.bufferedBeforeHandshakeDoneStorage.data() + packetOffset,
+                                msg.data,
+                                packetLen);
+                    pendingIt->second.bufferedBeforeHandshakeDoneBytes += static_cast<size_t>(msg.len);
+                    PendingIncomingConnection::BufferedPendingPacket cached;
+                    cached.offset = static_cast<uint32_t>(packetOffset);
+                    cached.len = static_cast<uint32_t>(packetLen);
+                    pendingIt->second.bufferedBeforeHandshakeDone.emplace_back(cached);
                 }
+                continue;
+            }
 
-                ++m_stat.zero_rtt_offered;
+            PendingIncomingConnection pending = std::move(pendingIt->second);
 
-                uint32_t ticketCid = 0;
-                Context::EncryptionMode ticketEncryptionMode = Context::kEncryptionNone;
-                if (!validateZeroRttTicket(msg.metaInfo.peerAddress,
-                                           sessionToken.token,
-                                           sessionToken.token_validity_period,
-                                           ticketCid,
-                                           ticketEncryptionMode)) {
-                    PendingIncomingConnection decision;
-                    decision.localCid = 0;
-                    decision.peerAddress = msg.metaInfo.peerAddress;
-                    decision.peerIp = msg.metaInfo.peerAddress.toIpString();
-                    decision.peerCid = scid;
-                    decision.zeroRttAccepted = false;
-                    ++m_stat.zero_rtt_rejected;
-                    noteZeroRttInvalidTicketRejected();
-                    reportZeroRttDecision(decision, false, "invalid_ticket");
-                    (void)sendPendingConnectionClose(decision, UTP_ERR_INVALID_PARAM, "invalid_ticket");
-                    continue;
-                }
+            Context::ConnectInfo info;
+            info.ip = pending.peerIp;
+            info.port = pending.peerAddress.port();
+            info.timeout = m_config.handshake_timeout;
+            info.encrypted = pending.encrypted;
 
-                if (!rememberZeroRttNonce(ticketCid, pn)) {
-                    PendingIncomingConnection decision;
-                    decision.localCid = 0;
-                    decision.peerAddress = msg.metaInfo.peerAddress;
-                    decision.peerIp = msg.metaInfo.peerAddress.toIpString();
-                    decision.peerCid = scid;
-                    decision.zeroRttAccepted = false;
-                    ++m_stat.zero_rtt_rejected;
-                    ++m_stat.zero_rtt_replay_rejected;
-                    reportZeroRttDecision(decision, false, "replay");
-                    (void)sendPendingConnectionClose(decision, UTP_ERR_CANCELLED, "replay");
-                    continue;
+            ConnectionImpl::SP conn = createAndInsertPassiveConnection(
+                pending.localCid,
+                info,
+                pending.peerAddress,
+                pending.peerCid,
+                pending.peerTp,
+                pending.hasPeerAckFrequency ? &pending.peerAckFrequency : nullptr,
+                pending.x25519,
+                pending.aesCtx,
+                "local cid collision while promoting passive connection");
+            if (!conn) {
+                continue;
+            }
+
+            removePendingIncoming(dcid);
+            if (m_onConnected) {
+                m_onConnected(conn);
+            }
+            replayBufferedPendingPackets(conn.get(),
+                                         pending.bufferedBeforeHandshakeDone,
+                                         pending.bufferedBeforeHandshakeDoneStorage,
+                                         msg);
+            conn->onUdpPacket(msg);
+            continue;
+        }
+
+        if (packetType == UTP_TYPE_0RTT) {
+            auto packetReleaser = [this] (PacketIn *pkt) {
+                m_mm.releasePacketIn(pkt);
+            };
+            std::unique_ptr<PacketIn, decltype(packetReleaser)> packet(
+                m_mm.getPacketIn(static_cast<uint32_t>(msg.len)), packetReleaser);
+            if (!packet) {
+                continue;
+            }
+            if (!detail::DecodeUdpPacketWithOptionalAead(msg, m_mm, nullptr, *packet)) {
+                continue;
+            }
+
+            FrameSessionToken sessionToken;
+            bool hasSessionToken = false;
+            size_t frameOffset = 0;
+            while (frameOffset < packet->payload_size) {
+                FrameType frameType = kFrameInvalid;
+                const uint8_t *frameData = nullptr;
+                size_t frameLen = 0;
+                Status nextSt;
+                if (packet->nextFrame(frameOffset, frameType, frameData, frameLen, nextSt) < 0) {
+                    break;
+                }
+                if (frameType == kFrameSessionToken) {
+                    Status st;
+                    sessionToken.decode(frameData, frameLen, st);
+                    if (st.ok()) {
+                        hasSessionToken = true;
+                    }
+                    break;
                 }
+            }
+
+            if (!hasSessionToken) {
+                continue;
+            }
+
+            ++m_stat.zero_rtt_offered;
 
+            uint32_t ticketCid = 0;
+            Context::EncryptionMode ticketEncryptionMode = Context::kEncryptionNone;
+            if (!validateZeroRttTicket(msg.metaInfo.peerAddress,
+                                       sessionToken.token,
+                                       sessionToken.token_validity_period,
+                                       ticketCid,
+                                       ticketEncryptionMode)) {
                 PendingIncomingConnection decision;
                 decision.localCid = 0;
                 decision.peerAddress = msg.metaInfo.peerAddress;
                 decision.peerIp = msg.metaInfo.peerAddress.toIpString();
                 decision.peerCid = scid;
-                decision.zeroRttAccepted = true;
-                ++m_stat.zero_rtt_accepted;
-                reportZeroRttDecision(decision, true, "accepted");
-
-                Context::NewConnectionInfo newInfo;
-                newInfo.remote_ip = msg.metaInfo.peerAddress.toIpString();
-                newInfo.remote_port = msg.metaInfo.peerAddress.port();
-                newInfo.local_cid = 0;
-                newInfo.peer_cid = scid;
-                newInfo.encrypted = ticketEncryptionMode;
-
-                bool accepted = true;
-                if (m_onNewConnection) {
-                    accepted = m_onNewConnection(newInfo);
-                }
-                if (!accepted) {
-                    PendingIncomingConnection decision;
-                    decision.localCid = 0;
-                    decision.peerAddress = msg.metaInfo.peerAddress;
-                    decision.peerIp = msg.metaInfo.peerAddress.toIpString();
-                    decision.peerCid = scid;
-                    (void)sendPendingConnectionClose(decision, UTP_ERR_CANCELLED, "connection rejected");
-                    continue;
-                }
-
-                uint32_t localCid = 0;
-                if (!allocLocalCid(localCid)) {
-                    continue;
-                }
-
-                Context::ConnectInfo info;
-                info.ip = newInfo.remote_ip;
-                info.port = newInfo.remote_port;
-                info.timeout = m_config.handshake_timeout;
-                info.encrypted = ticketEncryptionMode;
-
-                ConnectionImpl::SP conn = createAndInsertPassiveConnection(
-                    localCid,
-                    info,
-                    msg.metaInfo.peerAddress,
-                    scid,
-                    TransportParams{},
-                    nullptr,
-                    nullptr,
-                    nullptr,
-                    "local cid collision while creating 0-rtt connection",
-                    static_cast<uint32_t>(sessionToken.token.size()));
-                if (!conn) {
-                    continue;
-                }
-
-                PendingIncomingConnection sendCtx;
-                sendCtx.localCid = localCid;
-                sendCtx.peerCid = scid;
-                sendCtx.peerAddress = msg.metaInfo.peerAddress;
-                sendCtx.peerIp = msg.metaInfo.peerAddress.toIpString();
-                sendCtx.initialReceivedUs = time::MonotonicUs();
-                sendCtx.encrypted = ticketEncryptionMode;
-                (void)sendPendingHandshake(sendCtx);
-
-                if (m_onConnected) {
-                    m_onConnected(conn);
-                }
-                conn->onUdpPacket(msg);
+                decision.zeroRttAccepted = false;
+                ++m_stat.zero_rtt_rejected;
+                noteZeroRttInvalidTicketRejected();
+                reportZeroRttDecision(decision, false, "invalid_ticket");
+                (void)sendPendingConnectionClose(decision, UTP_ERR_INVALID_PARAM, "invalid_ticket");
                 continue;
             }
 
-            if (packetType != UTP_TYPE_INITIAL) {
+            if (!rememberZeroRttNonce(ticketCid, pn)) {
+                PendingIncomingConnection decision;
+                decision.localCid = 0;
+                decision.peerAddress = msg.metaInfo.peerAddress;
+                decision.peerIp = msg.metaInfo.peerAddress.toIpString();
+                decision.peerCid = scid;
+                decision.zeroRttAccepted = false;
+                ++m_stat.zero_rtt_rejected;
+                ++m_stat.zero_rtt_replay_rejected;
+                reportZeroRttDecision(decision, false, "replay");
+                (void)sendPendingConnectionClose(decision, UTP_ERR_CANCELLED, "replay");
                 continue;
             }
 
-            const std::string peerIp = msg.metaInfo.peerAddress.toIpString();
-            const uint16_t peerPort = msg.metaInfo.peerAddress.port();
-            bool knownPeerConnection = false;
-            for (const auto &entry : m_connections) {
-                if (!entry.second) {
-                    continue;
-                }
+            PendingIncomingConnection decision;
+            decision.localCid = 0;
+            decision.peerAddress = msg.metaInfo.peerAddress;
+            decision.peerIp = msg.metaInfo.peerAddress.toIpString();
+            decision.peerCid = scid;
+            decision.zeroRttAccepted = true;
+            ++m_stat.zero_rtt_accepted;
+            reportZeroRttDecision(decision, true, "accepted");
+
+            Context::NewConnectionInfo newInfo;
+            newInfo.remote_ip = msg.metaInfo.peerAddress.toIpString();
+            newInfo.remote_port = msg.metaInfo.peerAddress.port();
+            newInfo.local_cid = 0;
+            newInfo.peer_cid = scid;
+            newInfo.encrypted = ticketEncryptionMode;
 
-                const Connection::Description desc = entry.second->description();
-                const Context::ConnectInfo &peerInfo = entry.second->connectInfo();
-                if (desc.dcid == scid
-                    && peerInfo.port == peerPort
-                    && peerInfo.ip == peerIp) {
-                    knownPeerConnection = true;
-                    break;
-                }
+            bool accepted = true;
+            if (m_onNewConnection) {
+                accepted = m_onNewConnection(newInfo);
             }
-            if (knownPeerConnection) {
+            if (!accepted) {
+                PendingIncomingConnection decision;
+                decision.localCid = 0;
+                decision.peerAddress = msg.metaInfo.peerAddress;
+                decision.peerIp = msg.metaInfo.peerAddress.toIpString();
+                decision.peerCid = scid;
+                (void)sendPendingConnectionClose(decision, UTP_ERR_CANCELLED, "connection rejected");
                 continue;
             }
 
-            PeerIndexKey key;
-            key.peerAddress = msg.metaInfo.peerAddress;
-            key.peerCid = scid;
-            if (m_pendingIncomingPeerIndex.find(key) != m_pendingIncomingPeerIndex.end()) {
+            uint32_t localCid = 0;
+            if (!allocLocalCid(localCid)) {
                 continue;
             }
 
-            PacketIn initialPacket;
-            if (!initialPacket.decode(msg.data, msg.len).ok()) {
+            Context::ConnectInfo info;
+            info.ip = newInfo.remote_ip;
+            info.port = newInfo.remote_port;
+            info.timeout = m_config.handshake_timeout;
+            info.encrypted = ticketEncryptionMode;
+
+            ConnectionImpl::SP conn = createAndInsertPassiveConnection(
+                localCid,
+                info,
+                msg.metaInfo.peerAddress,
+                scid,
+                TransportParams{},
+                nullptr,
+                nullptr,
+                nullptr,
+                "local cid collision while creating 0-rtt connection",
+                static_cast<uint32_t>(sessionToken.token.size()));
+            if (!conn) {
                 continue;
             }
 
-            uint32_t localCid = 0;
-            if (!allocLocalCid(localCid)) {
+            PendingIncomingConnection sendCtx;
+            sendCtx.localCid = localCid;
+            sendCtx.peerCid = scid;
+            sendCtx.peerAddress = msg.metaInfo.peerAddress;
+            sendCtx.peerIp = msg.metaInfo.peerAddress.toIpString();
+            sendCtx.initialReceivedUs = time::MonotonicUs();
+            sendCtx.encrypted = ticketEncryptionMode;
+            (void)sendPendingHandshake(sendCtx);
+
+            if (m_onConnected) {
+                m_onConnected(conn);
+            }
+            conn->onUdpPacket(msg);
+            continue;
+        }
+
+        if (packetType != UTP_TYPE_INITIAL) {
+            continue;
+        }
+
+        const std::string peerIp = msg.metaInfo.peerAddress.toIpString();
+        const uint16_t peerPort = msg.metaInfo.peerAddress.port();
+        bool knownPeerConnection = false;
+        for (const auto &entry : m_connections) {
+            if (!entry.second) {
                 continue;
             }
 
-            PendingIncomingConnection pending;
-            pending.localCid = localCid;
-            pending.peerCid = scid;
-            pending.peerAddress = msg.metaInfo.peerAddress;
-            pending.peerIp = msg.metaInfo.peerAddress.toIpString();
-            pending.initialReceivedUs = time::MonotonicUs();
-            pending.encrypted = initialPacket.hasFrame(kFrameCrypto)
-                             ? Context::kEncryptionAesGcm128
-                             : Context::kEncryptionNone;
-            pending.bufferedBeforeHandshakeDone.reserve(PendingPreHandshakeBufferMaxPackets(m_config));
-            pending.bufferedBeforeHandshakeDoneStorage.reserve(PendingPreHandshakeBufferMaxBytes(m_config));
+            const Connection::Description desc = entry.second->description();
+            const Context::ConnectInfo &peerInfo = entry.second->connectInfo();
+            if (desc.dcid == scid
+                && peerInfo.port == peerPort
+                && peerInfo.ip == peerIp) {
+                knownPeerConnection = true;
+                break;
+            }
+        }
+        if (knownPeerConnection) {
+            continue;
+        }
 
-            size_t frameOffset = 0;
-            while (frameOffset < initialPacket.payload_size) {
+        PeerIndexKey key;
+        key.peerAddress = msg.metaInfo.peerAddress;
+        key.peerCid = scid;
+        if (m_pendingIncomingPeerIndex.find(key) != m_pendingIncomingPeerIndex.end()) {
+            continue;
+        }
+
+        PacketIn initialPacket;
+        if (!initialPacket.decode(msg.data, msg.len).ok()) {
+            continue;
+        }
+
+        // NOTE 待完成握手过多时先做无状态地址校验: 未回显有效令牌的 INITIAL 只回 Retry,
+        //      不分配 CID、不建 pending、不触发回调, 伪造源地址的洪泛拿不到令牌
+        if (m_config.retry_pending_threshold > 0) {
+            bool addressValidated = false;
+            size_t tokenOffset = 0;
+            while (tokenOffset < initialPacket.payload_size) {
                 FrameType frameType = kFrameInvalid;
                 const uint8_t *frameData = nullptr;
                 size_t frameLen = 0;
                 Status nextSt;
-                if (initialPacket.nextFrame(frameOffset, frameType, frameData, frameLen, nextSt) < 0) {
+                if (initialPacket.nextFrame(tokenOffset, frameType, frameData, frameLen, nextSt) < 0) {
                     break;
                 }
+                if (frameType != kFrameRetryToken) {
+                    continue;
+                }
 
-                parsePendingNegotiationFrame(pending,
-                                             static_cast<uint8_t>(frameType),
-                                             frameData,
-                                             frameLen);
+                FrameRetryToken retryToken;
+                Status st;
+                retryToken.decode(frameData, frameLen, st);
+                addressValidated = st.ok() && validateRetryToken(msg.metaInfo.peerAddress, scid, retryToken.token);
+                if (addressValidated) {
+                    ++m_stat.retry_token_accepted;
+                } else {
+                    ++m_stat.retry_token_rejected;
+                }
+                break;
+            }
 
-                if (frameType == kFrameCrypto && pending.aesCtx == nullptr) {
-                    std::array<uint8_t, FRAME_CRYPTO_EPH_PUBKEY_SIZE> peerPubKey{};
-                    FrameCrypto crypto;
-                    crypto.eph_pubkey = peerPubKey.data();
-                    Status st;
-                    crypto.decode(frameData, frameLen, st);
-                    if (st.ok()) {
-                        pending.encrypted = FrameCryptoTypeToEncryptionMode(crypto.crypto_type);
-                        if (!pending.x25519) {
-                            pending.x25519 = std::make_shared<X25519Wrapper>();
-                        }
+            if (!addressValidated && retryRequired()) {
+                if (sendRetry(msg.metaInfo.peerAddress, scid).ok()) {
+                    ++m_stat.retry_sent;
+                }
+                continue;
+            }
+        }
 
-                        try {
-                            X25519Wrapper::PublicKey peerPublicKey;
-                            std::memcpy(peerPublicKey.data(), peerPubKey.data(), peerPublicKey.size());
-
-                            pending.aesCtx = std::make_shared<AesGcmContext>();
-                            const uint32_t noncePrefix = pending.localCid ^ pending.peerCid;
-                            if (!InitAesContextByCryptoType(crypto.crypto_type,
-                                                            peerPublicKey,
-                                                            pending.x25519,
-                                                            pending.aesCtx,
-                                                            noncePrefix)) {
-                                pending.aesCtx.reset();
-                            }
-                        } catch (const std::exception &) {
+        uint32_t localCid = 0;
+        if (!allocLocalCid(localCid)) {
+            continue;
+        }
+
+        PendingIncomingConnection pending;
+        pending.localCid = localCid;
+        pending.peerCid = scid;
+        pending.peerAddress = msg.metaInfo.peerAddress;
+        pending.peerIp = msg.metaInfo.peerAddress.toIpString();
+        pending.initialReceivedUs = time::MonotonicUs();
+        pending.encrypted = initialPacket.hasFrame(kFrameCrypto)
+                         ? Context::kEncryptionAesGcm128
+                         : Context::kEncryptionNone;
+        pending.bufferedBeforeHandshakeDone.reserve(PendingPreHandshakeBufferMaxPackets(m_config));
+        pending.bufferedBeforeHandshakeDoneStorage.reserve(PendingPreHandshakeBufferMaxBytes(m_config));
+
+        size_t frameOffset = 0;
+        while (frameOffset < initialPacket.payload_size) {
+            FrameType frameType = kFrameInvalid;
+            const uint8_t *frameData = nullptr;
+            size_t frameLen = 0;
+            Status nextSt;
+            if (initialPacket.nextFrame(frameOffset, frameType, frameData, frameLen, nextSt) < 0) {
+                break;
+            }
+
+            parsePendingNegotiationFrame(pending,
+                                         static_cast<uint8_t>(frameType),
+                                         frameData,
+                                         frameLen);
+
+            if (frameType == kFrameCrypto && pending.aesCtx == nullptr) {
+                std::array<uint8_t, FRAME_CRYPTO_EPH_PUBKEY_SIZE> peerPubKey{};
+                FrameCrypto crypto;
+                crypto.eph_pubkey = peerPubKey.data();
+                Status st;
+                crypto.decode(frameData, frameLen, st);
+                if (st.ok()) {
+                    pending.encrypted = FrameCryptoTypeToEncryptionMode(crypto.crypto_type);
+                    if (!pending.x25519) {
+                        pending.x25519 = acquireKeyPair();
+                    }
+
+                    try {
+                        X25519Wrapper::PublicKey peerPublicKey;
+                        std::memcpy(peerPublicKey.data(), peerPubKey.data(), peerPublicKey.size());
+
+                        pending.aesCtx = std::make_shared<AesGcmContext>();
+                        const uint32_t noncePrefix = pending.localCid ^ pending.peerCid;
+                        if (!InitAesContextByCryptoType(crypto.crypto_type,
+                                                        peerPublicKey,
+                                                        pending.x25519,
+                                                        pending.aesCtx,
+                                                        noncePrefix)) {
                             pending.aesCtx.reset();
                         }
+                    } catch (const std::exception &) {
+                        pending.aesCtx.reset();
                     }
-                    continue;
                 }
+                continue;
+            }
 
-                if (frameType == kFrameSessionToken) {
-                    FrameSessionToken sessionToken;
-                    Status st;
-                    sessionToken.decode(frameData, frameLen, st);
-                    if (!st.ok()) {
-                        continue;
-                    }
+            if (frameType == kFrameSessionToken) {
+                FrameSessionToken sessionToken;
+                Status st;
+                sessionToken.decode(frameData, frameLen, st);
+                if (!st.ok()) {
+                    continue;
+                }
 
-                    pending.zeroRttOffered = true;
-                    ++m_stat.zero_rtt_offered;
-                    Context::EncryptionMode ticketEncryptionMode = Context::kEncryptionNone;
-                    pending.zeroRttAccepted = validateZeroRttTicket(msg.metaInfo.peerAddress,
-                                                                    sessionToken.token,
-                                                                    sessionToken.token_validity_period,
-                                                                    pending.zeroRttTokenCid,
-                                                                    ticketEncryptionMode);
-                    if (pending.zeroRttAccepted) {
-                        if (pending.encrypted == Context::kEncryptionNone) {
-                            pending.encrypted = ticketEncryptionMode;
-                        } else if (pending.encrypted != ticketEncryptionMode) {
-                            pending.zeroRttAccepted = false;
-                        }
-                    }
-                    if (pending.zeroRttAccepted) {
-                        ++m_stat.zero_rtt_accepted;
-                        reportZeroRttDecision(pending, true, "accepted");
-                    } else {
-                        ++pending.zeroRttRejectedCount;
-                        ++m_stat.zero_rtt_rejected;
-                        noteZeroRttInvalidTicketRejected();
-                        reportZeroRttDecision(pending, false, "invalid_ticket");
+                pending.zeroRttOffered = true;
+                ++m_stat.zero_rtt_offered;
+                Context::EncryptionMode ticketEncryptionMode = Context::kEncryptionNone;
+                pending.zeroRttAccepted = validateZeroRttTicket(msg.metaInfo.peerAddress,
+                                                                sessionToken.token,
+                                                                sessionToken.token_validity_period,
+                                                                pending.zeroRttTokenCid,
+                                                                ticketEncryptionMode);
+                if (pending.zeroRttAccepted) {
+                    if (pending.encrypted == Context::kEncryptionNone) {
+                        pending.encrypted = ticketEncryptionMode;
+                    } else if (pending.encrypted != ticketEncryptionMode) {
+                        pending.zeroRttAccepted = false;
                     }
                 }
+                if (pending.zeroRttAccepted) {
+                    ++m_stat.zero_rtt_accepted;
+                    reportZeroRttDecision(pending, true, "accepted");
+                } else {
+                    ++pending.zeroRttRejectedCount;
+                    ++m_stat.zero_rtt_rejected;
+                    noteZeroRttInvalidTicketRejected();
+                    reportZeroRttDecision(pending, false, "invalid_ticket");
+                }
             }
+        }
 
-            m_pendingIncomingPeerIndex.emplace(key, localCid);
-            m_pendingIncoming.emplace(localCid, pending);
-            m_pendingIncomingQueue.push_back(localCid);
+        m_pendingIncomingPeerIndex.emplace(key, localCid);
+        m_pendingIncoming.emplace(localCid, pending);
+        m_pendingIncomingQueue.push_back(localCid);
 
-            Context::NewConnectionInfo info;
-            info.remote_ip = pending.peerIp;
-            info.remote_port = pending.peerAddress.port();
-            info.local_cid = pending.localCid;
-            info.peer_cid = pending.peerCid;
-            info.encrypted = pending.encrypted;
+        Context::NewConnectionInfo info;
+        info.remote_ip = pending.peerIp;
+        info.remote_port = pending.peerAddress.port();
+        info.local_cid = pending.localCid;
+        info.peer_cid = pending.peerCid;
+        info.encrypted = pending.encrypted;
 
-            bool accepted = true;
-            if (m_onNewConnection) {
-                accepted = m_onNewConnection(info);
-            }
+        bool accepted = true;
+        if (m_onNewConnection) {
+            accepted = m_onNewConnection(info);
+        }
 
-            auto queuedPendingIt = m_pendingIncoming.find(localCid);
-            const bool alreadyAccepted = queuedPendingIt != m_pendingIncoming.end()
-                                      && queuedPendingIt->second.handshakeSent;
-            if (!accepted && !alreadyAccepted) {
-                if (queuedPendingIt != m_pendingIncoming.end()) {
-                    (void)sendPendingConnectionClose(queuedPendingIt->second,
-                                                     UTP_ERR_CANCELLED,
-                                                     "connection rejected");
-                }
-                removePendingIncoming(localCid);
+        auto queuedPendingIt = m_pendingIncoming.find(localCid);
+        const bool alreadyAccepted = queuedPendingIt != m_pendingIncoming.end()
+                                  && queuedPendingIt->second.handshakeSent;
+        if (!accepted && !alreadyAccepted) {
+            if (queuedPendingIt != m_pendingIncoming.end()) {
+                (void)sendPendingConnectionClose(queuedPendingIt->second,
+                                                 UTP_ERR_CANCELLED,
+                                                 "connection rejected");
             }
+            removePendingIncoming(localCid);
         }
     }
+
+    // 阶段二/三: 各连接整批解密并解析, 每个连接只产生一次 ACK 决策
+    flushRecvBatch(nowUs);
 }
 
 void ContextImpl::onWriteEvent()
 {
+    // 尽早回收零拷贝完成的包, 避免待重传包因 pin 无法改写
+    if (m_udpSocket.zeroCopyPending() > 0) {
+        drainSocketErrorQueue();
+    }
+
     m_inWriteDispatch = true;
-    size_t roundBudget = m_wantWriteConns.size();
+    size_t roundBudget = m_wantWriteCount;
     const ConnectionSchedulerMode schedulerMode = ConnectionScheduler(m_config);
     const uint32_t quantum = ConnectionWdrQuantum(m_config);
     const uint32_t deficitCap = ConnectionWdrDeficitCap(m_config);
 
-    while (roundBudget-- > 0 && !m_wantWriteConns.empty()) {
-        ConnectionImpl *conn = m_wantWriteConns.front();
-        m_wantWriteConns.pop_front();
-        m_wantWriteConnSet.erase(conn);
+    ConnectionImpl *conn = nullptr;
+    while (roundBudget-- > 0 && (conn = TAILQ_FIRST(&m_wantWriteConns)) != nullptr) {
+        TAILQ_REMOVE(&m_wantWriteConns, conn, m_writeLink);
+        conn->m_writeQueued = false;
+        --m_wantWriteCount;
 
-        if (conn == nullptr) {
-            continue;
-        }
-
-        ConnectionImpl::SP current;
-        if (!findManagedConnection(conn, current)) {
-            m_wdrrDeficit.erase(conn);
+        // 队列中的连接在析构时会自行出队, 这里只需确认仍受本 context 管理
+        auto connIt = m_connections.find(conn->cid());
+        if (connIt == m_connections.end() || connIt->second.get() != conn) {
+            conn->m_wdrrDeficit = 0;
             continue;
         }
 
+        ConnectionImpl::SP current = connIt->second;
         const uint64_t txBefore = current->statistic().tx_bytes;
 
         if (schedulerMode == kConnectionSchedulerWdrr) {
-            auto deficitIt = m_wdrrDeficit.find(conn);
-            uint32_t deficit = (deficitIt == m_wdrrDeficit.end()) ? 0u : deficitIt->second;
-            deficit = std::min<uint32_t>(deficit + quantum, deficitCap);
-            m_wdrrDeficit[conn] = deficit;
+            current->m_wdrrDeficit = std::min<uint32_t>(current->m_wdrrDeficit + quantum, deficitCap);
         }
 
         current->onWrite();
         handleConnectionState(current.get());
 
-        ConnectionImpl::SP aliveConn;
-        if (!findManagedConnection(conn, aliveConn)) {
-            m_wdrrDeficit.erase(conn);
-            continue;
-        }
-
         if (schedulerMode == kConnectionSchedulerWdrr) {
-            const uint64_t txAfter = aliveConn->statistic().tx_bytes;
+            const uint64_t txAfter = current->statistic().tx_bytes;
             const uint64_t sentBytes = (txAfter >= txBefore) ? (txAfter - txBefore) : 0;
             const uint32_t sent = static_cast<uint32_t>(std::min<uint64_t>(sentBytes, UINT32_MAX));
-            uint32_t remain = m_wdrrDeficit[conn];
-            remain = (sent >= remain) ? 0u : (remain - sent);
-            m_wdrrDeficit[conn] = remain;
+            const uint32_t remain = current->m_wdrrDeficit;
+            current->m_wdrrDeficit = (sent >= remain) ? 0u : (remain - sent);
         } else {
-            m_wdrrDeficit.erase(conn);
+            current->m_wdrrDeficit = 0;
         }
     }
 
     m_inWriteDispatch = false;
 
-    if (!m_wantWriteConns.empty()) {
+    if (!TAILQ_EMPTY(&m_wantWriteConns)) {
         m_writeEvent.start();
     }
 }
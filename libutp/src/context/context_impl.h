@@ -10,12 +10,12 @@
 
 #include <vector>
 #include <memory>
+#include <functional>
 #include <deque>
 #include <set>
 #include <tuple>
 #include <list>
 #include <unordered_map>
-#include <unordered_set>
 
 #include <event/timer.h>
 #include <event/poll.h>
@@ -26,8 +26,11 @@
 #include "context/connection_impl.h"
 #include "proto/frame/ack_frequency.h"
 #include "crypto/resumption_state_codec.h"
+#include "crypto/x25519_key_pool.h"
 
 #include "util/mm.h"
+#include "util/replay_filter.h"
+#include "util/timer_wheel.h"
 
 namespace eular {
 namespace utp {
@@ -53,6 +56,13 @@ class ContextImpl
     DISALLOW_MOVE(ContextImpl);
 
 public:
+    // 分片模式下由 ContextGroup 注入, 将数据报投递到指定分片, 返回 false 表示投递失败(队列满等)
+    using ShardForwarder = std::function<bool(uint32_t shard, const UdpSocket::MsgMetaInfo &msg)>;
+
+    static constexpr uint32_t kMaxShards = 256;
+    static constexpr uint32_t kShardCidShift = 24;
+    static constexpr uint32_t kShardCidLowMask = (1u << kShardCidShift) - 1;
+
     ContextImpl(event_base *base, Config *config);
     ~ContextImpl();
 
@@ -65,16 +75,34 @@ public:
     void setOnZeroRttDecision(const Context::OnZeroRttDecision &cb);
     void setResumptionSecret(const std::vector<uint8_t> &secret);
     void clearResumptionSecret();
+    void setKeyPairPoolSize(uint32_t capacity, uint32_t lowWatermark);
+    /// @brief 取一个握手用的临时密钥对, 优先从预生成池中弹出
+    std::shared_ptr<X25519Wrapper> acquireKeyPair();
     void wantWrite(ConnectionImpl *conn);
+    void removeFromWriteQueue(ConnectionImpl *conn);
 
     event_base*     loop() const { return m_base; }
+    TimerWheel*     timerWheel() { return &m_timerWheel; }
+    const std::shared_ptr<MemoryManager> &sharedMemoryPool() const { return m_sharedMm; }
     Config*         config() { return &m_config; }
-    Context::Statistic statistic() const { return m_stat; }
+    Context::Statistic statistic() const;
     void notePathValidationStarted();
     void notePathValidationSucceeded();
     void notePathValidationFailed();
     void noteZeroRttInvalidTicketRejected();
 
+    /**
+     * @brief 计算数据报所属分片, 需与 ContextGroup 挂载的 reuseport cBPF 程序保持一致
+     */
+    static uint32_t ShardOfPacket(uint32_t scid, uint32_t dcid, uint32_t shardCount);
+    void setShard(uint32_t index, uint32_t count, const ShardForwarder &forwarder);
+    uint32_t shardIndex() const { return m_shardIndex; }
+    socket_t socketFd() const { return m_udpSocket.fd(); }
+    const Address &localAddress() const { return m_udpSocket.localAddress(); }
+    /// @brief 发出的数据报改由 hook 接收, 配合 onForwardedPackets 注入收包, 用于进程内网络仿真
+    void setSendHook(const UdpSocket::SendHook &hook) { m_udpSocket.setSendHook(hook); }
+    void onForwardedPackets(const UdpSocket::MsgMetaInfo *msgs, size_t count);
+
 public:
     Status  bind(const std::string &ip, uint16_t port, const std::string &ifname);
     Status  connect(const Context::ConnectInfo &info);
@@ -201,7 +229,10 @@ private:
                                uint16_t validityPeriod,
                                uint32_t &ticketCid,
                                Context::EncryptionMode &encryptionMode);
-    void purgeZeroRttReplayCache(uint64_t nowMs);
+    bool retryRequired() const;
+    bool buildRetryToken(const Address &peerAddress, uint32_t peerCid, std::vector<uint8_t> &outToken);
+    bool validateRetryToken(const Address &peerAddress, uint32_t peerCid, const std::vector<uint8_t> &token);
+    Status sendRetry(const Address &peerAddress, uint32_t peerCid);
     bool rememberZeroRttNonce(uint32_t ticketCid, uint64_t nonce, uint64_t nowMs = 0);
     Status  parseSessionResumptionState(const std::string &state,
                                         CachedResumptionState &outInfo,
@@ -209,8 +240,11 @@ private:
 
 private:
     void onReadEvent();
+    void processIncomingPackets(const UdpSocket::MsgMetaInfo *msgs, size_t count, bool forwarded);
+    void flushRecvBatch(utp_time_t nowUs);
+    bool forwardToOwnerShard(uint32_t scid, uint32_t dcid, const UdpSocket::MsgMetaInfo &msg);
     void onWriteEvent();
-    void removeFromWriteQueue(ConnectionImpl *conn);
+    void drainSocketErrorQueue();
     bool findManagedConnection(ConnectionImpl *conn, ConnectionImpl::SP &outConn);
 
 private:
@@ -222,6 +256,7 @@ private:
     ev::EventPoll   m_readEvent;
     ev::EventPoll   m_writeEvent;
     ev::EventTimer  m_pendingHandshakeTimer;
+    TimerWheel      m_timerWheel;           // 连接级定时器统一挂在时间轮上, 需先于连接构造、晚于连接析构
 
     Context::OnConnected        m_onConnected;
     Context::OnConnectError     m_onConnectError;
@@ -232,9 +267,9 @@ private:
     using ConnectionMap = std::unordered_map<uint32_t, ConnectionImpl::SP>; // cid -> ConnectionImpl
     ConnectionMap                   m_connections;          // 所有连接容器
     std::unordered_map<ConnectionImpl *, PendingConnectAttempt> m_pendingConnections; // 正在连接队列
-    std::list<ConnectionImpl *>     m_wantWriteConns;       // WDRR 活跃连接队列
-    std::unordered_set<ConnectionImpl *> m_wantWriteConnSet; // 活跃连接去重集合
-    std::unordered_map<ConnectionImpl *, uint32_t> m_wdrrDeficit; // 每连接 deficit(bytes)
+    TAILQ_HEAD(ConnectionQueue, ConnectionImpl);
+    ConnectionQueue                 m_wantWriteConns;       // WDRR 活跃连接队列, 挂接点与 deficit 在 ConnectionImpl 内
+    size_t                          m_wantWriteCount{0};
     bool                            m_inWriteDispatch{false};
 
     std::unordered_map<uint32_t, PendingIncomingConnection> m_pendingIncoming; // local cid -> pending incoming
@@ -242,29 +277,21 @@ private:
     std::list<uint32_t>             m_pendingIncomingQueue; // 回调通知后的待 accept 队列
     std::set<uint32_t>              m_waitHandshakeDone;    // 已 accept，等待 HandshakeDone
     std::vector<UdpSocket::MsgMetaInfo> m_recvMsgScratch;
+    std::vector<ConnectionImpl::SP> m_recvBatchConns;       // 本次收包批次内已登记数据报的连接, 按首次命中顺序
     std::unique_ptr<TokenAuth>      m_tokenAuth;
+    X25519KeyPool                   m_keyPool;
 
     std::array<uint8_t, 32>         m_resumptionSecret{};   // 0-RTT 加密会话恢复密钥
     bool                            m_hasCustomResumptionSecret{false};
 
-    struct ZeroRttReplayKey {
-        uint32_t ticketCid{0};
-        uint64_t nonce{0};
-
-        bool operator==(const ZeroRttReplayKey &other) const {
-            return ticketCid == other.ticketCid && nonce == other.nonce;
-        }
-    };
-
-    struct ZeroRttReplayKeyHash {
-        size_t operator()(const ZeroRttReplayKey &key) const {
-            return static_cast<size_t>(key.ticketCid) ^ static_cast<size_t>(key.nonce) ^ static_cast<size_t>(key.nonce >> 32);
-        }
-    };
-
-    std::unordered_map<ZeroRttReplayKey, uint64_t, ZeroRttReplayKeyHash> m_zeroRttReplayCache;
+    ReplayFilter                    m_zeroRttReplayFilter;  // 0-RTT 抗重放, 首次使用时按配置分配
     MemoryManager            m_mm;
+    std::shared_ptr<MemoryManager> m_sharedMm;  // 共享池模式下所有连接的包缓冲来源, 由连接共同持有以免晚于上下文析构时悬空
     Context::Statistic       m_stat{};
+
+    uint32_t                 m_shardIndex{0};
+    uint32_t                 m_shardCount{1};
+    ShardForwarder           m_shardForwarder;
 };
 
 } // namespace utp
@@ -21,6 +21,7 @@
 
 #include "congestion/cubic.h"
 #include "congestion/bbr_v1.h"
+#include "congestion/bbr_v2.h"
 
 #include "proto/proto.h"
 #include "proto/frame/padding.h"
@@ -113,9 +114,21 @@ uint32_t PacketSentSize(const eular::utp::PacketOut *pkt)
         return pkt->encrypt_data_size;
     }
 
+    // 首次加密推迟到发送批次, 按密文长度计入
+    if ((pkt->po_flags & eular::utp::PacketOutFlags::kPoSealPending) &&
+        !(pkt->po_flags & eular::utp::PacketOutFlags::kPoEncrypted)) {
+        return pkt->data_size + eular::utp::AesGcmContext::GCM_TAG_SIZE;
+    }
+
     return pkt->data_size;
 }
 
+/// @brief 包实际离开主机的时间: SO_TXTIME 模式下为内核放行时间, 否则为交给内核的时间
+utp_time_t SentTimeOf(const eular::utp::UdpSocket::MsgMetaInfo &msg, utp_time_t nowUs)
+{
+    return std::max<utp_time_t>(nowUs, msg.txtime_ns / 1000);
+}
+
 bool IsHandshakePacket(const eular::utp::PacketOut *pkt)
 {
     return pkt != nullptr && (pkt->po_flags & eular::utp::PacketOutFlags::kPoHello);
@@ -139,6 +152,8 @@ void FillMsgMetaInfoFromPacket(const eular::utp::Address &peerAddress,
     msg.data = nullptr;
     msg.len = 0;
     msg.slice_count = 0;
+    msg.zc_packet = nullptr;
+    msg.zc_owner = nullptr;
     if (pkt == nullptr || !peerAddress.isValid()) {
         return;
     }
@@ -171,7 +186,7 @@ SendControl::SendControl(ConnectionImpl *conn, ContextImpl *ctx) :
     m_conn(conn),
     m_ctx(ctx)
 {
-    m_retransTimer.reset(ctx->loop(), [this] () {
+    m_retransTimer.reset(ctx->timerWheel(), [this] () {
         onRetransTimer();
     });
     init();
@@ -192,6 +207,7 @@ SendControl::~SendControl()
         }
     };
 
+    m_sentRing.clear();
     drainQueue(m_unackedPackets);
     drainQueue(m_scheduledPackets);
     drainQueue(m_lostPackets);
@@ -210,6 +226,8 @@ void SendControl::init()
     const Config *cfg = (m_ctx != nullptr) ? m_ctx->config() : nullptr;
     if (cfg != nullptr && cfg->cc_algorithm == 2) {
         m_congestion = std::dynamic_pointer_cast<Congestion>(std::make_shared<Cubic>(cfg));
+    } else if (cfg != nullptr && cfg->cc_algorithm == 3) {
+        m_congestion = std::dynamic_pointer_cast<Congestion>(std::make_shared<BbrV2>(cfg));
     } else {
         m_congestion = std::dynamic_pointer_cast<Congestion>(std::make_shared<BbrV1>(cfg));
     }
@@ -219,6 +237,9 @@ void SendControl::init()
     }
 
     m_flags |= SendCtlFlags::Pace; // 默认开启速率控制
+    if (cfg != nullptr && cfg->enable_ecn) {
+        m_flags |= SendCtlFlags::EcnEnabled;
+    }
     m_currentPackNo = 0;
     m_largestAckedPackNo = 0;
     m_largestAckedSentTime = 0;
@@ -276,6 +297,9 @@ Status SendControl::packetSent(PacketOut *pkt)
     m_congestion->onPacketSent(&info, m_bytesUnackedAll, m_flags & SendCtlFlags::AppLimited);
     pkt->bw_state = static_cast<BWPacketState *>(info.packetState);
     appendUnacked(pkt);
+    if (TraceRecorder *trace = tracer()) {
+        trace->record(kTracePacketSent, pkt->sent_time, pkt->packno, m_bytesUnackedAll, packetSize);
+    }
     if (pkt->frame_types & m_retxFrames) { // 需要超时重传
         retransAlarm(pkt->sent_time);
         if (m_nInflightRetrans == 1) {
@@ -293,6 +317,10 @@ bool SendControl::canSend()
 {
     uint64_t cwnd = m_congestion->getCwnd();
     uint64_t bytesOut = bytesOutTotal();
+    if (txTimePacing()) {
+        // 发送节奏交给内核 fq, 这里只限制时间戳领先当前时间的幅度
+        return bytesOut < cwnd && departureWithinHorizon(time::MonotonicUs());
+    }
     if (m_flags & SendCtlFlags::Pace) {
         if (bytesOut >= cwnd) {
             return false;
@@ -354,17 +382,13 @@ Status SendControl::onAckReceived(const AckInfo &ackInfo, utp_time_t nowUs)
         m_congestion->onBeginAck(nowUs, m_bytesUnackedAll);
     }
 
-    PacketOut *pkt = nullptr;
-    PacketOut *next = nullptr;
-    for (pkt = TAILQ_FIRST(&m_unackedPackets); pkt != nullptr; pkt = next) {
-        next = TAILQ_NEXT(pkt, po_next);
-
-        if (!IsPackNoAcked(ackInfo, pkt->packno)) {
-            continue;
-        }
-
+    TraceRecorder *trace = tracer();
+    auto onPacketAcked = [&] (PacketOut *pkt) {
         hasAcked = true;
         ++ackedPacketsThisRound;
+        if (trace != nullptr) {
+            trace->record(kTracePacketAcked, nowUs, pkt->packno, pkt->sent_time, PacketSentSize(pkt));
+        }
 
         if (pkt->packno >= largestAckedThisRound) {
             largestAckedThisRound = pkt->packno;
@@ -396,10 +420,39 @@ Status SendControl::onAckReceived(const AckInfo &ackInfo, utp_time_t nowUs)
 
         unackedRemove(pkt);
         destroyPacket(pkt);
+    };
+
+    if (m_sentRingDegraded) {
+        PacketOut *pkt = nullptr;
+        PacketOut *next = nullptr;
+        for (pkt = TAILQ_FIRST(&m_unackedPackets); pkt != nullptr; pkt = next) {
+            next = TAILQ_NEXT(pkt, po_next);
+            if (IsPackNoAcked(ackInfo, pkt->packno)) {
+                onPacketAcked(pkt);
+            }
+        }
+    } else if (ackInfo.range_size <= ackInfo.ack_ranges.size()) {
+        // 只访问 ACK 区间与在途窗口的交集; 解码后的区间按包号降序, 逆序遍历使确认顺序与发送顺序一致
+        for (uint32_t i = ackInfo.range_size; i-- > 0 && !m_sentRing.empty();) {
+            const Range &range = ackInfo.ack_ranges[i];
+            const utp_packno_t low = std::max(range.low, m_sentRing.lowest());
+            const utp_packno_t high = std::min(range.high, m_sentRing.highest());
+            for (utp_packno_t packno = low; packno <= high; ++packno) {
+                PacketOut *pkt = m_sentRing.find(packno);
+                if (pkt != nullptr) {
+                    onPacketAcked(pkt);
+                }
+            }
+        }
+    }
+
+    if (ackProgress) {
+        processEcnCounts(ackInfo, ackedPacketsThisRound, largestAckedThisRound);
     }
 
     if (m_congestion) {
         m_congestion->onEndAck(m_bytesUnackedAll);
+        traceCongestion(nowUs);
     }
 
     if (largestAckedThisRound > 0) {
@@ -586,11 +639,24 @@ int32_t SendControl::flushScheduledPackets(utp_time_t nowUs, uint32_t maxPackets
             break;
         }
 
-        FillMsgMetaInfoFromPacket(m_conn->m_peerAddress, pkt, msgs[preparedCount]);
         packets[preparedCount] = pkt;
         ++preparedCount;
     }
 
+    // 加密紧贴 sendmmsg 批次进行, 整批共用同一个已完成密钥扩展的加密上下文
+    preparedCount = sealPendingPackets(packets.data(), preparedCount);
+    if (preparedCount == 0) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < preparedCount; ++i) {
+        FillMsgMetaInfoFromPacket(m_conn->m_peerAddress, packets[i], msgs[i]);
+        msgs[i].zc_packet = packets[i];
+        msgs[i].zc_owner = &m_conn->m_mm;
+    }
+
+    // 已加密但超出时间窗口的包留在调度队列, 下次直接发送
+    preparedCount = stampDepartureTimes(packets.data(), msgs.data(), preparedCount, nowUs);
     if (preparedCount == 0) {
         return 0;
     }
@@ -600,6 +666,7 @@ int32_t SendControl::flushScheduledPackets(utp_time_t nowUs, uint32_t maxPackets
     if (sent <= 0) {
         return 0;
     }
+    commitDepartureTimes(packets.data(), msgs.data(), static_cast<size_t>(sent));
 
     sentAny = true;
     for (int32_t i = 0; i < sent; ++i) {
@@ -610,13 +677,14 @@ int32_t SendControl::flushScheduledPackets(utp_time_t nowUs, uint32_t maxPackets
         if (m_nScheduled > 0) {
             --m_nScheduled;
         }
-        sentPkt->sent_time = nowUs;
+        sentPkt->sent_time = SentTimeOf(msgs[static_cast<size_t>(i)], nowUs);
 
         m_conn->m_bytesOut += sentPkt->data_size;
         if ((sentPkt->local_flags & PacketOutLocalFlags::kPOLTrackOnSend) != 0) {
             sentPkt->local_flags &= ~PacketOutLocalFlags::kPOLTrackOnSend;
             if (sentPkt->po_flags & PacketOutFlags::kPoEncrypted) {
-                if ((sentPkt->po_flags & PacketOutFlags::kPoKeepPlaintext) &&
+                // NOTE 零拷贝发送的密文在完成通知前仍被内核引用, 留待回收时释放
+                if ((sentPkt->po_flags & PacketOutFlags::kPoKeepPlaintext) && !sentPkt->zeroCopyPinned() &&
                     sentPkt->encrypt_data != nullptr && sentPkt->encrypt_data != sentPkt->raw_data) {
                     AesGcmContext::ReleaseEncryptBuffer(sentPkt->encrypt_data, sentPkt->encrypt_data_size);
                     sentPkt->encrypt_data = nullptr;
@@ -643,7 +711,7 @@ int32_t SendControl::flushScheduledPackets(utp_time_t nowUs, uint32_t maxPackets
             }
         } else {
             if ((sentPkt->po_flags & PacketOutFlags::kPoEncrypted) &&
-                (sentPkt->po_flags & PacketOutFlags::kPoKeepPlaintext) &&
+                (sentPkt->po_flags & PacketOutFlags::kPoKeepPlaintext) && !sentPkt->zeroCopyPinned() &&
                 sentPkt->encrypt_data != nullptr && sentPkt->encrypt_data != sentPkt->raw_data) {
                 AesGcmContext::ReleaseEncryptBuffer(sentPkt->encrypt_data, sentPkt->encrypt_data_size);
                 sentPkt->encrypt_data = nullptr;
@@ -673,6 +741,11 @@ int32_t SendControl::retransmitLostBatch(utp_time_t nowUs, uint32_t maxPackets,
             break;
         }
 
+        // 上一次零拷贝发送尚未完成, 不能改写包号或重新加密; 跳过它, 不阻塞其后的丢失包
+        if (pkt->zeroCopyPinned()) {
+            continue;
+        }
+
         if (!m_conn->canSendStreamUnackedBytes(pkt->stream_data_size)) {
             break;
         }
@@ -700,13 +773,21 @@ int32_t SendControl::retransmitLostBatch(utp_time_t nowUs, uint32_t maxPackets,
                                        && m_conn->m_aesCtx
                                        && (needResetPackNo || pkt->encrypt_data == nullptr);
         if (needRegenerateCipher) {
-            if (m_conn->m_aesCtx->encrypt(pkt) != UTP_ERR_OK) {
-                break;
-            }
-            pkt->data_size = pkt->encrypt_data_size;
+            pkt->po_flags |= PacketOutFlags::kPoSealPending;
         }
 
-        UdpSocket::MsgMetaInfo &msg = msgs[preparedCount];
+        packets[preparedCount] = pkt;
+        ++preparedCount;
+    }
+
+    preparedCount = sealPendingPackets(packets.data(), preparedCount);
+    if (preparedCount == 0) {
+        return 0;
+    }
+
+    for (size_t idx = 0; idx < preparedCount; ++idx) {
+        pkt = packets[idx];
+        UdpSocket::MsgMetaInfo &msg = msgs[idx];
         msg.data = nullptr;
         msg.len = 0;
         msg.slice_count = 0;
@@ -723,11 +804,11 @@ int32_t SendControl::retransmitLostBatch(utp_time_t nowUs, uint32_t maxPackets,
             }
         }
         msg.metaInfo.peerAddress = m_conn->m_peerAddress;
-
-        packets[preparedCount] = pkt;
-        ++preparedCount;
+        msg.zc_packet = pkt;
+        msg.zc_owner = &m_conn->m_mm;
     }
 
+    preparedCount = stampDepartureTimes(packets.data(), msgs.data(), preparedCount, nowUs);
     if (preparedCount == 0) {
         return 0;
     }
@@ -737,13 +818,14 @@ int32_t SendControl::retransmitLostBatch(utp_time_t nowUs, uint32_t maxPackets,
     if (sent <= 0) {
         return 0;
     }
+    commitDepartureTimes(packets.data(), msgs.data(), static_cast<size_t>(sent));
 
     sentAny = true;
     for (int32_t i = 0; i < sent; ++i) {
         PacketOut *sentPkt = packets[static_cast<size_t>(i)];
         TAILQ_REMOVE(&m_lostPackets, sentPkt, po_next);
         sentPkt->po_flags &= ~(PacketOutFlags::kPoLost | PacketOutFlags::kPoLossRecorded | PacketOutFlags::kPoResetPackNo);
-        sentPkt->sent_time = nowUs;
+        sentPkt->sent_time = SentTimeOf(msgs[static_cast<size_t>(i)], nowUs);
 
         if (!sentPkt->addSendAttempt(sentPkt->packno, sentPkt->sent_time)) {
             UTP_LOGW("%s record retransmit attempt failed: Packet No=%" PRIu64,
@@ -776,6 +858,86 @@ int32_t SendControl::retransmitLostBatch(utp_time_t nowUs, uint32_t maxPackets,
     return sent;
 }
 
+bool SendControl::txTimePacing() const
+{
+    return (m_flags & SendCtlFlags::Pace) && m_conn != nullptr && m_conn->m_udpSocket != nullptr
+        && m_conn->m_udpSocket->txTimeEnabled();
+}
+
+bool SendControl::departureWithinHorizon(utp_time_t nowUs) const
+{
+    const uint64_t horizonNs = static_cast<uint64_t>(m_ctx->config()->txtime_horizon_us) * 1000;
+    return m_pacer.departureTimeNs(nowUs) <= nowUs * 1000 + horizonNs;
+}
+
+size_t SendControl::stampDepartureTimes(PacketOut *const *packets, UdpSocket::MsgMetaInfo *msgs, size_t count, utp_time_t nowUs)
+{
+    if (!txTimePacing()) {
+        return count;
+    }
+
+    const uint64_t rate = m_congestion ? m_congestion->getPacingRate(0) : 0;
+    const uint64_t limitNs = nowUs * 1000 + static_cast<uint64_t>(m_ctx->config()->txtime_horizon_us) * 1000;
+    uint64_t departureNs = m_pacer.departureTimeNs(nowUs);
+    size_t stamped = 0;
+    for (; stamped < count && departureNs <= limitNs; ++stamped) {
+        msgs[stamped].txtime_ns = departureNs;
+        departureNs += Pacer::departureGapNs(PacketSentSize(packets[stamped]), rate);
+    }
+
+    if (stamped == 0) {
+        // 等到时间戳重新落入窗口再唤醒
+        const uint64_t waitUs = (m_pacer.departureTimeNs(nowUs) - limitNs) / 1000;
+        m_conn->nextScheduleTime(waitUs / 1000 + 1);
+    }
+    return stamped;
+}
+
+void SendControl::commitDepartureTimes(PacketOut *const *packets, const UdpSocket::MsgMetaInfo *msgs, size_t sent)
+{
+    if (sent == 0 || msgs[sent - 1].txtime_ns == 0) {
+        return;
+    }
+
+    const uint64_t rate = m_congestion ? m_congestion->getPacingRate(0) : 0;
+    m_pacer.onDeparture(msgs[sent - 1].txtime_ns, PacketSentSize(packets[sent - 1]), rate);
+}
+
+size_t SendControl::sealPendingPackets(PacketOut *const *packets, size_t count)
+{
+    std::array<PacketOut *, kSendBatchCap> pending;
+    std::array<size_t, kSendBatchCap> pendingIndex;
+    size_t pendingCount = 0;
+    for (size_t i = 0; i < count && i < kSendBatchCap; ++i) {
+        if (packets[i]->po_flags & PacketOutFlags::kPoSealPending) {
+            pending[pendingCount] = packets[i];
+            pendingIndex[pendingCount] = i;
+            ++pendingCount;
+        }
+    }
+    if (pendingCount == 0) {
+        return count;
+    }
+
+    size_t sealed = 0;
+    Status st = m_conn->m_aesCtx ?
+        m_conn->m_aesCtx->encryptBatch(pending.data(), pendingCount, &sealed) :
+        Status::ErrorLiteral(UTP_ERR_CRYPTO_UNINITIALIZED, "Crypto context uninitialized");
+    for (size_t i = 0; i < sealed; ++i) {
+        pending[i]->data_size = pending[i]->encrypt_data_size;
+    }
+    if (st.ok()) {
+        return count;
+    }
+
+    // 加密失败的包留在原队列, 下次发送时重试; 其前面的包照常发送
+    UTP_LOGW("%s batch seal failed at Packet No=%" PRIu64 ": %s",
+             m_tag.c_str(),
+             pending[sealed]->packno,
+             st.message());
+    return pendingIndex[sealed];
+}
+
 void SendControl::setReorderThreshold(uint32_t threshold)
 {
     const uint32_t normalized = std::max<uint32_t>(1, threshold);
@@ -904,11 +1066,40 @@ void SendControl::recordLossSignal(utp_time_t nowUs)
     }
 }
 
+TraceRecorder *SendControl::tracer() const
+{
+    return m_conn != nullptr ? m_conn->trace() : nullptr;
+}
+
+void SendControl::traceCongestion(utp_time_t nowUs)
+{
+    TraceRecorder *trace = tracer();
+    if (trace == nullptr || !m_congestion) {
+        return;
+    }
+
+    // cwnd 与 pacing rate 任一变化都要记录, BBR 增益循环可能在 cwnd 不变时只调整 pacing rate
+    const uint64_t cwnd = m_congestion->getCwnd();
+    const uint64_t pacingRate = m_congestion->getPacingRate(0);
+    if (cwnd == m_tracedCwnd && pacingRate == m_tracedPacingRate) {
+        return;
+    }
+    m_tracedCwnd = cwnd;
+    m_tracedPacingRate = pacingRate;
+    trace->record(kTraceCongestionUpdate, nowUs, cwnd, pacingRate,
+                  static_cast<uint32_t>(std::min<uint64_t>(m_bytesUnackedAll, UINT32_MAX)));
+}
+
 void SendControl::appendUnacked(PacketOut *pkt)
 {
     const uint32_t packetSize = PacketSentSize(pkt);
     TAILQ_INSERT_TAIL(&m_unackedPackets, pkt, po_next);
     pkt->po_flags |= PacketOutFlags::kPoUnAcked;
+    if (!m_sentRingDegraded && !m_sentRing.insert(pkt)) {
+        UTP_LOGW("%s sent packet index insert failed, fall back to list scan: Packet No=%" PRIu64,
+            m_tag.c_str(), pkt->packno);
+        m_sentRingDegraded = true;
+    }
     if (m_conn != nullptr) {
         m_conn->onStreamPacketUnackedAdded(pkt);
     }
@@ -990,6 +1181,9 @@ void SendControl::onRetransTimer()
     utp_time_t now = time::MonotonicUs();
     RetransmissionMode rm = getRetransmissionMode();
     UTP_LOGD("%s Retransmission timer fired: mode=%s", m_tag.c_str(), util::to_string(rm));
+    if (m_conn != nullptr) {
+        m_conn->traceTimerFired(kTraceTimerRetrans, static_cast<uint64_t>(rm));
+    }
 
     if (TAILQ_EMPTY(&m_unackedPackets)) {
         m_lossTo = 0;
@@ -1018,6 +1212,7 @@ void SendControl::onRetransTimer()
         }
         hasLoss = expireUnacked(ExpireFilter::kAll, now) > 0;
     }
+    traceCongestion(now);
 
     if (hasLoss && m_conn != nullptr) {
         m_conn->nextScheduleTime(1);
@@ -1104,15 +1299,11 @@ bool SendControl::detectLosses(utp_time_t now)
     m_lossTo = 0;
     bool hasLoss = false;
 
-    PacketOut *pktOut = nullptr;
     PacketOut *next = nullptr;
     PacketOut *lossRecord = nullptr;
-    
-    for (pktOut = TAILQ_FIRST(&m_unackedPackets); pktOut != nullptr && pktOut->packno <= m_largestAckedPackNo; pktOut = next) {
-        next = TAILQ_NEXT(pktOut, po_next);
-
+    auto checkLoss = [&] (PacketOut *pktOut) {
         if (pktOut->po_flags & PacketOutFlags::kPoLossRecorded) {
-            continue;
+            return;
         }
 
         // NOTE FACK 检测, 如果当前包的包号加上重排序阈值小于最大的ACK包号, 则认为发生了重排序, 该包被认为丢失
@@ -1133,7 +1324,7 @@ bool SendControl::detectLosses(utp_time_t now)
             } else {
                 hasLoss = handleLostMtuProbe(pktOut) || hasLoss;
             }
-            continue;
+            return;
         }
 
         if (largestRetxPackNo
@@ -1150,7 +1341,7 @@ bool SendControl::detectLosses(utp_time_t now)
                 m_lossTo = srtt / 4;
             }
             hasLoss = (handleRegularLostPacket(pktOut, next) != nullptr) || hasLoss;
-            continue;
+            return;
         }
 
         if (srtt > 0 && m_largestAckedSentTime > pktOut->sent_time + srtt) {
@@ -1164,7 +1355,26 @@ bool SendControl::detectLosses(utp_time_t now)
                 }
             }
             hasLoss = (handleRegularLostPacket(pktOut, next) != nullptr) || hasLoss;
-            continue;
+            return;
+        }
+    };
+
+    if (m_sentRingDegraded) {
+        PacketOut *pktOut = nullptr;
+        for (pktOut = TAILQ_FIRST(&m_unackedPackets); pktOut != nullptr && pktOut->packno <= m_largestAckedPackNo; pktOut = next) {
+            next = TAILQ_NEXT(pktOut, po_next);
+            checkLoss(pktOut);
+        }
+    } else if (!m_sentRing.empty()) {
+        // 按包号从最小在途包扫描到最大已确认包; 低于 (最大已确认 - 重排序阈值) 的包每轮都会被判丢,
+        // 因此窗口下界紧跟最大已确认包号, 扫描长度与重排序窗口相当而非在途包总数
+        const utp_packno_t high = std::min(m_largestAckedPackNo, m_sentRing.highest());
+        for (utp_packno_t packno = m_sentRing.lowest(); packno <= high && !m_sentRing.empty(); ++packno) {
+            PacketOut *pktOut = m_sentRing.find(packno);
+            if (pktOut != nullptr) {
+                next = pktOut;
+                checkLoss(pktOut);
+            }
         }
     }
 
@@ -1259,8 +1469,57 @@ void SendControl::onLossEvent()
     m_largestSentAtCutback = m_sendHistory.largestPackNo();
 }
 
+bool SendControl::ecnMarking() const
+{
+    return (m_flags & SendCtlFlags::EcnEnabled) && m_conn != nullptr && m_conn->m_udpSocket != nullptr
+        && m_conn->m_udpSocket->ecnEnabled();
+}
+
+void SendControl::processEcnCounts(const AckInfo &ackInfo, uint32_t newlyAcked, utp_packno_t largestAcked)
+{
+    if (!ecnMarking() || newlyAcked == 0) {
+        return;
+    }
+
+    // RFC 9000 13.4.2.1: 计数不得回退, 且新增的标记包数不少于新确认的包数 (纯 ACK 包不在途但同样被计数);
+    // 否则路径清除了 ECN 标记或对端未开启 ECN, 此后不再信任 CE 反馈
+    const EcnCounts &counts = ackInfo.ecn;
+    const bool valid = ackInfo.has_ecn
+                    && counts.ect0 >= m_peerEcnCounts.ect0
+                    && counts.ect1 >= m_peerEcnCounts.ect1
+                    && counts.ce >= m_peerEcnCounts.ce
+                    && counts.total() - m_peerEcnCounts.total() >= newlyAcked;
+    if (!valid) {
+        UTP_LOGW("%s ECN validation failed: ect0=%" PRIu64 ", ect1=%" PRIu64 ", ce=%" PRIu64 ", newly acked %u",
+                 m_tag.c_str(), counts.ect0, counts.ect1, counts.ce, newlyAcked);
+        m_flags &= ~SendCtlFlags::EcnEnabled;
+        return;
+    }
+
+    const bool ceIncreased = counts.ce > m_peerEcnCounts.ce;
+    m_peerEcnCounts = counts;
+    if (!ceIncreased || largestAcked <= m_largestSentAtCutback) {
+        return;
+    }
+
+    // 与丢包共用降速窗口: 上次降速之后发出的包收到 CE 才再次降速
+    ++m_ecnCeEvents;
+    if (m_congestion) {
+        m_congestion->onEcnCe();
+    }
+    if (m_flags & SendCtlFlags::Pace) {
+        m_pacer.lossEvent();
+    }
+    m_largestSentAtCutback = m_sendHistory.largestPackNo();
+}
+
 utp_packno_t SendControl::largestRetxPacketNo() const
 {
+    // 在途包全部不可重传 (如纯 ACK / PING) 时无需从尾部遍历整个队列
+    if (m_nInflightRetrans == 0) {
+        return 0;
+    }
+
     PacketOut *pkt = nullptr;
     TAILQ_FOREACH_REVERSE(pkt, &m_unackedPackets, PacketOutTailQ, po_next) {
         if (0 == (pkt->po_flags & (PacketOutFlags::kPoLossRecorded)) && (pkt->frame_types & m_retxFrames)) {
@@ -1291,6 +1550,9 @@ PacketOut *SendControl::handleRegularLostPacket(PacketOut *pkt, PacketOut *&next
         m_congestion->onLost(&info);
         pkt->bw_state = static_cast<BWPacketState *>(info.packetState);
     }
+    if (TraceRecorder *trace = tracer()) {
+        trace->record(kTracePacketLost, time::MonotonicUs(), pkt->packno, pkt->sent_time, PacketSentSize(pkt));
+    }
 
     unackedRemove(pkt);
     pkt->po_flags |= PacketOutFlags::kPoLost;
@@ -1348,7 +1610,7 @@ Status SendControl::retransmitSplitStreamPacket(PacketOut *pkt, utp_time_t nowUs
     const uint16_t packetFlags = pkt->po_flags & (PacketOutFlags::kPoHello | PacketOutFlags::kPoNoEncrypt);
     const uint64_t bytesOutBefore = m_conn->m_bytesOut;
 
-    std::array<uint8_t, UTP_ETHERNET_MTU> framePayload{};
+    std::array<uint8_t, UTP_JUMBO_MTU> framePayload{};
     std::array<ConnectionImpl::FrameBuildMeta, PACKET_OUT_MAX_FRAMES> frameMetas{};
     size_t framePayloadSize = 0;
     size_t frameMetaCount = 0;
@@ -1515,6 +1777,10 @@ Status SendControl::retransmitLostPacket(PacketOut *pkt, utp_time_t nowUs)
         return Status::ErrorLiteral(UTP_ERR_INVALID_PARAM, "invalid param");
     }
 
+    if (pkt->zeroCopyPinned()) {
+        return Status::ErrorLiteral(UTP_ERR_WOULD_BLOCK, "zerocopy completion pending");
+    }
+
     if (!m_conn->canSendStreamUnackedBytes(pkt->stream_data_size)) {
         return Status::ErrorLiteral(UTP_ERR_WOULD_BLOCK, "congestion control blocked");
     }
@@ -1569,6 +1835,8 @@ Status SendControl::retransmitLostPacket(PacketOut *pkt, utp_time_t nowUs)
         }
     }
     msg.metaInfo.peerAddress = m_conn->m_peerAddress;
+    msg.zc_packet = pkt;
+    msg.zc_owner = &m_conn->m_mm;
 
     Status                              udpSt;
     int32_t sent = m_conn->m_udpSocket->send(msg, udpSt);
@@ -1619,6 +1887,11 @@ void SendControl::unackedRemove(PacketOut *pkt)
     const uint32_t packetSize = PacketSentSize(pkt);
     TAILQ_REMOVE(&m_unackedPackets, pkt, po_next);
     pkt->po_flags &= ~PacketOutFlags::kPoUnAcked;
+    m_sentRing.erase(pkt);
+    if (m_sentRingDegraded && TAILQ_EMPTY(&m_unackedPackets)) {
+        m_sentRing.clear();
+        m_sentRingDegraded = false;
+    }
     if (m_conn != nullptr) {
         m_conn->onStreamPacketUnackedRemoved(pkt);
     }
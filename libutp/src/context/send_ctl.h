@@ -13,14 +13,17 @@
 
 #include <queue.h>
 
-#include <event/timer.h>
-
 #include "congestion/congestion.h"
 #include "congestion/pacer.h"
 
 #include "proto/packet_common.h"
 #include "proto/packet_out.h"
+#include "socket/udp.h"
+#include "util/ack_info.h"
 #include "util/send_history.h"
+#include "util/sent_packet_ring.h"
+#include "util/timer_wheel.h"
+#include "util/trace_recorder.h"
 #include "util/enum.hpp"
 
 enum SendCtlFlags : uint32_t {
@@ -121,12 +124,31 @@ public:
     uint32_t    scheduledCount() const { return m_nScheduled; }
     void        setReorderThreshold(uint32_t threshold);
     bool        isLossFrequent(utp_time_t nowUs, utp_time_t windowUs, uint32_t threshold) const;
+    /// @brief 收到 CE 反馈后触发拥塞响应的次数
+    uint64_t    ecnCeEvents() const { return m_ecnCeEvents; }
+    /// @brief 拥塞控制算法的慢启动退出统计
+    SlowStartStats slowStartStats() const { return m_congestion ? m_congestion->slowStartStats() : SlowStartStats(); }
+    /// @brief 对端最近一次回传的 ECN 计数
+    const EcnCounts &peerEcnCounts() const { return m_peerEcnCounts; }
 
 private:
     bool        haveUnackedHandshakePackets() const;
     int32_t     expireUnacked(ExpireFilter filter, utp_time_t nowUs);
     void        onLossEvent();
+    /// @brief 本端发出的包是否带 ECT(0) 标记且 ECN 校验尚未失败
+    bool        ecnMarking() const;
+    /**
+     * @brief 校验 ACK 中的 ECN 计数, CE 计数增加时通知拥塞控制, 须在 onEndAck 之前调用
+     *
+     * @param newlyAcked 本次 ACK 新确认的包数
+     * @param largestAcked 本次 ACK 新确认的最大包号
+     */
+    void        processEcnCounts(const AckInfo &ackInfo, uint32_t newlyAcked, utp_packno_t largestAcked);
     void        recordLossSignal(utp_time_t nowUs);
+    /// @brief 连接开启事件追踪时返回追踪环
+    TraceRecorder *tracer() const;
+    /// @brief cwnd 与上次记录不同时写入一条拥塞状态追踪
+    void        traceCongestion(utp_time_t nowUs);
 
     void        appendUnacked(PacketOut *pkt);
     void        retransAlarm(utp_time_t now);
@@ -145,6 +167,20 @@ private:
     void        updateReorderThresholdOnAck(uint32_t ackedPackets, utp_time_t srtt, utp_time_t rttvar);
     utp_packno_t largestRetxPacketNo() const;
     int32_t     flushScheduledPackets(utp_time_t nowUs, uint32_t maxPackets, bool &sentAny);
+    /// @brief 批量加密批次内待加密的包, 返回从头开始可直接发送的包数量
+    size_t      sealPendingPackets(PacketOut *const *packets, size_t count);
+    /// @brief 是否由内核按 SO_TXTIME 时间戳 pacing
+    bool        txTimePacing() const;
+    /// @brief SO_TXTIME 模式下 Pacer 的下一发送时间是否仍在 txtime_horizon_us 内
+    bool        departureWithinHorizon(utp_time_t nowUs) const;
+    /**
+     * @brief SO_TXTIME 模式下为批次内的包依次分配最早发送时间
+     *
+     * @return 最早发送时间不超出 txtime_horizon_us 的前缀包数, 为 0 时已挂起调度定时器
+     */
+    size_t      stampDepartureTimes(PacketOut *const *packets, UdpSocket::MsgMetaInfo *msgs, size_t count, utp_time_t nowUs);
+    /// @brief 以批次内最后一个已发出的包推进 Pacer
+    void        commitDepartureTimes(PacketOut *const *packets, const UdpSocket::MsgMetaInfo *msgs, size_t sent);
     PacketOut*  handleRegularLostPacket(PacketOut *pkt, PacketOut *&next);
     bool        handleLostMtuProbe(PacketOut *pkt);
     Status      retransmitSplitStreamPacket(PacketOut *pkt, utp_time_t nowUs);
@@ -156,12 +192,14 @@ private:
 
 private:
     std::string         m_tag;
-    ev::EventTimer      m_retransTimer;                 // 重传定时器, 用于触发基于时间的重传 (如 RTO)
+    WheelTimer          m_retransTimer;                 // 重传定时器, 用于触发基于时间的重传 (如 RTO)
     ContextImpl*        m_ctx{};
     ConnectionImpl*     m_conn{};
     SendHistory         m_sendHistory{};                // 发送历史记录
     SendCtlFlags        m_flags{SendCtlFlags::None};    // 发送控制标志
-    PacketOutTailQ      m_unackedPackets{};             // 待确认的包队列
+    PacketOutTailQ      m_unackedPackets{};             // 待确认的包队列 (按发送顺序)
+    SentPacketRing      m_sentRing;                     // 待确认包的包号索引, 与 m_unackedPackets 同步增删
+    bool                m_sentRingDegraded{false};      // 索引插入失败, ACK 处理退回遍历队列, 队列清空后恢复
     utp_packno_t        m_largestAckedPackNo{0};        // 对端确认的最大包号 (用于丢包检测)
     utp_time_t          m_largestAckedSentTime{0};      // 最大已确认包的发送时间 (用于 RTT 采样)
     utp_time_t          m_lastSentTime{0};              // 最后一次发包时间 (用于空闲检测)
@@ -177,6 +215,10 @@ private:
     uint64_t            m_nInflightAll;                 // 飞行中的数据包总量, 包括一些非可重传包 (如 Ack-Only 包)
     uint64_t            m_nInflightRetrans;             // 飞行中可重传包的数量
     uint64_t            m_bytesRetransTotal{0};         // 累计重传字节数
+    EcnCounts           m_peerEcnCounts{};              // 已处理的对端 ECN 计数
+    uint64_t            m_ecnCeEvents{0};               // CE 反馈触发拥塞响应的次数
+    uint64_t            m_tracedCwnd{0};                // 最近一次写入追踪环的 cwnd
+    uint64_t            m_tracedPacingRate{0};          // 最近一次写入追踪环的 pacing rate
 
     /// @b 重传计数
     uint32_t            m_nConsecRtos;                  // 连续 RTO 次数, 用于计算RTO时指数退避
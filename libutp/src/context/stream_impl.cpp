@@ -17,6 +17,7 @@
 #include "logger/logger.h"
 #include "proto/packet_in.h"
 #include "util/error.h"
+#include "util/file_mapping.h"
 #include "util/mm.h"
 #include "util/time.h"
 
@@ -65,6 +66,31 @@ static size_t StreamSendBufferLimit(const ConnectionImpl *conn)
     return std::max<size_t>(conn->config()->stream_send_buffer_limit, 1);
 }
 
+static size_t StreamSendFileWindow(const ConnectionImpl *conn)
+{
+    if (conn == nullptr || conn->config() == nullptr || conn->config()->stream_send_file_window == 0) {
+        return StreamImpl::kDefaultSendFileWindow;
+    }
+    return conn->config()->stream_send_file_window;
+}
+
+namespace {
+
+// writev 分片共享的所有权对象, 最后一个区间释放时回调调用方
+struct ExternalBufferOwner {
+    explicit ExternalBufferOwner(const Stream::OnRelease &cb) : release(cb) {}
+    ~ExternalBufferOwner()
+    {
+        if (release) {
+            release();
+        }
+    }
+
+    Stream::OnRelease release;
+};
+
+} // namespace
+
 StreamImpl::StreamImpl(ConnectionImpl *conn, uint32_t streamId, uint8_t priority) :
     m_conn(conn),
     m_streamId(streamId),
@@ -73,10 +99,16 @@ StreamImpl::StreamImpl(ConnectionImpl *conn, uint32_t streamId, uint8_t priority
 {
     assert(m_conn != nullptr);
     m_recvMm = &m_conn->m_mm;
+    m_recvRingMode = m_conn->config() != nullptr && m_conn->config()->stream_recv_mode == kStreamRecvRing;
+    m_conn->takeDetachedFlowState(m_streamId, m_flow);
 }
 
 StreamImpl::~StreamImpl()
 {
+    if (m_schedState != kSchedIdle && m_conn != nullptr) {
+        m_conn->deactivateStream(this);
+    }
+    clearSendBuffers();
     clearRecvFragments();
 }
 
@@ -135,6 +167,12 @@ int32_t StreamImpl::read(void *buffer, size_t capacity)
 
     uint8_t *out = static_cast<uint8_t *>(buffer);
     size_t copied = 0;
+    if (m_recvRingMode) {
+        copied = m_recvRing.read(out, contiguous);
+        m_recvBufferedBytes = (m_recvBufferedBytes >= copied) ? (m_recvBufferedBytes - copied) : 0;
+        m_recvOffset += copied;
+    }
+
     RecvFragment *fragment = firstFragment();
     while (fragment != nullptr && copied < contiguous) {
         const uint64_t logicalOffset = fragment->offset + fragment->consumed;
@@ -228,11 +266,143 @@ int32_t StreamImpl::commitWrite(size_t bytes, bool fin)
         m_lastSendQueuedAtUs = time::MonotonicUs();
     }
 
+    onSendQueued(fin);
+    return static_cast<int32_t>(bytes);
+}
+
+int32_t StreamImpl::writev(const ConstBufferView *views, size_t count, const OnRelease &release, bool fin)
+{
+    Status st;
+    if (count > 0 && views == nullptr) {
+        return StreamErr(UTP_ERR_INVALID_PARAM, st);
+    }
+
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (views[i].len > 0 && views[i].data == nullptr) {
+            return StreamErr(UTP_ERR_INVALID_PARAM, st);
+        }
+        if (views[i].len > (std::numeric_limits<int32_t>::max)() - total) {
+            return StreamErr(UTP_ERR_OVERFLOW, st);
+        }
+        total += views[i].len;
+    }
+
+    if (total == 0 && !fin) {
+        return StreamErr(UTP_ERR_INVALID_PARAM, st);
+    }
+
+    if (m_localFinQueued) {
+        return StreamErr(UTP_ERR_STREAM_CLOSED, st);
+    }
+
+    if (m_conn == nullptr) {
+        return StreamErr(UTP_ERR_INVALID_STATE, st);
+    }
+
+    // 所有权整体转移, 不接受部分写入; 超过整个窗口的批次永远等不到足够余量, 直接拒绝
+    if (total > StreamSendFileWindow(m_conn)) {
+        return StreamErr(UTP_ERR_OVERFLOW, st);
+    }
+    if (total > sendExtentCredit()) {
+        return StreamErr(UTP_ERR_WOULD_BLOCK, st);
+    }
+
+    if (m_sendQueuedBytes + m_sendInFlightBytes + total > kMaxSendQueueBytes) {
+        return StreamErr(UTP_ERR_STREAM_DATA_LIMITED, st);
+    }
+
+    std::shared_ptr<ExternalBufferOwner> owner = std::make_shared<ExternalBufferOwner>(release);
+    uint64_t extentOffset = sendBufferedEndOffset();
+    for (size_t i = 0; i < count; ++i) {
+        if (views[i].len == 0) {
+            continue;
+        }
+
+        SendExtent extent;
+        extent.offset = extentOffset;
+        extent.data = static_cast<const uint8_t *>(views[i].data);
+        extent.len = views[i].len;
+        extent.holder = owner;
+        m_sendExtents.push_back(std::move(extent));
+        extentOffset += views[i].len;
+    }
+
+    if (total > 0) {
+        m_sendExtentBytes += total;
+        m_sendQueuedBytes += total;
+        m_lastSendQueuedAtUs = time::MonotonicUs();
+    }
+
+    // 无数据时 owner 在此处析构, release 立即回调
+    owner.reset();
+    onSendQueued(fin);
+    return static_cast<int32_t>(total);
+}
+
+int32_t StreamImpl::sendFile(int fd, uint64_t offset, size_t len, bool fin)
+{
+    Status st;
+    if (fd < 0 || (len == 0 && !fin)) {
+        return StreamErr(UTP_ERR_INVALID_PARAM, st);
+    }
+
+    if (m_localFinQueued) {
+        return StreamErr(UTP_ERR_STREAM_CLOSED, st);
+    }
+
+    if (m_conn == nullptr) {
+        return StreamErr(UTP_ERR_INVALID_STATE, st);
+    }
+
+    // 映射页不占用发送缓冲区, 单独按 stream_send_file_window 做背压
+    const size_t grant = std::min<size_t>({len, sendExtentCredit(), static_cast<size_t>((std::numeric_limits<int32_t>::max)())});
+    if (len > 0 && grant == 0) {
+        return StreamErr(UTP_ERR_WOULD_BLOCK, st);
+    }
+
+    if (m_sendQueuedBytes + m_sendInFlightBytes + grant > kMaxSendQueueBytes) {
+        return StreamErr(UTP_ERR_STREAM_DATA_LIMITED, st);
+    }
+
+    if (grant > 0) {
+        std::shared_ptr<FileMapping> mapping = std::make_shared<FileMapping>();
+        const Status mapStatus = mapping->map(fd, offset, grant);
+        if (!mapStatus.ok()) {
+            UTP_LOGW("stream %u sendFile map failed: %s", m_streamId, mapStatus.message());
+            return StreamErr(mapStatus.code(), st);
+        }
+
+        SendExtent extent;
+        extent.offset = sendBufferedEndOffset();
+        extent.data = mapping->data();
+        extent.len = grant;
+        extent.holder = std::move(mapping);
+        m_sendExtents.push_back(std::move(extent));
+        m_sendExtentBytes += grant;
+        m_sendQueuedBytes += grant;
+        m_lastSendQueuedAtUs = time::MonotonicUs();
+    }
+
+    onSendQueued(fin && grant == len);
+    return static_cast<int32_t>(grant);
+}
+
+void StreamImpl::onSendQueued(bool fin)
+{
     if (fin) {
         m_localFinQueued = true;
     }
 
     if (m_conn != nullptr) {
+        if (hasPendingSendWork()) {
+            // 新数据会推迟合并窗口, 也可能达到立即发送门限; 延迟中的 stream 重新入队, 由选流时重新判定
+            if (m_schedState == kSchedDeferred) {
+                m_conn->deactivateStream(this);
+            }
+            m_conn->activateStream(this);
+        }
+
         const utp_time_t nowUs = time::MonotonicUs();
         if (shouldDeferSend(nowUs)) {
             const utp_time_t remainUs = coalesceDelayRemainingUs(nowUs);
@@ -248,7 +418,6 @@ int32_t StreamImpl::commitWrite(size_t bytes, bool fin)
     }
 
     maybeNotifyClosed();
-    return static_cast<int32_t>(bytes);
 }
 
 size_t StreamImpl::acquireReadViews(ConstBufferView views[2], size_t maxBytes) const
@@ -259,6 +428,9 @@ size_t StreamImpl::acquireReadViews(ConstBufferView views[2], size_t maxBytes) c
 
     views[0] = {};
     views[1] = {};
+    if (m_recvRingMode) {
+        return m_recvRing.readableViews(views, maxBytes);
+    }
 
     size_t total = 0;
     size_t idx = 0;
@@ -305,6 +477,13 @@ int32_t StreamImpl::commitReadViews(size_t bytes)
     }
 
     size_t left = bytes;
+    if (m_recvRingMode) {
+        m_recvRing.consume(bytes);
+        m_recvBufferedBytes = (m_recvBufferedBytes >= bytes) ? (m_recvBufferedBytes - bytes) : 0;
+        m_recvOffset += bytes;
+        left = 0;
+    }
+
     while (left > 0) {
         RecvFragment *fragment = firstFragment();
         if (fragment == nullptr || (fragment->offset + fragment->consumed) != m_recvOffset) {
@@ -388,7 +567,7 @@ int32_t StreamImpl::reset(uint16_t errorCode)
     m_sendInFlightBytes = 0;
     m_sendAckedOffset = m_nextSendOffset;
     m_sendAckedRanges.clear();
-    m_sendBuffer.consume(m_sendBuffer.size());
+    clearSendBuffers();
     clearRecvFragments();
     maybeNotifyClosed();
     return 0;
@@ -413,12 +592,13 @@ int32_t StreamImpl::setPriority(uint8_t priority)
 
     const uint8_t oldPriority = m_priority;
     m_priority = priority;
-    m_schedWaitRounds = 0;
     UTP_LOGD("stream %u priority updated: %u -> %u",
              m_streamId,
              static_cast<uint32_t>(oldPriority),
              static_cast<uint32_t>(m_priority));
     if (m_conn != nullptr) {
+        m_schedServedRound = m_conn->m_schedRound;
+        m_conn->onStreamPriorityChanged(this);
         m_conn->scheduleWrite();
     }
 
@@ -487,7 +667,12 @@ Status StreamImpl::onFrame(const FrameStream &frame, PacketIn *packet)
         data += trim;
     }
 
+    if (m_recvRingMode) {
+        return onRingFrame(frameOffset, data, frameLength, frameFin);
+    }
+
     RecvFragment *insertedLast = nullptr;
+    bool quotaExhausted = false;
     const uint64_t originalEnd = frameOffset + frameLength;
     uint64_t cursor = frameOffset;
     const uint8_t *cursorData = data;
@@ -517,8 +702,9 @@ Status StreamImpl::onFrame(const FrameStream &frame, PacketIn *packet)
             fragment->offset = cursor;
             fragment->fin = frameFin && (cursor + frameLength == originalEnd);
 
-            if (m_recvMm != nullptr && fragment->packet != nullptr && fragment->len > 0) {
-                m_recvMm->retainPacketIn(fragment->packet);
+            if (!retainRecvFragment(fragment)) {
+                quotaExhausted = true;
+                break;
             }
 
             bool inserted = false;
@@ -547,8 +733,9 @@ Status StreamImpl::onFrame(const FrameStream &frame, PacketIn *packet)
             fragment->offset = cursor;
             fragment->fin = false;
 
-            if (m_recvMm != nullptr && fragment->packet != nullptr && fragment->len > 0) {
-                m_recvMm->retainPacketIn(fragment->packet);
+            if (!retainRecvFragment(fragment)) {
+                quotaExhausted = true;
+                break;
             }
 
             bool inserted = false;
@@ -580,6 +767,12 @@ Status StreamImpl::onFrame(const FrameStream &frame, PacketIn *packet)
         iter = nextFragment(iter);
     }
 
+    // 连接内存配额已满, 剩余数据连同 FIN 丢弃, 等待对端重传
+    if (quotaExhausted) {
+        maybeNotifyReadable(true);
+        return Status::OK();
+    }
+
     if (frameFin) {
         if (insertedLast != nullptr) {
             insertedLast->fin = true;
@@ -623,15 +816,15 @@ Status StreamImpl::onReset(uint16_t errorCode, bool fromPeer)
         m_resetByPeer = true;
     }
 
+    m_localFinQueued = true;
+    m_localFinSent = true;
+    m_peerFin = true;
     m_sendQueuedBytes = 0;
     m_sendInFlightBytes = 0;
     m_sendAckedOffset = m_nextSendOffset;
     m_sendAckedRanges.clear();
-    m_sendBuffer.consume(m_sendBuffer.size());
+    clearSendBuffers();
     clearRecvFragments();
-    m_localFinQueued = true;
-    m_localFinSent = true;
-    m_peerFin = true;
 
     notifyResetOnce();
     maybeNotifyClosed();
@@ -649,9 +842,10 @@ Status StreamImpl::flushPendingSends(size_t maxBytes)
         const uint64_t inFlightBytesU64 = (m_nextSendOffset >= m_sendAckedOffset)
                                        ? (m_nextSendOffset - m_sendAckedOffset)
                                        : 0;
-        const size_t inFlightBytes = static_cast<size_t>(std::min<uint64_t>(inFlightBytesU64, m_sendBuffer.size()));
-        const size_t maxQueuedFromBuffer = m_sendBuffer.size() > inFlightBytes
-                                         ? (m_sendBuffer.size() - inFlightBytes)
+        const size_t bufferedBytes = sendBufferedBytes();
+        const size_t inFlightBytes = static_cast<size_t>(std::min<uint64_t>(inFlightBytesU64, bufferedBytes));
+        const size_t maxQueuedFromBuffer = bufferedBytes > inFlightBytes
+                                         ? (bufferedBytes - inFlightBytes)
                                          : 0;
         if (m_sendQueuedBytes > maxQueuedFromBuffer) {
             m_sendQueuedBytes = maxQueuedFromBuffer;
@@ -692,20 +886,31 @@ Status StreamImpl::flushPendingSends(size_t maxBytes)
         size_t payloadLen = 0;
         bool frameFin = false;
 
-        ConstBufferView views[2];
-        const size_t startOffsetInBuffer = inFlightBytes;
-        const size_t count = m_sendBuffer.readableViewsFrom(views,
-                                                            startOffsetInBuffer,
-                                                            std::min(unsentBytes, budgetLeft));
-        if (count == 0 || views[0].data == nullptr || views[0].len == 0) {
-            if (unsentBytes == 0) {
-                continue;
+        uint64_t nextExtentOffset = (std::numeric_limits<uint64_t>::max)();
+        const SendExtent *extent = findSendExtent(m_nextSendOffset, &nextExtentOffset);
+        if (extent != nullptr) {
+            // sendFile 数据直接从映射页构建帧
+            const uint64_t extentLeft = extent->end() - m_nextSendOffset;
+            payload = extent->data + (m_nextSendOffset - extent->offset);
+            payloadLen = static_cast<size_t>(std::min<uint64_t>(extentLeft, std::min(unsentBytes, budgetLeft)));
+            payloadLen = std::min<size_t>(payloadLen, UINT16_MAX);
+        } else {
+            // 环形缓冲区只保存非映射数据, 起点需扣除其间的映射区间
+            const size_t startOffsetInBuffer = inFlightBytes - sendExtentBytesBetween(m_sendAckedOffset, m_nextSendOffset);
+            const size_t readLimit = static_cast<size_t>(std::min<uint64_t>(std::min(unsentBytes, budgetLeft),
+                                                                            nextExtentOffset - m_nextSendOffset));
+            ConstBufferView views[2];
+            const size_t count = m_sendBuffer.readableViewsFrom(views, startOffsetInBuffer, readLimit);
+            if (count == 0 || views[0].data == nullptr || views[0].len == 0) {
+                if (unsentBytes == 0) {
+                    continue;
+                }
+                return Status::ErrorLiteral(UTP_ERR_WOULD_BLOCK, "no readable views");
             }
-            return Status::ErrorLiteral(UTP_ERR_WOULD_BLOCK, "no readable views");
-        }
 
-        payload = static_cast<const uint8_t *>(views[0].data);
-        payloadLen = std::min<size_t>(views[0].len, UINT16_MAX);
+            payload = static_cast<const uint8_t *>(views[0].data);
+            payloadLen = std::min<size_t>(views[0].len, UINT16_MAX);
+        }
 
         Status status = Status::ErrorLiteral(UTP_ERR_WOULD_BLOCK, "initial block");
         size_t tryLen = std::min(payloadLen, StreamPayloadMtuBudget(m_conn));
@@ -790,34 +995,26 @@ void StreamImpl::onPacketAcked(uint64_t streamOffset, size_t len)
         start = m_sendAckedOffset;
     }
 
-    auto it = m_sendAckedRanges.lower_bound(start);
-    if (it != m_sendAckedRanges.begin()) {
-        auto prev = std::prev(it);
-        if (prev->second >= start) {
-            start = prev->first;
-            end = std::max(end, prev->second);
-            it = m_sendAckedRanges.erase(prev);
-        }
-    }
-
-    while (it != m_sendAckedRanges.end() && it->first <= end) {
-        end = std::max(end, it->second);
-        it = m_sendAckedRanges.erase(it);
+    if (!m_sendAckedRanges.insert(start, end)) {
+        return;
     }
-    m_sendAckedRanges[start] = end;
 
     uint64_t advancedTo = m_sendAckedOffset;
-    auto begin = m_sendAckedRanges.begin();
-    if (begin != m_sendAckedRanges.end() && begin->first <= m_sendAckedOffset && begin->second > m_sendAckedOffset) {
-        advancedTo = begin->second;
+    if (!m_sendAckedRanges.empty()) {
+        const SendAckedRanges::Range &front = m_sendAckedRanges.front();
+        if (front.start <= m_sendAckedOffset && front.end > m_sendAckedOffset) {
+            advancedTo = front.end;
+        }
     }
 
     if (advancedTo > m_sendAckedOffset) {
         const size_t delta = static_cast<size_t>(std::min<uint64_t>(advancedTo - m_sendAckedOffset,
-                                                                     m_sendBuffer.size()));
+                                                                     sendBufferedBytes()));
         if (delta > 0) {
-            m_sendBuffer.consume(delta);
-            m_sendAckedOffset += delta;
+            const uint64_t ackedEnd = m_sendAckedOffset + delta;
+            m_sendBuffer.consume(delta - sendExtentBytesBetween(m_sendAckedOffset, ackedEnd));
+            trimSendExtents(ackedEnd);
+            m_sendAckedOffset = ackedEnd;
             if (m_sendInFlightBytes >= delta) {
                 m_sendInFlightBytes -= delta;
             } else {
@@ -827,24 +1024,98 @@ void StreamImpl::onPacketAcked(uint64_t streamOffset, size_t len)
         }
     }
 
-    while (!m_sendAckedRanges.empty()) {
-        auto front = m_sendAckedRanges.begin();
-        if (front->second <= m_sendAckedOffset) {
-            m_sendAckedRanges.erase(front);
-            continue;
-        }
-        break;
-    }
+    m_sendAckedRanges.eraseBelow(m_sendAckedOffset);
 }
 
 size_t StreamImpl::appWriteCredit() const
 {
+    // sendFile 映射数据不占用写缓冲区额度
     const size_t cap = StreamSendBufferLimit(m_conn);
-    const size_t used = m_sendQueuedBytes + m_sendInFlightBytes;
+    const size_t total = m_sendQueuedBytes + m_sendInFlightBytes;
+    const size_t used = (total > m_sendExtentBytes) ? (total - m_sendExtentBytes) : 0;
     const size_t queueCredit = (used >= cap) ? 0 : (cap - used);
     return std::min(queueCredit, m_sendBuffer.freeSize());
 }
 
+size_t StreamImpl::sendExtentCredit() const
+{
+    const size_t window = StreamSendFileWindow(m_conn);
+    return (m_sendExtentBytes >= window) ? 0 : (window - m_sendExtentBytes);
+}
+
+size_t StreamImpl::sendBufferedBytes() const
+{
+    return m_sendBuffer.size() + m_sendExtentBytes;
+}
+
+size_t StreamImpl::sendExtentBytesBetween(uint64_t start, uint64_t end) const
+{
+    size_t bytes = 0;
+    for (const SendExtent &extent : m_sendExtents) {
+        if (extent.offset >= end) {
+            break;
+        }
+        const uint64_t lo = std::max(start, extent.offset);
+        const uint64_t hi = std::min(end, extent.end());
+        if (hi > lo) {
+            bytes += static_cast<size_t>(hi - lo);
+        }
+    }
+    return bytes;
+}
+
+const SendExtent* StreamImpl::findSendExtent(uint64_t offset, uint64_t *nextExtentOffset) const
+{
+    for (const SendExtent &extent : m_sendExtents) {
+        if (extent.end() <= offset) {
+            continue;
+        }
+        if (extent.offset <= offset) {
+            return &extent;
+        }
+        if (nextExtentOffset != nullptr) {
+            *nextExtentOffset = extent.offset;
+        }
+        return nullptr;
+    }
+    return nullptr;
+}
+
+void StreamImpl::trimSendExtents(uint64_t ackedOffset)
+{
+    while (!m_sendExtents.empty()) {
+        SendExtent &front = m_sendExtents.front();
+        if (front.offset >= ackedOffset) {
+            break;
+        }
+
+        if (front.end() <= ackedOffset) {
+            // 先出队再释放 holder, release 回调中可以安全地继续写入
+            std::shared_ptr<void> holder = std::move(front.holder);
+            m_sendExtentBytes -= front.len;
+            m_sendExtents.pop_front();
+            holder.reset();
+            continue;
+        }
+
+        const size_t trim = static_cast<size_t>(ackedOffset - front.offset);
+        front.offset += trim;
+        front.data += trim;
+        front.len -= trim;
+        m_sendExtentBytes -= trim;
+        break;
+    }
+}
+
+void StreamImpl::clearSendBuffers()
+{
+    m_sendBuffer.consume(m_sendBuffer.size());
+    std::deque<SendExtent> extents;
+    extents.swap(m_sendExtents);
+    m_sendExtentBytes = 0;
+    extents.clear();
+}
+
 uint64_t StreamImpl::sendBufferedEndOffset() const
 {
     return m_nextSendOffset + static_cast<uint64_t>(m_sendQueuedBytes);
@@ -865,32 +1136,11 @@ bool StreamImpl::shouldDeferSend(utp_time_t nowUs) const
         return false;
     }
 
-    if (m_conn == nullptr) {
-        return false;
-    }
-
-    // Before path validation and HandshakeDone convergence, anti-amplification
-    // credit is tight. Deferring here can accumulate payloads and repeatedly
-    // hit WOULD_BLOCK without making stream-level forward progress.
-    if (m_conn->m_networkPath.needPathValidation()) {
-        return false;
-    }
-    if (m_conn->m_handshakeDonePending && !m_conn->m_handshakeDoneSent) {
-        return false;
-    }
-    if (m_conn->m_bytesIn < 2048) {
+    if (m_conn == nullptr || !m_conn->streamCoalescingAllowed()) {
         return false;
     }
 
     const Config *cfg = m_conn->config();
-    if (cfg == nullptr || !cfg->stream_enable_coalescing) {
-        return false;
-    }
-
-    if (cfg->stream_coalesce_delay_us == 0) {
-        return false;
-    }
-
     if (m_sendQueuedBytes >= cfg->stream_min_payload_before_immediate_send) {
         return false;
     }
@@ -899,28 +1149,60 @@ bool StreamImpl::shouldDeferSend(utp_time_t nowUs) const
         return false;
     }
 
-    return nowUs < (m_lastSendQueuedAtUs + cfg->stream_coalesce_delay_us);
+    return nowUs < coalesceDeadlineUs();
 }
 
-utp_time_t StreamImpl::coalesceDelayRemainingUs(utp_time_t nowUs) const
+utp_time_t StreamImpl::coalesceDeadlineUs() const
 {
-    if (m_conn == nullptr) {
+    if (m_conn == nullptr || m_conn->config() == nullptr || m_lastSendQueuedAtUs == 0) {
         return 0;
     }
+    return m_lastSendQueuedAtUs + m_conn->config()->stream_coalesce_delay_us;
+}
 
-    const Config *cfg = m_conn->config();
-    if (cfg == nullptr || m_lastSendQueuedAtUs == 0) {
+utp_time_t StreamImpl::coalesceDelayRemainingUs(utp_time_t nowUs) const
+{
+    if (m_conn == nullptr) {
         return 0;
     }
 
-    const utp_time_t deadlineUs = m_lastSendQueuedAtUs + cfg->stream_coalesce_delay_us;
-    if (nowUs >= deadlineUs) {
+    const utp_time_t deadlineUs = coalesceDeadlineUs();
+    if (deadlineUs == 0 || nowUs >= deadlineUs) {
         return 0;
     }
 
     return deadlineUs - nowUs;
 }
 
+Status StreamImpl::onRingFrame(uint64_t offset, const uint8_t *data, size_t len, bool fin)
+{
+    if (len > 0) {
+        if (!m_recvRing.allocated()) {
+            // 对端遵守流控时, 未读数据不会超出 [m_recvOffset, m_recvOffset + 窗口)
+            const uint64_t window = m_conn != nullptr ? m_conn->localStreamDataWindow() : kMaxRecvFragmentBytes;
+            m_recvRing.reset(static_cast<size_t>(window), m_recvOffset);
+        }
+
+        size_t added = 0;
+        if (!m_recvRing.write(offset, data, len, &added)) {
+            UTP_LOGW("stream %u data [%llu, %llu) exceeds receive window [%llu, +%zu)", m_streamId,
+                     static_cast<unsigned long long>(offset), static_cast<unsigned long long>(offset + len),
+                     static_cast<unsigned long long>(m_recvOffset), m_recvRing.capacity());
+            return Status::ErrorLiteral(UTP_ERR_STREAM_DATA_LIMITED, "stream data exceeds receive window");
+        }
+        m_recvBufferedBytes += added;
+    }
+
+    if (fin) {
+        m_recvFinOffset = offset + len;
+    }
+
+    maybeAdvancePeerFin();
+    maybeNotifyReadable(true);
+    maybeNotifyClosed();
+    return Status::OK();
+}
+
 Status StreamImpl::insertRecvFragment(RecvFragment *fragment, bool *inserted)
 {
     if (fragment == nullptr) {
@@ -979,6 +1261,7 @@ void StreamImpl::clearRecvFragments()
         fragment = next;
     }
     m_recvFragmentsTree = RB_ROOT;
+    m_recvRing.clear();
     m_recvBufferedBytes = 0;
 }
 
@@ -1046,6 +1329,20 @@ void StreamImpl::eraseRecvFragment(RecvFragment *fragment)
     releaseRecvFragment(fragment);
 }
 
+bool StreamImpl::retainRecvFragment(RecvFragment *fragment)
+{
+    if (m_recvMm == nullptr || fragment->packet == nullptr || fragment->len == 0) {
+        return true;
+    }
+
+    if (!m_recvMm->retainPacketIn(fragment->packet)) {
+        fragment->packet = nullptr;
+        m_recvMm->putRecvFragment(fragment);
+        return false;
+    }
+    return true;
+}
+
 void StreamImpl::releaseRecvFragment(RecvFragment *fragment)
 {
     if (fragment == nullptr) {
@@ -1063,6 +1360,13 @@ void StreamImpl::releaseRecvFragment(RecvFragment *fragment)
 
 void StreamImpl::maybeAdvancePeerFin()
 {
+    if (m_recvRingMode) {
+        if (m_recvFinOffset == m_recvOffset) {
+            m_peerFin = true;
+        }
+        return;
+    }
+
     while (true) {
         RecvFragment *fragment = firstFragment();
         if (fragment == nullptr
@@ -1083,6 +1387,9 @@ size_t StreamImpl::contiguousReadableBytes(size_t maxBytes) const
     if (maxBytes == 0) {
         return 0;
     }
+    if (m_recvRingMode) {
+        return std::min(maxBytes, m_recvRing.contiguousBytes());
+    }
 
     size_t total = 0;
     uint64_t expectedOffset = m_recvOffset;
@@ -8,11 +8,16 @@
 #ifndef __UTP_CONTEXT_STREAM_IMPL_H__
 #define __UTP_CONTEXT_STREAM_IMPL_H__
 
-#include <map>
+#include <deque>
+#include <memory>
 #include <vector>
 
+#include <queue.h>
+
 #include "proto/frame/stream.h"
 #include "rbtree.h"
+#include "util/interval_set.h"
+#include "util/reassembly_ring.h"
 #include "util/ring_buffer.h"
 #include "utp/stream.h"
 #include "utp/types.h"
@@ -44,12 +49,41 @@ struct RecvFragment {
     size_t remaining() const { return len > consumed ? (len - consumed) : 0; }
 };
 
+/**
+ * @brief 不经过发送环形缓冲区的外部发送数据 (sendFile 映射页, writev 调用方缓冲区), 按流偏移升序排列
+ *
+ * 确认推进时从头部裁剪, 全部确认后释放 holder (解除映射或回调调用方).
+ */
+struct SendExtent {
+    uint64_t              offset{0};    // 起始流偏移
+    const uint8_t*        data{nullptr};
+    size_t                len{0};
+    std::shared_ptr<void> holder;       // 持有映射/释放回调, 同一次写入的区间共享
+
+    uint64_t end() const { return offset + len; }
+};
+
+/**
+ * @brief 流级流量控制状态, 随 StreamImpl 存放; 尚未建立 StreamImpl 的流 (如 0-RTT 早数据) 暂存在连接上
+ */
+struct StreamFlowState {
+    uint64_t   peer_max_stream_data{0};         // 对端通告的 MAX_STREAM_DATA
+    bool       peer_max_stream_data_known{false};
+    uint64_t   local_max_stream_data{0};        // 本端已通告的窗口, 0 表示尚未通告
+    uint64_t   local_bytes_consumed{0};         // 应用已读取的字节数
+    uint64_t   max_sent_offset{0};              // 已发送数据的最大结束偏移
+    utp_time_t last_max_stream_data_us{0};      // 上次发送 MAX_STREAM_DATA 的时间
+    utp_time_t last_blocked_us{0};              // 上次发送 STREAM_DATA_BLOCKED 的时间
+};
+
 class StreamImpl : public Stream
 {
 public:
     using SP = std::shared_ptr<StreamImpl>;
+    using SendAckedRanges = IntervalSet<4>;
 
     static constexpr size_t kDefaultBufferCapacity = 64 * 1024;
+    static constexpr size_t kDefaultSendFileWindow = 4 * 1024 * 1024;
     static constexpr size_t kMaxSendQueueBytes = 16 * 1024 * 1024;
     static constexpr size_t kMaxRecvFragmentBytes = 2 * 1024 * 1024;
 
@@ -58,6 +92,8 @@ public:
 
     uint32_t id() const override;
     int32_t  write(const void* data, size_t len, bool fin) override;
+    int32_t  writev(const ConstBufferView* views, size_t count, const OnRelease& release, bool fin) override;
+    int32_t  sendFile(int fd, uint64_t offset, size_t len, bool fin) override;
     int32_t  read(void* buffer, size_t capacity) override;
     size_t   acquireWriteBuffer(MutableBufferView views[2], size_t maxBytes) override;
     int32_t  commitWrite(size_t bytes, bool fin) override;
@@ -88,10 +124,20 @@ private:
     Status        onConnectionWritable(utp_time_t nowUs);
     void          onPacketAcked(uint64_t streamOffset, size_t len);
     size_t        appWriteCredit() const;
+    size_t        sendExtentCredit() const;
+    size_t        sendBufferedBytes() const;
+    size_t        sendExtentBytesBetween(uint64_t start, uint64_t end) const;
+    const SendExtent* findSendExtent(uint64_t offset, uint64_t *nextExtentOffset) const;
+    void          trimSendExtents(uint64_t ackedOffset);
+    void          clearSendBuffers();
+    void          onSendQueued(bool fin);
     uint64_t      sendBufferedEndOffset() const;
     bool          hasPendingSendWork() const;
     bool          shouldDeferSend(utp_time_t nowUs) const;
     utp_time_t    coalesceDelayRemainingUs(utp_time_t nowUs) const;
+    /// @brief 合并窗口截止时刻, 未排队过数据时为 0
+    utp_time_t    coalesceDeadlineUs() const;
+    Status        onRingFrame(uint64_t offset, const uint8_t* data, size_t len, bool fin);
     Status        insertRecvFragment(RecvFragment* fragment, bool* inserted = nullptr);
     void          clearRecvFragments();
     RecvFragment* findLowerBound(uint64_t offset) const;
@@ -99,6 +145,7 @@ private:
     RecvFragment* firstFragment() const;
     RecvFragment* nextFragment(const RecvFragment* fragment) const;
     void          eraseRecvFragment(RecvFragment* fragment);
+    bool          retainRecvFragment(RecvFragment* fragment);   // 连接内存配额不足时归还分片并返回 false
     void          releaseRecvFragment(RecvFragment* fragment);
     void          maybeAdvancePeerFin();
     size_t        contiguousReadableBytes(size_t maxBytes) const;
@@ -125,20 +172,36 @@ private:
     size_t                         m_recvBufferedBytes{0};
     utp_time_t                     m_lastSendQueuedAtUs{0};  // enqueue timestamp for coalescing window(us)
     MemoryManager*                 m_recvMm{nullptr};
-    std::unique_ptr<MemoryManager> m_ownedRecvMm;
     RingBuffer                     m_sendBuffer;
+    std::deque<SendExtent>         m_sendExtents;           // sendFile/writev 外部区间, 与环形缓冲区数据按流偏移交错
+    size_t                         m_sendExtentBytes{0};    // m_sendExtents 中尚未确认的字节数
     struct rb_root                 m_recvFragmentsTree{RB_ROOT};
+    bool                           m_recvRingMode{false};   // Config::stream_recv_mode == kStreamRecvRing
+    ReassemblyRing                 m_recvRing;              // 环形重组模式下的接收缓冲, 首次收到数据时按接收窗口分配
+    uint64_t                       m_recvFinOffset{UINT64_MAX}; // 环形重组模式下对端 FIN 的流偏移
     OnReadable                     m_onReadable;
     OnWritable                     m_onWritable;
     OnClosed                       m_onClosed;
     OnReset                        m_onReset;
     bool                           m_notifyingReadable{false};
     bool                           m_notifyingWritable{false};
-    std::map<uint64_t, uint64_t>   m_sendAckedRanges;
+    SendAckedRanges                m_sendAckedRanges;       // 已确认但尚未连续推进的发送区间
+    StreamFlowState                m_flow;
 
     /// @b Stream 调度属性
+    enum SchedState : uint8_t {
+        kSchedIdle,                                 // 不在任何调度队列中
+        kSchedActive,                               // 挂在连接的某个优先级活跃队列上
+        kSchedDeferred,                             // 因合并发送暂缓, 挂在连接的延迟队列上
+    };
+
     uint8_t  m_priority{Stream::kPriorityDefault};  // stream 基础优先级(0最高,7最低)
-    uint32_t m_schedWaitRounds{0};                  // STRICT 模式下累计等待轮次(用于 aging)
+    TAILQ_ENTRY(StreamImpl) m_schedLink;            // 活跃队列指针, 由 ConnectionImpl 维护
+    uint8_t  m_schedState{kSchedIdle};
+    uint8_t  m_schedLevel{0};                       // 所在活跃队列下标
+    uint32_t m_drrDeficit{0};                       // DRR 模式下的 deficit(bytes), 出队时清零
+    uint64_t m_schedServedRound{0};                 // 上次被选中(或入队)时连接的调度轮次, 用于 STRICT aging
+    utp_time_t m_deferUntilUs{0};                   // 在延迟队列中的排序键 (合并窗口截止时刻)
 };
 
 }  // namespace utp
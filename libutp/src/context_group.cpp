@@ -0,0 +1,67 @@
+/*************************************************************************
+    > File Name: context_group.cpp
+    > Author: eular
+    > Brief:
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include "utp/context_group.h"
+
+#include "context/context_group_impl.h"
+#include "util/error.h"
+
+namespace eular {
+namespace utp {
+ContextGroup::ContextGroup(uint32_t shards, Config *config)
+{
+    m_impl = std::make_shared<ContextGroupImpl>(shards, config);
+}
+
+ContextGroup::~ContextGroup()
+{
+    m_impl->stop();
+}
+
+void ContextGroup::setOnShardStart(const OnShardStart &cb)
+{
+    m_impl->setOnShardStart(cb);
+}
+
+int32_t ContextGroup::start(const std::string &ip, uint16_t port, const std::string &ifname)
+{
+    Status status = m_impl->start(ip, port, ifname);
+    if (status.ok()) {
+        return 0;
+    }
+
+    SetLastErrorV(status.code(), status.message());
+    return -1;
+}
+
+void ContextGroup::stop()
+{
+    m_impl->stop();
+}
+
+uint32_t ContextGroup::shardCount() const
+{
+    return m_impl->shardCount();
+}
+
+uint16_t ContextGroup::port() const
+{
+    return m_impl->port();
+}
+
+bool ContextGroup::cbpfAttached() const
+{
+    return m_impl->cbpfAttached();
+}
+
+Context *ContextGroup::context(uint32_t shard)
+{
+    return m_impl->context(shard);
+}
+
+} // namespace utp
+} // namespace eular
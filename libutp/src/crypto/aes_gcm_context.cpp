@@ -137,6 +137,34 @@ Status AesGcmContext::init(const AesKey256 &key, uint32_t noncePerfix)
 }
 
 Status AesGcmContext::encrypt(PacketOut *packet)
+{
+    return encryptBatch(&packet, 1);
+}
+
+Status AesGcmContext::encryptBatch(PacketOut *const *packets, size_t count, size_t *sealed)
+{
+    if (sealed != nullptr) {
+        *sealed = 0;
+    }
+
+    if (count > 0 && packets == nullptr) {
+        return Status::Error(UTP_ERR_INVALID_PARAM,
+                             fmt::format("packets is null when count={}", count));
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        Status st = sealPacket(packets[i]);
+        if (!st.ok()) {
+            return st;
+        }
+        if (sealed != nullptr) {
+            ++(*sealed);
+        }
+    }
+    return Status::OK();
+}
+
+Status AesGcmContext::sealPacket(PacketOut *packet)
 {
     if (packet == nullptr || packet->raw_data == nullptr) {
         return Status::ErrorLiteral(UTP_ERR_INVALID_PARAM, "invalid packet for encrypt");
@@ -179,13 +207,13 @@ Status AesGcmContext::encrypt(PacketOut *packet)
 
     size_t outCipherPayloadLen = cipherPayloadLen;
     // For in-place encryption, plaintext and ciphertext pointers are the same.
-    const Status encStatus = encrypt(packet->raw_data + UTP_HEADER_SIZE,
-                                     plainPayloadLen,
-                                     targetBuffer,
-                                     UTP_HEADER_SIZE,
-                                     packet->packno,
-                                     targetBuffer + UTP_HEADER_SIZE,
-                                     &outCipherPayloadLen);
+    const Status encStatus = sealPayload(packet->raw_data + UTP_HEADER_SIZE,
+                                         plainPayloadLen,
+                                         targetBuffer,
+                                         UTP_HEADER_SIZE,
+                                         packet->packno,
+                                         targetBuffer + UTP_HEADER_SIZE,
+                                         &outCipherPayloadLen);
     if (!encStatus.ok()) {
         if (!inPlace) {
             ReleaseEncryptBuffer(targetBuffer, encryptedPacketLen);
@@ -200,6 +228,86 @@ Status AesGcmContext::encrypt(PacketOut *packet)
     packet->encrypt_data = targetBuffer;
     packet->encrypt_data_size = static_cast<uint16_t>(UTP_HEADER_SIZE + outCipherPayloadLen);
     packet->po_flags |= PacketOutFlags::kPoEncrypted;
+    packet->po_flags &= ~PacketOutFlags::kPoSealPending;
+    return Status::OK();
+}
+
+Status AesGcmContext::sealPayload(const uint8_t *plaintext, size_t plaintext_len, const uint8_t *aad, size_t aad_len, uint64_t counter, uint8_t *ciphertext, size_t *ciphertext_len)
+{
+    if (m_cipher == nullptr || m_keySize == 0) {
+        return Status::ErrorLiteral(UTP_ERR_CRYPTO_UNINITIALIZED, "Crypto context uninitialized");
+    }
+
+    if (plaintext_len > (std::numeric_limits<int>::max)() || aad_len > (std::numeric_limits<int>::max)()) {
+        return Status::ErrorLiteral(UTP_ERR_OVERFLOW, "encrypt input is too large");
+    }
+
+    if (*ciphertext_len < plaintext_len + GCM_TAG_SIZE) {
+        return Status::Error(UTP_ERR_OVERFLOW,
+                             fmt::format("ciphertext buffer too small: required={}, provided={}",
+                                         plaintext_len + GCM_TAG_SIZE,
+                                         *ciphertext_len));
+    }
+
+    int32_t status = 1;
+    if (m_sealCtx == nullptr) {
+#if defined(UTP_ENABLE_FAULT_INJECTION)
+        if (fiu_fail("crypto/evp_ctx/alloc")) {
+            return Status::ErrorLiteral(UTP_ERR_NO_MEMORY, "alloc EVP_CIPHER_CTX failed");
+        }
+#endif
+        m_sealCtx = EVP_CIPHER_CTX_new();
+        if (m_sealCtx == nullptr) {
+            return Status::ErrorLiteral(UTP_ERR_NO_MEMORY, "alloc EVP_CIPHER_CTX failed");
+        }
+
+        // NOTE 密钥扩展与 GHASH 表只在此处计算一次, 之后每个包只重设 nonce
+        status = EVP_EncryptInit_ex(m_sealCtx, m_cipher, nullptr, nullptr, nullptr);
+        status = (status == 1) ? EVP_CIPHER_CTX_ctrl(m_sealCtx, EVP_CTRL_GCM_SET_IVLEN, GCM_NONCE_SIZE, nullptr) : 0;
+        status = (status == 1) ? EVP_EncryptInit_ex(m_sealCtx, nullptr, nullptr, m_key.data(), nullptr) : 0;
+    }
+
+    Nonce nonce = buildNonce(counter);
+    status = (status == 1) ? EVP_EncryptInit_ex(m_sealCtx, nullptr, nullptr, nullptr, nonce.data()) : 0;
+
+    int32_t outLen = 0;
+    int32_t totalLen = 0;
+    if (status == 1 && aad != nullptr && aad_len > 0) {
+        status = EVP_EncryptUpdate(m_sealCtx, nullptr, &outLen, aad, static_cast<int32_t>(aad_len));
+    }
+    if (status == 1 && plaintext != nullptr && plaintext_len > 0) {
+        status = EVP_EncryptUpdate(m_sealCtx,
+                                   ciphertext,
+                                   &outLen,
+                                   plaintext,
+                                   static_cast<int32_t>(plaintext_len));
+        totalLen += outLen;
+    }
+    if (status == 1) {
+        status = EVP_EncryptFinal_ex(m_sealCtx, ciphertext + totalLen, &outLen);
+        totalLen += outLen;
+    }
+    if (status == 1) {
+        status = EVP_CIPHER_CTX_ctrl(m_sealCtx,
+                                     EVP_CTRL_GCM_GET_TAG,
+                                     GCM_TAG_SIZE,
+                                     ciphertext + totalLen);
+    }
+
+    if (status != 1) {
+        // 上下文状态不可信, 下次使用时重建
+        EVP_CIPHER_CTX_free(m_sealCtx);
+        m_sealCtx = nullptr;
+
+        uint32_t sslCode = 0;
+        OpenSSLErrorMsg msg = GetOpenSSLErrorMsg(sslCode);
+        return Status::Error(UTP_ERR_CRYPTO_ENCRYPTION,
+                             fmt::format("AES-GCM encryption failed: {} (code=0x{:X})",
+                                         msg.data(),
+                                         sslCode));
+    }
+
+    *ciphertext_len = static_cast<size_t>(totalLen + GCM_TAG_SIZE);
     return Status::OK();
 }
 
@@ -465,22 +573,27 @@ Status AesGcmContext::decrypt(const uint8_t *ciphertext, size_t ciphertext_len,
     Nonce nonce = buildNonce(counter);
 
     const uint8_t *tag = ciphertext + cipherDataLen;
-    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
-    if (ctx == nullptr) {
-        return Status::ErrorLiteral(UTP_ERR_NO_MEMORY, "alloc EVP_CIPHER_CTX failed");
-    }
+    int32_t status = 1;
+    if (m_openCtx == nullptr) {
+        m_openCtx = EVP_CIPHER_CTX_new();
+        if (m_openCtx == nullptr) {
+            return Status::ErrorLiteral(UTP_ERR_NO_MEMORY, "alloc EVP_CIPHER_CTX failed");
+        }
 
-    int32_t status = EVP_DecryptInit_ex(ctx, m_cipher, nullptr, nullptr, nullptr);
-    status = (status == 1) ? EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, nonce.size(), nullptr) : 0;
-    status = (status == 1) ? EVP_DecryptInit_ex(ctx, nullptr, nullptr, m_key.data(), nonce.data()) : 0;
+        // NOTE 与加密侧相同, 密钥只设置一次, 同一收包批次内的包逐个重设 nonce 即可
+        status = EVP_DecryptInit_ex(m_openCtx, m_cipher, nullptr, nullptr, nullptr);
+        status = (status == 1) ? EVP_CIPHER_CTX_ctrl(m_openCtx, EVP_CTRL_GCM_SET_IVLEN, nonce.size(), nullptr) : 0;
+        status = (status == 1) ? EVP_DecryptInit_ex(m_openCtx, nullptr, nullptr, m_key.data(), nullptr) : 0;
+    }
+    status = (status == 1) ? EVP_DecryptInit_ex(m_openCtx, nullptr, nullptr, nullptr, nonce.data()) : 0;
 
     int32_t outLen = 0;
     int32_t totalLen = 0;
     if (status == 1 && aad != nullptr && aad_len > 0) {
-        status = EVP_DecryptUpdate(ctx, nullptr, &outLen, aad, static_cast<int32_t>(aad_len));
+        status = EVP_DecryptUpdate(m_openCtx, nullptr, &outLen, aad, static_cast<int32_t>(aad_len));
     }
     if (status == 1 && cipherDataLen > 0) {
-        status = EVP_DecryptUpdate(ctx,
+        status = EVP_DecryptUpdate(m_openCtx,
                                    plaintext,
                                    &outLen,
                                    ciphertext,
@@ -488,15 +601,23 @@ Status AesGcmContext::decrypt(const uint8_t *ciphertext, size_t ciphertext_len,
         totalLen += outLen;
     }
     if (status == 1) {
-        status = EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, GCM_TAG_SIZE, const_cast<uint8_t *>(tag));
+        status = EVP_CIPHER_CTX_ctrl(m_openCtx, EVP_CTRL_GCM_SET_TAG, GCM_TAG_SIZE, const_cast<uint8_t *>(tag));
     }
+
+    // NOTE 仅标签校验失败时保留上下文, 伪造包不会触发重新密钥扩展
+    bool tagMismatch = false;
     if (status == 1) {
-        status = EVP_DecryptFinal_ex(ctx, plaintext + totalLen, &outLen);
+        status = EVP_DecryptFinal_ex(m_openCtx, plaintext + totalLen, &outLen);
+        tagMismatch = (status != 1);
         totalLen += outLen;
     }
 
-    EVP_CIPHER_CTX_free(ctx);
     if (status != 1) {
+        if (!tagMismatch) {
+            EVP_CIPHER_CTX_free(m_openCtx);
+            m_openCtx = nullptr;
+        }
+
         uint32_t sslCode = 0;
         OpenSSLErrorMsg msg = GetOpenSSLErrorMsg(sslCode);
         return Status::Error(UTP_ERR_CRYPTO_DECRYPTION,
@@ -522,6 +643,14 @@ AesGcmContext::Nonce AesGcmContext::buildNonce(uint64_t counter) const
 
 void AesGcmContext::cleanup()
 {
+    if (m_sealCtx != nullptr) {
+        EVP_CIPHER_CTX_free(m_sealCtx);
+        m_sealCtx = nullptr;
+    }
+    if (m_openCtx != nullptr) {
+        EVP_CIPHER_CTX_free(m_openCtx);
+        m_openCtx = nullptr;
+    }
     m_cipher = nullptr;
     m_keySize = 0;
     std::memset(m_key.data(), 0, m_key.size());
@@ -80,6 +80,18 @@ public:
     Status encrypt(PacketOut *packet);
     Status decrypt(PacketIn *packet);
 
+    /**
+     * @brief 批量加密同一 sendmmsg 批次内的包, 逐包语义与 encrypt(PacketOut *) 一致
+     *
+     * 整批复用一个已完成密钥扩展的 EVP 上下文, 逐包只重设 nonce;
+     * 遇到失败立即返回, 之后的包保持原状。
+     *
+     * @param packets 待加密包数组
+     * @param count 包数量
+     * @param[out] sealed 从头开始连续加密成功的包数量, 可为空
+     */
+    Status encryptBatch(PacketOut *const *packets, size_t count, size_t *sealed = nullptr);
+
     static uint8_t *AcquireEncryptBuffer(size_t size);
     static void     ReleaseEncryptBuffer(uint8_t *buffer, size_t size);
 
@@ -129,14 +141,21 @@ public:
                     uint8_t* plaintext, size_t* plaintext_len);
 
 private:
-    Nonce buildNonce(uint64_t counter) const;
-    void  cleanup();
+    Nonce  buildNonce(uint64_t counter) const;
+    void   cleanup();
+    Status sealPacket(PacketOut *packet);
+    Status sealPayload(const uint8_t *plaintext, size_t plaintext_len,
+                       const uint8_t *aad, size_t aad_len,
+                       uint64_t counter,
+                       uint8_t *ciphertext, size_t *ciphertext_len);
 
 private:
     const EVP_CIPHER*      m_cipher{nullptr};
     std::array<uint8_t, 32> m_key{};
     size_t                  m_keySize{0};
     std::array<uint8_t, 4> m_noncePerfix; // 96-bit nonce for AES-GCM
+    EVP_CIPHER_CTX*        m_sealCtx{nullptr}; // 已设置密钥的加密上下文, 按包只重设 nonce
+    EVP_CIPHER_CTX*        m_openCtx{nullptr}; // 已设置密钥的解密上下文
 };
 
 } // namespace utp
@@ -30,6 +30,9 @@ static inline const std::string& TokenAadByType(TokenType type)
     if (type == TokenType::kZeroRttResumption) {
         return TOKEN_AAD_0RTT;
     }
+    if (type == TokenType::kRetry) {
+        return TOKEN_AAD_RETRY;
+    }
     return TOKEN_AAD_PATH;
 }
 
@@ -45,6 +45,7 @@ namespace utp {
 enum class TokenType : uint8_t {
     kPathValidation = 1,
     kZeroRttResumption = 2,
+    kRetry = 3,
 };
 
 struct TokenMeta {
@@ -68,6 +69,7 @@ struct TokenMeta {
 static const size_t      TOKEN_META_SIZE = 1 + 4 + 4 + 1 + 4 + 4 + 2 + 16;  // 36 bytes
 static const std::string TOKEN_AAD_PATH("UTP-PathToken-AAD");
 static const std::string TOKEN_AAD_0RTT("UTP-0RTTToken-AAD");
+static const std::string TOKEN_AAD_RETRY("UTP-RetryToken-AAD");
 
 // Token format: nonce(12) || ciphertext(sizeof(TokenMeta)) || tag(16)
 static const size_t TOKEN_SIZE = AEAD_NONCE_SIZE + TOKEN_META_SIZE + AEAD_TAG_SIZE;
@@ -0,0 +1,125 @@
+/*************************************************************************
+    > File Name: x25519_key_pool.cpp
+    > Author: eular
+    > Brief: 后台线程预生成的 X25519 临时密钥对池
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include "crypto/x25519_key_pool.h"
+
+#include <exception>
+
+#include "logger/logger.h"
+
+namespace eular {
+namespace utp {
+
+X25519KeyPool::~X25519KeyPool()
+{
+    stop();
+}
+
+void X25519KeyPool::resize(size_t capacity, size_t lowWatermark)
+{
+    stop();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = capacity;
+    m_lowWatermark = (lowWatermark < capacity) ? lowWatermark : capacity / 2;
+    while (m_keys.size() > m_capacity) {
+        m_keys.pop_back();
+    }
+    if (m_capacity == 0) {
+        return;
+    }
+
+    m_stopping = false;
+    m_thread = std::thread([this] () {
+        refillLoop();
+    });
+}
+
+X25519KeyPool::KeyPair X25519KeyPool::acquire()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_keys.empty()) {
+            KeyPair key = std::move(m_keys.front());
+            m_keys.pop_front();
+            ++m_hits;
+            if (m_keys.size() <= m_lowWatermark) {
+                m_cond.notify_one();
+            }
+            return key;
+        }
+        if (m_capacity > 0) {
+            ++m_misses;
+        }
+    }
+
+    return std::make_shared<X25519Wrapper>();
+}
+
+size_t X25519KeyPool::capacity() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_capacity;
+}
+
+size_t X25519KeyPool::available() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_keys.size();
+}
+
+uint64_t X25519KeyPool::hits() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+}
+
+uint64_t X25519KeyPool::misses() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+}
+
+void X25519KeyPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cond.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void X25519KeyPool::refillLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        m_cond.wait(lock, [this] () {
+            return m_stopping || m_keys.size() <= m_lowWatermark;
+        });
+
+        // 生成在锁外进行, 不阻塞事件循环线程的 acquire
+        while (!m_stopping && m_keys.size() < m_capacity) {
+            lock.unlock();
+            KeyPair key;
+            try {
+                key = std::make_shared<X25519Wrapper>();
+            } catch (const std::exception &e) {
+                UTP_LOGW("x25519 key pool refill failed: %s", e.what());
+                lock.lock();
+                return;
+            }
+            lock.lock();
+            m_keys.push_back(std::move(key));
+        }
+    }
+}
+
+} // namespace utp
+} // namespace eular
@@ -0,0 +1,74 @@
+/*************************************************************************
+    > File Name: x25519_key_pool.h
+    > Author: eular
+    > Brief: 后台线程预生成的 X25519 临时密钥对池
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#ifndef __CRYPTO_X25519_KEY_POOL_H__
+#define __CRYPTO_X25519_KEY_POOL_H__
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "crypto/x25519_wrapper.h"
+
+namespace eular {
+namespace utp {
+
+/**
+ * @brief X25519 临时密钥对池
+ *
+ * 密钥生成 (一次标量乘) 移到辅助线程, 事件循环线程建连时只弹出现成的密钥对, 之后仍在本线程做共享密钥推导.
+ * 剩余数量降到低水位时唤醒辅助线程补满到容量. 池为空时退回在调用线程现场生成, 行为与未启用池一致.
+ * 每个密钥对只使用一次, 弹出后即从池中移除.
+ */
+class X25519KeyPool
+{
+    X25519KeyPool(const X25519KeyPool &) = delete;
+    X25519KeyPool &operator=(const X25519KeyPool &) = delete;
+
+public:
+    using KeyPair = std::shared_ptr<X25519Wrapper>;
+
+    X25519KeyPool() = default;
+    ~X25519KeyPool();
+
+    /**
+     * @brief 设置池容量与低水位
+     *
+     * @param capacity 预生成的密钥对数量上限; 0 表示关闭, 停止辅助线程并清空池
+     * @param lowWatermark 剩余数量不高于该值时开始补充, 不小于 capacity 时取 capacity / 2; 0 表示取空后才补充
+     */
+    void        resize(size_t capacity, size_t lowWatermark);
+    /// @brief 弹出一个密钥对; 池为空或未启用时现场生成, 失败时抛出 std::runtime_error
+    KeyPair     acquire();
+
+    size_t      capacity() const;
+    size_t      available() const;
+    uint64_t    hits() const;
+    uint64_t    misses() const;
+
+private:
+    void        stop();
+    void        refillLoop();
+
+private:
+    mutable std::mutex      m_mutex;
+    std::condition_variable m_cond;
+    std::deque<KeyPair>     m_keys;
+    size_t                  m_capacity{0};
+    size_t                  m_lowWatermark{0};
+    uint64_t                m_hits{0};          // 从池中取得的次数
+    uint64_t                m_misses{0};        // 启用池但池为空, 现场生成的次数
+    bool                    m_stopping{false};
+    std::thread             m_thread;
+};
+
+} // namespace utp
+} // namespace eular
+
+#endif // __CRYPTO_X25519_KEY_POOL_H__
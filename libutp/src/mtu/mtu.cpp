@@ -15,6 +15,7 @@
 
 namespace {
 
+// 未提供配置时的默认梯队
 constexpr std::array<uint16_t, 4> kProbeLadderMtu = {{1380, 1450, 1492, 1500}};
 
 }
@@ -47,7 +48,7 @@ void MtuDiscovery::init(const Config *config, Address::Family family)
     const uint16_t cfgBase = (config == nullptr) ? ETHERNET_MTU_MID : config->mtu_base;
 
     m_mtuMin = NormalizeMtu(cfgMin, family);
-    m_mtuMax = ClampValue<uint16_t>(cfgMax, m_mtuMin, UTP_ETHERNET_MTU);
+    m_mtuMax = ClampValue<uint16_t>(cfgMax, m_mtuMin, UTP_JUMBO_MTU);
     m_mtuBase = ClampValue<uint16_t>(cfgBase, m_mtuMin, m_mtuMax);
     // 默认初始化使用 mtu_base，保证关闭 DPLPMTUD 时也能按配置运行。
     m_currentMtu = m_mtuBase;
@@ -57,6 +58,7 @@ void MtuDiscovery::init(const Config *config, Address::Family family)
     m_probePhase = kProbePhaseLadder;
 
     m_probeStep = (config == nullptr || config->mtu_probe_step == 0) ? 16 : config->mtu_probe_step;
+    buildLadder(config);
     m_probeTimeoutMs = (config == nullptr || config->mtu_probe_timeout == 0)
                          ? 2000
                          : config->mtu_probe_timeout;
@@ -94,7 +96,16 @@ uint16_t MtuDiscovery::MinimumSupportedMtu(Address::Family family)
 
 uint16_t MtuDiscovery::NormalizeMtu(uint16_t mtu, Address::Family family)
 {
-    return ClampValue<uint16_t>(mtu, MinimumSupportedMtu(family), UTP_ETHERNET_MTU);
+    return ClampValue<uint16_t>(mtu, MinimumSupportedMtu(family), UTP_JUMBO_MTU);
+}
+
+uint16_t MtuDiscovery::MaxRecvPayloadSize(const Config *config)
+{
+    uint16_t mtu = UTP_ETHERNET_MTU;
+    if (config != nullptr) {
+        mtu = ClampValue<uint16_t>(config->mtu_max, UTP_ETHERNET_MTU, UTP_JUMBO_MTU);
+    }
+    return PacketSizeFromMtu(mtu, Address::IPv4);
 }
 
 void MtuDiscovery::onPathValidated(utp_time_t nowMs)
@@ -369,9 +380,27 @@ void MtuDiscovery::resetSearchWindow()
     m_searchHighMtu = m_ceilingMtu;
 }
 
+void MtuDiscovery::buildLadder(const Config *config)
+{
+    m_ladder.clear();
+    if (config == nullptr) {
+        m_ladder.assign(kProbeLadderMtu.begin(), kProbeLadderMtu.end());
+    } else {
+        m_ladder = config->mtu_probe_ladder;
+    }
+
+    // 过滤越界候选并保证 mtu_max 为最后一级, 巨帧路径一次跳跃即可到达上限
+    m_ladder.erase(std::remove_if(m_ladder.begin(), m_ladder.end(), [this] (uint16_t mtu) {
+        return mtu < m_mtuMin || mtu > m_mtuMax;
+    }), m_ladder.end());
+    m_ladder.push_back(m_mtuMax);
+    std::sort(m_ladder.begin(), m_ladder.end());
+    m_ladder.erase(std::unique(m_ladder.begin(), m_ladder.end()), m_ladder.end());
+}
+
 uint16_t MtuDiscovery::nextLadderTarget() const
 {
-    for (uint16_t ladder : kProbeLadderMtu) {
+    for (uint16_t ladder : m_ladder) {
         if (ladder <= m_searchLowMtu) {
             continue;
         }
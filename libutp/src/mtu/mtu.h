@@ -10,11 +10,14 @@
 
 #include <stdint.h>
 
+#include <vector>
+
 #include "socket/address.h"
 #include "utp/types.h"
 
-// 即只上探到 1500 字节的 MTU
+// 默认只上探到 1500 字节的 MTU
 #define UTP_ETHERNET_MTU    1500
+#define UTP_JUMBO_MTU       9000 // 巨帧上限, mtu_max 不可超过此值
 #define IPV4_HEADER_SIZE    20
 #define IPV6_HEADER_SIZE    40
 #define UDP_HEADER_SIZE     8
@@ -57,6 +60,8 @@ public:
     static uint16_t NormalizeMtu(uint16_t mtu, Address::Family family);
     static uint16_t PacketSizeFromMtu(uint16_t mtu, Address::Family family);
     static uint16_t MtuFromPacketSize(uint16_t packetSize, Address::Family family);
+    // 按 mtu_max 计算接收一个 UDP 载荷所需的缓冲大小, 不小于以太网 MTU
+    static uint16_t MaxRecvPayloadSize(const Config *config);
 
 private:
     enum ProbePhase : uint8_t {
@@ -68,6 +73,7 @@ private:
 private:
     void clearInFlightProbe();
     void resetSearchWindow();
+    void buildLadder(const Config *config);
     uint16_t nextLadderTarget() const;
     uint16_t nextBinaryTarget() const;
     uint16_t safetyMtu() const;
@@ -80,6 +86,7 @@ private:
     uint16_t        m_mtuMax{UTP_ETHERNET_MTU};
     uint16_t        m_mtuBase{ETHERNET_MTU_MID};
     uint16_t        m_probeStep{16}; // 二分收敛阈值，不再用于线性累加
+    std::vector<uint16_t> m_ladder;  // 梯队候选 MTU，升序且位于 [mtu_min, mtu_max]，末项为 mtu_max
 
     uint32_t        m_probeIntervalMs{300000};
     uint16_t        m_probeTimeoutMs{2000};
@@ -36,6 +36,8 @@ std::string FrameTypeToString(uint32_t type)
         "MaxStreamData",
         "DataBlocked",
         "StreamDataBlocked",
+        "AckEcn",
+        "RetryToken",
     };
 
     if (type == kFrameInvalid) {
@@ -48,6 +48,8 @@ enum FrameType : uint8_t {
     kFrameMaxStreamData,      // 流级流量控制窗口更新帧
     kFrameDataBlocked,        // 连接级流量控制受限帧
     kFrameStreamDataBlocked,  // 流级流量控制受限帧
+    kFrameAckEcn,             // 携带 ECN 计数的确认帧, 接收侧按 kFrameAck 处理
+    kFrameRetryToken,         // 无状态地址校验令牌帧
     kFrameMax,
 };
 
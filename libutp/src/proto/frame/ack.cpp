@@ -43,7 +43,8 @@ int32_t eular::utp::FrameAck::encode(void *buffer, size_t size, Status &status)
 
     uint8_t rangeCount = rangeSize();
     uint8_t *bufferOffset = static_cast<uint8_t *>(buffer);
-    bufferOffset = Serialize::SerializeTo(bufferOffset, size, FrameType::kFrameAck);
+    const bool ecn = withEcn();
+    bufferOffset = Serialize::SerializeTo(bufferOffset, size, ecn ? FrameType::kFrameAckEcn : FrameType::kFrameAck);
     bufferOffset = Serialize::SerializeTo(bufferOffset, size, rangeCount);
     utp_time_t delta = _now - _history->largestAckedReceived();
     uint16_t ackDelay = static_cast<uint16_t>(delta >> _params->ack_delay_exponent);
@@ -62,6 +63,12 @@ int32_t eular::utp::FrameAck::encode(void *buffer, size_t size, Status &status)
         lastPackNo = it->low;
     }
 
+    if (ecn) {
+        bufferOffset = Serialize::SerializeTo(bufferOffset, size, _ecn->ect0);
+        bufferOffset = Serialize::SerializeTo(bufferOffset, size, _ecn->ect1);
+        bufferOffset = Serialize::SerializeTo(bufferOffset, size, _ecn->ce);
+    }
+
     return ackFrameSize;
 }
 
@@ -85,7 +92,7 @@ int32_t eular::utp::FrameAck::decode(const void *buffer, size_t size, Status &st
         status = Status::ErrorLiteral(UTP_ERR_OVERFLOW, "failed to decode ack frame type");
         return -1;
     }
-    if (frameType != FrameType::kFrameAck) {
+    if (frameType != FrameType::kFrameAck && frameType != FrameType::kFrameAckEcn) {
         status = Status::Error(UTP_ERR_FRAME_UNEXPECTED, fmt::format("Invalid frame type: {}", static_cast<uint8_t>(frameType)));
         return -1;
     }
@@ -102,7 +109,9 @@ int32_t eular::utp::FrameAck::decode(const void *buffer, size_t size, Status &st
         return -1;
     }
 
-    const size_t expectedSize = FRAME_ACK_HDR_SIZE + static_cast<size_t>(rangeCount) * FRAME_ACK_RANGE_SIZE;
+    const bool   ecn = frameType == FrameType::kFrameAckEcn;
+    const size_t expectedSize = FRAME_ACK_HDR_SIZE + static_cast<size_t>(rangeCount) * FRAME_ACK_RANGE_SIZE
+                              + (ecn ? FRAME_ACK_ECN_SIZE : 0);
     if (sizeOriginal < expectedSize) {
         status = Status::Error(UTP_ERR_OVERFLOW, fmt::format("ack frame too short: size={}, expected={}", sizeOriginal, expectedSize));
         return -1;
@@ -180,14 +189,24 @@ int32_t eular::utp::FrameAck::decode(const void *buffer, size_t size, Status &st
         lastAcked = _ackInfo->ack_ranges[i].low;
     }
 
-    assert((sizeOriginal - size) == (rangeCount * FRAME_ACK_RANGE_SIZE + FRAME_ACK_HDR_SIZE));
+    _ackInfo->has_ecn = ecn;
+    if (ecn) {
+        if (!DeserializeHelper(bufferOffset, size, _ackInfo->ecn.ect0) ||
+            !DeserializeHelper(bufferOffset, size, _ackInfo->ecn.ect1) ||
+            !DeserializeHelper(bufferOffset, size, _ackInfo->ecn.ce)) {
+            status = Status::ErrorLiteral(UTP_ERR_OVERFLOW, "failed to decode ack ecn counts");
+            return -1;
+        }
+    }
+
+    assert((sizeOriginal - size) == expectedSize);
     return sizeOriginal - size;
 }
 
 int32_t eular::utp::FrameAck::frameSize() const
 {
     uint32_t rangeCount = rangeSize();
-    uint32_t size = rangeCount * FRAME_ACK_RANGE_SIZE;
+    uint32_t size = rangeCount * FRAME_ACK_RANGE_SIZE + (withEcn() ? FRAME_ACK_ECN_SIZE : 0);
     return static_cast<int32_t>(FRAME_ACK_HDR_SIZE + size);
 }
 
@@ -16,6 +16,7 @@
 
 #define FRAME_ACK_HDR_SIZE      (1 + 1 + 2 + 4 + 8) // type + ack_count + ack_delay + first_ack_range + ack_largest
 #define FRAME_ACK_RANGE_SIZE    (8)                 // ack_range size
+#define FRAME_ACK_ECN_SIZE      (8 + 8 + 8)         // ect0_count + ect1_count + ce_count, 仅 kFrameAckEcn 携带
 
 namespace eular {
 namespace utp {
@@ -28,9 +29,11 @@ public:
     int32_t decode(const void *buffer, size_t size, Status &status);
     int32_t frameSize() const;
     int32_t rangeSize() const;
+    bool    withEcn() const { return _ecn != nullptr && _ecn->total() > 0; }
 
 public:
     const ReceiveHistory*   _history{nullptr}; // for encoding
+    const EcnCounts*        _ecn{nullptr};     // for encoding, 任一计数非 0 时编码为 kFrameAckEcn
     AckInfo*                _ackInfo{nullptr}; // for decoding
     utp_time_t              _now{0};
     Config*                 _config{nullptr};
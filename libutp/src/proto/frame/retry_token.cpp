@@ -0,0 +1,82 @@
+/*************************************************************************
+    > File Name: retry_token.cpp
+    > Author: eular
+    > Brief: 无状态地址校验 Retry 令牌帧
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include "proto/frame/retry_token.h"
+
+#include <cstring>
+#include <limits>
+#include <utils/serialize.hpp>
+
+#include "utp/errno.h"
+#include "util/error.h"
+#include "logger/logger.h"
+
+namespace eular {
+namespace utp {
+
+int32_t FrameRetryToken::encode(void *buffer, size_t size, Status &status) const
+{
+    if (token.empty() || token.size() > std::numeric_limits<uint8_t>::max()) {
+        status = Status::Error(UTP_ERR_INVALID_PARAM,
+                               fmt::format("invalid retry token size {}", token.size()));
+        return -1;
+    }
+
+    const int32_t frameLen = frameSize();
+    if (size < static_cast<size_t>(frameLen)) {
+        status = Status::Error(UTP_ERR_OVERFLOW,
+                               fmt::format("buffer size {} is smaller than retry token frame size {}", size, frameLen));
+        return -1;
+    }
+
+    uint8_t *bufferOffset = static_cast<uint8_t *>(buffer);
+    bufferOffset = Serialize::SerializeTo(bufferOffset, size, FrameType::kFrameRetryToken);
+    bufferOffset = Serialize::SerializeTo(bufferOffset, size, static_cast<uint8_t>(token.size()));
+    std::memcpy(bufferOffset, token.data(), token.size());
+
+    return frameLen;
+}
+
+int32_t FrameRetryToken::decode(const void *buffer, size_t size, Status &status)
+{
+    if (size < FRAME_RETRY_TOKEN_HDR_SIZE) {
+        status = Status::Error(UTP_ERR_OVERFLOW,
+                               fmt::format("buffer size {} is smaller than minimum retry token frame size {}",
+                                           size,
+                                           FRAME_RETRY_TOKEN_HDR_SIZE));
+        return -1;
+    }
+
+    const uint8_t *bufferOffset = static_cast<const uint8_t *>(buffer);
+    FrameType frameType;
+    uint8_t tokenSize = 0;
+    bufferOffset = Serialize::DeserializeFrom(bufferOffset, size, frameType);
+    if (frameType != FrameType::kFrameRetryToken) {
+        status = Status::ErrorLiteral(UTP_ERR_FRAME_UNEXPECTED, "Invalid frame type for retry token");
+        return -1;
+    }
+
+    bufferOffset = Serialize::DeserializeFrom(bufferOffset, size, tokenSize);
+    if (tokenSize == 0 || size < tokenSize) {
+        status = Status::Error(UTP_ERR_OVERFLOW,
+                               fmt::format("retry token payload truncated: left={}, required={}",
+                                           size,
+                                           tokenSize));
+        return -1;
+    }
+
+    token.assign(bufferOffset, bufferOffset + tokenSize);
+    return FRAME_RETRY_TOKEN_HDR_SIZE + tokenSize;
+}
+
+int32_t FrameRetryToken::frameSize() const
+{
+    return FRAME_RETRY_TOKEN_HDR_SIZE + static_cast<int32_t>(token.size());
+}
+
+} // namespace utp
+} // namespace eular
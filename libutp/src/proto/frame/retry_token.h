@@ -0,0 +1,41 @@
+/*************************************************************************
+    > File Name: retry_token.h
+    > Author: eular
+    > Brief: 无状态地址校验 Retry 令牌帧
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#ifndef __UTP_PROTO_FRAME_RETRY_TOKEN_H__
+#define __UTP_PROTO_FRAME_RETRY_TOKEN_H__
+
+#include <vector>
+
+#include "proto/frame.h"
+
+#define FRAME_RETRY_TOKEN_HDR_SIZE   (1 + 1) // type + token_size
+
+namespace eular {
+namespace utp {
+
+/**
+ * @brief Retry 令牌帧
+ *
+ * 服务端在 UTP_TYPE_RETRY 包中下发, 客户端在随后的 INITIAL 包中原样回显.
+ */
+struct FrameRetryToken : public FrameBase {
+public:
+    FrameRetryToken() : FrameBase(FrameType::kFrameRetryToken) {}
+    ~FrameRetryToken() = default;
+
+    int32_t encode(void *buffer, size_t size, Status &status) const;
+    int32_t decode(const void *buffer, size_t size, Status &status);
+    int32_t frameSize() const;
+
+public:
+    std::vector<uint8_t>    token;
+};
+
+} // namespace utp
+} // namespace eular
+
+#endif // __UTP_PROTO_FRAME_RETRY_TOKEN_H__
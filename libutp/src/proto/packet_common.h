@@ -38,6 +38,8 @@ enum PacketFrameTypeBit : uint32_t {
     kFTBitMaxStreamData     = 1 << kFrameMaxStreamData,
     kFTBitDataBlocked       = 1 << kFrameDataBlocked,
     kFTBitStreamDataBlocked = 1 << kFrameStreamDataBlocked,
+    kFTBitAckEcn            = 1 << kFrameAckEcn,
+    kFTBitRetryToken        = 1 << kFrameRetryToken,
 };
 
 #define UTP_FRAME_RETX_MASK (   \
@@ -62,6 +64,8 @@ enum PacketFrameTypeBit : uint32_t {
     | kFTBitMaxStreamData       \
     | kFTBitDataBlocked         \
     | kFTBitStreamDataBlocked   \
+    /* | kFTBitAckEcn */        \
+    /* | kFTBitRetryToken */    \
 )
 
 static inline bool IsValidPackNo(uint64_t packno) {
@@ -22,6 +22,7 @@
 #include "proto/frame/padding.h"
 #include "proto/frame/path.h"
 #include "proto/frame/reset_stream.h"
+#include "proto/frame/retry_token.h"
 #include "proto/frame/session_token.h"
 #include "proto/frame/stream.h"
 #include "proto/frame/stream_data_blocked.h"
@@ -34,6 +35,7 @@ namespace {
 
 constexpr size_t kAckFrameHeaderSize = (1 + 1 + 2 + 4 + 8);
 constexpr size_t kAckRangeSize = 8;
+constexpr size_t kAckEcnSize = 8 * 3;
 
 uint16_t ReadBE16(const uint8_t *p) { return static_cast<uint16_t>((static_cast<uint16_t>(p[0]) << 8) | p[1]); }
 
@@ -92,7 +94,9 @@ Status PacketIn::decode(const void *buffer, size_t size) {
                                  fmt::format("invalid frame type {}", static_cast<uint32_t>(frameType)));
         }
 
-        frame_types |= (1u << static_cast<uint32_t>(frameType));
+        // NOTE kFrameAckEcn 与 kFrameAck 语义相同, 统一记为 kFrameAck, 纯 ACK 包判定等逻辑无需区分
+        const FrameType bitType = frameType == kFrameAckEcn ? kFrameAck : frameType;
+        frame_types |= (1u << static_cast<uint32_t>(bitType));
         iter += frameLen;
     }
 
@@ -151,6 +155,12 @@ Status PacketIn::frameLength(const uint8_t *frameData, size_t payloadLeft, Frame
             }
             frameLen = FRAME_SESSION_TOKEN_HDR_SIZE + frameData[1];
             break;
+        case kFrameRetryToken:
+            if (payloadLeft < FRAME_RETRY_TOKEN_HDR_SIZE) {
+                return Status::ErrorLiteral(UTP_ERR_OVERFLOW, "retry token frame too short");
+            }
+            frameLen = FRAME_RETRY_TOKEN_HDR_SIZE + frameData[1];
+            break;
         case kFrameConnectionClose:
             if (payloadLeft < FRAME_CONNECTION_CLOSE_HDR_SIZE) {
                 return Status::ErrorLiteral(UTP_ERR_OVERFLOW, "connection close frame too short");
@@ -169,6 +179,12 @@ Status PacketIn::frameLength(const uint8_t *frameData, size_t payloadLeft, Frame
             }
             frameLen = kAckFrameHeaderSize + static_cast<size_t>(frameData[1]) * kAckRangeSize;
             break;
+        case kFrameAckEcn:
+            if (payloadLeft < kAckFrameHeaderSize) {
+                return Status::ErrorLiteral(UTP_ERR_OVERFLOW, "ack ecn frame too short");
+            }
+            frameLen = kAckFrameHeaderSize + static_cast<size_t>(frameData[1]) * kAckRangeSize + kAckEcnSize;
+            break;
         case kFrameCrypto:
             frameLen = FRAME_CRYPTO_SIZE;
             break;
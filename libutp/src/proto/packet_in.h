@@ -15,6 +15,8 @@
 namespace eular {
 namespace utp {
 
+class MemoryManager;
+
 struct PacketIn {
 public:
     Status decode(const void *buffer, size_t size);
@@ -45,6 +47,8 @@ public:
 
     uint32_t frame_types{0};
     PacketMetaInfo meta{};
+
+    MemoryManager *quota_owner{nullptr};    // 因重组保留而计入其配额的共享池视图
 };
 
 }  // namespace utp
@@ -59,6 +59,7 @@ void PacketOut::initForReuse(uint8_t *raw, uint16_t alloc)
     stream_offset = 0;
     encrypt_data = nullptr;
     bw_state = nullptr;
+    zc_pending = 0;
     attempts_head = nullptr;
     attempts_tail = nullptr;
     attempts_count = 0;
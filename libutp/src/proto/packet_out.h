@@ -32,6 +32,7 @@ enum PacketOutFlags : uint32_t {
     kPoLost         = (1 << 7), // 本包处于丢包队列, 等待重传
     kPoLossRecorded = (1 << 8), // 已记录丢包事件, 等待重传
     kPoKeepPlaintext= (1 << 9), // 加密后仍保留 raw_data 明文，供重传改包号后再次加密
+    kPoSealPending  = (1 << 10),// 待加密, 在进入 sendmmsg 批次前统一批量加密
 };
 
 enum PacketOutLocalFlags : uint16_t {
@@ -39,6 +40,7 @@ enum PacketOutLocalFlags : uint16_t {
     kPOLLimited     = (1 << 1), // 近期发生过丢包事件, 且当前拥塞受限
     kPOLFacked      = (1 << 2), // 被 FACK 检测出丢失
     kPOLTrackOnSend = (1 << 3), // 调度发送后需要进入 unacked 队列
+    kPOLZcPutDeferred = (1 << 4), // 已被回收, 但仍被 MSG_ZEROCOPY 引用, 待内核完成通知后真正释放
 };
 
 enum FrameMetaFlags : uint8_t {
@@ -102,6 +104,7 @@ struct PacketOut {
     void                initForReuse(uint8_t *raw, uint16_t alloc);
     bool                addSendAttempt(utp_packno_t packetNo, utp_time_t sentTime);
     void                clearSendAttempts();
+    bool                zeroCopyPinned() const { return zc_pending > 0; }
 
     TAILQ_ENTRY(PacketOut)  po_next;    // 未确认包队列指针
 
@@ -128,8 +131,8 @@ struct PacketOut {
     uint8_t*        encrypt_data;   // 加密后数据指针
     PacketOutSlice  slices[PACKET_OUT_MAX_SLICES];
     BWPacketState*  bw_state;       // 带宽采样状态指针
-    // TODO(next): 为 MSG_ZEROCOPY 增加发送完成跟踪字段（cookie/完成状态/完成区间），
-    // 并与 attempts/重传状态联合决定回收时机。
+    // NOTE MSG_ZEROCOPY 发送后内核直接引用发送缓冲, 完成通知到达前不可改写(改包号/重新加密)或释放
+    uint16_t          zc_pending;   // 尚未收到完成通知的零拷贝发送次数
     PacketOutAttempt* attempts_head;
     PacketOutAttempt* attempts_tail;
     uint16_t          attempts_count;
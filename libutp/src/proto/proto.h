@@ -23,6 +23,7 @@
 #define UTP_TYPE_0RTT             0x03  // 0-RTT Data
 #define UTP_TYPE_CONNECTION_CLOSE 0x04  // Connection Close
 #define UTP_TYPE_CTRL             0x05  // Control Frame
+#define UTP_TYPE_RETRY            0x06  // Stateless Retry
 
 #define UTP_DEFAULT_ACK_THRESHOLD     5   // 每5个包发一次 ACK
 #define UTP_DEFAULT_MAX_ACK_DELAY_MS  25  // 最大延迟 25ms
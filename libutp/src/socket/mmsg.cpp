@@ -10,7 +10,8 @@
 namespace eular {
 namespace utp {
 
-static constexpr size_t MSG_CTRL_SIZE = CMSG_SPACE(sizeof(in6_pktinfo));
+// pktinfo + UDP_GRO 段大小 + IP_TOS/IPV6_TCLASS
+static constexpr size_t MSG_CTRL_SIZE = CMSG_SPACE(sizeof(in6_pktinfo)) + CMSG_SPACE(sizeof(int32_t)) * 2;
 
 MultipleMsg::MultipleMsg(uint32_t size, uint32_t mss) :
     m_nMsg(size),
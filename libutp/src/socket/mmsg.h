@@ -19,6 +19,15 @@
 #define MAX_MMSG_SIZE  32
 #endif
 
+// UDP GRO 模式下每个槽位可容纳一个合并后的超大数据报, 槽位数相应减少
+#ifndef MAX_GRO_MMSG_SIZE
+#define MAX_GRO_MMSG_SIZE  8
+#endif
+
+#ifndef GRO_SLOT_SIZE
+#define GRO_SLOT_SIZE  (64 * 1024)
+#endif
+
 namespace eular {
 namespace utp {
 class MultipleMsg
@@ -13,10 +13,19 @@
 namespace eular {
 namespace utp {
 
+/// @brief IP 头 ECN 字段的码点 (RFC 3168)
+enum EcnCodepoint : uint8_t {
+    kEcnNotEct  = 0x00,
+    kEcnEct1    = 0x01,
+    kEcnEct0    = 0x02,
+    kEcnCe      = 0x03,
+};
+
 struct PacketMetaInfo {
     int32_t         fd;
     Address         localAddress;
     Address         peerAddress;
+    uint8_t         ecn{0};         // 接收时 IP 头中的 ECN 码点 (TOS/Traffic Class 低 2 位)
 };
 
 
@@ -7,8 +7,10 @@
 
 #include "socket/udp.h"
 
+#include <algorithm>
 #include <array>
 #include <chrono>
+#include <cstdlib>
 #include <cstring>
 #include <stdexcept>
 #include <mutex>
@@ -16,7 +18,10 @@
 
 #include <utils/string8.h>
 
+#include "crypto/aes_gcm_context.h"
 #include "util/error.h"
+#include "util/mm.h"
+#include "mtu/mtu.h"
 #include "socket/util.h"
 #include "utp/config.h"
 #include "logger/logger.h"
@@ -26,7 +31,8 @@ namespace eular {
 namespace utp {
 UdpSocket::UdpSocket(Config &config) :
 #if defined(USE_SENDMMSG)
-    m_mmsg(MAX_MMSG_SIZE, UTP_ETHERNET_MTU - IPV4_HEADER_SIZE - UDP_HEADER_SIZE),
+    m_mmsg(config.enable_gro ? MAX_GRO_MMSG_SIZE : MAX_MMSG_SIZE,
+           config.enable_gro ? GRO_SLOT_SIZE : MtuDiscovery::MaxRecvPayloadSize(&config)),
 #endif
     m_config(config)
 {
@@ -35,7 +41,7 @@ UdpSocket::UdpSocket(Config &config) :
         throw std::runtime_error("UdpSocket: mmsg init failed");
     }
 #endif
-    m_recvBuffer.reserve(UTP_ETHERNET_MTU);
+    m_recvBuffer.reserve(MtuDiscovery::MaxRecvPayloadSize(&config));
 }
 
 UdpSocket::~UdpSocket()
@@ -44,6 +50,14 @@ UdpSocket::~UdpSocket()
         Socket::Close(m_sock);
         m_sock = INVALID_SOCKET;
     }
+
+    // 关闭后不会再有完成通知, 接管的缓冲在此回收
+    for (auto it = m_zcPins.begin(); it != m_zcPins.end(); ++it) {
+        if (it->orphan != nullptr) {
+            releaseOrphan(it->orphan);
+            it->orphan = nullptr;
+        }
+    }
 }
 
 void UdpSocket::updateTag(const std::string &tag)
@@ -53,7 +67,22 @@ void UdpSocket::updateTag(const std::string &tag)
 
 namespace {
 
-int32_t SendSingleMsgImpl(UdpSocket &sock, const UdpSocket::MsgMetaInfo &msg, Status &status)
+#if defined(USE_SENDMMSG)
+size_t GetGroSegmentSize(const msghdr &hdr)
+{
+    for (const cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(const_cast<msghdr *>(&hdr), const_cast<cmsghdr *>(cmsg))) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+            int32_t segSize = 0;
+            std::memcpy(&segSize, CMSG_DATA(cmsg), sizeof(segSize));
+            return segSize > 0 ? static_cast<size_t>(segSize) : 0;
+        }
+    }
+    return 0;
+}
+#endif
+
+int32_t SendSingleMsgImpl(UdpSocket &sock, const UdpSocket::MsgMetaInfo &msg, bool &zeroCopy, Status &status)
 {
     if (!sock.isValid()) {
         status = Status::Error(UTP_ERR_SOCKET_WRITE, fmt::format("{} send failed: socket invalid", sock.tag()));
@@ -76,6 +105,7 @@ int32_t SendSingleMsgImpl(UdpSocket &sock, const UdpSocket::MsgMetaInfo &msg, St
     }
 
 #if defined(OS_WINDOWS)
+    zeroCopy = false;
     int32_t wsaRet = 0;
     if (hasSlices) {
         WSABUF bufs[UdpSocket::kMaxMsgSlices] = {};
@@ -129,10 +159,24 @@ int32_t SendSingleMsgImpl(UdpSocket &sock, const UdpSocket::MsgMetaInfo &msg, St
     }
     return 1;
 #else
-    ssize_t nwritten = 0;
+    int32_t sendFlags = MSG_NOSIGNAL;
+#if defined(OS_LINUX)
+    if (zeroCopy) {
+        sendFlags |= MSG_ZEROCOPY;
+    }
+#else
+    zeroCopy = false;
+#endif
+
+#if defined(OS_LINUX)
+    const bool txTime = sock.txTimeEnabled() && msg.txtime_ns != 0;
+#else
+    const bool txTime = false;
+#endif
+
+    struct iovec iov[UdpSocket::kMaxMsgSlices] = {};
+    size_t iovCount = 0;
     if (hasSlices) {
-        struct iovec iov[UdpSocket::kMaxMsgSlices] = {};
-        size_t iovCount = 0;
         for (uint8_t i = 0; i < msg.slice_count && i < UdpSocket::kMaxMsgSlices; ++i) {
             if (msg.slices[i].data == nullptr || msg.slices[i].len == 0) {
                 continue;
@@ -145,21 +189,57 @@ int32_t SendSingleMsgImpl(UdpSocket &sock, const UdpSocket::MsgMetaInfo &msg, St
         if (iovCount == 0) {
             return 0;
         }
+    } else if (txTime) {
+        iov[0].iov_base = const_cast<void *>(msg.data);
+        iov[0].iov_len = msg.len;
+        iovCount = 1;
+    }
 
-        struct msghdr sndmsg;
-        std::memset(&sndmsg, 0, sizeof(sndmsg));
-        sndmsg.msg_name = &remoteStorage;
-        sndmsg.msg_namelen = remoteLen;
-        sndmsg.msg_iov = iov;
-        sndmsg.msg_iovlen = iovCount;
-        nwritten = ::sendmsg(sock.fd(), &sndmsg, MSG_NOSIGNAL);
-    } else {
-        nwritten = ::sendto(sock.fd(),
-                            msg.data,
-                            msg.len,
-                            MSG_NOSIGNAL,
-                            reinterpret_cast<sockaddr *>(&remoteStorage),
-                            remoteLen);
+    auto sendOnce = [&](int32_t flags) -> ssize_t {
+        if (hasSlices || txTime) {
+            struct msghdr sndmsg;
+            std::memset(&sndmsg, 0, sizeof(sndmsg));
+            sndmsg.msg_name = &remoteStorage;
+            sndmsg.msg_namelen = remoteLen;
+            sndmsg.msg_iov = iov;
+            sndmsg.msg_iovlen = iovCount;
+#if defined(OS_LINUX)
+            union {
+                char            buf[CMSG_SPACE(sizeof(uint64_t))];
+                struct cmsghdr  align;
+            } txTimeCtrl;
+            if (txTime) {
+                std::memset(txTimeCtrl.buf, 0, sizeof(txTimeCtrl.buf));
+                sndmsg.msg_control = txTimeCtrl.buf;
+                sndmsg.msg_controllen = sizeof(txTimeCtrl.buf);
+                struct cmsghdr *cm = CMSG_FIRSTHDR(&sndmsg);
+                cm->cmsg_level = SOL_SOCKET;
+                cm->cmsg_type = SCM_TXTIME;
+                cm->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+                std::memcpy(CMSG_DATA(cm), &msg.txtime_ns, sizeof(uint64_t));
+            }
+#endif
+            return ::sendmsg(sock.fd(), &sndmsg, flags);
+        }
+        return ::sendto(sock.fd(),
+                        msg.data,
+                        msg.len,
+                        flags,
+                        reinterpret_cast<sockaddr *>(&remoteStorage),
+                        remoteLen);
+    };
+
+    ssize_t nwritten = sendOnce(sendFlags);
+#if defined(OS_LINUX)
+    // NOTE optmem 不足以记录零拷贝引用时返回 ENOBUFS, 回退为普通拷贝发送
+    if (nwritten < 0 && zeroCopy && GetSystemLastError() == ENOBUFS) {
+        zeroCopy = false;
+        sendFlags &= ~MSG_ZEROCOPY;
+        nwritten = sendOnce(sendFlags);
+    }
+#endif
+    if (nwritten < 0) {
+        zeroCopy = false;
     }
 
 #if defined(UTP_ENABLE_FAULT_INJECTION)
@@ -259,6 +339,64 @@ Status UdpSocket::bind(const std::string &ip, uint16_t port, const std::string &
         st = Socket::Ioctl::SetNoSigPipe(m_sock);
         if (!st.ok()) break;
 
+        // NOTE 零拷贝不可用(内核过旧/非 Linux)时不影响绑定, 回退为普通发送
+        m_zcEnabled = false;
+        if (m_config.enable_zerocopy) {
+            Status zcStatus = Socket::Ioctl::SetZeroCopy(m_sock);
+            if (zcStatus.ok()) {
+                m_zcEnabled = true;
+            } else {
+                UTP_LOGW("%s MSG_ZEROCOPY disabled: %s", m_tag.c_str(), zcStatus.message());
+            }
+        }
+
+        // NOTE SO_TXTIME 不可用时不影响绑定, 由用户态 Pacer 控制发送节奏
+        m_txTimeEnabled = false;
+        if (m_config.enable_txtime) {
+            Status txTimeStatus = Socket::Ioctl::SetTxTime(m_sock);
+            if (txTimeStatus.ok()) {
+                m_txTimeEnabled = true;
+            } else {
+                UTP_LOGW("%s SO_TXTIME disabled: %s", m_tag.c_str(), txTimeStatus.message());
+            }
+        }
+
+        // NOTE ECN 不可用时不影响绑定, 数据报不带 ECT 标记, 拥塞控制只响应丢包
+        m_ecnEnabled = false;
+        if (m_config.enable_ecn) {
+            Status ecnStatus = Socket::Ioctl::SetEcn(m_sock, address.family());
+            if (ecnStatus.ok()) {
+                m_ecnEnabled = true;
+            } else {
+                UTP_LOGW("%s ECN disabled: %s", m_tag.c_str(), ecnStatus.message());
+            }
+        }
+
+        // NOTE 以 gso_size=0 探测内核是否支持 UDP_SEGMENT(4.18+), 实际段大小通过 cmsg 逐次指定
+        m_gsoEnabled = false;
+#if defined(USE_SENDMMSG)
+        if (m_config.enable_gso) {
+            Status gsoStatus = Socket::Ioctl::SetUdpSegment(m_sock, 0);
+            if (gsoStatus.ok()) {
+                m_gsoEnabled = true;
+            } else {
+                UTP_LOGW("%s UDP GSO disabled: %s", m_tag.c_str(), gsoStatus.message());
+            }
+        }
+
+        m_groEnabled = false;
+        if (m_config.enable_gro) {
+            Status groStatus = Socket::Ioctl::SetUdpGro(m_sock);
+            if (groStatus.ok()) {
+                m_groEnabled = true;
+            } else {
+                // 内核不支持 GRO 时槽位退回 MSS 大小, 避免空占 64 KiB 缓冲
+                UTP_LOGW("%s UDP GRO disabled: %s", m_tag.c_str(), groStatus.message());
+                m_mmsg.resize(MAX_MMSG_SIZE, MtuDiscovery::MaxRecvPayloadSize(&m_config));
+            }
+        }
+#endif
+
         st = Socket::Bind(m_sock, address);
         if (!st.ok()) break;
 
@@ -311,18 +449,29 @@ int32_t UdpSocket::recvErrorMsg(ErrorMsg &errMsg, Status &status)
 
     errMsg.data = m_recvBuffer.data();
     errMsg.len = static_cast<size_t>(nreads);
-    errMsg.peer_addr.fromSockAddr((struct sockaddr *)&remoteAddr, addrLen);
+    errMsg.peer_addr.fromSockAddr((struct sockaddr *)&remoteAddr, msg.msg_namelen);
     for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
-        if (cmsg->cmsg_type != IP_RECVERR) {
-            continue;
-        }
-        if (cmsg->cmsg_level != SOL_IP) {
+        const bool isIPv4Err = cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR;
+        const bool isIPv6Err = cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR;
+        if (!isIPv4Err && !isIPv6Err) {
             continue;
         }
         struct sock_extended_err *err = (struct sock_extended_err *)CMSG_DATA(cmsg);
         if (err == NULL) {
             continue;
         }
+        // NOTE 零拷贝完成通知: [ee_info, ee_data] 为完成的发送序号闭区间
+        if (err->ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+            const uint32_t released = releaseZeroCopy(err->ee_info, err->ee_data);
+            errMsg.zc_completed += released;
+            if (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                errMsg.zc_copied += released;
+            }
+            continue;
+        }
+        if (!isIPv4Err) {
+            continue;
+        }
         if (err->ee_origin != SO_EE_ORIGIN_ICMP && err->ee_origin != SO_EE_ORIGIN_ICMP6) {
             continue;
         }
@@ -343,6 +492,8 @@ int32_t UdpSocket::recvErrorMsg(ErrorMsg &errMsg, Status &status)
 int32_t UdpSocket::recv(std::vector<MsgMetaInfo> &msgVec, Status &status)
 {
 #if defined(USE_SENDMMSG)
+    // NOTE recvmmsg 会改写 msg_namelen/msg_controllen, 每次接收前需还原
+    m_mmsg.reset();
     int32_t n = ::recvmmsg(m_sock, m_mmsg.mmsghdrAt(0), m_mmsg.size(), 0, nullptr);
     if (n < 0) {
         int32_t code = GetSystemLastError();
@@ -364,26 +515,55 @@ int32_t UdpSocket::recv(std::vector<MsgMetaInfo> &msgVec, Status &status)
     if (msgVec.size() < static_cast<size_t>(n)) {
         msgVec.resize(static_cast<size_t>(n));
     }
+
+    size_t count = 0;
     for (int32_t i = 0; i < n; ++i) {
-        MsgMetaInfo &rmsg = msgVec[i];
-        rmsg.len = m_mmsg.mmsghdrAt(i)->msg_len;
-        rmsg.data = m_mmsg.dataAt(i);
-        rmsg.slice_count = 0;
-        rmsg.metaInfo.fd = m_sock;
-        rmsg.metaInfo.localAddress = Socket::Util::GetIPPktInfo(m_mmsg.mmsghdrAt(i)->msg_hdr, m_bindAddr.family());
-        if (!rmsg.metaInfo.localAddress.isValid()) {
-            rmsg.metaInfo.localAddress = *pointer;
+        const msghdr &hdr = m_mmsg.mmsghdrAt(i)->msg_hdr;
+        const size_t  totalLen = m_mmsg.mmsghdrAt(i)->msg_len;
+        size_t        segSize = m_groEnabled ? GetGroSegmentSize(hdr) : 0;
+        if (segSize == 0 || segSize >= totalLen) {
+            segSize = totalLen;
+        }
+
+        // NOTE GRO 合并的数据报按段大小切分为多条消息, 仅引用槽位内的数据, 不拷贝
+        const size_t segments = totalLen == 0 ? 1 : (totalLen + segSize - 1) / segSize;
+        if (msgVec.size() < count + segments) {
+            msgVec.resize(count + segments + static_cast<size_t>(n - i - 1));
+        }
+
+        Address localAddress = Socket::Util::GetIPPktInfo(hdr, m_bindAddr.family());
+        if (!localAddress.isValid()) {
+            localAddress = *pointer;
+        }
+        Address peerAddress;
+        peerAddress.fromSockAddr(m_mmsg.sockaddrAt(i), hdr.msg_namelen);
+        const uint8_t ecn = m_ecnEnabled ? Socket::Util::GetEcnCodepoint(hdr) : 0;
+
+        const char *data = m_mmsg.dataAt(i);
+        for (size_t k = 0; k < segments; ++k) {
+            const size_t offset = k * segSize;
+            MsgMetaInfo &rmsg = msgVec[count++];
+            rmsg.data = data + offset;
+            rmsg.len = std::min(segSize, totalLen - offset);
+            rmsg.slice_count = 0;
+            rmsg.metaInfo.fd = m_sock;
+            rmsg.metaInfo.localAddress = localAddress;
+            rmsg.metaInfo.peerAddress = peerAddress;
+            rmsg.metaInfo.ecn = ecn;
+        }
+        if (segments > 1) {
+            ++m_groBatches;
+            m_groSegments += segments;
         }
-        rmsg.metaInfo.peerAddress.fromSockAddr(m_mmsg.sockaddrAt(i), m_mmsg.mmsghdrAt(i)->msg_hdr.msg_namelen);
     }
 
-    return n;
+    return static_cast<int32_t>(count);
 #else
 
 #if defined(OS_LINUX) || defined(OS_APPLE)
     sockaddr_storage remoteAddr;
     socket_t addrLen = sizeof(remoteAddr);
-    char cmsgbuf[CMSG_SPACE(sizeof(in6_pktinfo))] = {0};
+    char cmsgbuf[CMSG_SPACE(sizeof(in6_pktinfo)) + CMSG_SPACE(sizeof(int32_t))] = {0};
     struct msghdr msg;
     struct iovec iov;
     iov.iov_base = m_recvBuffer.data();
@@ -470,6 +650,7 @@ int32_t UdpSocket::recv(std::vector<MsgMetaInfo> &msgVec, Status &status)
         rmsg.metaInfo.localAddress = *pointer;
     }
     rmsg.metaInfo.peerAddress.fromSockAddr((struct sockaddr *)&remoteAddr, addrLen);
+    rmsg.metaInfo.ecn = m_ecnEnabled ? Socket::Util::GetEcnCodepoint(msg) : 0;
 
     return 1;
 #endif // defined(USE_SENDMMSG)
@@ -477,11 +658,28 @@ int32_t UdpSocket::recv(std::vector<MsgMetaInfo> &msgVec, Status &status)
 
 int32_t UdpSocket::send(const MsgMetaInfo &msg, Status &status)
 {
-    return SendSingleMsgImpl(*this, msg, status);
+    if (m_sendHook) {
+        return send(&msg, 1, status);
+    }
+
+    bool zeroCopy = shouldZeroCopy(msg);
+    const int32_t ret = SendSingleMsgImpl(*this, msg, zeroCopy, status);
+    if (zeroCopy) {
+        pinZeroCopy(msg, m_zcNextSeq++);
+    }
+    return ret;
 }
 
 int32_t UdpSocket::send(const MsgMetaInfo *msgVec, size_t count, Status &status)
 {
+    if (m_sendHook) {
+        // 数据报交给回调后即视为发出, 不固定零拷贝引用
+        for (size_t i = 0; i < count; ++i) {
+            m_sendHook(msgVec[i]);
+        }
+        return static_cast<int32_t>(count);
+    }
+
     if (!isValid()) {
         status = Status::Error(UTP_ERR_SOCKET_WRITE, fmt::format("{} send failed: socket invalid", tag()));
         return -1;
@@ -493,30 +691,48 @@ int32_t UdpSocket::send(const MsgMetaInfo *msgVec, size_t count, Status &status)
 
 #if defined(USE_SENDMMSG) && defined(OS_LINUX)
     if (count > 1) {
+        // 一个 mmsghdr 可携带多个等长消息(UDP_SEGMENT), 由内核/网卡按 gso_size 切分
+        struct GsoGroup {
+            size_t first;       // 组内首条消息下标(相对 base)
+            size_t segments;    // 组内消息数
+            size_t segSize;     // 段大小, 即首条消息长度
+            size_t bytes;       // 组内总字节数
+            bool   closed;      // 最后一段短于 segSize 后不可再追加
+        };
+        union GsoCtrl {
+            char            buf[CMSG_SPACE(sizeof(uint16_t)) + CMSG_SPACE(sizeof(uint64_t))];
+            struct cmsghdr  align;
+        };
+
         int32_t sentCount = 0;
         for (size_t base = 0; base < count;) {
             const size_t batchCount = std::min<size_t>(static_cast<size_t>(MAX_MMSG_SIZE), count - base);
-            std::array<mmsghdr, MAX_MMSG_SIZE>                         mmsg;
-            std::array<sockaddr_storage, MAX_MMSG_SIZE>                remoteStorage;
-            std::array<std::array<struct iovec, kMaxMsgSlices>, MAX_MMSG_SIZE> iovecs;
-
+            std::array<mmsghdr, MAX_MMSG_SIZE>                      mmsg;
+            std::array<sockaddr_storage, MAX_MMSG_SIZE>             remoteStorage;
+            std::array<struct iovec, MAX_MMSG_SIZE * kMaxMsgSlices> iovecs;
+            std::array<GsoGroup, MAX_MMSG_SIZE>                     groups;
+            std::array<GsoCtrl, MAX_MMSG_SIZE>                      gsoCtrl;
+
+            // NOTE sendmmsg 的 flags 作用于整批, 只将零拷贝资格一致的连续消息放在同一批
+            const bool zeroCopy = shouldZeroCopy(msgVec[base]);
+            const bool useGso = m_gsoEnabled;
             size_t preparedCount = 0;
+            size_t hdrCount = 0;
+            size_t iovUsed = 0;
             bool   invalidMsg = false;
             for (; preparedCount < batchCount; ++preparedCount) {
                 const MsgMetaInfo &msg = msgVec[base + preparedCount];
-                if (!msg.metaInfo.peerAddress.isValid()) {
-                    invalidMsg = true;
+                if (preparedCount > 0 && shouldZeroCopy(msg) != zeroCopy) {
                     break;
                 }
-
-                socklen_t remoteLen = msg.metaInfo.peerAddress.toSockAddr(remoteStorage[preparedCount]);
-                if (remoteLen == 0) {
+                if (!msg.metaInfo.peerAddress.isValid()) {
                     invalidMsg = true;
                     break;
                 }
 
-                struct iovec *iov = iovecs[preparedCount].data();
+                struct iovec *iov = &iovecs[iovUsed];
                 size_t        iovCount = 0;
+                size_t        msgLen = 0;
                 if (msg.slice_count > 0) {
                     for (uint8_t i = 0; i < msg.slice_count && i < kMaxMsgSlices; ++i) {
                         if (msg.slices[i].data == nullptr || msg.slices[i].len == 0) {
@@ -524,11 +740,13 @@ int32_t UdpSocket::send(const MsgMetaInfo *msgVec, size_t count, Status &status)
                         }
                         iov[iovCount].iov_base = const_cast<void *>(msg.slices[i].data);
                         iov[iovCount].iov_len = msg.slices[i].len;
+                        msgLen += msg.slices[i].len;
                         ++iovCount;
                     }
                 } else if (msg.data != nullptr && msg.len > 0) {
                     iov[0].iov_base = const_cast<void *>(msg.data);
                     iov[0].iov_len = msg.len;
+                    msgLen = msg.len;
                     iovCount = 1;
                 }
 
@@ -536,15 +754,45 @@ int32_t UdpSocket::send(const MsgMetaInfo *msgVec, size_t count, Status &status)
                     invalidMsg = true;
                     break;
                 }
+                iovUsed += iovCount;
+
+                if (useGso && hdrCount > 0) {
+                    GsoGroup &group = groups[hdrCount - 1];
+                    const MsgMetaInfo &head = msgVec[base + group.first];
+                    if (!group.closed && msgLen <= group.segSize &&
+                        group.segments < kGsoMaxSegments && group.bytes + msgLen <= kGsoMaxBytes &&
+                        msg.txtime_ns == head.txtime_ns &&
+                        msg.metaInfo.peerAddress == head.metaInfo.peerAddress) {
+                        mmsg[hdrCount - 1].msg_hdr.msg_iovlen += iovCount;
+                        ++group.segments;
+                        group.bytes += msgLen;
+                        group.closed = msgLen < group.segSize;
+                        continue;
+                    }
+                }
 
-                mmsg[preparedCount].msg_hdr.msg_name = &remoteStorage[preparedCount];
-                mmsg[preparedCount].msg_hdr.msg_namelen = remoteLen;
-                mmsg[preparedCount].msg_hdr.msg_iov = iov;
-                mmsg[preparedCount].msg_hdr.msg_iovlen = iovCount;
-                mmsg[preparedCount].msg_hdr.msg_control = nullptr;
-                mmsg[preparedCount].msg_hdr.msg_controllen = 0;
-                mmsg[preparedCount].msg_hdr.msg_flags = 0;
-                mmsg[preparedCount].msg_len = 0;
+                socklen_t remoteLen = msg.metaInfo.peerAddress.toSockAddr(remoteStorage[hdrCount]);
+                if (remoteLen == 0) {
+                    invalidMsg = true;
+                    break;
+                }
+
+                GsoGroup &group = groups[hdrCount];
+                group.first = preparedCount;
+                group.segments = 1;
+                group.segSize = msgLen;
+                group.bytes = msgLen;
+                group.closed = false;
+
+                mmsg[hdrCount].msg_hdr.msg_name = &remoteStorage[hdrCount];
+                mmsg[hdrCount].msg_hdr.msg_namelen = remoteLen;
+                mmsg[hdrCount].msg_hdr.msg_iov = iov;
+                mmsg[hdrCount].msg_hdr.msg_iovlen = iovCount;
+                mmsg[hdrCount].msg_hdr.msg_control = nullptr;
+                mmsg[hdrCount].msg_hdr.msg_controllen = 0;
+                mmsg[hdrCount].msg_hdr.msg_flags = 0;
+                mmsg[hdrCount].msg_len = 0;
+                ++hdrCount;
             }
 
             if (preparedCount == 0) {
@@ -555,7 +803,51 @@ int32_t UdpSocket::send(const MsgMetaInfo *msgVec, size_t count, Status &status)
                 return sentCount;
             }
 
-            int32_t ret = ::sendmmsg(m_sock, mmsg.data(), static_cast<unsigned int>(preparedCount), MSG_NOSIGNAL);
+            bool hasGso = false;
+            for (size_t h = 0; h < hdrCount; ++h) {
+                const bool segmented = groups[h].segments >= 2;
+                const uint64_t txtimeNs = m_txTimeEnabled ? msgVec[base + groups[h].first].txtime_ns : 0;
+                if (!segmented && txtimeNs == 0) {
+                    continue;
+                }
+                std::memset(gsoCtrl[h].buf, 0, sizeof(gsoCtrl[h].buf));
+                mmsg[h].msg_hdr.msg_control = gsoCtrl[h].buf;
+                mmsg[h].msg_hdr.msg_controllen = sizeof(gsoCtrl[h].buf);
+                struct cmsghdr *cm = CMSG_FIRSTHDR(&mmsg[h].msg_hdr);
+                size_t ctrlLen = 0;
+                if (segmented) {
+                    cm->cmsg_level = SOL_UDP;
+                    cm->cmsg_type = UDP_SEGMENT;
+                    cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                    const uint16_t segSize = static_cast<uint16_t>(groups[h].segSize);
+                    std::memcpy(CMSG_DATA(cm), &segSize, sizeof(segSize));
+                    ctrlLen += CMSG_SPACE(sizeof(uint16_t));
+                    cm = CMSG_NXTHDR(&mmsg[h].msg_hdr, cm);
+                    hasGso = true;
+                }
+                if (txtimeNs != 0) {
+                    // 整个 GSO 组共用首条消息的发送时间, 组内消息的 txtime_ns 相同
+                    cm->cmsg_level = SOL_SOCKET;
+                    cm->cmsg_type = SCM_TXTIME;
+                    cm->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+                    std::memcpy(CMSG_DATA(cm), &txtimeNs, sizeof(txtimeNs));
+                    ctrlLen += CMSG_SPACE(sizeof(uint64_t));
+                }
+                mmsg[h].msg_hdr.msg_controllen = ctrlLen;
+            }
+
+            int32_t flags = MSG_NOSIGNAL | (zeroCopy ? MSG_ZEROCOPY : 0);
+            int32_t ret = ::sendmmsg(m_sock, mmsg.data(), static_cast<unsigned int>(hdrCount), flags);
+            if (ret < 0 && zeroCopy && GetSystemLastError() == ENOBUFS) {
+                flags &= ~MSG_ZEROCOPY;
+                ret = ::sendmmsg(m_sock, mmsg.data(), static_cast<unsigned int>(hdrCount), flags);
+            }
+            if (ret < 0 && hasGso && GetSystemLastError() == EIO) {
+                // NOTE 网卡不支持校验和卸载时 GSO 发送返回 EIO, 关闭 GSO 后按普通批量重发
+                UTP_LOGW("%s UDP GSO disabled: sendmmsg returned EIO", m_tag.c_str());
+                m_gsoEnabled = false;
+                continue;
+            }
             if (ret < 0) {
                 int32_t code = GetSystemLastError();
                 if (code == EAGAIN || code == EWOULDBLOCK) {
@@ -571,8 +863,25 @@ int32_t UdpSocket::send(const MsgMetaInfo *msgVec, size_t count, Status &status)
                 return sentCount > 0 ? sentCount : -1;
             }
 
-            sentCount += ret;
-            if (ret < static_cast<int32_t>(preparedCount)) {
+            size_t sentMsgs = 0;
+            for (int32_t h = 0; h < ret; ++h) {
+                const GsoGroup &group = groups[static_cast<size_t>(h)];
+                if ((flags & MSG_ZEROCOPY) != 0) {
+                    // 内核按 sendmsg 调用分配零拷贝序号, 同组消息共享一个序号
+                    const uint32_t seq = m_zcNextSeq++;
+                    for (size_t i = 0; i < group.segments; ++i) {
+                        pinZeroCopy(msgVec[base + group.first + i], seq);
+                    }
+                }
+                if (group.segments > 1) {
+                    ++m_gsoBatches;
+                    m_gsoSegments += group.segments;
+                }
+                sentMsgs += group.segments;
+            }
+
+            sentCount += static_cast<int32_t>(sentMsgs);
+            if (ret < static_cast<int32_t>(hdrCount)) {
                 return sentCount;
             }
 
@@ -585,7 +894,7 @@ int32_t UdpSocket::send(const MsgMetaInfo *msgVec, size_t count, Status &status)
 
     int32_t sentCount = 0;
     for (size_t i = 0; i < count; ++i) {
-        const int32_t ret = SendSingleMsgImpl(*this, msgVec[i], status);
+        const int32_t ret = send(msgVec[i], status);
         if (ret > 0) {
             ++sentCount;
             continue;
@@ -606,5 +915,104 @@ int32_t UdpSocket::send(const std::vector<MsgMetaInfo> &msgVec, Status &status)
     return send(msgVec.data(), msgVec.size(), status);
 }
 
+bool UdpSocket::adoptZeroCopy(PacketOut *pkt)
+{
+    if (pkt == nullptr || !pkt->zeroCopyPinned()) {
+        return false;
+    }
+
+    ZeroCopyOrphan *orphan = nullptr;
+    for (auto it = m_zcPins.begin(); it != m_zcPins.end(); ++it) {
+        if (it->done || it->packet != pkt) {
+            continue;
+        }
+        if (orphan == nullptr) {
+            orphan = new ZeroCopyOrphan();
+            orphan->raw_data = pkt->raw_data;
+            orphan->encrypt_data = pkt->encrypt_data != pkt->raw_data ? pkt->encrypt_data : nullptr;
+            orphan->encrypt_data_size = pkt->encrypt_data_size;
+            orphan->refs = 0;
+            ++m_zcOrphanCount;
+        }
+        ++orphan->refs;
+        it->packet = nullptr;
+        it->owner = nullptr;
+        it->orphan = orphan;
+    }
+
+    return orphan != nullptr;
+}
+
+void UdpSocket::releaseOrphan(ZeroCopyOrphan *orphan)
+{
+    if (--orphan->refs != 0) {
+        return;
+    }
+
+    std::free(orphan->raw_data);
+    AesGcmContext::ReleaseEncryptBuffer(orphan->encrypt_data, orphan->encrypt_data_size);
+    delete orphan;
+    --m_zcOrphanCount;
+}
+
+void UdpSocket::dropZeroCopyOwner(const MemoryManager *owner)
+{
+    for (auto it = m_zcPins.begin(); it != m_zcPins.end(); ++it) {
+        if (it->owner == owner) {
+            it->packet = nullptr;
+            it->owner = nullptr;
+        }
+    }
+}
+
+bool UdpSocket::shouldZeroCopy(const MsgMetaInfo &msg) const
+{
+    // NOTE 仅对连续缓冲生效; slice 可能引用流发送缓冲, 生命周期不受 PacketOut 约束
+    return m_zcEnabled && msg.zc_packet != nullptr && msg.zc_owner != nullptr
+        && msg.slice_count == 0 && msg.len >= m_config.zerocopy_min_bytes;
+}
+
+void UdpSocket::pinZeroCopy(const MsgMetaInfo &msg, uint32_t seq)
+{
+    ZeroCopyPin pin;
+    pin.seq = seq;
+    pin.done = false;
+    pin.packet = msg.zc_packet;
+    pin.owner = msg.zc_owner;
+    pin.orphan = nullptr;
+    if (pin.packet != nullptr) {
+        ++pin.packet->zc_pending;
+    }
+    m_zcPins.push_back(pin);
+}
+
+uint32_t UdpSocket::releaseZeroCopy(uint32_t lo, uint32_t hi)
+{
+    // NOTE pin 按 seq 非递减排列(GSO 同组共享 seq), 序号按 uint32 回绕比较
+    uint32_t released = 0;
+    for (auto it = m_zcPins.begin(); it != m_zcPins.end(); ++it) {
+        if (static_cast<int32_t>(it->seq - hi) > 0) {
+            break;
+        }
+        if (it->done || static_cast<int32_t>(it->seq - lo) < 0) {
+            continue;
+        }
+        if (it->orphan != nullptr) {
+            releaseOrphan(it->orphan);
+            it->orphan = nullptr;
+        } else if (it->owner != nullptr) {
+            it->owner->releaseZeroCopy(it->packet);
+        }
+        it->done = true;
+        ++released;
+    }
+
+    // 完成通知通常按序到达, 从队首回收已完成的记录
+    while (!m_zcPins.empty() && m_zcPins.front().done) {
+        m_zcPins.pop_front();
+    }
+    return released;
+}
+
 } // namespace utp
 } // namespace eular
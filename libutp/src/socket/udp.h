@@ -8,6 +8,8 @@
 #ifndef __UTP_SOCKET_UDP_H__
 #define __UTP_SOCKET_UDP_H__
 
+#include <deque>
+#include <functional>
 #include <vector>
 
 #include <utils/buffer.h>
@@ -20,10 +22,15 @@
 
 namespace eular {
 namespace utp {
+struct PacketOut;
+class MemoryManager;
+
 class UdpSocket
 {
 public:
     static constexpr uint8_t kMaxMsgSlices = 4;
+    static constexpr size_t  kGsoMaxSegments = 64;      // 内核 UDP_MAX_SEGMENTS
+    static constexpr size_t  kGsoMaxBytes = 65535 - 40 - 8; // IPv6 头 + UDP 头
 
     struct MsgSlice {
         const void* data;
@@ -36,6 +43,9 @@ public:
         uint8_t         slice_count;
         MsgSlice        slices[kMaxMsgSlices];
         PacketMetaInfo  metaInfo;
+        PacketOut*      zc_packet = nullptr;    // 非空时允许零拷贝发送, 完成通知前该包保持 pin 住
+        MemoryManager*  zc_owner = nullptr;     // zc_packet 所属的内存管理器
+        uint64_t        txtime_ns = 0;          // 最早发送时间 (CLOCK_MONOTONIC ns), 0 表示立即发送, 仅在 SO_TXTIME 启用时生效
     };
 
     struct ErrorMsg {
@@ -46,8 +56,14 @@ public:
         void*       data;
         size_t      len;
         Address     peer_addr;
+
+        uint32_t    zc_completed = 0;   // 本次通知完成的零拷贝发送数
+        uint32_t    zc_copied = 0;      // 其中被内核回退为拷贝发送的数量
     };
 
+    /// @brief 发送拦截回调, 设置后数据报不再写入套接字; 用于进程内网络仿真
+    using SendHook = std::function<void(const MsgMetaInfo &msg)>;
+
     UdpSocket(Config &config);
     ~UdpSocket();
 
@@ -55,28 +71,90 @@ public:
     void updateTag(const std::string& tag);
     const std::string& tag() const { return m_tag; }
     socket_t fd() const { return m_sock; }
+    const Address &localAddress() const { return m_localAddr; }
+    void setSendHook(const SendHook &hook) { m_sendHook = hook; }
 
 public:
     bool isValid() const { return m_sock != INVALID_SOCKET; }
+    bool zeroCopyEnabled() const { return m_zcEnabled; }
+    size_t zeroCopyPending() const { return m_zcPins.size(); }
+    size_t zeroCopyOrphaned() const { return m_zcOrphanCount; }
+    bool gsoEnabled() const { return m_gsoEnabled; }
+    uint64_t gsoBatches() const { return m_gsoBatches; }
+    uint64_t gsoSegments() const { return m_gsoSegments; }
+    bool groEnabled() const { return m_groEnabled; }
+    uint64_t groBatches() const { return m_groBatches; }
+    uint64_t groSegments() const { return m_groSegments; }
+    bool txTimeEnabled() const { return m_txTimeEnabled; }
+    bool ecnEnabled() const { return m_ecnEnabled; }
 
     Status bind(const std::string &ip, uint16_t port, const std::string &ifname);
 
+    /**
+     * @brief 读取错误队列, 包括 ICMP 错误与 MSG_ZEROCOPY 完成通知
+     *
+     * @param errMsg 错误信息, 零拷贝完成通知会在此处释放对应 PacketOut 的 pin
+     * @return int32_t 1 表示读取到一条消息, 0 表示队列为空, 小于0表示失败
+     */
     int32_t recvErrorMsg(ErrorMsg &errMsg, Status &status);
 
+    /**
+     * @brief 接管 pkt 仍被内核零拷贝引用的缓冲, 全部完成通知到达后释放
+     *
+     * @note 属主 MemoryManager 析构时调用; 返回 true 后 raw_data/encrypt_data 归 socket 所有,
+     *       属主只回收 PacketOut 对象本身
+     * @return pkt 有未完成的零拷贝发送并已接管时返回 true
+     */
+    bool adoptZeroCopy(PacketOut *pkt);
+
+    /**
+     * @brief 丢弃 owner 名下尚未完成的零拷贝引用, 在 owner 析构前调用
+     */
+    void dropZeroCopyOwner(const MemoryManager *owner);
+
     /**
      * @brief 读取数据
      *
+     * @note 启用 GRO 时, 内核合并的数据报会按 UDP_GRO 段大小切分为多条消息, 消息数据指向接收槽位,
+     *       在下一次 recv 前有效
      * @param msgVec 数据缓存
      * @return int32_t 返回读取到的数据包数量, 小于0表示失败, 等于0表示无数据
      */
     int32_t recv(std::vector<MsgMetaInfo>& msgVec, Status &status);
     int32_t send(const MsgMetaInfo &msg, Status &status);
-    int32_t send(const MsgMetaInfo *msgVec, size_t count, Status &status);
 
-    // TODO(next): 在 Linux 上增加 MSG_ZEROCOPY 发送与错误队列完成事件处理（SO_EE_ORIGIN_ZEROCOPY）。
-    // NOTE: 需要与 SendControl/PacketOut 生命周期联动，避免在 completion 前释放或改写缓冲。
+    /**
+     * @brief 批量发送
+     *
+     * @note 启用 GSO 时, 连续的同目的等长消息(最后一条可以更短)会合并为一次 UDP_SEGMENT 发送;
+     *       启用 SO_TXTIME 时只合并 txtime_ns 相同的消息, 每个 mmsghdr 携带一个 SCM_TXTIME
+     * @return int32_t 返回已发送的消息数量, 小于0表示失败
+     */
+    int32_t send(const MsgMetaInfo *msgVec, size_t count, Status &status);
     int32_t send(const std::vector<MsgMetaInfo> &msgVec, Status &status);
 
+private:
+    // 属主已析构但内核仍在引用的缓冲, 同一个包可能对应多个 pin, 全部完成后释放
+    struct ZeroCopyOrphan {
+        uint8_t*    raw_data;
+        uint8_t*    encrypt_data;
+        uint16_t    encrypt_data_size;
+        uint32_t    refs;
+    };
+
+    struct ZeroCopyPin {
+        uint32_t        seq;
+        bool            done;
+        PacketOut*      packet;
+        MemoryManager*  owner;
+        ZeroCopyOrphan* orphan;
+    };
+
+    bool     shouldZeroCopy(const MsgMetaInfo &msg) const;
+    void     pinZeroCopy(const MsgMetaInfo &msg, uint32_t seq);
+    uint32_t releaseZeroCopy(uint32_t lo, uint32_t hi);
+    void     releaseOrphan(ZeroCopyOrphan *orphan);
+
 private:
     socket_t        m_sock{INVALID_SOCKET};
     Address         m_bindAddr;
@@ -88,6 +166,23 @@ private:
 #endif
     ByteBuffer      m_recvBuffer;
     std::string     m_tag;
+
+    bool                    m_zcEnabled{false};
+    uint32_t                m_zcNextSeq{0};     // 与内核 per-socket 零拷贝计数保持一致
+    std::deque<ZeroCopyPin> m_zcPins;           // 按 seq 非递减排列
+    size_t                  m_zcOrphanCount{0}; // 已接管尚未释放的缓冲数
+
+    bool            m_gsoEnabled{false};
+    uint64_t        m_gsoBatches{0};    // 合并发送(>=2 段)的次数
+    uint64_t        m_gsoSegments{0};   // 合并发送的总段数
+
+    bool            m_groEnabled{false};
+    uint64_t        m_groBatches{0};    // 收到的合并数据报(>=2 段)数量
+    uint64_t        m_groSegments{0};   // 合并数据报切分出的总段数
+
+    bool            m_txTimeEnabled{false};
+    bool            m_ecnEnabled{false};    // 发送标记 ECT(0) 并读取接收报文的 ECN 码点
+    SendHook        m_sendHook;
 };
 
 } // namespace utp
@@ -231,6 +231,139 @@ Status Socket::Ioctl::SetNoSigPipe(socket_t sockfd)
 #endif
 }
 
+Status Socket::Ioctl::SetZeroCopy(socket_t sockfd, bool on)
+{
+#if defined(OS_LINUX)
+    int32_t flag = on ? 1 : 0;
+    int32_t ret = ::setsockopt(sockfd, SOL_SOCKET, SO_ZEROCOPY, &flag, sizeof(flag));
+    if (ret != 0) {
+        int32_t err = GetSystemLastError();
+        return Status::Error(UTP_ERR_SOCKET_IOCTL, fmt::format("setsockopt({}, SOL_SOCKET, SO_ZEROCOPY, {}) failed: [{}, {}].",
+                sockfd, on, err, GetSystemErrnoMsg(err)));
+    }
+    return Status::OK();
+#else
+    UNUSED(sockfd);
+    if (!on) {
+        return Status::OK();
+    }
+    return Status::ErrorLiteral(UTP_ERR_SOCKET_IOCTL, "SO_ZEROCOPY is not supported on this platform.");
+#endif
+}
+
+Status Socket::Ioctl::SetUdpSegment(socket_t sockfd, uint16_t gsoSize)
+{
+#if defined(OS_LINUX)
+    int32_t size = gsoSize;
+    int32_t ret = ::setsockopt(sockfd, SOL_UDP, UDP_SEGMENT, &size, sizeof(size));
+    if (ret != 0) {
+        int32_t err = GetSystemLastError();
+        return Status::Error(UTP_ERR_SOCKET_IOCTL, fmt::format("setsockopt({}, SOL_UDP, UDP_SEGMENT, {}) failed: [{}, {}].",
+                sockfd, gsoSize, err, GetSystemErrnoMsg(err)));
+    }
+    return Status::OK();
+#else
+    UNUSED(sockfd);
+    UNUSED(gsoSize);
+    return Status::ErrorLiteral(UTP_ERR_SOCKET_IOCTL, "UDP_SEGMENT is not supported on this platform.");
+#endif
+}
+
+Status Socket::Ioctl::SetUdpGro(socket_t sockfd, bool on)
+{
+#if defined(OS_LINUX)
+    int32_t flag = on ? 1 : 0;
+    int32_t ret = ::setsockopt(sockfd, SOL_UDP, UDP_GRO, &flag, sizeof(flag));
+    if (ret != 0) {
+        int32_t err = GetSystemLastError();
+        return Status::Error(UTP_ERR_SOCKET_IOCTL, fmt::format("setsockopt({}, SOL_UDP, UDP_GRO, {}) failed: [{}, {}].",
+                sockfd, on, err, GetSystemErrnoMsg(err)));
+    }
+    return Status::OK();
+#else
+    UNUSED(sockfd);
+    if (!on) {
+        return Status::OK();
+    }
+    return Status::ErrorLiteral(UTP_ERR_SOCKET_IOCTL, "UDP_GRO is not supported on this platform.");
+#endif
+}
+
+Status Socket::Ioctl::SetTxTime(socket_t sockfd, bool on)
+{
+#if defined(OS_LINUX)
+    // NOTE 内核没有关闭 SO_TXTIME 的途径, 新建的套接字默认关闭
+    if (!on) {
+        return Status::OK();
+    }
+
+    // 与 linux/net_tstamp.h 中 struct sock_txtime 布局一致; fq 只接受 CLOCK_MONOTONIC, 与 time::MonotonicUs 同源
+    struct {
+        clockid_t   clockid;
+        uint32_t    flags;
+    } txtime = {CLOCK_MONOTONIC, 0};
+    int32_t ret = ::setsockopt(sockfd, SOL_SOCKET, SO_TXTIME, &txtime, sizeof(txtime));
+    if (ret != 0) {
+        int32_t err = GetSystemLastError();
+        return Status::Error(UTP_ERR_SOCKET_IOCTL, fmt::format("setsockopt({}, SOL_SOCKET, SO_TXTIME, {}) failed: [{}, {}].",
+                sockfd, on, err, GetSystemErrnoMsg(err)));
+    }
+    return Status::OK();
+#else
+    UNUSED(sockfd);
+    if (!on) {
+        return Status::OK();
+    }
+    return Status::ErrorLiteral(UTP_ERR_SOCKET_IOCTL, "SO_TXTIME is not supported on this platform.");
+#endif
+}
+
+Status Socket::Ioctl::SetEcn(socket_t sockfd, int32_t family, bool on)
+{
+#if defined(OS_LINUX)
+    // NOTE 在 SetIPTos 的 DSCP CS5 基础上置 ECT(0), 套接字上发出的所有数据报都带 ECN 标记
+    int32_t tos = on ? (0xA0 | 0x02) : 0xA0;
+    int32_t ret = ::setsockopt(sockfd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos));
+    if (ret != 0) {
+        int32_t err = GetSystemLastError();
+        return Status::Error(UTP_ERR_SOCKET_IOCTL, fmt::format("setsockopt({}, IPPROTO_IP, IP_TOS, {:#x}) failed: [{}, {}].",
+                sockfd, tos, err, GetSystemErrnoMsg(err)));
+    }
+
+    int32_t enable = on ? 1 : 0;
+    ret = ::setsockopt(sockfd, IPPROTO_IP, IP_RECVTOS, &enable, sizeof(enable));
+    if (ret != 0) {
+        int32_t err = GetSystemLastError();
+        return Status::Error(UTP_ERR_SOCKET_IOCTL, fmt::format("setsockopt({}, IPPROTO_IP, IP_RECVTOS, {}) failed: [{}, {}].",
+                sockfd, on, err, GetSystemErrnoMsg(err)));
+    }
+
+    if (family == AF_INET6) {
+        ret = ::setsockopt(sockfd, IPPROTO_IPV6, IPV6_TCLASS, &tos, sizeof(tos));
+        if (ret != 0) {
+            int32_t err = GetSystemLastError();
+            return Status::Error(UTP_ERR_SOCKET_IOCTL, fmt::format("setsockopt({}, IPPROTO_IPV6, IPV6_TCLASS, {:#x}) failed: [{}, {}].",
+                    sockfd, tos, err, GetSystemErrnoMsg(err)));
+        }
+
+        ret = ::setsockopt(sockfd, IPPROTO_IPV6, IPV6_RECVTCLASS, &enable, sizeof(enable));
+        if (ret != 0) {
+            int32_t err = GetSystemLastError();
+            return Status::Error(UTP_ERR_SOCKET_IOCTL, fmt::format("setsockopt({}, IPPROTO_IPV6, IPV6_RECVTCLASS, {}) failed: [{}, {}].",
+                    sockfd, on, err, GetSystemErrnoMsg(err)));
+        }
+    }
+    return Status::OK();
+#else
+    UNUSED(sockfd);
+    UNUSED(family);
+    if (!on) {
+        return Status::OK();
+    }
+    return Status::ErrorLiteral(UTP_ERR_SOCKET_IOCTL, "ECN is not supported on this platform.");
+#endif
+}
+
 int32_t Socket::Ioctl::GetMtuByIfname(socket_t sockfd, const char *ifname, Status &status)
 {
     if (ifname == nullptr) {
@@ -418,6 +551,31 @@ Address Socket::Util::GetIPPktInfo(const msghdr_t &msg, uint16_t port)
 #endif
 }
 
+uint8_t Socket::Util::GetEcnCodepoint(const msghdr_t &msg)
+{
+#if defined(OS_LINUX)
+    if (msg.msg_controllen == 0 || msg.msg_control == nullptr) {
+        return 0;
+    }
+
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR((msghdr *)&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR((msghdr *)&msg, cmsg)) {
+        // NOTE IP_TOS 的载荷为 1 字节, IPV6_TCLASS 为 int
+        if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_TOS && cmsg->cmsg_len >= CMSG_LEN(sizeof(uint8_t))) {
+            return *(const uint8_t *)CMSG_DATA(cmsg) & 0x03;
+        } else if (cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_TCLASS
+                   && cmsg->cmsg_len >= CMSG_LEN(sizeof(int32_t))) {
+            int32_t tclass = 0;
+            memcpy(&tclass, CMSG_DATA(cmsg), sizeof(tclass));
+            return static_cast<uint8_t>(tclass & 0x03);
+        }
+    }
+    return 0;
+#else
+    UNUSED(msg);
+    return 0;
+#endif
+}
+
 socket_t Socket::Open(int32_t family, Status &status)
 {
     if (family != AF_INET && family != AF_INET6) {
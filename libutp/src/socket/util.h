@@ -34,6 +34,11 @@ public:
         static Status   SetIPv6Only(socket_t sockfd);
         static Status   SetIPTos(socket_t sockfd);
         static Status   SetNoSigPipe(socket_t sockfd);
+        static Status   SetZeroCopy(socket_t sockfd, bool on = true);
+        static Status   SetUdpSegment(socket_t sockfd, uint16_t gsoSize);
+        static Status   SetUdpGro(socket_t sockfd, bool on = true);
+        static Status   SetTxTime(socket_t sockfd, bool on = true);
+        static Status   SetEcn(socket_t sockfd, int32_t family, bool on = true);
         static int32_t  GetMtuByIfname(socket_t sockfd, const char *ifname, Status &status);
     };
 
@@ -41,6 +46,8 @@ public:
     {
     public:
         static Address  GetIPPktInfo(const msghdr_t &msg, uint16_t port);
+        /// @brief 从 IP_TOS / IPV6_TCLASS 控制消息中取出 ECN 码点, 无控制消息时返回 0 (Not-ECT)
+        static uint8_t  GetEcnCodepoint(const msghdr_t &msg);
     };
 
 
@@ -13,4 +13,6 @@ void eular::utp::AckInfo::reset()
     largest_ack_packno = 0;
     ack_delay = 0;
     range_size = 0;
+    has_ecn = false;
+    ecn = EcnCounts();
 }
\ No newline at end of file
@@ -14,6 +14,15 @@
 
 namespace eular {
 namespace utp {
+/// @brief 收到的 ECT(0) / ECT(1) / CE 标记包的累计数量
+struct EcnCounts {
+    uint64_t    ect0{0};
+    uint64_t    ect1{0};
+    uint64_t    ce{0};
+
+    uint64_t    total() const { return ect0 + ect1 + ce; }
+};
+
 /// @brief 解析Ack帧后得到的Ack信息
 class AckInfo
 {
@@ -29,6 +38,8 @@ public:
     utp_time_t              ack_delay{0};           // Ack延迟
     uint32_t                range_size{0};          // Ack范围大小
     std::array<Range, 256>  ack_ranges{};           // Ack范围数组
+    bool                    has_ecn{false};         // 是否为携带 ECN 计数的 Ack 帧
+    EcnCounts               ecn{};                  // 对端累计收到的 ECN 标记包数
 };
 
 } // namespace utp
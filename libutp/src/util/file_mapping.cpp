@@ -0,0 +1,133 @@
+/*************************************************************************
+    > File Name: file_mapping.cpp
+    > Author: eular
+    > Brief:
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include "util/file_mapping.h"
+
+#include <limits>
+
+#include "utp/platform.h"
+
+#if defined(OS_WINDOWS)
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "util/error.h"
+
+namespace eular {
+namespace utp {
+
+FileMapping::~FileMapping()
+{
+    unmap();
+}
+
+Status FileMapping::map(int fd, uint64_t offset, size_t len)
+{
+    unmap();
+    if (fd < 0 || len == 0) {
+        return Status::ErrorLiteral(UTP_ERR_INVALID_PARAM, "invalid file or length");
+    }
+
+#if defined(OS_WINDOWS)
+    HANDLE file = reinterpret_cast<HANDLE>(::_get_osfhandle(fd));
+    if (file == INVALID_HANDLE_VALUE) {
+        return Status::ErrorLiteral(UTP_ERR_INVALID_PARAM, "invalid file descriptor");
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!::GetFileSizeEx(file, &fileSize)) {
+        const int32_t code = GetSystemLastError();
+        return Status::Error(UTP_ERR_INVALID_PARAM, fmt::format("GetFileSizeEx failed: [{}, {}]", code, GetSystemErrnoMsg(code)));
+    }
+    if (offset > static_cast<uint64_t>(fileSize.QuadPart) || len > static_cast<uint64_t>(fileSize.QuadPart) - offset) {
+        return Status::ErrorLiteral(UTP_ERR_INVALID_PARAM, "file range exceeds file size");
+    }
+
+    SYSTEM_INFO sysInfo;
+    ::GetSystemInfo(&sysInfo);
+    const uint64_t granularity = sysInfo.dwAllocationGranularity;
+    const uint64_t alignedOffset = offset - (offset % granularity);
+    const size_t   mapLen = static_cast<size_t>(offset - alignedOffset) + len;
+
+    HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        const int32_t code = GetSystemLastError();
+        return Status::Error(UTP_ERR_NO_MEMORY, fmt::format("CreateFileMapping failed: [{}, {}]", code, GetSystemErrnoMsg(code)));
+    }
+    // 视图持有映射对象的引用, 句柄可以立即关闭
+    void *base = ::MapViewOfFile(mapping, FILE_MAP_READ,
+                                 static_cast<DWORD>(alignedOffset >> 32),
+                                 static_cast<DWORD>(alignedOffset & 0xFFFFFFFFu),
+                                 mapLen);
+    ::CloseHandle(mapping);
+    if (base == nullptr) {
+        const int32_t code = GetSystemLastError();
+        return Status::Error(UTP_ERR_NO_MEMORY, fmt::format("MapViewOfFile failed: [{}, {}]", code, GetSystemErrnoMsg(code)));
+    }
+#else
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        const int32_t code = GetSystemLastError();
+        return Status::Error(UTP_ERR_INVALID_PARAM, fmt::format("fstat({}) failed: [{}, {}]", fd, code, GetSystemErrnoMsg(code)));
+    }
+    if (!S_ISREG(st.st_mode)) {
+        return Status::ErrorLiteral(UTP_ERR_INVALID_PARAM, "not a regular file");
+    }
+    // 越过文件末尾的页访问会触发 SIGBUS, 映射前先校验区间
+    const uint64_t fileSize = static_cast<uint64_t>(st.st_size);
+    if (offset > fileSize || len > fileSize - offset) {
+        return Status::ErrorLiteral(UTP_ERR_INVALID_PARAM, "file range exceeds file size");
+    }
+
+    const uint64_t pageSize = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+    const uint64_t alignedOffset = offset - (offset % pageSize);
+    const size_t   mapLen = static_cast<size_t>(offset - alignedOffset) + len;
+    if (alignedOffset > static_cast<uint64_t>((std::numeric_limits<off_t>::max)())) {
+        return Status::ErrorLiteral(UTP_ERR_OVERFLOW, "file offset overflow");
+    }
+
+    void *base = ::mmap(nullptr, mapLen, PROT_READ, MAP_SHARED, fd, static_cast<off_t>(alignedOffset));
+    if (base == MAP_FAILED) {
+        const int32_t code = GetSystemLastError();
+        return Status::Error(UTP_ERR_NO_MEMORY, fmt::format("mmap({}) failed: [{}, {}]", fd, code, GetSystemErrnoMsg(code)));
+    }
+#if defined(MADV_SEQUENTIAL)
+    (void)::madvise(base, mapLen, MADV_SEQUENTIAL);
+#endif
+#endif
+
+    m_base = base;
+    m_mapLen = mapLen;
+    m_data = static_cast<const uint8_t *>(base) + (offset - alignedOffset);
+    m_len = len;
+    return Status::OK();
+}
+
+void FileMapping::unmap()
+{
+    if (m_base == nullptr) {
+        return;
+    }
+
+#if defined(OS_WINDOWS)
+    ::UnmapViewOfFile(m_base);
+#else
+    ::munmap(m_base, m_mapLen);
+#endif
+    m_base = nullptr;
+    m_mapLen = 0;
+    m_data = nullptr;
+    m_len = 0;
+}
+
+} // namespace utp
+} // namespace eular
@@ -0,0 +1,51 @@
+/*************************************************************************
+    > File Name: file_mapping.h
+    > Author: eular
+    > Brief: 只读文件区间映射, 供 Stream::sendFile 直接从文件页构建 STREAM 帧
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#ifndef __UTP_UTIL_FILE_MAPPING_H__
+#define __UTP_UTIL_FILE_MAPPING_H__
+
+#include <cstddef>
+#include <cstdint>
+
+#include "util/status.h"
+
+namespace eular {
+namespace utp {
+
+/**
+ * @brief 将文件 [offset, offset + len) 以只读方式映射到内存, 析构时解除映射
+ *
+ * 映射起点按页 (Windows 为分配粒度) 向下对齐, data() 指向 offset 处.
+ * 映射期间文件对应区间被截断会导致访问异常 (SIGBUS), 调用方需保证文件在发送完成前不被截断.
+ */
+class FileMapping
+{
+public:
+    FileMapping() = default;
+    ~FileMapping();
+
+    FileMapping(const FileMapping &) = delete;
+    FileMapping &operator=(const FileMapping &) = delete;
+
+    Status          map(int fd, uint64_t offset, size_t len);
+    void            unmap();
+
+    const uint8_t*  data() const { return m_data; }
+    size_t          size() const { return m_len; }
+    bool            mapped() const { return m_base != nullptr; }
+
+private:
+    void*           m_base{nullptr};    // 对齐后的映射起点
+    size_t          m_mapLen{0};        // 实际映射长度
+    const uint8_t*  m_data{nullptr};    // 请求区间起点
+    size_t          m_len{0};           // 请求区间长度
+};
+
+} // namespace utp
+} // namespace eular
+
+#endif // __UTP_UTIL_FILE_MAPPING_H__
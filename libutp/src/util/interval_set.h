@@ -0,0 +1,141 @@
+/*************************************************************************
+    > File Name: interval_set.h
+    > Author: eular
+    > Brief: 有序数组实现的左闭右开区间集合, 少量区间时不分配堆内存
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#ifndef __UTP_UTIL_INTERVAL_SET_H__
+#define __UTP_UTIL_INTERVAL_SET_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <utils/utils.h>
+
+namespace eular {
+namespace utp {
+
+/**
+ * @brief [start, end) 区间集合, 插入时合并重叠或相邻的区间
+ *
+ * 区间按 start 升序存放在连续数组中, 前 N 个区间使用内联存储;
+ * 超出后整体迁移到堆上, 之后按 2 倍扩容, clear() 不归还已分配的容量。
+ *
+ * @tparam N 内联存储的区间数
+ */
+template <size_t N>
+class IntervalSet
+{
+    DISALLOW_COPY_AND_ASSIGN(IntervalSet);
+
+public:
+    struct Range {
+        uint64_t start;
+        uint64_t end;
+    };
+
+    IntervalSet() = default;
+    ~IntervalSet()
+    {
+        if (m_ranges != m_inline) {
+            std::free(m_ranges);
+        }
+    }
+
+    bool         empty() const { return m_size == 0; }
+    size_t       size() const { return m_size; }
+    size_t       capacity() const { return m_capacity; }
+    bool         inlined() const { return m_ranges == m_inline; }
+    const Range *begin() const { return m_ranges; }
+    const Range *end() const { return m_ranges + m_size; }
+    const Range &front() const { return m_ranges[0]; }
+    void         clear() { m_size = 0; }
+
+    /**
+     * @brief 插入 [start, end), 空区间忽略
+     *
+     * @return 内存不足时返回 false, 集合保持不变
+     */
+    bool insert(uint64_t start, uint64_t end)
+    {
+        if (start >= end) {
+            return true;
+        }
+
+        // 第一个 end >= start 的区间, 即可能与新区间重叠或相邻的最左区间
+        Range *first = std::lower_bound(m_ranges, m_ranges + m_size, start,
+                                        [] (const Range &range, uint64_t value) { return range.end < value; });
+        Range *last = first;
+        while (last != m_ranges + m_size && last->start <= end) {
+            ++last;
+        }
+
+        const size_t index = static_cast<size_t>(first - m_ranges);
+        if (first == last) {
+            if (m_size == m_capacity && !grow()) {
+                return false;
+            }
+            Range *slot = m_ranges + index;
+            std::copy_backward(slot, m_ranges + m_size, m_ranges + m_size + 1);
+            slot->start = start;
+            slot->end = end;
+            ++m_size;
+            return true;
+        }
+
+        first->start = std::min(first->start, start);
+        first->end = std::max((last - 1)->end, end);
+        const size_t merged = static_cast<size_t>(last - first) - 1;
+        if (merged > 0) {
+            std::copy(last, m_ranges + m_size, first + 1);
+            m_size -= merged;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 移除所有 end <= offset 的区间
+     */
+    void eraseBelow(uint64_t offset)
+    {
+        Range *keep = std::lower_bound(m_ranges, m_ranges + m_size, offset,
+                                       [] (const Range &range, uint64_t value) { return range.end <= value; });
+        const size_t dropped = static_cast<size_t>(keep - m_ranges);
+        if (dropped > 0) {
+            std::copy(keep, m_ranges + m_size, m_ranges);
+            m_size -= dropped;
+        }
+    }
+
+private:
+    bool grow()
+    {
+        const size_t capacity = m_capacity * 2;
+        Range *ranges = static_cast<Range *>(std::malloc(capacity * sizeof(Range)));
+        if (ranges == nullptr) {
+            return false;
+        }
+        std::copy(m_ranges, m_ranges + m_size, ranges);
+        if (m_ranges != m_inline) {
+            std::free(m_ranges);
+        }
+        m_ranges = ranges;
+        m_capacity = capacity;
+        return true;
+    }
+
+private:
+    Range   m_inline[N];
+    Range*  m_ranges{m_inline};
+    size_t  m_size{0};
+    size_t  m_capacity{N};
+};
+
+} // namespace utp
+} // namespace eular
+
+#endif // __UTP_UTIL_INTERVAL_SET_H__
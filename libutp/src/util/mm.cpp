@@ -10,8 +10,10 @@
 #include "mtu/mtu.h"
 #include "proto/proto.h"
 #include "logger/logger.h"
+#include "socket/udp.h"
 #include "mm.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 
@@ -35,7 +37,8 @@ enum {
     PACKET_OUT_PAYLOAD_1 = ETHERNET_MTU_MID - IPV4_HEADER_SIZE - UDP_HEADER_SIZE - UTP_HEADER_SIZE,
     PACKET_OUT_PAYLOAD_2 = UTP_ETHERNET_MTU - IPV4_HEADER_SIZE - UDP_HEADER_SIZE - UTP_HEADER_SIZE,
     PACKET_OUT_PAYLOAD_3 = 4096,
-    PACKET_OUT_PAYLOAD_4 = 0xffff,
+    PACKET_OUT_PAYLOAD_4 = UTP_JUMBO_MTU - IPV4_HEADER_SIZE - UDP_HEADER_SIZE - UTP_HEADER_SIZE,
+    PACKET_OUT_PAYLOAD_5 = 0xffff,
 };
 
 static constexpr uint16_t g_packetOutSizeVec[] = {
@@ -44,38 +47,54 @@ static constexpr uint16_t g_packetOutSizeVec[] = {
     PACKET_OUT_PAYLOAD_2,
     PACKET_OUT_PAYLOAD_3,
     PACKET_OUT_PAYLOAD_4,
+    PACKET_OUT_PAYLOAD_5,
 };
 
 enum {
     PACKET_IN_SIZE_0 = ETHERNET_MTU_MIN,
     PACKET_IN_SIZE_1 = UTP_ETHERNET_MTU,
-    PACKET_IN_SIZE_2 = 0xffff,
+    PACKET_IN_SIZE_2 = UTP_JUMBO_MTU,
+    PACKET_IN_SIZE_3 = 0xffff,
 };
 
 static constexpr uint16_t g_packetInSizeVec[] = {
     PACKET_IN_SIZE_0,
     PACKET_IN_SIZE_1,
     PACKET_IN_SIZE_2,
+    PACKET_IN_SIZE_3,
 };
 
+static_assert(sizeof(g_packetOutSizeVec) / sizeof(g_packetOutSizeVec[0]) == MM_OUT_BUCKETS, "packet out buckets");
+static_assert(sizeof(g_packetInSizeVec) / sizeof(g_packetInSizeVec[0]) == MM_IN_BUCKETS, "packet in buckets");
+
 static int32_t PacketOutIndex(uint32_t size)
 {
     uint32_t idx = (size > PACKET_OUT_PAYLOAD_0)
                 + (size > PACKET_OUT_PAYLOAD_1)
                 + (size > PACKET_OUT_PAYLOAD_2)
-                + (size > PACKET_OUT_PAYLOAD_3);
+                + (size > PACKET_OUT_PAYLOAD_3)
+                + (size > PACKET_OUT_PAYLOAD_4);
     return idx;
 }
 
 static int32_t PacketInIndex(uint32_t size)
 {
     uint32_t idx = (size > PACKET_IN_SIZE_0)
-                + (size > PACKET_IN_SIZE_1);
+                + (size > PACKET_IN_SIZE_1)
+                + (size > PACKET_IN_SIZE_2);
     return idx;
 }
 
 MemoryManager::MemoryManager()
 {
+    TAILQ_INIT(&zc_deferred);
+    zc_deferred_count = 0;
+    zc_socket = nullptr;
+    bytes_inuse = 0;
+    bytes_inuse_max = 0;
+    quota_bytes = 0;
+    quota_rejected = 0;
+
     for (uint32_t i = 0; i < MM_OUT_BUCKETS; ++i) {
         SLIST_INIT(&packet_out_bufs[i]);
         std::memset(&packet_out_stats[i], 0, sizeof(packet_out_stats[i]));
@@ -89,6 +108,24 @@ MemoryManager::MemoryManager()
 
 MemoryManager::~MemoryManager()
 {
+    // NOTE MSG_ZEROCOPY 下内核引用的就是这些缓冲所在的物理页, 完成通知前回收到池中会被后续分配改写,
+    //      仍在排队的数据报(通常是 CONNECTION_CLOSE)随之损坏; 缓冲交给 socket, 完成通知到达后再释放
+    PacketOut *deferred = nullptr;
+    while ((deferred = TAILQ_FIRST(&zc_deferred)) != nullptr) {
+        TAILQ_REMOVE(&zc_deferred, deferred, po_next);
+        deferred->local_flags &= ~PacketOutLocalFlags::kPOLZcPutDeferred;
+        --zc_deferred_count;
+        if (zc_socket != nullptr && zc_socket->adoptZeroCopy(deferred)) {
+            detachPacketOut(deferred);
+            continue;
+        }
+        deferred->zc_pending = 0;
+        putPacketOut(deferred);
+    }
+    if (zc_socket != nullptr) {
+        zc_socket->dropZeroCopyOwner(this);
+    }
+
     for (uint32_t i = 0; i < MM_OUT_BUCKETS; ++i) {
         PacketOutBuf *pob = nullptr;
         while ((pob = SLIST_FIRST(&packet_out_bufs[i])) != nullptr) {
@@ -106,14 +143,60 @@ MemoryManager::~MemoryManager()
     }
 }
 
+bool MemoryManager::attachSharedPool(std::shared_ptr<MemoryManager> shared, uint32_t quotaBytes)
+{
+    if (!shared || shared.get() == this || shared->sharedPool() != nullptr) {
+        return false;
+    }
+    // NOTE 借出对象需归还给分配它的池, 只允许在尚未分配前切换
+    if (bytes_inuse != 0 || zc_deferred_count != 0 || m_sharedPool) {
+        return false;
+    }
+
+    m_sharedPool = std::move(shared);
+    quota_bytes = quotaBytes;
+    return true;
+}
+
+uint64_t MemoryManager::bytesCached() const
+{
+    uint64_t bytes = 0;
+    for (uint32_t i = 0; i < MM_OUT_BUCKETS; ++i) {
+        const PoolStats &stats = packet_out_stats[i];
+        if (stats.objs_total > stats.objs_inuse) {
+            bytes += static_cast<uint64_t>(stats.objs_total - stats.objs_inuse) * g_packetOutSizeVec[i];
+        }
+    }
+    for (uint32_t i = 0; i < MM_IN_BUCKETS; ++i) {
+        const PoolStats &stats = packet_in_stats[i];
+        if (stats.objs_total > stats.objs_inuse) {
+            bytes += static_cast<uint64_t>(stats.objs_total - stats.objs_inuse) * g_packetInSizeVec[i];
+        }
+    }
+    return bytes;
+}
+
 PacketOut *MemoryManager::getPacketOut(uint32_t size)
+{
+    const uint32_t idx = PacketOutIndex(size);
+    if (!chargeQuota(g_packetOutSizeVec[idx])) {
+        return nullptr;
+    }
+
+    PacketOut *packetOut = m_sharedPool ? m_sharedPool->getPacketOut(size) : allocPacketOut(idx);
+    if (packetOut == nullptr) {
+        releaseQuota(g_packetOutSizeVec[idx]);
+    }
+    return packetOut;
+}
+
+PacketOut *MemoryManager::allocPacketOut(uint32_t idx)
 {
     PacketOut *packetOut = packet_out_malo.get();
     if (!packetOut) {
         return nullptr;
     }
 
-    uint32_t idx = PacketOutIndex(size);
     PacketOutBuf *pob = SLIST_FIRST(&packet_out_bufs[idx]);
     if (pob) {
         SLIST_REMOVE_HEAD(&packet_out_bufs[idx], next_pob);
@@ -147,6 +230,25 @@ void MemoryManager::putPacketOut(PacketOut *pkt)
         return;
     }
 
+    if (pkt->zeroCopyPinned()) {
+        if ((pkt->local_flags & PacketOutLocalFlags::kPOLZcPutDeferred) == 0) {
+            pkt->local_flags |= PacketOutLocalFlags::kPOLZcPutDeferred;
+            TAILQ_INSERT_TAIL(&zc_deferred, pkt, po_next);
+            ++zc_deferred_count;
+        }
+        return;
+    }
+
+    releaseQuota(pkt->alloc_size);
+    if (m_sharedPool) {
+        m_sharedPool->putPacketOut(pkt);
+        return;
+    }
+    freePacketOut(pkt);
+}
+
+void MemoryManager::freePacketOut(PacketOut *pkt)
+{
     pkt->clearSendAttempts();
     if (pkt->encrypt_data != nullptr && pkt->encrypt_data != pkt->raw_data) {
         AesGcmContext::ReleaseEncryptBuffer(pkt->encrypt_data, pkt->encrypt_data_size);
@@ -171,14 +273,80 @@ void MemoryManager::putPacketOut(PacketOut *pkt)
     packet_out_malo.put(pkt);
 }
 
+void MemoryManager::releaseZeroCopy(PacketOut *pkt)
+{
+    if (pkt == nullptr || !pkt->zeroCopyPinned()) {
+        return;
+    }
+
+    --pkt->zc_pending;
+    if (pkt->zeroCopyPinned() || (pkt->local_flags & PacketOutLocalFlags::kPOLZcPutDeferred) == 0) {
+        return;
+    }
+
+    releaseZeroCopyAll(pkt);
+}
+
+void MemoryManager::releaseZeroCopyAll(PacketOut *pkt)
+{
+    if ((pkt->local_flags & PacketOutLocalFlags::kPOLZcPutDeferred) != 0) {
+        TAILQ_REMOVE(&zc_deferred, pkt, po_next);
+        pkt->local_flags &= ~PacketOutLocalFlags::kPOLZcPutDeferred;
+        --zc_deferred_count;
+    }
+    pkt->zc_pending = 0;
+    putPacketOut(pkt);
+}
+
+void MemoryManager::detachPacketOut(PacketOut *pkt)
+{
+    // 缓冲已转交他处, 只归还 PacketOut 对象, 该缓冲不再计入池
+    releaseQuota(pkt->alloc_size);
+    if (m_sharedPool) {
+        m_sharedPool->detachPacketOut(pkt);
+        return;
+    }
+
+    PoolStats *stats = &packet_out_stats[PacketOutIndex(pkt->alloc_size)];
+    poolStatsFree(stats);
+    --stats->objs_total;
+
+    pkt->clearSendAttempts();
+    pkt->raw_data = nullptr;
+    pkt->alloc_size = 0;
+    pkt->encrypt_data = nullptr;
+    pkt->encrypt_data_size = 0;
+    pkt->zc_pending = 0;
+    packet_out_malo.put(pkt);
+}
+
 PacketIn *MemoryManager::getPacketIn(uint32_t size)
+{
+    // 解码用的 PacketIn 在批次结束时即归还, 不占视图配额; 否则在途包占满配额后, 能释放它们的 ACK 也会被丢弃.
+    // 只有被重组保留时才计入配额, 见 retainPacketIn
+    if (m_sharedPool) {
+        return m_sharedPool->getPacketIn(size);
+    }
+
+    const uint32_t idx = PacketInIndex(size);
+    if (!chargeQuota(g_packetInSizeVec[idx])) {
+        return nullptr;
+    }
+
+    PacketIn *packetIn = allocPacketIn(idx);
+    if (packetIn == nullptr) {
+        releaseQuota(g_packetInSizeVec[idx]);
+    }
+    return packetIn;
+}
+
+PacketIn *MemoryManager::allocPacketIn(uint32_t idx)
 {
     PacketIn *packetIn = packet_in_malo.get();
     if (!packetIn) {
         return nullptr;
     }
 
-    const uint32_t idx = PacketInIndex(size);
     PacketInBuf *pib = SLIST_FIRST(&packet_in_bufs[idx]);
     if (pib) {
         SLIST_REMOVE_HEAD(&packet_in_bufs[idx], next_pib);
@@ -205,6 +373,10 @@ PacketIn *MemoryManager::getPacketIn(uint32_t size)
 
 RecvFragment *MemoryManager::getRecvFragment()
 {
+    if (m_sharedPool) {
+        return m_sharedPool->getRecvFragment();
+    }
+
     RecvFragment *fragment = recv_fragment_malo.get();
     if (!fragment) {
         return nullptr;
@@ -220,6 +392,20 @@ void MemoryManager::putPacketIn(PacketIn *pkt)
         return;
     }
 
+    if (pkt->quota_owner != nullptr) {
+        pkt->quota_owner->releaseQuota(pkt->alloc_size);
+        pkt->quota_owner = nullptr;
+    }
+    if (m_sharedPool) {
+        m_sharedPool->putPacketIn(pkt);
+        return;
+    }
+    releaseQuota(pkt->alloc_size);
+    freePacketIn(pkt);
+}
+
+void MemoryManager::freePacketIn(PacketIn *pkt)
+{
     PacketInBuf *pib = (PacketInBuf *) pkt->raw_data;
     const uint32_t idx = PacketInIndex(pkt->alloc_size);
 
@@ -248,16 +434,29 @@ void MemoryManager::putRecvFragment(RecvFragment *fragment)
         return;
     }
 
+    if (m_sharedPool) {
+        m_sharedPool->putRecvFragment(fragment);
+        return;
+    }
     recv_fragment_malo.put(fragment);
 }
 
-void MemoryManager::retainPacketIn(PacketIn *pkt)
+bool MemoryManager::retainPacketIn(PacketIn *pkt)
 {
     if (pkt == nullptr) {
-        return;
+        return false;
+    }
+
+    // 首次被保留时计入视图配额, 同一个包被多个分片引用只计一次
+    if (m_sharedPool && pkt->quota_owner == nullptr) {
+        if (!chargeQuota(pkt->alloc_size)) {
+            return false;
+        }
+        pkt->quota_owner = this;
     }
 
     ++pkt->refcnt;
+    return true;
 }
 
 void MemoryManager::releasePacketIn(PacketIn *pkt)
@@ -272,6 +471,26 @@ void MemoryManager::releasePacketIn(PacketIn *pkt)
     }
 }
 
+bool MemoryManager::chargeQuota(uint32_t bytes)
+{
+    if (quota_bytes != 0 && bytes_inuse + bytes > quota_bytes) {
+        ++quota_rejected;
+        if (m_sharedPool) {
+            ++m_sharedPool->quota_rejected;
+        }
+        return false;
+    }
+
+    bytes_inuse += bytes;
+    bytes_inuse_max = std::max(bytes_inuse_max, bytes_inuse);
+    return true;
+}
+
+void MemoryManager::releaseQuota(uint32_t bytes)
+{
+    bytes_inuse = bytes_inuse > bytes ? bytes_inuse - bytes : 0;
+}
+
 void MemoryManager::poolStatsAllocated(PoolStats *stats, uint32_t allocated)
 {
     ++stats->calls;
@@ -9,6 +9,7 @@
 #define __UTP_UTIL_MM_H__
 
 #include <array>
+#include <memory>
 
 #include "context/stream_impl.h"
 #include "proto/packet_in.h"
@@ -16,11 +17,13 @@
 #include "queue.h"
 #include "util/malo.hpp"
 
-#define MM_OUT_BUCKETS 5
-#define MM_IN_BUCKETS  3
+#define MM_OUT_BUCKETS 6
+#define MM_IN_BUCKETS  4
 
 namespace eular {
 namespace utp {
+class UdpSocket;
+
 class MemoryManager
 {
 public:
@@ -36,15 +39,38 @@ public:
     MemoryManager();
     ~MemoryManager();
 
+    /**
+     * @brief 切换为共享池视图: 对象与缓冲取自 shared 并归还给它, 本实例只保留零拷贝延迟队列与用量统计
+     *
+     * @param shared 上下文级共享池, 仅可在同一线程内使用
+     * @param quotaBytes 本实例可借出的包缓冲字节上限, 0 表示不限; 超出时 getPacketOut 返回 nullptr, retainPacketIn 返回 false.
+     *                   解码用的 PacketIn 不受配额限制, 被重组保留后才计入
+     * @return 已有借出对象或 shared 为自身/空时返回 false
+     */
+    bool          attachSharedPool(std::shared_ptr<MemoryManager> shared, uint32_t quotaBytes);
+    MemoryManager* sharedPool() const { return m_sharedPool.get(); }
+
+    /**
+     * @brief 空闲链表中缓存的包缓冲字节数
+     */
+    uint64_t      bytesCached() const;
+
     PacketOut*    getPacketOut(uint32_t size);
     PacketIn*     getPacketIn(uint32_t size);
     RecvFragment* getRecvFragment();
     void          putPacketOut(PacketOut* pkt);
     void          putPacketIn(PacketIn* pkt);
     void          putRecvFragment(RecvFragment* fragment);
-    void          retainPacketIn(PacketIn* pkt);
+    bool          retainPacketIn(PacketIn* pkt);
     void          releasePacketIn(PacketIn* pkt);
 
+    /**
+     * @brief 处理一次 MSG_ZEROCOPY 完成通知
+     *
+     * @param pkt 零拷贝发送的包; 若其已被 putPacketOut 延迟回收且不再被内核引用, 则在此真正释放
+     */
+    void          releaseZeroCopy(PacketOut* pkt);
+
 private:
     void poolStatsAllocated(PoolStats* stats, uint32_t allocated);
     void poolStatsFree(PoolStats* stats);
@@ -52,6 +78,14 @@ private:
     bool hasNewSample(PoolStats* stats);
     void maybeShrinkPoolOut(uint32_t idx);
     void maybeShrinkPoolIn(uint32_t idx);
+    void releaseZeroCopyAll(PacketOut* pkt);
+    void detachPacketOut(PacketOut* pkt);
+    PacketOut* allocPacketOut(uint32_t idx);
+    void       freePacketOut(PacketOut* pkt);
+    PacketIn*  allocPacketIn(uint32_t idx);
+    void       freePacketIn(PacketIn* pkt);
+    bool chargeQuota(uint32_t bytes);
+    void releaseQuota(uint32_t bytes);
 
 public:
     MaloCacheLine<StreamImpl>   stream_malo;
@@ -63,6 +97,18 @@ public:
     PoolStats                   packet_out_stats[MM_OUT_BUCKETS];
     SLIST_HEAD(, PacketInBuf)   packet_in_bufs[MM_IN_BUCKETS];
     PoolStats                   packet_in_stats[MM_IN_BUCKETS];
+
+    PacketOutTailQ              zc_deferred;        // 等待零拷贝完成通知的已回收包
+    uint32_t                    zc_deferred_count;
+    UdpSocket*                  zc_socket;          // 析构时接管仍被内核引用的零拷贝缓冲, 须比本实例活得久
+
+    uint64_t                    bytes_inuse;        // 已借出的包缓冲字节数 (共享池上为所有视图之和)
+    uint64_t                    bytes_inuse_max;
+    uint32_t                    quota_bytes;        // 0 表示不限
+    uint64_t                    quota_rejected;     // 因配额拒绝的分配次数 (共享池上为所有视图之和)
+
+private:
+    std::shared_ptr<MemoryManager> m_sharedPool;
 };
 
 }  // namespace utp
@@ -5,8 +5,8 @@
     > Created Time: Wed 14 Jan 2026 09:42:08 PM CST
  ************************************************************************/
 
-#ifndef __UTP_UTIL_H__
-#define __UTP_UTIL_H__
+#ifndef __UTP_RANDOM_HPP__
+#define __UTP_RANDOM_HPP__
 
 #include <random>
 #include <limits>
@@ -60,4 +60,4 @@ inline void RandomBytes(void* data, std::size_t n)
 } // namespace utp
 } // namespace eular
 
-#endif // __UTP_UTIL_H__
+#endif // __UTP_RANDOM_HPP__
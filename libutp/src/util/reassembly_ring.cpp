@@ -0,0 +1,211 @@
+/*************************************************************************
+    > File Name: reassembly_ring.cpp
+    > Author: eular
+    > Brief: 按流偏移直接写入的接收重组环, 位图记录已填充字节
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include "util/reassembly_ring.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "util/util.h"
+
+namespace eular {
+namespace utp {
+
+namespace {
+
+constexpr size_t kBitsPerWord = 64;
+
+inline uint64_t WordMask(size_t begin, size_t end)
+{
+    // [begin, end) 位于同一个字内, end - begin 在 (0, 64]
+    const uint64_t high = (end == kBitsPerWord) ? ~0ULL : ((1ULL << end) - 1);
+    return high & ~((1ULL << begin) - 1);
+}
+
+} // namespace
+
+void ReassemblyRing::reset(size_t capacity, uint64_t baseOffset)
+{
+    clear();
+    if (capacity == 0) {
+        m_base = baseOffset;
+        m_contiguousEnd = baseOffset;
+        return;
+    }
+
+    m_buffer.reset(new uint8_t[capacity]);
+    m_bitmap.assign((capacity + kBitsPerWord - 1) / kBitsPerWord, 0);
+    m_capacity = capacity;
+    m_base = baseOffset;
+    m_contiguousEnd = baseOffset;
+}
+
+void ReassemblyRing::clear()
+{
+    m_buffer.reset();
+    std::vector<uint64_t>().swap(m_bitmap);
+    m_capacity = 0;
+    m_head = 0;
+    m_filled = 0;
+    m_contiguousEnd = m_base;
+}
+
+bool ReassemblyRing::write(uint64_t offset, const uint8_t *data, size_t len, size_t *newlyFilled)
+{
+    if (newlyFilled != nullptr) {
+        *newlyFilled = 0;
+    }
+    if (len == 0) {
+        return true;
+    }
+    if (data == nullptr || offset < m_base || offset - m_base > m_capacity || len > m_capacity - (offset - m_base)) {
+        return false;
+    }
+
+    const size_t pos = indexOf(offset);
+    const size_t first = std::min(len, m_capacity - pos);
+    std::memcpy(m_buffer.get() + pos, data, first);
+    size_t added = setBits(pos, first);
+    if (first < len) {
+        std::memcpy(m_buffer.get(), data + first, len - first);
+        added += setBits(0, len - first);
+    }
+    m_filled += added;
+
+    // 只有触及连续区间末尾的写入才可能推进 contiguousEnd
+    if (added > 0 && offset <= m_contiguousEnd) {
+        const size_t limit = m_capacity - contiguousBytes();
+        if (limit > 0) {
+            const size_t endPos = indexOf(m_contiguousEnd);
+            const size_t linear = std::min(limit, m_capacity - endPos);
+            size_t advance = countSetBits(endPos, linear);
+            if (advance == linear && linear < limit) {
+                advance += countSetBits(0, limit - linear);
+            }
+            m_contiguousEnd += advance;
+        }
+    }
+
+    if (newlyFilled != nullptr) {
+        *newlyFilled = added;
+    }
+    return true;
+}
+
+size_t ReassemblyRing::readableViews(Stream::ConstBufferView views[2], size_t maxBytes) const
+{
+    if (views == nullptr) {
+        return 0;
+    }
+
+    views[0] = {};
+    views[1] = {};
+    const size_t total = std::min(maxBytes, contiguousBytes());
+    if (total == 0) {
+        return 0;
+    }
+
+    const size_t first = std::min(total, m_capacity - m_head);
+    views[0].data = m_buffer.get() + m_head;
+    views[0].len = first;
+    if (first < total) {
+        views[1].data = m_buffer.get();
+        views[1].len = total - first;
+    }
+    return total;
+}
+
+size_t ReassemblyRing::read(uint8_t *buffer, size_t len)
+{
+    if (buffer == nullptr) {
+        return 0;
+    }
+
+    Stream::ConstBufferView views[2];
+    const size_t total = readableViews(views, len);
+    size_t copied = 0;
+    for (size_t i = 0; i < 2 && copied < total; ++i) {
+        if (views[i].len > 0) {
+            std::memcpy(buffer + copied, views[i].data, views[i].len);
+            copied += views[i].len;
+        }
+    }
+    consume(total);
+    return total;
+}
+
+void ReassemblyRing::consume(size_t bytes)
+{
+    bytes = std::min(bytes, contiguousBytes());
+    if (bytes == 0) {
+        return;
+    }
+
+    const size_t first = std::min(bytes, m_capacity - m_head);
+    clearBits(m_head, first);
+    if (first < bytes) {
+        clearBits(0, bytes - first);
+    }
+
+    m_head = (m_head + bytes) % m_capacity;
+    m_base += bytes;
+    m_filled -= bytes;
+}
+
+size_t ReassemblyRing::setBits(size_t pos, size_t len)
+{
+    size_t added = 0;
+    const size_t end = pos + len;
+    while (pos < end) {
+        const size_t word = pos / kBitsPerWord;
+        const size_t begin = pos % kBitsPerWord;
+        const size_t stop = std::min(kBitsPerWord, begin + (end - pos));
+        const uint64_t mask = WordMask(begin, stop);
+        added += Util::PopCount(mask & ~m_bitmap[word]);
+        m_bitmap[word] |= mask;
+        pos += stop - begin;
+    }
+    return added;
+}
+
+void ReassemblyRing::clearBits(size_t pos, size_t len)
+{
+    const size_t end = pos + len;
+    while (pos < end) {
+        const size_t word = pos / kBitsPerWord;
+        const size_t begin = pos % kBitsPerWord;
+        const size_t stop = std::min(kBitsPerWord, begin + (end - pos));
+        m_bitmap[word] &= ~WordMask(begin, stop);
+        pos += stop - begin;
+    }
+}
+
+size_t ReassemblyRing::countSetBits(size_t pos, size_t maxLen) const
+{
+    size_t count = 0;
+    while (count < maxLen) {
+        const size_t word = pos / kBitsPerWord;
+        const size_t begin = pos % kBitsPerWord;
+        const size_t stop = std::min(kBitsPerWord, begin + (maxLen - count));
+        const uint64_t missing = ~m_bitmap[word] & WordMask(begin, stop);
+        if (missing != 0) {
+            return count + static_cast<size_t>(Util::CountTrailingZeros(missing)) - begin;
+        }
+        count += stop - begin;
+        pos += stop - begin;
+    }
+    return maxLen;
+}
+
+size_t ReassemblyRing::indexOf(uint64_t offset) const
+{
+    const size_t pos = m_head + static_cast<size_t>(offset - m_base);
+    return pos >= m_capacity ? pos - m_capacity : pos;
+}
+
+} // namespace utp
+} // namespace eular
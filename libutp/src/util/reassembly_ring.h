@@ -0,0 +1,79 @@
+/*************************************************************************
+    > File Name: reassembly_ring.h
+    > Author: eular
+    > Brief: 按流偏移直接写入的接收重组环, 位图记录已填充字节
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#ifndef __UTP_UTIL_REASSEMBLY_RING_H__
+#define __UTP_UTIL_REASSEMBLY_RING_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "utp/stream.h"
+
+namespace eular {
+namespace utp {
+
+/**
+ * @brief 流接收重组环
+ *
+ * 容量等于流级接收窗口, 覆盖流偏移 [base, base + capacity). 乱序数据直接拷贝到其偏移对应的位置,
+ * 每字节一位的位图记录已填充区间; base 起连续已填充的部分可通过 readableViews 零拷贝读取.
+ * 重复到达的数据直接覆盖 (内容相同), 不做区间合并, 也不为每个分片分配节点.
+ */
+class ReassemblyRing
+{
+public:
+    ReassemblyRing() = default;
+
+    /**
+     * @brief 分配容量并将 base 设为 baseOffset, 原有数据全部丢弃
+     */
+    void        reset(size_t capacity, uint64_t baseOffset);
+    /// @brief 释放缓冲区与位图
+    void        clear();
+
+    bool        allocated() const { return m_capacity > 0; }
+    size_t      capacity() const { return m_capacity; }
+    uint64_t    baseOffset() const { return m_base; }
+    /// @brief base 起连续已填充的字节数
+    size_t      contiguousBytes() const { return static_cast<size_t>(m_contiguousEnd - m_base); }
+    /// @brief 已填充尚未消费的字节数 (含乱序部分)
+    size_t      bufferedBytes() const { return m_filled; }
+
+    /**
+     * @brief 写入流偏移 [offset, offset + len) 的数据
+     *
+     * @param newlyFilled 输出此次新填充的字节数
+     * @return 数据超出 [base, base + capacity) 时返回 false 且不写入
+     */
+    bool        write(uint64_t offset, const uint8_t *data, size_t len, size_t *newlyFilled = nullptr);
+    size_t      readableViews(Stream::ConstBufferView views[2], size_t maxBytes) const;
+    size_t      read(uint8_t *buffer, size_t len);
+    /// @brief 消费 base 起的 bytes 字节, 不超过 contiguousBytes()
+    void        consume(size_t bytes);
+
+private:
+    size_t      setBits(size_t pos, size_t len);
+    void        clearBits(size_t pos, size_t len);
+    size_t      countSetBits(size_t pos, size_t maxLen) const;
+    size_t      indexOf(uint64_t offset) const;
+
+private:
+    std::unique_ptr<uint8_t[]>  m_buffer;
+    std::vector<uint64_t>       m_bitmap;
+    size_t                      m_capacity{0};
+    size_t                      m_head{0};              // base 在 m_buffer 中的下标
+    uint64_t                    m_base{0};              // 首个未消费字节的流偏移
+    uint64_t                    m_contiguousEnd{0};     // base 起连续已填充区间的结束偏移
+    size_t                      m_filled{0};
+};
+
+} // namespace utp
+} // namespace eular
+
+#endif // __UTP_UTIL_REASSEMBLY_RING_H__
@@ -0,0 +1,71 @@
+/*************************************************************************
+    > File Name: replay_filter.h
+    > Author: eular
+    > Brief: 按时间窗轮换的分块 Bloom 过滤器, 用于 0-RTT 抗重放
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#ifndef __UTP_UTIL_REPLAY_FILTER_H__
+#define __UTP_UTIL_REPLAY_FILTER_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace eular {
+namespace utp {
+
+/**
+ * @brief 0-RTT 抗重放过滤器
+ *
+ * 一对 Bloom 过滤器 (当前/上一窗口) 轮换使用, 每个覆盖 windowMs. 查询同时检查两者, 插入只写当前窗口,
+ * 因此任一记录至少保留 windowMs、至多 2 * windowMs; 轮换只是交换与清零, 没有逐项过期扫描.
+ * 每个键的全部探测位落在同一个 512 位块 (一条缓存行) 内.
+ *
+ * Bloom 过滤器只有假阳性: 误判为重放的 0-RTT 被拒绝, 由业务回退普通握手; 真正的重放一定能被拦住.
+ */
+class ReplayFilter
+{
+public:
+    ReplayFilter() = default;
+
+    /**
+     * @brief 按窗口时长与单窗口预期条目数分配过滤器, 原有记录全部丢弃
+     *
+     * @param windowMs 单个过滤器覆盖的时长 (ms)
+     * @param expectedEntries 单个窗口内预期插入的条目数, 决定过滤器大小
+     * @param seed 哈希种子, 应随机选取, 避免对端构造碰撞
+     */
+    void        reset(uint64_t windowMs, size_t expectedEntries, uint64_t seed);
+    bool        allocated() const { return m_blockCount > 0; }
+
+    /**
+     * @brief 检查并记录 (ticketCid, nonce)
+     *
+     * @return 之前未记录时写入并返回 true; 已记录 (或假阳性) 时返回 false
+     */
+    bool        checkAndInsert(uint32_t ticketCid, uint64_t nonce, uint64_t nowMs);
+    /// @brief 按两个过滤器当前的置位比例估算的假阳性概率
+    double      falsePositiveRate() const;
+    size_t      memoryBytes() const { return (m_current.size() + m_previous.size()) * sizeof(uint64_t); }
+
+private:
+    void        rotate(uint64_t nowMs);
+    bool        contains(const std::vector<uint64_t> &bits, size_t block, uint64_t probe) const;
+
+private:
+    std::vector<uint64_t>   m_current;
+    std::vector<uint64_t>   m_previous;
+    size_t                  m_currentSetBits{0};
+    size_t                  m_previousSetBits{0};
+    size_t                  m_blockCount{0};
+    uint64_t                m_windowMs{0};
+    uint64_t                m_windowStartMs{0};
+    uint64_t                m_seed{0};
+    bool                    m_started{false};
+};
+
+} // namespace utp
+} // namespace eular
+
+#endif // __UTP_UTIL_REPLAY_FILTER_H__
@@ -0,0 +1,122 @@
+/*************************************************************************
+    > File Name: sent_packet_ring.cpp
+    > Author: eular
+    > Brief: 按包号索引的已发送包环形表
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include "util/sent_packet_ring.h"
+
+#include <algorithm>
+#include <new>
+
+#include "proto/packet_out.h"
+
+namespace eular {
+namespace utp {
+
+constexpr size_t SentPacketRing::kInitialCapacity;
+constexpr size_t SentPacketRing::kMaxCapacity;
+
+bool SentPacketRing::insert(PacketOut *pkt)
+{
+    if (pkt == nullptr) {
+        return false;
+    }
+
+    const utp_packno_t packno = pkt->packno;
+    if (m_count == 0) {
+        if (!reserve(packno, packno + 1)) {
+            return false;
+        }
+        m_low = packno;
+        m_high = packno + 1;
+    } else {
+        const utp_packno_t low = std::min(m_low, packno);
+        const utp_packno_t high = std::max(m_high, packno + 1);
+        if (!reserve(low, high)) {
+            return false;
+        }
+        if (slot(packno) != nullptr) {
+            return false;
+        }
+        m_low = low;
+        m_high = high;
+    }
+
+    slot(packno) = pkt;
+    ++m_count;
+    return true;
+}
+
+PacketOut *SentPacketRing::find(utp_packno_t packno) const
+{
+    if (m_count == 0 || packno < m_low || packno >= m_high) {
+        return nullptr;
+    }
+
+    return slot(packno);
+}
+
+bool SentPacketRing::erase(const PacketOut *pkt)
+{
+    if (pkt == nullptr || find(pkt->packno) != pkt) {
+        return false;
+    }
+
+    slot(pkt->packno) = nullptr;
+    if (--m_count == 0) {
+        m_low = 0;
+        m_high = 0;
+        return true;
+    }
+
+    while (slot(m_low) == nullptr) {
+        ++m_low;
+    }
+    while (slot(m_high - 1) == nullptr) {
+        --m_high;
+    }
+    return true;
+}
+
+void SentPacketRing::clear()
+{
+    for (utp_packno_t packno = m_low; m_count > 0 && packno < m_high; ++packno) {
+        slot(packno) = nullptr;
+    }
+    m_count = 0;
+    m_low = 0;
+    m_high = 0;
+}
+
+bool SentPacketRing::reserve(utp_packno_t low, utp_packno_t high)
+{
+    const utp_packno_t span = high - low;
+    if (span <= m_capacity) {
+        return true;
+    }
+    if (span > kMaxCapacity) {
+        return false;
+    }
+
+    size_t capacity = std::max(m_capacity, kInitialCapacity);
+    while (capacity < span) {
+        capacity *= 2;
+    }
+
+    std::unique_ptr<PacketOut *[]> slots(new (std::nothrow) PacketOut *[capacity]());
+    if (!slots) {
+        return false;
+    }
+    for (utp_packno_t packno = m_low; m_count > 0 && packno < m_high; ++packno) {
+        slots[packno & (capacity - 1)] = slot(packno);
+    }
+
+    m_slots = std::move(slots);
+    m_capacity = capacity;
+    return true;
+}
+
+} // namespace utp
+} // namespace eular
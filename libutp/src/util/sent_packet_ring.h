@@ -0,0 +1,76 @@
+/*************************************************************************
+    > File Name: sent_packet_ring.h
+    > Author: eular
+    > Brief: 按包号索引的已发送包环形表
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#ifndef __UTP_UTIL_SENT_PACKET_RING_H__
+#define __UTP_UTIL_SENT_PACKET_RING_H__
+
+#include <stddef.h>
+#include <memory>
+
+#include <utils/utils.h>
+
+#include "utp/types.h"
+
+namespace eular {
+namespace utp {
+
+struct PacketOut;
+
+/**
+ * @brief 以 packno & mask 定位槽位的已发送包表, 查找/插入/删除均为 O(1)
+ *
+ * 表覆盖 [lowest(), highest()] 窗口, 窗口外的槽位恒为空; 窗口跨度超过容量时按 2 倍扩容。
+ * 删除最小(最大)包号时窗口随之收缩并跳过已空的槽位, 摊还 O(1)。
+ */
+class SentPacketRing
+{
+    DISALLOW_COPY_AND_ASSIGN(SentPacketRing);
+
+public:
+    static constexpr size_t kInitialCapacity = 64;
+    static constexpr size_t kMaxCapacity = 1u << 22;    // 窗口跨度上限, 超出时 insert 失败
+
+    SentPacketRing() = default;
+    ~SentPacketRing() = default;
+
+    bool         empty() const { return m_count == 0; }
+    size_t       size() const { return m_count; }
+    size_t       capacity() const { return m_capacity; }
+    /// @brief 表内最小包号, 表为空时无意义
+    utp_packno_t lowest() const { return m_low; }
+    /// @brief 表内最大包号, 表为空时无意义
+    utp_packno_t highest() const { return m_high - 1; }
+
+    /**
+     * @brief 以 pkt->packno 为键插入, 包号可以小于 lowest()
+     *
+     * @return 包号已存在或内存不足时返回 false, 表保持不变
+     */
+    bool         insert(PacketOut *pkt);
+    PacketOut*   find(utp_packno_t packno) const;
+    /**
+     * @brief 删除 pkt, 仅当槽位中保存的正是 pkt 时生效
+     */
+    bool         erase(const PacketOut *pkt);
+    void         clear();
+
+private:
+    bool         reserve(utp_packno_t low, utp_packno_t high);
+    PacketOut*&  slot(utp_packno_t packno) const { return m_slots[packno & (m_capacity - 1)]; }
+
+private:
+    std::unique_ptr<PacketOut *[]> m_slots;
+    size_t          m_capacity{0};
+    size_t          m_count{0};
+    utp_packno_t    m_low{0};       // 窗口下界 (含)
+    utp_packno_t    m_high{0};      // 窗口上界 (不含)
+};
+
+} // namespace utp
+} // namespace eular
+
+#endif // __UTP_UTIL_SENT_PACKET_RING_H__
@@ -0,0 +1,277 @@
+/*************************************************************************
+    > File Name: timer_wheel.cpp
+    > Author: eular
+    > Brief: 上下文级分层时间轮
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include "util/timer_wheel.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "util/time.h"
+#include "util/util.h"
+
+namespace {
+// 返回 [from, kSlots) 内第一个非空槽位, 不存在时返回 -1
+int32_t FindNextSlot(const uint64_t *bitmap, uint32_t from)
+{
+    constexpr uint32_t kWords = eular::utp::TimerWheel::kSlots / 64;
+    for (uint32_t word = from / 64; word < kWords; ++word) {
+        uint64_t bits = bitmap[word];
+        if (word == from / 64) {
+            bits &= ~0ULL << (from % 64);
+        }
+        if (bits != 0) {
+            return static_cast<int32_t>(word * 64 + eular::utp::Util::CountTrailingZeros(bits));
+        }
+    }
+    return -1;
+}
+} // namespace
+
+namespace eular {
+namespace utp {
+
+constexpr uint32_t TimerWheel::kLevels;
+constexpr uint32_t TimerWheel::kSlotBits;
+constexpr uint32_t TimerWheel::kSlots;
+constexpr uint32_t TimerWheel::kSlotMask;
+
+WheelTimer::~WheelTimer()
+{
+    stop();
+}
+
+bool WheelTimer::reset(TimerWheel *wheel, TimerCB cb) noexcept
+{
+    if (wheel == nullptr && cb == nullptr) {
+        stop();
+        m_wheel = nullptr;
+        m_cb = nullptr;
+        return true;
+    }
+
+    if (wheel == nullptr || cb == nullptr) {
+        return false;
+    }
+
+    stop();
+    m_wheel = wheel;
+    m_cb = cb;
+    return true;
+}
+
+bool WheelTimer::start(uint64_t timeout, uint64_t repeat) noexcept
+{
+    if (m_wheel == nullptr) {
+        return false;
+    }
+
+    stop();
+    m_repeat = repeat;
+    m_wheel->schedule(this, timeout);
+    return true;
+}
+
+void WheelTimer::stop() noexcept
+{
+    if (m_wheel != nullptr && isActive()) {
+        m_wheel->unlink(this);
+    }
+}
+
+TimerWheel::TimerWheel(event_base *base, uint32_t tickUs) :
+    m_tickUs(std::max<uint32_t>(tickUs, 1))
+{
+    for (uint32_t level = 0; level < kLevels; ++level) {
+        for (uint32_t slot = 0; slot < kSlots; ++slot) {
+            TAILQ_INIT(&m_slots[level][slot]);
+        }
+    }
+    std::memset(m_bitmap, 0, sizeof(m_bitmap));
+    m_current = toTick(time::MonotonicUs());
+    m_driver.reset(base, [this] () {
+        onDriverTimeout();
+    });
+}
+
+TimerWheel::~TimerWheel()
+{
+    m_driver.stop();
+    for (uint32_t level = 0; level < kLevels; ++level) {
+        for (uint32_t slot = 0; slot < kSlots; ++slot) {
+            WheelTimer *timer = nullptr;
+            while ((timer = TAILQ_FIRST(&m_slots[level][slot])) != nullptr) {
+                unlink(timer);
+                timer->m_wheel = nullptr;
+            }
+        }
+    }
+}
+
+void TimerWheel::schedule(WheelTimer *timer, uint64_t delayMs)
+{
+    const uint64_t nowTick = toTick(time::MonotonicUs());
+    if (!m_advancing && nowTick > m_current) {
+        // NOTE 当前 tick 之后直到 now 都没有到期项时直接前移, 使新定时器落在更低层
+        uint64_t next = 0;
+        if (!nextEventTick(next) || next > nowTick) {
+            m_current = nowTick;
+        }
+    }
+
+    // NOTE 推进过程中新挂入的定时器最早在下一次推进时触发, 与 libevent 定时器语义一致, 避免回调反复重挂导致空转
+    const uint64_t ticks = (delayMs * 1000 + m_tickUs - 1) / m_tickUs;
+    const uint64_t floorTick = m_advancing ? std::max(m_current, m_advanceTarget) : m_current;
+    timer->m_expire = std::max<uint64_t>(nowTick + ticks, floorTick + 1);
+    place(timer);
+    ++m_count;
+
+    if (!m_advancing) {
+        rearm(nowTick);
+    }
+}
+
+void TimerWheel::place(WheelTimer *timer)
+{
+    const uint64_t diff = timer->m_expire - m_current;
+    uint32_t level = 0;
+    while (level + 1 < kLevels && diff >= (1ULL << (kSlotBits * (level + 1)))) {
+        ++level;
+    }
+
+    // 超出最高层覆盖范围时先挂到最远的槽位, 级联时再按真实到期时间重新放置
+    const uint64_t span = 1ULL << (kSlotBits * kLevels);
+    const uint64_t slotExpire = diff >= span ? m_current + span - 1 : timer->m_expire;
+    const uint32_t slot = static_cast<uint32_t>((slotExpire >> (kSlotBits * level)) & kSlotMask);
+
+    TAILQ_INSERT_TAIL(&m_slots[level][slot], timer, m_link);
+    m_bitmap[level][slot / 64] |= 1ULL << (slot % 64);
+    timer->m_level = static_cast<int16_t>(level);
+    timer->m_slot = static_cast<uint16_t>(slot);
+}
+
+void TimerWheel::unlink(WheelTimer *timer)
+{
+    const uint32_t level = static_cast<uint32_t>(timer->m_level);
+    const uint32_t slot = timer->m_slot;
+    TAILQ_REMOVE(&m_slots[level][slot], timer, m_link);
+    if (TAILQ_EMPTY(&m_slots[level][slot])) {
+        m_bitmap[level][slot / 64] &= ~(1ULL << (slot % 64));
+    }
+    timer->m_level = -1;
+    --m_count;
+}
+
+void TimerWheel::cascade(uint32_t level)
+{
+    const uint32_t slot = static_cast<uint32_t>((m_current >> (kSlotBits * level)) & kSlotMask);
+    TimerList pending;
+    TAILQ_INIT(&pending);
+    WheelTimer *timer = nullptr;
+    while ((timer = TAILQ_FIRST(&m_slots[level][slot])) != nullptr) {
+        unlink(timer);
+        TAILQ_INSERT_TAIL(&pending, timer, m_link);
+    }
+    while ((timer = TAILQ_FIRST(&pending)) != nullptr) {
+        TAILQ_REMOVE(&pending, timer, m_link);
+        place(timer);
+        ++m_count;
+    }
+}
+
+bool TimerWheel::nextEventTick(uint64_t &tick) const
+{
+    bool found = false;
+    for (uint32_t level = 0; level < kLevels; ++level) {
+        const uint32_t shift = kSlotBits * level;
+        const uint32_t current = static_cast<uint32_t>((m_current >> shift) & kSlotMask);
+        // 第 0 层槽位即到期 tick; 更高层槽位对应的块一定在当前块之后, 到达块起点时级联
+        const uint32_t from = level == 0 ? current : current + 1;
+        int32_t slot = from < kSlots ? FindNextSlot(m_bitmap[level], from) : -1;
+        if (slot < 0) {
+            slot = FindNextSlot(m_bitmap[level], 0);
+        }
+        if (slot < 0) {
+            continue;
+        }
+
+        uint64_t distance = (static_cast<uint32_t>(slot) - current) & kSlotMask;
+        if (level > 0 && distance == 0) {
+            distance = kSlots;
+        }
+        const uint64_t candidate = level == 0 ? m_current + distance
+                                              : ((m_current >> shift) + distance) << shift;
+        if (!found || candidate < tick) {
+            tick = candidate;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void TimerWheel::advance(uint64_t nowUs)
+{
+    const uint64_t target = toTick(nowUs);
+    m_advanceTarget = target;
+    m_advancing = true;
+    while (m_count > 0) {
+        uint64_t next = 0;
+        if (!nextEventTick(next) || next > target) {
+            break;
+        }
+
+        m_current = next;
+        for (uint32_t level = kLevels - 1; level > 0; --level) {
+            const uint64_t blockMask = (1ULL << (kSlotBits * level)) - 1;
+            if ((m_current & blockMask) == 0) {
+                cascade(level);
+            }
+        }
+
+        TimerList &expired = m_slots[0][m_current & kSlotMask];
+        WheelTimer *timer = nullptr;
+        while ((timer = TAILQ_FIRST(&expired)) != nullptr) {
+            unlink(timer);
+            if (timer->m_repeat != 0) {
+                schedule(timer, timer->m_repeat);
+            }
+            // NOTE 回调可能析构定时器所属对象, 先复制回调
+            WheelTimer::TimerCB cb = timer->m_cb;
+            cb();
+        }
+    }
+    m_current = std::max(m_current, target);
+    m_advancing = false;
+    rearm(target);
+}
+
+void TimerWheel::rearm(uint64_t nowTick)
+{
+    uint64_t next = 0;
+    if (!nextEventTick(next)) {
+        m_driver.stop();
+        m_armedTick = UINT64_MAX;
+        return;
+    }
+
+    // NOTE 仅在最早到期时间提前时才重新 event_add, 晚到的驱动触发只会空推进一次
+    if (next >= m_armedTick) {
+        return;
+    }
+
+    const uint64_t delayUs = (next > nowTick ? next - nowTick : 0) * m_tickUs;
+    m_armedTick = next;
+    m_driver.start((delayUs + 999) / 1000);
+}
+
+void TimerWheel::onDriverTimeout()
+{
+    m_armedTick = UINT64_MAX;
+    advance(time::MonotonicUs());
+}
+
+} // namespace utp
+} // namespace eular
@@ -0,0 +1,119 @@
+/*************************************************************************
+    > File Name: timer_wheel.h
+    > Author: eular
+    > Brief: 上下文级分层时间轮, 以单个 libevent 定时器驱动所有连接定时器
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#ifndef __UTP_UTIL_TIMER_WHEEL_H__
+#define __UTP_UTIL_TIMER_WHEEL_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <functional>
+
+#include <queue.h>
+#include <event/timer.h>
+#include <utils/utils.h>
+
+struct event_base;
+
+namespace eular {
+namespace utp {
+
+class TimerWheel;
+
+/**
+ * @brief 挂在 TimerWheel 上的定时器, 接口与 ev::EventTimer 保持一致 (超时单位 ms)
+ *
+ * 启停只做链表摘挂, 不经过 libevent 最小堆; 析构时自动从时间轮摘除。
+ */
+struct WheelTimer
+{
+    DISALLOW_COPY_AND_ASSIGN(WheelTimer);
+    DISALLOW_MOVE(WheelTimer);
+
+public:
+    using TimerCB = std::function<void()>;
+
+    WheelTimer() noexcept = default;
+    ~WheelTimer();
+
+    /**
+     * @brief 绑定时间轮与回调, 两者均为空时解除绑定
+     */
+    bool reset(TimerWheel *wheel = nullptr, TimerCB cb = nullptr) noexcept;
+    bool start(uint64_t timeout, uint64_t repeat = 0) noexcept;
+    void stop() noexcept;
+    bool isActive() const noexcept { return m_level >= 0; }
+
+private:
+    friend class TimerWheel;
+
+    TAILQ_ENTRY(WheelTimer) m_link;
+    TimerWheel* m_wheel{nullptr};
+    TimerCB     m_cb;
+    uint64_t    m_expire{0};    // 到期 tick
+    uint64_t    m_repeat{0};    // 重复间隔 (ms)
+    int16_t     m_level{-1};    // 所在层, -1 表示未挂载
+    uint16_t    m_slot{0};
+};
+
+/**
+ * @brief 分层时间轮 (4 层 x 256 槽), tick 取 Config::clock_granularity_us
+ *
+ * 只在最近一个非空槽位(或需要级联的槽位)到期时唤醒, 空闲区间借助各层位图整段跳过;
+ * 驱动定时器仅在最早到期时间提前时才重新 event_add。
+ */
+class TimerWheel
+{
+    DISALLOW_COPY_AND_ASSIGN(TimerWheel);
+    DISALLOW_MOVE(TimerWheel);
+
+public:
+    static constexpr uint32_t kLevels = 4;
+    static constexpr uint32_t kSlotBits = 8;
+    static constexpr uint32_t kSlots = 1u << kSlotBits;
+    static constexpr uint32_t kSlotMask = kSlots - 1;
+
+    TimerWheel(event_base *base, uint32_t tickUs);
+    ~TimerWheel();
+
+    uint32_t tickUs() const { return m_tickUs; }
+    size_t   size() const { return m_count; }
+
+    /**
+     * @brief 推进时间轮到 nowUs 并触发所有到期定时器, 由驱动定时器调用
+     */
+    void advance(uint64_t nowUs);
+
+private:
+    friend struct WheelTimer;
+    TAILQ_HEAD(TimerList, WheelTimer);
+
+    void     schedule(WheelTimer *timer, uint64_t delayMs);
+    void     unlink(WheelTimer *timer);
+    void     place(WheelTimer *timer);
+    void     cascade(uint32_t level);
+    bool     nextEventTick(uint64_t &tick) const;
+    void     rearm(uint64_t nowTick);
+    void     onDriverTimeout();
+    uint64_t toTick(uint64_t us) const { return us / m_tickUs; }
+
+private:
+    TimerList       m_slots[kLevels][kSlots];
+    uint64_t        m_bitmap[kLevels][kSlots / 64];
+    uint64_t        m_current{0};               // 当前 tick
+    uint64_t        m_armedTick{UINT64_MAX};    // 驱动定时器已设置的到期 tick
+    uint64_t        m_advanceTarget{0};         // 本次推进的目标 tick
+    size_t          m_count{0};
+    uint32_t        m_tickUs{1};
+    bool            m_advancing{false};
+    ev::EventTimer  m_driver;
+};
+
+} // namespace utp
+} // namespace eular
+
+#endif // __UTP_UTIL_TIMER_WHEEL_H__
@@ -0,0 +1,163 @@
+/*************************************************************************
+    > File Name: trace_recorder.cpp
+    > Author: eular
+    > Brief: 每连接的定长二进制事件追踪环, 可导出为 qlog JSON
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include "util/trace_recorder.h"
+
+#include <algorithm>
+
+#include "fmt/fmt.h"
+
+namespace eular {
+namespace utp {
+
+namespace {
+
+constexpr size_t kMinTraceRecords = 16;
+
+size_t RoundUpPow2(size_t value)
+{
+    size_t result = kMinTraceRecords;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+const char *TimerName(uint8_t timer)
+{
+    switch (timer) {
+    case kTraceTimerConn:           return "connection";
+    case kTraceTimerSchedule:       return "schedule";
+    case kTraceTimerPathValidation: return "path_validation";
+    case kTraceTimerHandshakeDone:  return "handshake_done";
+    case kTraceTimerAck:            return "ack";
+    case kTraceTimerKeepalive:      return "keepalive";
+    case kTraceTimerCloseDrain:     return "close_drain";
+    case kTraceTimerRetrans:        return "retransmission";
+    default:                        return "unknown";
+    }
+}
+
+// qlog 的 JSON 字符串转义, 仅 title 需要
+std::string EscapeJson(const std::string &value)
+{
+    std::string out;
+    out.reserve(value.size());
+    for (char ch : value) {
+        switch (ch) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(ch) < 0x20) {
+                out += fmt::format("\\u{:04x}", static_cast<unsigned>(ch));
+            } else {
+                out += ch;
+            }
+            break;
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+TraceRecorder::TraceRecorder(size_t capacity) :
+    m_records(RoundUpPow2(capacity))
+{
+    m_mask = m_records.size() - 1;
+}
+
+std::vector<TraceRecord> TraceRecorder::snapshot() const
+{
+    std::vector<TraceRecord> out;
+    const uint64_t count = std::min<uint64_t>(m_written, m_records.size());
+    out.reserve(static_cast<size_t>(count));
+    for (uint64_t seq = m_written - count; seq < m_written; ++seq) {
+        out.push_back(m_records[static_cast<size_t>(seq & m_mask)]);
+    }
+    return out;
+}
+
+std::string TraceRecorder::ToQlog(const std::vector<TraceRecord> &records, const std::string &title,
+                                  uint32_t groupId, uint64_t dropped)
+{
+    const uint64_t referenceUs = records.empty() ? 0 : records.front().timeUs;
+
+    fmt::memory_buffer buf;
+    fmt::format_to(std::back_inserter(buf),
+                   "{{\"qlog_version\":\"0.3\",\"qlog_format\":\"JSON\",\"title\":\"{}\",\"traces\":[{{"
+                   "\"vantage_point\":{{\"type\":\"unknown\"}},"
+                   "\"common_fields\":{{\"group_id\":\"{:08x}\",\"time_format\":\"relative\","
+                   "\"reference_time\":{}.{:03d},\"dropped_events\":{}}},\"events\":[",
+                   EscapeJson(title), groupId, referenceUs / 1000, static_cast<int>(referenceUs % 1000), dropped);
+
+    bool first = true;
+    for (const TraceRecord &rec : records) {
+        const uint64_t relUs = rec.timeUs >= referenceUs ? rec.timeUs - referenceUs : 0;
+        fmt::format_to(std::back_inserter(buf), "{}{{\"time\":{}.{:03d},", first ? "" : ",",
+                       relUs / 1000, static_cast<int>(relUs % 1000));
+        first = false;
+
+        switch (rec.type) {
+        case kTracePacketSent:
+            fmt::format_to(std::back_inserter(buf),
+                           "\"name\":\"transport:packet_sent\",\"data\":{{\"header\":{{\"packet_number\":{}}},"
+                           "\"raw\":{{\"length\":{}}},\"bytes_in_flight\":{}}}}}",
+                           rec.a, rec.u32, rec.b);
+            break;
+        case kTracePacketAcked:
+            fmt::format_to(std::back_inserter(buf),
+                           "\"name\":\"recovery:packet_acked\",\"data\":{{\"header\":{{\"packet_number\":{}}},"
+                           "\"raw\":{{\"length\":{}}},\"sent_time_us\":{}}}}}",
+                           rec.a, rec.u32, rec.b);
+            break;
+        case kTracePacketLost:
+            fmt::format_to(std::back_inserter(buf),
+                           "\"name\":\"recovery:packet_lost\",\"data\":{{\"header\":{{\"packet_number\":{}}},"
+                           "\"raw\":{{\"length\":{}}},\"sent_time_us\":{}}}}}",
+                           rec.a, rec.u32, rec.b);
+            break;
+        case kTraceCongestionUpdate:
+            fmt::format_to(std::back_inserter(buf),
+                           "\"name\":\"recovery:metrics_updated\",\"data\":{{\"congestion_window\":{},"
+                           "\"pacing_rate\":{},\"bytes_in_flight\":{}}}}}",
+                           rec.a, rec.b * 8, rec.u32);
+            break;
+        case kTraceStreamScheduled:
+            fmt::format_to(std::back_inserter(buf),
+                           "\"name\":\"utp:stream_scheduled\",\"data\":{{\"stream_id\":{},\"scheduler\":{},"
+                           "\"priority\":{},\"drr_deficit\":{}}}}}",
+                           rec.u32, rec.sub, rec.aux, rec.a);
+            break;
+        case kTraceTimerFired:
+            // 只有重传定时器对应 qlog 的 loss timer, 其他定时器用自定义事件, 避免被工具当作丢包定时器到期
+            if (rec.sub == kTraceTimerRetrans) {
+                fmt::format_to(std::back_inserter(buf),
+                               "\"name\":\"recovery:loss_timer_updated\",\"data\":{{\"event_type\":\"expired\","
+                               "\"timer_type\":\"{}\",\"mode\":{}}}}}",
+                               TimerName(rec.sub), rec.a);
+            } else {
+                fmt::format_to(std::back_inserter(buf),
+                               "\"name\":\"utp:timer_fired\",\"data\":{{\"timer_type\":\"{}\",\"detail\":{}}}}}",
+                               TimerName(rec.sub), rec.a);
+            }
+            break;
+        default:
+            fmt::format_to(std::back_inserter(buf), "\"name\":\"utp:unknown\",\"data\":{{\"type\":{}}}}}", rec.type);
+            break;
+        }
+    }
+
+    fmt::format_to(std::back_inserter(buf), "]}}]}}");
+    return fmt::to_string(buf);
+}
+
+} // namespace utp
+} // namespace eular
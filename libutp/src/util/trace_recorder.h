@@ -0,0 +1,104 @@
+/*************************************************************************
+    > File Name: trace_recorder.h
+    > Author: eular
+    > Brief: 每连接的定长二进制事件追踪环, 可导出为 qlog JSON
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#ifndef __UTP_UTIL_TRACE_RECORDER_H__
+#define __UTP_UTIL_TRACE_RECORDER_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace eular {
+namespace utp {
+
+enum TraceEvent : uint8_t {
+    kTracePacketSent = 1,       ///< a: 包号, b: 发送后在途字节, u32: 包大小
+    kTracePacketAcked,          ///< a: 包号, b: 发送时间 (us), u32: 包大小
+    kTracePacketLost,           ///< a: 包号, b: 发送时间 (us), u32: 包大小
+    kTraceCongestionUpdate,     ///< a: cwnd, b: pacing 速率 (字节/秒), u32: 在途字节 (截断到 32 位)
+    kTraceStreamScheduled,      ///< a: 选中后的 DRR 赤字, u32: 流 ID, sub: 调度模式, aux: 有效优先级
+    kTraceTimerFired,           ///< sub: TraceTimer, a: 定时器相关参数 (如重传模式); 仅重传定时器导出为 recovery:loss_timer_updated
+};
+
+enum TraceTimer : uint8_t {
+    kTraceTimerConn = 1,
+    kTraceTimerSchedule,
+    kTraceTimerPathValidation,
+    kTraceTimerHandshakeDone,
+    kTraceTimerAck,
+    kTraceTimerKeepalive,
+    kTraceTimerCloseDrain,
+    kTraceTimerRetrans,
+};
+
+/**
+ * @brief 定长追踪记录, 字段含义由 type 决定 (见 TraceEvent)
+ */
+struct TraceRecord {
+    uint64_t    timeUs;     // 单调时钟 (us)
+    uint8_t     type;
+    uint8_t     sub;
+    uint16_t    aux;
+    uint32_t    u32;
+    uint64_t    a;
+    uint64_t    b;
+};
+static_assert(sizeof(TraceRecord) == 32, "TraceRecord must stay 32 bytes");
+
+/**
+ * @brief 事件追踪环
+ *
+ * 预分配 2 的幂条记录, 写满后覆盖最旧的记录. 记录路径只做一次下标计算和 32 字节写入, 不分配内存、不加锁,
+ * 只能在连接所在的事件循环线程调用. 导出时按时间顺序拷贝出来再转换为 qlog, 不影响记录路径.
+ */
+class TraceRecorder
+{
+public:
+    explicit TraceRecorder(size_t capacity);
+
+    void        record(TraceEvent type, uint64_t timeUs, uint64_t a, uint64_t b = 0, uint32_t u32 = 0,
+                       uint8_t sub = 0, uint16_t aux = 0)
+    {
+        TraceRecord &rec = m_records[static_cast<size_t>(m_written & m_mask)];
+        rec.timeUs = timeUs;
+        rec.type = type;
+        rec.sub = sub;
+        rec.aux = aux;
+        rec.u32 = u32;
+        rec.a = a;
+        rec.b = b;
+        ++m_written;
+    }
+
+    size_t      capacity() const { return m_records.size(); }
+    /// @brief 累计写入的记录数, 超过容量的部分已被覆盖
+    uint64_t    written() const { return m_written; }
+    /// @brief 按写入顺序返回环中仍保留的记录
+    std::vector<TraceRecord> snapshot() const;
+
+    /**
+     * @brief 将记录转换为 qlog (0.3, JSON 格式)
+     *
+     * @param records 按时间顺序排列的记录
+     * @param title 写入 qlog 的标题
+     * @param groupId 写入 common_fields.group_id, 通常为本端连接 ID
+     * @param dropped 因环被写满而丢失的最旧记录数
+     */
+    static std::string ToQlog(const std::vector<TraceRecord> &records, const std::string &title,
+                              uint32_t groupId, uint64_t dropped = 0);
+
+private:
+    std::vector<TraceRecord>    m_records;
+    uint64_t                    m_mask{0};
+    uint64_t                    m_written{0};
+};
+
+} // namespace utp
+} // namespace eular
+
+#endif // __UTP_UTIL_TRACE_RECORDER_H__
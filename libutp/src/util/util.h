@@ -9,9 +9,15 @@
 #define __UTP_UTIL_H__
 
 #include <cstddef>
+#include <cstdint>
 
+#include "utp/platform.h"
 #include "utp/types.h"
 
+#if defined(UTP_COMPILER_MSVC)
+#include <intrin.h>
+#endif
+
 namespace eular {
 namespace utp {
 class Util {
@@ -41,6 +47,48 @@ public:
      * @return uint32_t 生成的远端CID
      */
     static uint32_t GenerateRemoteConnectionId(const void *key, const char *peerIp, uint32_t peerCid, utp_time_t timestamp, uint8_t attempt = 0);
+
+    /**
+     * @brief 返回最低置位比特的下标
+     *
+     * @param value 调用方保证非 0
+     * @return uint32_t 下标, 范围 [0, 64)
+     */
+    static inline uint32_t CountTrailingZeros(uint64_t value)
+    {
+#if defined(UTP_COMPILER_MSVC)
+        unsigned long index = 0;
+        _BitScanForward64(&index, value);
+        return static_cast<uint32_t>(index);
+#elif defined(UTP_COMPILER_GNU_LIKE)
+        return static_cast<uint32_t>(__builtin_ctzll(value));
+#else
+        uint32_t index = 0;
+        while (((value >> index) & 1u) == 0u) {
+            ++index;
+        }
+        return index;
+#endif
+    }
+
+    /**
+     * @brief 返回置位比特个数
+     */
+    static inline uint32_t PopCount(uint64_t value)
+    {
+#if defined(UTP_COMPILER_MSVC)
+        return static_cast<uint32_t>(__popcnt64(value));
+#elif defined(UTP_COMPILER_GNU_LIKE)
+        return static_cast<uint32_t>(__builtin_popcountll(value));
+#else
+        uint32_t count = 0;
+        while (value != 0) {
+            value &= value - 1;
+            ++count;
+        }
+        return count;
+#endif
+    }
 };
 
 } // namespace utp
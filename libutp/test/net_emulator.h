@@ -0,0 +1,653 @@
+/*************************************************************************
+    > File Name: net_emulator.h
+    > Author: eular
+    > Brief: 进程内网络仿真与拥塞控制评估
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#ifndef __UTP_TEST_NET_EMULATOR_H__
+#define __UTP_TEST_NET_EMULATOR_H__
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <event2/event.h>
+#include <event/loop.h>
+
+#include "congestion/bbr_v1.h"
+#include "congestion/bbr_v2.h"
+#include "congestion/cubic.h"
+#include "congestion/pacer.h"
+#include "context/context_impl.h"
+#include "util/time.h"
+#include "utp/config.h"
+
+namespace eular {
+namespace utp {
+namespace netem {
+
+/**
+ * @brief 单向链路参数
+ *
+ * 包先进入瓶颈 FIFO (drop-tail), 按带宽串行化后再经过传播时延; 随机丢包发生在出队之后,
+ * 因此被丢弃的包同样占用瓶颈带宽. 突发丢包采用 Gilbert-Elliott 两状态模型.
+ */
+struct LinkConfig {
+    uint64_t    bandwidthBps{20 * 1000 * 1000}; // 瓶颈带宽 (bit/s), 0 表示不限速
+    uint32_t    rttMs{40};              // 双向传播时延, 每个方向各占一半
+    uint32_t    jitterMs{0};            // 每包额外时延在 [0, jitterMs] 内均匀分布
+    double      lossRate{0.0};          // Good 状态下的随机丢包率
+    double      burstEnter{0.0};        // 每包从 Good 进入 Bad 状态的概率
+    double      burstExit{0.5};         // 每包从 Bad 回到 Good 状态的概率
+    double      burstLossRate{1.0};     // Bad 状态下的丢包率
+    double      reorderRate{0.0};       // 被额外延迟 reorderDelayMs 的包的比例
+    uint32_t    reorderDelayMs{0};
+    size_t      queueBytes{64 * 1024};  // 瓶颈队列容量, 0 表示不限
+    uint32_t    seed{1};
+};
+
+struct LinkStats {
+    uint64_t    packets{0};
+    uint64_t    bytes{0};
+    uint64_t    queueDrops{0};          // 瓶颈队列溢出
+    uint64_t    lossDrops{0};           // 随机/突发丢包
+    std::vector<uint64_t> queueDelayUs; // 每个入队包的排队时延
+
+    uint64_t queueDelayPercentile(double q) const
+    {
+        if (queueDelayUs.empty()) {
+            return 0;
+        }
+        std::vector<uint64_t> sorted(queueDelayUs);
+        const size_t index = std::min(sorted.size() - 1, static_cast<size_t>(q * static_cast<double>(sorted.size())));
+        std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(index), sorted.end());
+        return sorted[index];
+    }
+
+    double queueDelayMeanUs() const
+    {
+        if (queueDelayUs.empty()) {
+            return 0.0;
+        }
+        long double sum = 0;
+        for (uint64_t v : queueDelayUs) {
+            sum += v;
+        }
+        return static_cast<double>(sum / queueDelayUs.size());
+    }
+};
+
+/**
+ * @brief 单向虚拟链路, 只计算每个包的命运 (丢弃或到达时间), 由调用方负责按时间投递
+ */
+class VirtualLink
+{
+public:
+    struct Verdict {
+        bool        dropped{false};
+        uint64_t    deliverAtUs{0};
+    };
+
+    explicit VirtualLink(const LinkConfig &cfg = LinkConfig()) { reset(cfg); }
+
+    void reset(const LinkConfig &cfg)
+    {
+        m_cfg = cfg;
+        m_rng.seed(cfg.seed);
+        m_busyUntilNs = 0;
+        m_badState = false;
+        m_stats = LinkStats();
+    }
+
+    Verdict submit(uint64_t nowUs, size_t bytes)
+    {
+        Verdict verdict;
+        const uint64_t nowNs = nowUs * 1000;
+        uint64_t startNs = nowNs;
+        if (m_cfg.bandwidthBps > 0) {
+            // 未发完的字节即当前队列长度
+            const uint64_t backlogNs = m_busyUntilNs > nowNs ? m_busyUntilNs - nowNs : 0;
+            const uint64_t backlogBytes = backlogNs * m_cfg.bandwidthBps / 8000000000ULL;
+            if (m_cfg.queueBytes > 0 && backlogBytes + bytes > m_cfg.queueBytes) {
+                ++m_stats.queueDrops;
+                verdict.dropped = true;
+                return verdict;
+            }
+            startNs = std::max(nowNs, m_busyUntilNs);
+            m_busyUntilNs = startNs + bytes * 8000000000ULL / m_cfg.bandwidthBps;
+        } else {
+            m_busyUntilNs = nowNs;
+        }
+
+        ++m_stats.packets;
+        m_stats.bytes += bytes;
+        m_stats.queueDelayUs.push_back((startNs - nowNs) / 1000);
+
+        if (lose()) {
+            ++m_stats.lossDrops;
+            verdict.dropped = true;
+            return verdict;
+        }
+
+        uint64_t delayUs = static_cast<uint64_t>(m_cfg.rttMs) * 1000 / 2;
+        if (m_cfg.jitterMs > 0) {
+            delayUs += std::uniform_int_distribution<uint64_t>(0, m_cfg.jitterMs * 1000ULL)(m_rng);
+        }
+        if (m_cfg.reorderRate > 0 && uniform() < m_cfg.reorderRate) {
+            delayUs += m_cfg.reorderDelayMs * 1000ULL;
+        }
+        verdict.deliverAtUs = (m_busyUntilNs + 999) / 1000 + delayUs;
+        return verdict;
+    }
+
+    const LinkConfig &config() const { return m_cfg; }
+    const LinkStats &stats() const { return m_stats; }
+    /// @brief 只清空统计, 队列与丢包状态保持不变
+    void clearStats() { m_stats = LinkStats(); }
+
+private:
+    double uniform() { return std::uniform_real_distribution<double>(0.0, 1.0)(m_rng); }
+
+    bool lose()
+    {
+        if (m_cfg.burstEnter > 0) {
+            m_badState = m_badState ? (uniform() >= m_cfg.burstExit) : (uniform() < m_cfg.burstEnter);
+        }
+        const double rate = m_badState ? m_cfg.burstLossRate : m_cfg.lossRate;
+        return rate > 0 && uniform() < rate;
+    }
+
+private:
+    LinkConfig      m_cfg;
+    std::mt19937_64 m_rng;
+    uint64_t        m_busyUntilNs{0};
+    bool            m_badState{false};
+    LinkStats       m_stats;
+};
+
+/// @brief 单次评估的结果, 重传率 = 重传字节 / 发送字节
+struct EvalResult {
+    uint64_t    durationUs{0};
+    uint64_t    deliveredBytes{0};      // 接收端收到的去重后数据量
+    uint64_t    txBytes{0};
+    uint64_t    rtxBytes{0};
+    uint64_t    queueDrops{0};
+    uint64_t    lossDrops{0};
+    double      queueDelayMeanMs{0};
+    double      queueDelayP50Ms{0};
+    double      queueDelayP95Ms{0};
+
+    double goodputMbps() const
+    {
+        return durationUs == 0 ? 0.0 : static_cast<double>(deliveredBytes) * 8.0 / static_cast<double>(durationUs);
+    }
+
+    double retransRatio() const
+    {
+        return txBytes == 0 ? 0.0 : static_cast<double>(rtxBytes) / static_cast<double>(txBytes);
+    }
+
+    void fillQueueStats(const LinkStats &stats)
+    {
+        queueDrops = stats.queueDrops;
+        lossDrops = stats.lossDrops;
+        queueDelayMeanMs = stats.queueDelayMeanUs() / 1000.0;
+        queueDelayP50Ms = stats.queueDelayPercentile(0.50) / 1000.0;
+        queueDelayP95Ms = stats.queueDelayPercentile(0.95) / 1000.0;
+    }
+};
+
+inline std::string FormatResultHeader()
+{
+    char line[160];
+    snprintf(line, sizeof(line), "%-10s %12s %10s %10s %10s %10s %9s %9s",
+        "algorithm", "goodput Mbps", "retrans %", "qdelay ms", "q p50 ms", "q p95 ms", "q drops", "loss");
+    return line;
+}
+
+inline std::string FormatResult(const std::string &name, const EvalResult &result)
+{
+    char line[160];
+    snprintf(line, sizeof(line), "%-10s %12.2f %10.2f %10.2f %10.2f %10.2f %9llu %9llu",
+        name.c_str(), result.goodputMbps(), result.retransRatio() * 100.0,
+        result.queueDelayMeanMs, result.queueDelayP50Ms, result.queueDelayP95Ms,
+        static_cast<unsigned long long>(result.queueDrops), static_cast<unsigned long long>(result.lossDrops));
+    return line;
+}
+
+using CongestionFactory = std::function<Congestion::SP(const Config *cfg)>;
+
+/// @brief 与 SendControl 相同的 cc_algorithm 映射, 新算法可直接传入自定义工厂
+inline Congestion::SP MakeCongestion(const Config *cfg)
+{
+    if (cfg != nullptr && cfg->cc_algorithm == 2) {
+        return std::make_shared<Cubic>(cfg);
+    }
+    if (cfg != nullptr && cfg->cc_algorithm == 3) {
+        return std::make_shared<BbrV2>(cfg);
+    }
+    return std::make_shared<BbrV1>(cfg);
+}
+
+/**
+ * @brief 仿真时钟下的拥塞控制评估
+ *
+ * 离散事件模型: 单条始终有数据可发的流, 接收端逐包立即确认, 反向路径只有传播时延.
+ * 发送侧按 SendControl 的调用顺序驱动 Congestion (onPacketSent / onBeginAck / onAck / onEndAck /
+ * onLost / onLoss), 丢包判定采用包序阈值 3 与 9/8 RTT 时间阈值, 长时间无确认时整窗判丢并调用 onTimeout.
+ * 不经过套接字与定时器, 几秒的传输在毫秒级完成, 结果只取决于链路参数与随机种子.
+ */
+class CcSimulator
+{
+public:
+    CcSimulator(const LinkConfig &link, const CongestionFactory &factory, const Config *cfg = nullptr) :
+        m_link(link),
+        m_cc(factory(cfg))
+    {
+        m_cc->onInit(&m_rtt);
+    }
+
+    EvalResult run(uint64_t durationMs, uint32_t packetSize = 1200)
+    {
+        const uint64_t endUs = durationMs * 1000;
+        m_packetSize = packetSize;
+        while (m_nowUs < endUs) {
+            trySend();
+
+            uint64_t next = endUs;
+            if (!m_events.empty()) {
+                next = std::min(next, m_events.top().atUs);
+            }
+            if (canSendByCwnd()) {
+                next = std::min(next, std::max(m_nowUs + 1, (m_nextSendNs + 999) / 1000));
+            }
+            if (!m_outstanding.empty()) {
+                next = std::min(next, m_lastProgressUs + ptoUs());
+            }
+            m_nowUs = std::max(m_nowUs, next);
+
+            while (!m_events.empty() && m_events.top().atUs <= m_nowUs) {
+                const Event ev = m_events.top();
+                m_events.pop();
+                if (ev.ack) {
+                    onAckArrived(ev.packNo);
+                } else {
+                    onDataArrived(ev.packNo, ev.chunk);
+                }
+            }
+            if (!m_outstanding.empty() && m_nowUs >= m_lastProgressUs + ptoUs()) {
+                onPto();
+            }
+        }
+
+        EvalResult result;
+        result.durationUs = endUs;
+        result.deliveredBytes = m_deliveredChunks * m_packetSize;
+        result.txBytes = m_txBytes;
+        result.rtxBytes = m_rtxBytes;
+        result.fillQueueStats(m_link.stats());
+        return result;
+    }
+
+    const RttStats &rtt() const { return m_rtt; }
+    Congestion *congestion() const { return m_cc.get(); }
+
+private:
+    struct Sent {
+        PacketInfo  info;
+        uint64_t    chunk;
+    };
+
+    struct Event {
+        uint64_t    atUs;
+        uint64_t    seq;
+        uint64_t    packNo;
+        uint64_t    chunk;
+        bool        ack;
+
+        bool operator>(const Event &other) const
+        {
+            return atUs != other.atUs ? atUs > other.atUs : seq > other.seq;
+        }
+    };
+
+    bool canSendByCwnd() const { return m_inflight + m_packetSize <= m_cc->getCwnd(); }
+
+    uint64_t ptoUs() const
+    {
+        if (m_rtt.srtt() == 0) {
+            return 1000000;
+        }
+        return m_rtt.srtt() + std::max<uint64_t>(4 * m_rtt.rttVar(), 1000) + 25000;
+    }
+
+    void trySend()
+    {
+        while (canSendByCwnd() && m_nextSendNs <= m_nowUs * 1000) {
+            uint64_t chunk = 0;
+            const bool retrans = !m_retransQueue.empty();
+            if (retrans) {
+                chunk = m_retransQueue.front();
+                m_retransQueue.pop_front();
+                m_rtxBytes += m_packetSize;
+            } else {
+                chunk = m_nextChunk++;
+            }
+
+            const uint64_t packNo = ++m_lastPackNo;
+            if (m_outstanding.empty()) {
+                m_lastProgressUs = m_nowUs;
+            }
+            Sent &sent = m_outstanding[packNo];
+            sent.info.packetNo = packNo;
+            sent.info.sendTimeUs = m_nowUs;
+            sent.info.packetSize = m_packetSize;
+            sent.info.packetState = nullptr;
+            sent.chunk = chunk;
+            m_cc->onPacketSent(&sent.info, m_inflight, 0);
+            m_inflight += m_packetSize;
+            m_txBytes += m_packetSize;
+
+            const VirtualLink::Verdict verdict = m_link.submit(m_nowUs, m_packetSize);
+            if (!verdict.dropped) {
+                m_events.push(Event{verdict.deliverAtUs, m_eventSeq++, packNo, chunk, false});
+            }
+
+            const uint64_t rate = m_cc->getPacingRate(0);
+            m_nextSendNs = std::max(m_nextSendNs, m_nowUs * 1000) + Pacer::departureGapNs(m_packetSize, rate);
+        }
+    }
+
+    void onDataArrived(uint64_t packNo, uint64_t chunk)
+    {
+        if (chunk >= m_received.size()) {
+            m_received.resize(chunk + 1024, 0);
+        }
+        if (!m_received[chunk]) {
+            m_received[chunk] = 1;
+            ++m_deliveredChunks;
+        }
+        const uint64_t oneWayUs = static_cast<uint64_t>(m_link.config().rttMs) * 1000 / 2;
+        m_events.push(Event{m_nowUs + oneWayUs, m_eventSeq++, packNo, chunk, true});
+    }
+
+    void onAckArrived(uint64_t packNo)
+    {
+        auto it = m_outstanding.find(packNo);
+        if (it == m_outstanding.end()) {
+            return; // 已判丢的包迟到, 不再计入
+        }
+
+        m_cc->onBeginAck(m_nowUs, m_inflight);
+        const uint64_t sendTimeUs = it->second.info.sendTimeUs;
+        m_inflight -= it->second.info.packetSize;
+        m_cc->onAck(&it->second.info, m_nowUs, 0);
+        m_outstanding.erase(it);
+        m_cc->onEndAck(m_inflight);
+
+        m_rtt.update(static_cast<int64_t>(m_nowUs - sendTimeUs));
+        m_largestAcked = std::max(m_largestAcked, packNo);
+        m_lastProgressUs = m_nowUs;
+        detectLoss(sendTimeUs);
+    }
+
+    void detectLoss(uint64_t latestSendUs)
+    {
+        const uint64_t lossDelayUs = std::max(m_rtt.srtt(), m_nowUs - latestSendUs) * 9 / 8;
+        bool lost = false;
+        for (auto it = m_outstanding.begin(); it != m_outstanding.end() && it->first < m_largestAcked;) {
+            if (it->first + 3 <= m_largestAcked || it->second.info.sendTimeUs + lossDelayUs <= m_nowUs) {
+                markLost(it->second);
+                it = m_outstanding.erase(it);
+                lost = true;
+            } else {
+                ++it;
+            }
+        }
+        if (lost) {
+            m_cc->onLoss();
+        }
+    }
+
+    void onPto()
+    {
+        for (auto &entry : m_outstanding) {
+            markLost(entry.second);
+        }
+        m_outstanding.clear();
+        m_cc->onTimeout();
+        m_lastProgressUs = m_nowUs;
+    }
+
+    void markLost(Sent &sent)
+    {
+        m_inflight -= sent.info.packetSize;
+        m_cc->onLost(&sent.info);
+        m_retransQueue.push_back(sent.chunk);
+    }
+
+private:
+    VirtualLink                 m_link;
+    Congestion::SP              m_cc;
+    RttStats                    m_rtt;
+    uint32_t                    m_packetSize{1200};
+    uint64_t                    m_nowUs{0};
+    uint64_t                    m_nextSendNs{0};
+    uint64_t                    m_lastProgressUs{0};
+    uint64_t                    m_inflight{0};
+    uint64_t                    m_lastPackNo{0};
+    uint64_t                    m_largestAcked{0};
+    uint64_t                    m_nextChunk{0};
+    uint64_t                    m_deliveredChunks{0};
+    uint64_t                    m_txBytes{0};
+    uint64_t                    m_rtxBytes{0};
+    uint64_t                    m_eventSeq{0};
+    std::map<uint64_t, Sent>    m_outstanding;
+    std::deque<uint64_t>        m_retransQueue;
+    std::vector<uint8_t>        m_received;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> m_events;
+};
+
+/**
+ * @brief 真实时钟下的一对 Context, 数据报经发送拦截进入虚拟链路而非内核
+ *
+ * 两个 ContextImpl 共享一个事件循环, 各自绑定回环地址以获得合法的本地地址, 但发出的数据报由
+ * setSendHook 截获, 按链路给出的到达时间通过 onForwardedPackets 注入对端. 协议栈内部直接读取
+ * 单调时钟, 因此这一模式只能以真实时间运行, 评估时长即实际耗时.
+ */
+class ContextPair
+{
+public:
+    ContextPair(const LinkConfig &forward, const LinkConfig &reverse, const Config &cfg) :
+        m_config(cfg),
+        m_client(new ContextImpl(m_loop.loop(), &m_config)),
+        m_server(new ContextImpl(m_loop.loop(), &m_config))
+    {
+        m_links[0].reset(forward);
+        m_links[1].reset(reverse);
+    }
+
+    ~ContextPair()
+    {
+        m_server->setSendHook(nullptr);
+        m_client->setSendHook(nullptr);
+    }
+
+    /**
+     * @brief 客户端建连后单流持续写入 durationMs, 统计服务端读到的数据量
+     * @return 握手未在 handshakeMs 内完成时返回 false
+     */
+    bool runBulkTransfer(uint64_t durationMs, EvalResult &result, uint64_t handshakeMs = 3000)
+    {
+        if (!m_server->bind("127.0.0.1", 0, "").ok() || !m_client->bind("127.0.0.1", 0, "").ok()) {
+            return false;
+        }
+        m_client->setSendHook([this] (const UdpSocket::MsgMetaInfo &msg) { enqueue(0, msg); });
+        m_server->setSendHook([this] (const UdpSocket::MsgMetaInfo &msg) { enqueue(1, msg); });
+
+        uint64_t received = 0;
+        ContextImpl *server = m_server.get();
+        m_server->setOnNewConnection([server] (const Context::NewConnectionInfo &) {
+            server->accept();
+            return true;
+        });
+        m_server->setOnConnected([&received] (Connection::Ptr conn) {
+            conn->setOnIncomingStream([&received] (Stream *stream) {
+                stream->setOnReadable([&received, stream] () {
+                    char buffer[16 * 1024];
+                    int32_t n = 0;
+                    while ((n = stream->read(buffer, sizeof(buffer))) > 0) {
+                        received += static_cast<uint64_t>(n);
+                    }
+                });
+            });
+        });
+
+        Connection::Ptr conn;
+        Stream *stream = nullptr;
+        m_client->setOnConnected([&conn] (Connection::Ptr c) { conn = c; });
+
+        Context::ConnectInfo info;
+        info.ip = "127.0.0.1";
+        info.port = m_server->localAddress().port();
+        info.timeout = static_cast<uint32_t>(handshakeMs);
+        if (!m_client->connect(info).ok()) {
+            return false;
+        }
+        if (!pumpUntil([&conn] () { return conn != nullptr; }, handshakeMs)) {
+            return false;
+        }
+
+        const int32_t sid = conn->createStream(Connection::kStreamTypeBidirectional);
+        stream = sid < 0 ? nullptr : conn->getStream(static_cast<uint32_t>(sid));
+        if (stream == nullptr) {
+            return false;
+        }
+        std::vector<char> payload(16 * 1024, 'x');
+        auto fill = [stream, &payload] () {
+            while (stream->write(payload.data(), payload.size()) > 0) {
+            }
+        };
+        stream->setOnWritable(fill);
+
+        const Connection::Statistic before = conn->statistic();
+        const uint64_t startUs = time::MonotonicUs();
+        m_links[0].clearStats();
+        fill();
+        pumpUntil([] () { return false; }, durationMs);
+        const uint64_t elapsedUs = time::MonotonicUs() - startUs;
+        const Connection::Statistic after = conn->statistic();
+
+        result = EvalResult();
+        result.durationUs = elapsedUs;
+        result.deliveredBytes = received;
+        result.txBytes = after.tx_bytes - before.tx_bytes;
+        result.rtxBytes = after.rtx_bytes - before.rtx_bytes;
+        result.fillQueueStats(m_links[0].stats());
+        stream->setOnWritable(nullptr);
+        conn->close();
+        pumpUntil([] () { return false; }, 20);
+        return true;
+    }
+
+    const LinkStats &forwardStats() const { return m_links[0].stats(); }
+
+private:
+    struct Datagram {
+        uint64_t                atUs;
+        uint64_t                seq;
+        int32_t                 direction;  // 0: 客户端 -> 服务端, 1: 服务端 -> 客户端
+        std::vector<uint8_t>    payload;
+
+        bool operator>(const Datagram &other) const
+        {
+            return atUs != other.atUs ? atUs > other.atUs : seq > other.seq;
+        }
+    };
+
+    void enqueue(int32_t direction, const UdpSocket::MsgMetaInfo &msg)
+    {
+        Datagram dgram;
+        dgram.direction = direction;
+        dgram.seq = m_seq++;
+        if (msg.slice_count == 0) {
+            const uint8_t *data = static_cast<const uint8_t *>(msg.data);
+            dgram.payload.assign(data, data + msg.len);
+        } else {
+            for (uint8_t i = 0; i < msg.slice_count; ++i) {
+                const uint8_t *data = static_cast<const uint8_t *>(msg.slices[i].data);
+                dgram.payload.insert(dgram.payload.end(), data, data + msg.slices[i].len);
+            }
+        }
+
+        const VirtualLink::Verdict verdict = m_links[direction].submit(time::MonotonicUs(), dgram.payload.size());
+        if (verdict.dropped) {
+            return;
+        }
+        dgram.atUs = verdict.deliverAtUs;
+        m_inFlight.push(std::move(dgram));
+    }
+
+    void deliverDue()
+    {
+        const uint64_t nowUs = time::MonotonicUs();
+        while (!m_inFlight.empty() && m_inFlight.top().atUs <= nowUs) {
+            Datagram dgram = std::move(const_cast<Datagram &>(m_inFlight.top()));
+            m_inFlight.pop();
+
+            ContextImpl *from = dgram.direction == 0 ? m_client.get() : m_server.get();
+            ContextImpl *to = dgram.direction == 0 ? m_server.get() : m_client.get();
+            UdpSocket::MsgMetaInfo msg;
+            msg.data = dgram.payload.data();
+            msg.len = dgram.payload.size();
+            msg.slice_count = 0;
+            msg.metaInfo.fd = static_cast<int32_t>(to->socketFd());
+            msg.metaInfo.localAddress = to->localAddress();
+            msg.metaInfo.peerAddress = from->localAddress();
+            to->onForwardedPackets(&msg, 1);
+        }
+    }
+
+    bool pumpUntil(const std::function<bool()> &done, uint64_t timeoutMs)
+    {
+        const uint64_t deadlineUs = time::MonotonicUs() + timeoutMs * 1000;
+        while (time::MonotonicUs() < deadlineUs) {
+            m_loop.dispatch(EVLOOP_NONBLOCK | EVLOOP_ONCE);
+            deliverDue();
+            if (done()) {
+                return true;
+            }
+            if (m_inFlight.empty() || m_inFlight.top().atUs > time::MonotonicUs() + 200) {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+        return done();
+    }
+
+private:
+    ev::EventLoop                   m_loop;
+    Config                          m_config;
+    std::unique_ptr<ContextImpl>    m_client;
+    std::unique_ptr<ContextImpl>    m_server;
+    VirtualLink                     m_links[2];
+    uint64_t                        m_seq{0};
+    std::priority_queue<Datagram, std::vector<Datagram>, std::greater<Datagram>> m_inFlight;
+};
+
+} // namespace netem
+} // namespace utp
+} // namespace eular
+
+#endif // __UTP_TEST_NET_EMULATOR_H__
@@ -472,6 +472,80 @@ TEST_CASE("Ack reordering threshold updates send side and triggers immediate ACK
     REQUIRE(clientConn->m_bytesOut > bytesOutBefore);
 }
 
+TEST_CASE("Receive batch decodes per connection and acknowledges once", "[Ack][Integration]")
+{
+    Config cfg;
+    cfg.handshake_timeout = 200;
+    cfg.ack_delay = 200;
+
+    ev::EventLoop loop;
+    ContextImpl server(loop.loop(), &cfg);
+    ContextImpl client(loop.loop(), &cfg);
+
+    REQUIRE(server.bind("127.0.0.1", 0, "").ok());
+    REQUIRE(client.bind("127.0.0.1", 0, "").ok());
+
+    server.setOnNewConnection([](const Context::NewConnectionInfo &) {
+        return true;
+    });
+
+    Context::ConnectInfo info;
+    info.ip = "127.0.0.1";
+    info.port = BoundPort(server);
+    info.timeout = 200;
+    REQUIRE(client.connect(info).ok());
+
+    REQUIRE(PumpUntil(
+        loop,
+        [&]() {
+            return FindConnectedByRemote(server, BoundPort(client)) != nullptr
+                && FindConnectedByRemote(client, BoundPort(server)) != nullptr;
+        },
+        [&]() {
+            (void)AcceptPending(server);
+        },
+        300,
+        1));
+
+    ConnectionImpl::SP clientConn = FindConnectedByRemote(client, BoundPort(server));
+    ConnectionImpl::SP serverConn = FindConnectedByRemote(server, BoundPort(client));
+    REQUIRE(clientConn != nullptr);
+    REQUIRE(serverConn != nullptr);
+
+    clientConn->m_ackElicitingThreshold = 2;
+    clientConn->m_ackElicitingSinceLastAck = 0;
+    clientConn->m_ackPendingSinceUs = 0;
+    clientConn->m_ackTimer.stop();
+
+    constexpr size_t kBatch = 8;
+    const utp_packno_t basePn = clientConn->m_receiveHistory.largest() + 1;
+    std::vector<std::vector<uint8_t>> wires;
+    for (size_t i = 0; i < kBatch; ++i) {
+        const std::vector<uint8_t> payload = BuildStreamPayload(77, i * 4, "data");
+        wires.push_back(BuildWirePacket(serverConn->cid(), clientConn->cid(), basePn + i, UTP_TYPE_CTRL, payload));
+    }
+    std::vector<eular::utp::UdpSocket::MsgMetaInfo> msgs(kBatch);
+    for (size_t i = 0; i < kBatch; ++i) {
+        msgs[i].data = wires[i].data();
+        msgs[i].len = wires[i].size();
+        msgs[i].slice_count = 0;
+        msgs[i].metaInfo.peerAddress = server.m_udpSocket.m_localAddr;
+    }
+
+    const uint64_t packetNumberBefore = clientConn->m_packetNumber;
+    const uint64_t bytesInBefore = clientConn->m_bytesIn;
+    client.processIncomingPackets(msgs.data(), msgs.size(), false);
+
+    // 阈值为 2 时逐包处理会回 4 个 ACK, 整批处理只回 1 个且覆盖全部包
+    REQUIRE(clientConn->m_bytesIn > bytesInBefore);
+    REQUIRE(clientConn->m_receiveHistory.largest() == basePn + kBatch - 1);
+    REQUIRE(clientConn->m_ackElicitingSinceLastAck == 0);
+    REQUIRE_FALSE(clientConn->m_ackTimer.isActive());
+    REQUIRE(clientConn->m_packetNumber == packetNumberBefore + 1);
+    REQUIRE(clientConn->m_recvBatchMsgs.empty());
+    REQUIRE(client.m_recvBatchConns.empty());
+}
+
 TEST_CASE("Ack piggyback coalesces pending ACK with outgoing stream packet", "[Ack][Integration]")
 {
     Config cfg;
@@ -863,3 +937,184 @@ TEST_CASE("Sparse ACK ranges clear pending once one range covers HandshakeDone",
     REQUIRE_FALSE(conn.m_handshakeDonePending);
     REQUIRE_FALSE(conn.m_handshakeDoneTimer.isActive());
 }
+
+TEST_CASE("Ack ranges release packets sent out of packet number order", "[Ack]")
+{
+    Config cfg;
+    ev::EventLoop loop;
+    ContextImpl ctx(loop.loop(), &cfg);
+    ConnectionImpl conn(&ctx, nullptr, 2107);
+
+    conn.m_state = ConnectionImpl::kStateConnected;
+    const uint32_t streamBits = (1u << static_cast<uint32_t>(FrameType::kFrameStream));
+    // 重传包先于已调度的旧包号发出, 队列顺序与包号顺序不一致
+    BuildUnackedPacket(conn, 72, streamBits, 8);
+    BuildUnackedPacket(conn, 70, streamBits, 8);
+    BuildUnackedPacket(conn, 71, streamBits, 8);
+    BuildUnackedPacket(conn, 200, streamBits, 8);
+    REQUIRE(conn.m_sendCtl->m_sentRing.size() == 4);
+    REQUIRE(conn.m_sendCtl->m_sentRing.lowest() == 70);
+
+    // 超出在途窗口的区间被裁剪
+    Status st = conn.m_sendCtl->onAckReceived(
+        BuildAckRanges({Range{199, 100000}, Range{71, 72}, Range{0, 70}}),
+        eular::utp::time::MonotonicUs());
+    REQUIRE(st.ok());
+    REQUIRE(TAILQ_EMPTY(&conn.m_sendCtl->m_unackedPackets));
+    REQUIRE(conn.m_sendCtl->m_sentRing.empty());
+    REQUIRE(conn.m_sendCtl->m_nInflightAll == 0);
+}
+
+TEST_CASE("ECN CE feedback triggers one congestion response per round", "[Ack][ECN]")
+{
+    Config cfg;
+    cfg.cc_algorithm = 2;
+    cfg.enable_ecn = true;
+    ev::EventLoop loop;
+    ContextImpl ctx(loop.loop(), &cfg);
+    eular::utp::UdpSocket sock(cfg);
+    REQUIRE(sock.bind("127.0.0.1", 0, "").ok());
+    sock.m_ecnEnabled = true; // 不依赖内核 IP_RECVTOS 支持
+    ConnectionImpl conn(&ctx, &sock, 2108);
+
+    conn.m_state = ConnectionImpl::kStateConnected;
+    SendControl *sendCtl = conn.m_sendCtl.get();
+    const uint32_t streamBits = (1u << static_cast<uint32_t>(FrameType::kFrameStream));
+    for (utp_packno_t packno = 1; packno <= 6; ++packno) {
+        BuildUnackedPacket(conn, packno, streamBits, 8);
+    }
+    sendCtl->m_sendHistory._last_sent = 6;
+    const uint64_t initCwnd = sendCtl->m_congestion->getCwnd();
+
+    eular::utp::AckInfo ack = BuildAckRange(1, 2);
+    ack.has_ecn = true;
+    ack.ecn.ect0 = 2;
+    REQUIRE(sendCtl->onAckReceived(ack, eular::utp::time::MonotonicUs()).ok());
+    REQUIRE(sendCtl->ecnCeEvents() == 0);
+    REQUIRE(sendCtl->m_congestion->getCwnd() > initCwnd);
+
+    // 首个 CE 降速, 同一轮内 (包号不超过降速时已发出的最大包号) 的后续 CE 不再降速
+    ack = BuildAckRange(1, 3);
+    ack.has_ecn = true;
+    ack.ecn.ect0 = 2;
+    ack.ecn.ce = 1;
+    REQUIRE(sendCtl->onAckReceived(ack, eular::utp::time::MonotonicUs()).ok());
+    REQUIRE(sendCtl->ecnCeEvents() == 1);
+    const uint64_t reducedCwnd = sendCtl->m_congestion->getCwnd();
+    REQUIRE(reducedCwnd < initCwnd);
+    REQUIRE(sendCtl->m_largestSentAtCutback == 6);
+
+    ack = BuildAckRange(1, 4);
+    ack.has_ecn = true;
+    ack.ecn.ect0 = 2;
+    ack.ecn.ce = 2;
+    REQUIRE(sendCtl->onAckReceived(ack, eular::utp::time::MonotonicUs()).ok());
+    REQUIRE(sendCtl->ecnCeEvents() == 1);
+    REQUIRE(sendCtl->peerEcnCounts().ce == 2);
+
+    // 计数未覆盖新确认的包: 路径清除了标记, 不再信任 ECN 反馈
+    ack = BuildAckRange(1, 6);
+    ack.has_ecn = true;
+    ack.ecn.ect0 = 3;
+    ack.ecn.ce = 2;
+    REQUIRE(sendCtl->onAckReceived(ack, eular::utp::time::MonotonicUs()).ok());
+    REQUIRE_FALSE(sendCtl->m_flags & SendCtlFlags::EcnEnabled);
+    REQUIRE(sendCtl->ecnCeEvents() == 1);
+    REQUIRE(conn.statistic().ecn_ce_events == 1);
+}
+
+TEST_CASE("Received ECN codepoints are counted per codepoint", "[Ack][ECN]")
+{
+    Config cfg;
+    ev::EventLoop loop;
+    ContextImpl ctx(loop.loop(), &cfg);
+    ConnectionImpl conn(&ctx, nullptr, 2109);
+
+    REQUIRE_FALSE(conn.noteEcnCodepoint(eular::utp::kEcnNotEct));
+    REQUIRE_FALSE(conn.noteEcnCodepoint(eular::utp::kEcnEct0));
+    REQUIRE_FALSE(conn.noteEcnCodepoint(eular::utp::kEcnEct1));
+    REQUIRE(conn.noteEcnCodepoint(eular::utp::kEcnCe));
+    REQUIRE(conn.m_recvEcnCounts.ect0 == 1);
+    REQUIRE(conn.m_recvEcnCounts.ect1 == 1);
+    REQUIRE(conn.m_recvEcnCounts.ce == 1);
+}
+
+TEST_CASE("Connection memory quota full of unacked data still accepts the ACKs that drain it", "[Ack][Integration][SharedPool]")
+{
+    Config cfg;
+    cfg.handshake_timeout = 200;
+    cfg.shared_memory_pool = true;
+    cfg.connection_memory_quota = 8 * 1024;
+
+    ev::EventLoop loop;
+    ContextImpl server(loop.loop(), &cfg);
+    ContextImpl client(loop.loop(), &cfg);
+
+    REQUIRE(server.bind("127.0.0.1", 0, "").ok());
+    REQUIRE(client.bind("127.0.0.1", 0, "").ok());
+
+    server.setOnNewConnection([](const Context::NewConnectionInfo &) {
+        return true;
+    });
+
+    Context::ConnectInfo info;
+    info.ip = "127.0.0.1";
+    info.port = BoundPort(server);
+    info.timeout = 200;
+    REQUIRE(client.connect(info).ok());
+
+    REQUIRE(PumpUntil(
+        loop,
+        [&]() {
+            return FindConnectedByRemote(server, BoundPort(client)) != nullptr
+                && FindConnectedByRemote(client, BoundPort(server)) != nullptr;
+        },
+        [&]() {
+            (void)AcceptPending(server);
+        },
+        300,
+        1));
+
+    ConnectionImpl::SP clientConn = FindConnectedByRemote(client, BoundPort(server));
+    ConnectionImpl::SP serverConn = FindConnectedByRemote(server, BoundPort(client));
+    REQUIRE(clientConn != nullptr);
+    REQUIRE(serverConn != nullptr);
+    REQUIRE(clientConn->m_mm.sharedPool() != nullptr);
+
+    const int32_t clientSid = clientConn->createStream(eular::utp::Connection::kStreamTypeBidirectional);
+    REQUIRE(clientSid >= 0);
+    auto clientStreamIt = clientConn->m_streams.find(static_cast<uint32_t>(clientSid));
+    REQUIRE(clientStreamIt != clientConn->m_streams.end());
+
+    // 待发数据远超配额, 在途包会占满配额
+    const std::string payload(64 * 1024, 'q');
+    REQUIRE(clientStreamIt->second->write(payload.data(), payload.size(), false) == static_cast<int32_t>(payload.size()));
+
+    size_t received = 0;
+    std::vector<uint8_t> buffer(16 * 1024);
+    REQUIRE(PumpUntil(
+        loop,
+        [&]() {
+            return received == payload.size() && TAILQ_EMPTY(&clientConn->m_sendCtl->m_unackedPackets);
+        },
+        [&]() {
+            auto it = serverConn->m_streams.find(static_cast<uint32_t>(clientSid));
+            if (it == serverConn->m_streams.end() || it->second == nullptr) {
+                return;
+            }
+            int32_t n = 0;
+            while ((n = it->second->read(buffer.data(), buffer.size())) > 0) {
+                received += static_cast<size_t>(n);
+            }
+        },
+        2000,
+        1));
+
+    REQUIRE(clientConn->m_mm.quota_rejected > 0);
+    REQUIRE(clientConn->m_mm.bytes_inuse_max <= cfg.connection_memory_quota);
+
+    // 确认释放在途包后配额恢复
+    PacketOut *probe = clientConn->m_mm.getPacketOut(1200);
+    REQUIRE(probe != nullptr);
+    clientConn->m_mm.putPacketOut(probe);
+}
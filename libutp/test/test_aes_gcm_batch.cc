@@ -0,0 +1,157 @@
+/*************************************************************************
+    > File Name: test_aes_gcm_batch.cc
+    > Author: eular
+    > Brief: AES-GCM 批量加密
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include <catch2/catch.hpp>
+#include "util/status.h"
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "utp/errno.h"
+#include "crypto/aes_gcm_context.h"
+#include "proto/proto.h"
+#include "proto/packet_out.h"
+#include "util/mm.h"
+
+using eular::utp::AesGcmContext;
+using eular::utp::MemoryManager;
+using eular::utp::PacketOut;
+using eular::utp::PacketOutFlags;
+using eular::utp::Status;
+
+namespace {
+
+PacketOut *MakePlainPacket(MemoryManager &mm, uint64_t packno, size_t payloadLen, uint16_t flags)
+{
+    PacketOut *pkt = mm.getPacketOut(static_cast<uint32_t>(UTP_HEADER_SIZE + payloadLen + AesGcmContext::GCM_TAG_SIZE));
+    REQUIRE(pkt != nullptr);
+    for (size_t i = 0; i < UTP_HEADER_SIZE + payloadLen; ++i) {
+        pkt->raw_data[i] = static_cast<uint8_t>((packno * 31 + i) & 0xff);
+    }
+    pkt->packno = packno;
+    pkt->data_size = static_cast<uint16_t>(UTP_HEADER_SIZE + payloadLen);
+    pkt->po_flags = flags;
+    return pkt;
+}
+
+std::vector<uint8_t> Wire(const PacketOut *pkt)
+{
+    return std::vector<uint8_t>(pkt->encrypt_data, pkt->encrypt_data + pkt->encrypt_data_size);
+}
+
+// 通过逐次新建 EVP 上下文的底层接口计算期望的密文包
+std::vector<uint8_t> ReferenceWire(AesGcmContext &aes, const PacketOut *pkt)
+{
+    const size_t plainLen = pkt->data_size - UTP_HEADER_SIZE;
+    const size_t cipherLen = plainLen + AesGcmContext::GCM_TAG_SIZE;
+    std::vector<uint8_t> wire(pkt->raw_data, pkt->raw_data + UTP_HEADER_SIZE);
+    wire[offsetof(eular::utp::UTPHeaderProto, payload_length)] = static_cast<uint8_t>(cipherLen >> 8);
+    wire[offsetof(eular::utp::UTPHeaderProto, payload_length) + 1] = static_cast<uint8_t>(cipherLen & 0xff);
+    wire.resize(UTP_HEADER_SIZE + cipherLen);
+
+    size_t outLen = cipherLen;
+    REQUIRE(aes.encrypt(pkt->raw_data + UTP_HEADER_SIZE, plainLen, wire.data(), UTP_HEADER_SIZE,
+                        pkt->packno, wire.data() + UTP_HEADER_SIZE, &outLen));
+    REQUIRE(outLen == cipherLen);
+    return wire;
+}
+
+} // namespace
+
+TEST_CASE("AesGcmContext: batch seal matches per-packet encrypt", "[AesGcm]")
+{
+    AesGcmContext::AesKey256 key;
+    key.fill(0x5a);
+    AesGcmContext single;
+    AesGcmContext batch;
+    REQUIRE(single.init(key, 0x01020304));
+    REQUIRE(batch.init(key, 0x01020304));
+
+    MemoryManager mm;
+    const size_t payloadLens[] = {0, 1, 15, 16, 17, 600, 1200};
+    const uint16_t flags[] = {0, PacketOutFlags::kPoKeepPlaintext};
+    for (uint16_t flag : flags) {
+        std::vector<std::vector<uint8_t>> expected;
+        std::vector<PacketOut *> sealing;
+        for (size_t i = 0; i < sizeof(payloadLens) / sizeof(payloadLens[0]); ++i) {
+            sealing.push_back(MakePlainPacket(mm, 100 + i, payloadLens[i],
+                                              static_cast<uint16_t>(flag | PacketOutFlags::kPoSealPending)));
+            expected.push_back(ReferenceWire(single, sealing.back()));
+        }
+
+        size_t sealed = 0;
+        REQUIRE(batch.encryptBatch(sealing.data(), sealing.size(), &sealed));
+        REQUIRE(sealed == sealing.size());
+
+        for (size_t i = 0; i < sealing.size(); ++i) {
+            REQUIRE((sealing[i]->po_flags & PacketOutFlags::kPoEncrypted) != 0);
+            REQUIRE((sealing[i]->po_flags & PacketOutFlags::kPoSealPending) == 0);
+            REQUIRE((sealing[i]->encrypt_data == sealing[i]->raw_data) == (flag == 0));
+            REQUIRE(Wire(sealing[i]) == expected[i]);
+
+            // 密文可被同一密钥解开
+            std::vector<uint8_t> plain(payloadLens[i] + 1);
+            size_t plainLen = plain.size();
+            REQUIRE(single.decrypt(sealing[i]->encrypt_data + UTP_HEADER_SIZE,
+                                   sealing[i]->encrypt_data_size - UTP_HEADER_SIZE,
+                                   sealing[i]->encrypt_data, UTP_HEADER_SIZE,
+                                   sealing[i]->packno,
+                                   plain.data(), &plainLen));
+            REQUIRE(plainLen == payloadLens[i]);
+        }
+
+        for (PacketOut *pkt : sealing) {
+            mm.putPacketOut(pkt);
+        }
+    }
+}
+
+TEST_CASE("AesGcmContext: batch seal stops at the first bad packet", "[AesGcm]")
+{
+    AesGcmContext::AesKey128 key;
+    key.fill(0x11);
+    AesGcmContext aes;
+
+    MemoryManager mm;
+    std::vector<PacketOut *> packets;
+    packets.push_back(MakePlainPacket(mm, 1, 32, PacketOutFlags::kPoSealPending));
+    packets.push_back(MakePlainPacket(mm, 2, 32, PacketOutFlags::kPoSealPending));
+    packets.push_back(MakePlainPacket(mm, 3, 32, PacketOutFlags::kPoSealPending));
+
+    size_t sealed = 99;
+    Status st = aes.encryptBatch(packets.data(), packets.size(), &sealed);
+    REQUIRE(st.code() == UTP_ERR_CRYPTO_UNINITIALIZED);
+    REQUIRE(sealed == 0);
+
+    REQUIRE(aes.init(key, 7));
+    packets[1]->data_size = UTP_HEADER_SIZE - 1;
+    st = aes.encryptBatch(packets.data(), packets.size(), &sealed);
+    REQUIRE(st.code() == UTP_ERR_OVERFLOW);
+    REQUIRE(sealed == 1);
+    REQUIRE((packets[0]->po_flags & PacketOutFlags::kPoSealPending) == 0);
+    REQUIRE((packets[1]->po_flags & PacketOutFlags::kPoSealPending) != 0);
+    REQUIRE((packets[2]->po_flags & PacketOutFlags::kPoEncrypted) == 0);
+
+    // 重新设置密钥后缓存的加密上下文随之重建
+    AesGcmContext::AesKey128 other;
+    other.fill(0x22);
+    AesGcmContext expected;
+    REQUIRE(expected.init(other, 7));
+    REQUIRE(aes.init(other, 7));
+    PacketOut *lhs = MakePlainPacket(mm, 9, 40, 0);
+    PacketOut *rhs = MakePlainPacket(mm, 9, 40, 0);
+    REQUIRE(aes.encryptBatch(&lhs, 1));
+    REQUIRE(expected.encrypt(rhs));
+    REQUIRE(Wire(lhs) == Wire(rhs));
+
+    for (PacketOut *pkt : packets) {
+        mm.putPacketOut(pkt);
+    }
+    mm.putPacketOut(lhs);
+    mm.putPacketOut(rhs);
+}
@@ -8,6 +8,8 @@
 #include <catch2/catch.hpp>
 #include "util/status.h"
 
+#include <vector>
+
 #define protected public
 #define private public
 #include "congestion/bbr_v1.h"
@@ -70,3 +72,117 @@ TEST_CASE("BbrV1: probe_rtt_multiplier affects ProbeRTT cwnd", "[BBR]")
     uint64_t expectedCwnd = static_cast<uint64_t>(0.6f * 20000);
     REQUIRE(bbr.getProbeRttCwnd() == expectedCwnd);
 }
+
+TEST_CASE("BbrV1: ECN CE feedback enters packet conservation without loss", "[BBR][ECN]")
+{
+    RttStats rtt;
+    rtt.update(20000);
+
+    BbrV1 bbr;
+    bbr.onInit(&rtt);
+
+    std::vector<eular::utp::PacketInfo> packets(4);
+    uint64_t inflight = 0;
+    for (size_t i = 0; i < packets.size(); ++i) {
+        packets[i].packetNo = i + 1;
+        packets[i].sendTimeUs = 1000 * (i + 1);
+        packets[i].packetSize = 1200;
+        inflight += packets[i].packetSize;
+        bbr.onPacketSent(&packets[i], inflight, 0);
+    }
+
+    bbr.onBeginAck(30000, inflight);
+    bbr.onAck(&packets[0], 30000, 0);
+    bbr.onEndAck(inflight - 1200);
+    REQUIRE_FALSE(bbr.inRecovery());
+
+    bbr.onBeginAck(31000, inflight - 1200);
+    bbr.onAck(&packets[1], 31000, 0);
+    bbr.onEcnCe();
+    bbr.onEndAck(inflight - 2400);
+    REQUIRE(bbr.inRecovery());
+    REQUIRE(bbr.m_recoveryState == BbrV1::RecoveryState::Conservation);
+    REQUIRE(bbr.getCwnd() <= bbr.m_recoveryWindow);
+}
+
+TEST_CASE("BbrV1: cwnd target carries no ack-aggregation headroom", "[BBR]")
+{
+    RttStats rtt;
+    rtt.update(20000);
+
+    BbrV1 bbr;
+    bbr.onInit(&rtt);
+
+    // 一次 ACK 确认一整批包, 远超按带宽估算的确认量
+    std::vector<eular::utp::PacketInfo> packets(40);
+    uint64_t inflight = 0;
+    for (size_t round = 0; round < 2; ++round) {
+        const size_t begin = round * 20;
+        for (size_t i = begin; i < begin + 20; ++i) {
+            packets[i].packetNo = i + 1;
+            packets[i].sendTimeUs = 1000 + 30000 * round + i;
+            packets[i].packetSize = 1200;
+            bbr.onPacketSent(&packets[i], inflight, 0);
+            inflight += packets[i].packetSize;
+        }
+
+        const uint64_t ackTime = 30000 * (round + 1);
+        bbr.onBeginAck(ackTime, inflight);
+        for (size_t i = begin; i < begin + 20; ++i) {
+            bbr.onAck(&packets[i], ackTime, 0);
+            inflight -= packets[i].packetSize;
+        }
+        bbr.onEndAck(inflight);
+    }
+    REQUIRE(bbr.m_maxAckHeight.get() == 0);
+
+    bbr.m_mode = BbrV1::Mode::ProbeBW;
+    bbr.m_flags |= BbrV1::BBR_FLAG_IS_AT_FULL_BANDWIDTH;
+    bbr.m_cwnd = bbr.m_maxCwnd;
+    bbr.calculateCwnd(0, 0);
+    REQUIRE(bbr.m_cwnd == bbr.getTargetCwnd(bbr.m_cwndGain));
+}
+
+TEST_CASE("BbrV1: only losses reported during an ACK count toward it", "[BBR]")
+{
+    RttStats rtt;
+    rtt.update(20000);
+
+    BbrV1 bbr;
+    bbr.onInit(&rtt);
+
+    std::vector<eular::utp::PacketInfo> packets(5);
+    uint64_t inflight = 0;
+    for (size_t i = 0; i < packets.size(); ++i) {
+        packets[i].packetNo = i + 1;
+        packets[i].sendTimeUs = 1000 * (i + 1);
+        packets[i].packetSize = 1200;
+        inflight += packets[i].packetSize;
+        bbr.onPacketSent(&packets[i], inflight, 0);
+    }
+
+    bbr.onBeginAck(30000, inflight);
+    bbr.onAck(&packets[0], 30000, 0);
+    bbr.onEndAck(inflight - 1200);
+    inflight -= 1200;
+
+    // 两次 ACK 之间报告的丢包不结转到下一次 ACK
+    bbr.onLost(&packets[1]);
+    inflight -= 1200;
+    bbr.onBeginAck(31000, inflight);
+    REQUIRE_FALSE(bbr.m_ackState.hasLosses);
+    REQUIRE(bbr.m_ackState.lostBytes == 0);
+    bbr.onAck(&packets[2], 31000, 0);
+    bbr.onEndAck(inflight - 1200);
+    inflight -= 1200;
+    REQUIRE_FALSE(bbr.inRecovery());
+
+    // ACK 期间报告的丢包照常进入恢复
+    bbr.onBeginAck(32000, inflight);
+    bbr.onLost(&packets[3]);
+    inflight -= 1200;
+    REQUIRE(bbr.m_ackState.hasLosses);
+    bbr.onAck(&packets[4], 32000, 0);
+    bbr.onEndAck(inflight - 1200);
+    REQUIRE(bbr.inRecovery());
+}
@@ -0,0 +1,276 @@
+/*************************************************************************
+    > File Name: test_bbr_v2.cc
+    > Author: eular
+    > Brief: BBRv2 拥塞控制
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include <catch2/catch.hpp>
+
+#include <deque>
+
+#define protected public
+#define private public
+#include "congestion/bbr_v2.h"
+#undef private
+#undef protected
+#include "utp/config.h"
+
+using eular::utp::BbrV2;
+using eular::utp::Config;
+using eular::utp::PacketInfo;
+using eular::utp::RttStats;
+
+namespace {
+
+constexpr uint32_t kPacketSize = 1200;
+constexpr uint64_t kRttUs = 20000;
+
+// 单条流的收发模拟: 每轮发出一批包, 一个 RTT 后整批确认
+struct Flow {
+    explicit Flow(const Config *cfg = nullptr) : bbr(cfg)
+    {
+        rtt.update(kRttUs);
+        bbr.onInit(&rtt);
+    }
+
+    void send(size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            PacketInfo pkt;
+            pkt.packetNo = nextPackNo++;
+            pkt.sendTimeUs = now;
+            pkt.packetSize = kPacketSize;
+            packets.push_back(pkt);
+            bbr.onPacketSent(&packets.back(), inflight, 0);
+            inflight += kPacketSize;
+        }
+    }
+
+    // 丢包在 ACK 处理之后判定, 计入下一次 ACK
+    void lose(size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            PacketInfo &pkt = packets[nextAck++];
+            inflight -= pkt.packetSize;
+            bbr.onLost(&pkt);
+        }
+    }
+
+    void ack(size_t count, bool ce = false)
+    {
+        bbr.onBeginAck(now, inflight);
+        for (size_t i = 0; i < count; ++i) {
+            PacketInfo &pkt = packets[nextAck++];
+            inflight -= pkt.packetSize;
+            bbr.onAck(&pkt, now, 0);
+        }
+        if (ce) {
+            bbr.onEcnCe();
+        }
+        bbr.onEndAck(inflight);
+    }
+
+    // 发出 count 个包, 一个 RTT 后丢失其中 lost 个并确认其余的包
+    void round(size_t count, size_t lost = 0, bool ce = false)
+    {
+        send(count);
+        now += kRttUs;
+        lose(lost);
+        ack(count - lost, ce);
+    }
+
+    // 直接进入 PROBE_BW 的指定子阶段
+    void enterProbeBW(BbrV2::ProbeBWPhase phase)
+    {
+        bbr.m_flags |= BbrV2::BBR2_FLAG_IS_AT_FULL_BANDWIDTH;
+        bbr.enterProbeBWMode();
+        switch (phase) {
+        case BbrV2::ProbeBWPhase::Down:
+            break;
+        case BbrV2::ProbeBWPhase::Cruise:
+            bbr.startProbeCruise();
+            break;
+        case BbrV2::ProbeBWPhase::Refill:
+            bbr.startProbeRefill();
+            break;
+        case BbrV2::ProbeBWPhase::Up:
+            bbr.startProbeUp();
+            break;
+        }
+    }
+
+    BbrV2                   bbr;
+    RttStats                rtt;
+    std::deque<PacketInfo>  packets;
+    uint64_t                nextPackNo{1};
+    size_t                  nextAck{0};
+    uint64_t                inflight{0};
+    uint64_t                now{1000};
+};
+
+} // namespace
+
+TEST_CASE("BbrV2: configurable params are applied", "[BBR][BBRv2]")
+{
+    Config cfg;
+    cfg.bbr_init_cwnd_mss = 24;
+    cfg.bbr_min_cwnd_mss = 8;
+    cfg.bbr2_loss_thresh = 0.05f;
+    cfg.bbr2_beta = 0.5f;
+    cfg.bbr2_headroom = 0.2f;
+    cfg.bbr2_startup_full_loss_count = 4;
+    cfg.bbr2_probe_wait_ms = 500;
+    cfg.bbr2_probe_max_rounds = 16;
+
+    Flow flow(&cfg);
+    REQUIRE(flow.bbr.getCwnd() == 24 * 1460);
+    REQUIRE(flow.bbr.mode() == BbrV2::Mode::StartUp);
+    REQUIRE(flow.bbr.inflightHi() == UINT64_MAX);
+    REQUIRE(flow.bbr.inflightLo() == UINT64_MAX);
+    REQUIRE(flow.bbr.m_lossThresh == Approx(0.05f));
+    REQUIRE(flow.bbr.m_beta == Approx(0.5f));
+    REQUIRE(flow.bbr.m_headroom == Approx(0.2f));
+    REQUIRE(flow.bbr.m_startupFullLossCount == 4);
+    REQUIRE(flow.bbr.m_probeWaitBaseUs == 500000);
+    REQUIRE(flow.bbr.m_probeMaxRounds == 16);
+
+    // 超出范围的值回退默认值
+    Config bad;
+    bad.bbr2_loss_thresh = 1.5f;
+    bad.bbr2_beta = 0.0f;
+    bad.bbr2_headroom = -0.1f;
+    BbrV2 fallback(&bad);
+    REQUIRE(fallback.m_lossThresh == Approx(0.02f));
+    REQUIRE(fallback.m_beta == Approx(0.7f));
+    REQUIRE(fallback.m_headroom == Approx(0.15f));
+}
+
+TEST_CASE("BbrV2: loss rate above threshold bounds inflight_hi and ends PROBE_UP", "[BBR][BBRv2]")
+{
+    Flow flow;
+    for (int i = 0; i < 4; ++i) {
+        flow.round(20);
+    }
+    flow.enterProbeBW(BbrV2::ProbeBWPhase::Up);
+    REQUIRE(flow.bbr.phase() == BbrV2::ProbeBWPhase::Up);
+
+    // 1/100 低于默认 2% 阈值, 不收紧上限
+    flow.round(100, 1);
+    REQUIRE(flow.bbr.inflightHi() == UINT64_MAX);
+    REQUIRE(flow.bbr.phase() == BbrV2::ProbeBWPhase::Up);
+
+    // 下一轮 4/40 = 10% 超过阈值
+    flow.round(40, 4);
+    REQUIRE(flow.bbr.inflightHi() != UINT64_MAX);
+    // 上限不高于此前探测到的在途峰值
+    REQUIRE(flow.bbr.inflightHi() < 100 * kPacketSize);
+    // 结束探测; 在途已排空时同一 ACK 内即由 DOWN 转入 CRUISE
+    REQUIRE(flow.bbr.phase() != BbrV2::ProbeBWPhase::Up);
+    REQUIRE(flow.bbr.m_pacingGain < 1.25f);
+    REQUIRE(flow.bbr.getCwnd() <= flow.bbr.inflightHi());
+}
+
+TEST_CASE("BbrV2: ECN CE in CRUISE cuts the short-term lower bounds", "[BBR][BBRv2][ECN]")
+{
+    Flow flow;
+    for (int i = 0; i < 4; ++i) {
+        flow.round(20);
+    }
+    flow.enterProbeBW(BbrV2::ProbeBWPhase::Cruise);
+    flow.bbr.m_probeWaitUs = UINT64_MAX / 2;
+    flow.bbr.m_roundsSinceProbe = 0;
+    const uint64_t cwndBefore = flow.bbr.getCwnd();
+
+    flow.round(20, 0, true);
+    REQUIRE(flow.bbr.inflightHi() != UINT64_MAX);
+    REQUIRE(flow.bbr.inflightLo() == UINT64_MAX);
+
+    // 下一轮开始时按 beta 回退 inflight_lo/bw_lo, cwnd 随之受限
+    flow.round(20);
+    REQUIRE(flow.bbr.inflightLo() != UINT64_MAX);
+    REQUIRE(flow.bbr.m_bwLo != UINT64_MAX);
+    REQUIRE(flow.bbr.inflightLo() < cwndBefore);
+    REQUIRE(flow.bbr.getCwnd() <= flow.bbr.inflightLo());
+    // CRUISE 在 inflight_hi 之下保留余量
+    REQUIRE(flow.bbr.getCwnd() <= flow.bbr.getInflightWithHeadroom());
+
+    // 进入 REFILL 时清除短期下界
+    flow.bbr.startProbeRefill();
+    REQUIRE(flow.bbr.inflightLo() == UINT64_MAX);
+    REQUIRE(flow.bbr.m_bwLo == UINT64_MAX);
+}
+
+TEST_CASE("BbrV2: PROBE_BW cycles DOWN, CRUISE, REFILL, UP and grows inflight_hi", "[BBR][BBRv2]")
+{
+    Flow flow;
+    for (int i = 0; i < 4; ++i) {
+        flow.round(20);
+    }
+    flow.enterProbeBW(BbrV2::ProbeBWPhase::Down);
+    flow.bbr.m_probeWaitUs = 10 * kRttUs;
+    REQUIRE(flow.bbr.m_pacingGain == Approx(0.9f));
+
+    // 在途已排空到 BDP 以下
+    flow.round(20);
+    REQUIRE(flow.bbr.phase() == BbrV2::ProbeBWPhase::Cruise);
+    REQUIRE(flow.bbr.m_pacingGain == Approx(1.0f));
+
+    // 探测等待时间到达后进入 REFILL, 满一轮后进入 UP
+    flow.now += 10 * kRttUs;
+    flow.round(20);
+    REQUIRE(flow.bbr.phase() == BbrV2::ProbeBWPhase::Refill);
+    flow.round(20);
+    REQUIRE(flow.bbr.phase() == BbrV2::ProbeBWPhase::Up);
+    REQUIRE(flow.bbr.m_pacingGain == Approx(1.25f));
+
+    // cwnd 受 inflight_hi 约束时每轮放宽量翻倍
+    const uint64_t hi = 10 * kPacketSize;
+    flow.bbr.m_inflightHi = hi;
+    flow.round(10);
+    REQUIRE(flow.bbr.inflightHi() == hi + 1460);
+    flow.round(10);
+    REQUIRE(flow.bbr.inflightHi() == hi + 1460 + 2 * 1460);
+    REQUIRE(flow.bbr.getCwnd() <= flow.bbr.inflightHi());
+}
+
+TEST_CASE("BbrV2: heavy loss in STARTUP exits with inflight_hi set", "[BBR][BBRv2]")
+{
+    Flow flow;
+    flow.round(20);
+    flow.round(20);
+    REQUIRE(flow.bbr.mode() == BbrV2::Mode::StartUp);
+
+    // 丢包事件少于 bbr2_startup_full_loss_count 时仍停留在 STARTUP
+    flow.round(40, 4);
+    REQUIRE(flow.bbr.mode() == BbrV2::Mode::StartUp);
+    REQUIRE(flow.bbr.inflightHi() == UINT64_MAX);
+
+    flow.round(40, 10);
+    REQUIRE(flow.bbr.mode() != BbrV2::Mode::StartUp);
+    REQUIRE(flow.bbr.inflightHi() != UINT64_MAX);
+    REQUIRE(flow.bbr.getCwnd() <= flow.bbr.inflightHi());
+}
+
+TEST_CASE("BbrV2: ack aggregation adds headroom to cwnd at full bandwidth", "[BBR][BBRv2]")
+{
+    Flow flow;
+
+    // 8 Mbit/s = 1000 bytes/ms
+    flow.bbr.m_maxBandwidth.updateMax(1, 8000000);
+
+    // 第一次 ACK 开启聚合周期
+    flow.bbr.m_ackState.ackTime = 1000000;
+    REQUIRE(flow.bbr.updateAckAggregationBytes(10000) == 0);
+
+    // 1ms 内按带宽只应确认 1000 字节, 实际累计 15000 字节, 超出 14000
+    flow.bbr.m_ackState.ackTime = 1001000;
+    REQUIRE(flow.bbr.updateAckAggregationBytes(5000) == 14000);
+    REQUIRE(flow.bbr.m_maxAckHeight.get() == 14000);
+
+    // 带宽已满时 cwnd 目标值在 BDP 之上加上最大聚合量
+    flow.enterProbeBW(BbrV2::ProbeBWPhase::Cruise);
+    flow.bbr.m_cwnd = flow.bbr.m_maxCwnd;
+    flow.bbr.calculateCwnd(0, 0);
+    REQUIRE(flow.bbr.m_cwnd == flow.bbr.boundCwnd(flow.bbr.getTargetInflight(flow.bbr.m_cwndGain) + 14000));
+}
@@ -83,6 +83,28 @@ eular::utp::PacketOut *LastUnackedPacket(eular::utp::SendControl *sendCtl)
     return last;
 }
 
+size_t DeferredStreamCount(ConnectionImpl &conn)
+{
+    size_t count = 0;
+    StreamImpl *stream = nullptr;
+    TAILQ_FOREACH(stream, &conn.m_deferredStreams, m_schedLink) {
+        ++count;
+    }
+    return count;
+}
+
+bool DeferredStreamsSorted(ConnectionImpl &conn)
+{
+    StreamImpl *stream = nullptr;
+    TAILQ_FOREACH(stream, &conn.m_deferredStreams, m_schedLink) {
+        StreamImpl *next = TAILQ_NEXT(stream, m_schedLink);
+        if (next != nullptr && next->m_deferUntilUs < stream->m_deferUntilUs) {
+            return false;
+        }
+    }
+    return true;
+}
+
 } // namespace
 
 TEST_CASE("ConnectionImpl: getStream returns created stream pointer", "[Connection][Stream]")
@@ -561,18 +583,19 @@ TEST_CASE("ConnectionImpl: schedule timer enqueues context write instead of dire
     ConnectionImpl conn(&ctx, nullptr, 1201);
     conn.m_state = ConnectionImpl::kStateConnected;
 
-    REQUIRE(ctx.m_wantWriteConns.empty());
+    REQUIRE(TAILQ_EMPTY(&ctx.m_wantWriteConns));
     REQUIRE(conn.m_schedulerStats.emptyRounds == 0);
 
     conn.nextScheduleTime(1);
 
-    for (int i = 0; i < 10 && ctx.m_wantWriteConns.empty(); ++i) {
+    for (int i = 0; i < 10 && TAILQ_EMPTY(&ctx.m_wantWriteConns); ++i) {
         loop.dispatch(EVLOOP_NONBLOCK | EVLOOP_ONCE);
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
 
-    REQUIRE_FALSE(ctx.m_wantWriteConns.empty());
-    REQUIRE(ctx.m_wantWriteConns.front() == &conn);
+    REQUIRE_FALSE(TAILQ_EMPTY(&ctx.m_wantWriteConns));
+    REQUIRE(TAILQ_FIRST(&ctx.m_wantWriteConns) == &conn);
+    REQUIRE(conn.m_writeQueued);
     REQUIRE(conn.m_schedulerStats.emptyRounds == 0);
 }
 
@@ -594,13 +617,13 @@ TEST_CASE("ContextImpl: onWriteEvent processes multiple connections in one fair
 
     ctx.wantWrite(c1.get());
     ctx.wantWrite(c2.get());
-    REQUIRE(ctx.m_wantWriteConns.size() == 2);
+    REQUIRE(ctx.m_wantWriteCount == 2);
 
     ctx.onWriteEvent();
 
     REQUIRE(c1->m_schedulerStats.emptyRounds == 1);
     REQUIRE(c2->m_schedulerStats.emptyRounds == 1);
-    REQUIRE(ctx.m_wantWriteConns.empty());
+    REQUIRE(TAILQ_EMPTY(&ctx.m_wantWriteConns));
 }
 
 TEST_CASE("ConnectionImpl: strict scheduler picks higher priority stream first", "[Connection][Stream][Priority]")
@@ -624,22 +647,25 @@ TEST_CASE("ConnectionImpl: strict scheduler picks higher priority stream first",
     sLow->m_sendQueuedBytes = 32;
 
     conn.m_streams.emplace(sHigh->id(), sHigh);
+    conn.activateStream(sHigh.get());
     conn.m_streams.emplace(sMid->id(), sMid);
+    conn.activateStream(sMid.get());
     conn.m_streams.emplace(sLow->id(), sLow);
+    conn.activateStream(sLow.get());
 
-    StreamImpl::SP selected = conn.pickNextWritableStream();
+    StreamImpl::SP selected = conn.pickNextWritableStream(eular::utp::time::MonotonicUs());
     REQUIRE(selected != nullptr);
     REQUIRE(selected->id() == sHigh->id());
     selected->m_sendQueuedBytes = 0;
-    conn.updateStrictAgingState(selected->id());
+    conn.updateStrictAgingState(selected.get());
 
-    selected = conn.pickNextWritableStream();
+    selected = conn.pickNextWritableStream(eular::utp::time::MonotonicUs());
     REQUIRE(selected != nullptr);
     REQUIRE(selected->id() == sMid->id());
     selected->m_sendQueuedBytes = 0;
-    conn.updateStrictAgingState(selected->id());
+    conn.updateStrictAgingState(selected.get());
 
-    selected = conn.pickNextWritableStream();
+    selected = conn.pickNextWritableStream(eular::utp::time::MonotonicUs());
     REQUIRE(selected != nullptr);
     REQUIRE(selected->id() == sLow->id());
 }
@@ -663,14 +689,16 @@ TEST_CASE("ConnectionImpl: strict scheduler aging promotes long-wait stream", "[
     sAged->m_sendQueuedBytes = 32;
 
     conn.m_streams.emplace(sBase->id(), sBase);
+    conn.activateStream(sBase.get());
     conn.m_streams.emplace(sAged->id(), sAged);
+    conn.activateStream(sAged.get());
 
-    StreamImpl::SP first = conn.pickNextWritableStream();
+    StreamImpl::SP first = conn.pickNextWritableStream(eular::utp::time::MonotonicUs());
     REQUIRE(first != nullptr);
     REQUIRE(first->id() == sBase->id());
-    conn.updateStrictAgingState(first->id());
+    conn.updateStrictAgingState(first.get());
 
-    StreamImpl::SP second = conn.pickNextWritableStream();
+    StreamImpl::SP second = conn.pickNextWritableStream(eular::utp::time::MonotonicUs());
     REQUIRE(second != nullptr);
     REQUIRE(second->id() == sAged->id());
 }
@@ -694,14 +722,16 @@ TEST_CASE("ConnectionImpl: drr scheduler rotates equal-priority streams", "[Conn
     s2->m_sendQueuedBytes = 64;
 
     conn.m_streams.emplace(s1->id(), s1);
+    conn.activateStream(s1.get());
     conn.m_streams.emplace(s2->id(), s2);
+    conn.activateStream(s2.get());
 
-    StreamImpl::SP first = conn.pickNextWritableStream();
+    StreamImpl::SP first = conn.pickNextWritableStream(eular::utp::time::MonotonicUs());
     REQUIRE(first != nullptr);
     REQUIRE(first->id() == s1->id());
     first->m_sendQueuedBytes = 0;
 
-    StreamImpl::SP second = conn.pickNextWritableStream();
+    StreamImpl::SP second = conn.pickNextWritableStream(eular::utp::time::MonotonicUs());
     REQUIRE(second != nullptr);
     REQUIRE(second->id() == s2->id());
 }
@@ -723,18 +753,101 @@ TEST_CASE("ConnectionImpl: scheduler mode switch changes stream selection", "[Co
     highIdHighPrio->m_sendQueuedBytes = 16;
 
     conn.m_streams.emplace(lowIdLowPrio->id(), lowIdLowPrio);
+    conn.activateStream(lowIdLowPrio.get());
     conn.m_streams.emplace(highIdHighPrio->id(), highIdHighPrio);
+    conn.activateStream(highIdHighPrio.get());
 
-    StreamImpl::SP selected = conn.pickNextWritableStream();
+    StreamImpl::SP selected = conn.pickNextWritableStream(eular::utp::time::MonotonicUs());
     REQUIRE(selected != nullptr);
     REQUIRE(selected->id() == lowIdLowPrio->id());
 
     cfg.stream_scheduler_mode = eular::utp::kStreamSchedulerStrict;
-    selected = conn.pickNextWritableStream();
+    selected = conn.pickNextWritableStream(eular::utp::time::MonotonicUs());
     REQUIRE(selected != nullptr);
     REQUIRE(selected->id() == highIdHighPrio->id());
 }
 
+TEST_CASE("ConnectionImpl: scheduler queues only streams with pending data", "[Connection][Stream][Priority]")
+{
+    Config cfg;
+    cfg.stream_scheduler_mode = eular::utp::kStreamSchedulerStrict;
+    cfg.stream_aging_threshold = 1024;
+    ev::EventLoop loop;
+    ContextImpl ctx(loop.loop(), &cfg);
+
+    ConnectionImpl conn(&ctx, nullptr, 1020);
+    conn.m_state = ConnectionImpl::kStateConnected;
+
+    std::vector<StreamImpl::SP> streams;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        StreamImpl::SP stream = std::make_shared<StreamImpl>(&conn, i * 4, 4);
+        conn.m_streams.emplace(stream->id(), stream);
+        streams.push_back(stream);
+    }
+    REQUIRE(conn.m_activeStreamCount == 0);
+
+    const char payload[32] = {0};
+    REQUIRE(streams[500]->write(payload, sizeof(payload), false) == static_cast<int32_t>(sizeof(payload)));
+    REQUIRE(streams[7]->write(payload, sizeof(payload), false) == static_cast<int32_t>(sizeof(payload)));
+    REQUIRE(streams[500]->write(payload, sizeof(payload), false) == static_cast<int32_t>(sizeof(payload)));
+    REQUIRE(conn.m_activeStreamCount == 2);
+    REQUIRE(conn.m_activeStreamLevels == (1u << 4));
+
+    // 同级按入队顺序轮转
+    StreamImpl::SP selected = conn.pickNextWritableStream(eular::utp::time::MonotonicUs());
+    REQUIRE(selected == streams[500]);
+    conn.updateStrictAgingState(selected.get());
+    selected = conn.pickNextWritableStream(eular::utp::time::MonotonicUs());
+    REQUIRE(selected == streams[7]);
+    conn.updateStrictAgingState(selected.get());
+
+    // 优先级变化后移入对应队列
+    REQUIRE(streams[7]->setPriority(1) == 0);
+    REQUIRE(streams[7]->m_schedLevel == 1);
+    REQUIRE(conn.m_activeStreamLevels == ((1u << 1) | (1u << 4)));
+    selected = conn.pickNextWritableStream(eular::utp::time::MonotonicUs());
+    REQUIRE(selected == streams[7]);
+
+    // 数据发完的 stream 在下次选流时摘除, deficit 一并清零
+    streams[7]->m_sendQueuedBytes = 0;
+    streams[7]->m_drrDeficit = 100;
+    selected = conn.pickNextWritableStream(eular::utp::time::MonotonicUs());
+    REQUIRE(selected == streams[500]);
+    REQUIRE(conn.m_activeStreamCount == 1);
+    REQUIRE(streams[7]->m_schedState == StreamImpl::kSchedIdle);
+    REQUIRE(streams[7]->m_drrDeficit == 0);
+
+    // 析构时自动出队
+    conn.m_streams.erase(streams[500]->id());
+    streams[500].reset();
+    selected.reset();
+    REQUIRE(conn.m_activeStreamCount == 0);
+    REQUIRE(conn.m_activeStreamLevels == 0);
+}
+
+TEST_CASE("ContextImpl: destroyed connection leaves the write queue", "[Context][Scheduler]")
+{
+    Config cfg;
+    ev::EventLoop loop;
+    ContextImpl ctx(loop.loop(), &cfg);
+
+    auto c1 = std::make_shared<ConnectionImpl>(&ctx, nullptr, 1303);
+    auto c2 = std::make_shared<ConnectionImpl>(&ctx, nullptr, 1304);
+    ctx.wantWrite(c1.get());
+    ctx.wantWrite(c2.get());
+    ctx.wantWrite(c1.get());
+    REQUIRE(ctx.m_wantWriteCount == 2);
+
+    c1.reset();
+    REQUIRE(ctx.m_wantWriteCount == 1);
+    REQUIRE(TAILQ_FIRST(&ctx.m_wantWriteConns) == c2.get());
+
+    // 未受本 context 管理的连接出队后直接跳过
+    ctx.onWriteEvent();
+    REQUIRE(TAILQ_EMPTY(&ctx.m_wantWriteConns));
+    REQUIRE_FALSE(c2->m_writeQueued);
+}
+
 TEST_CASE("StreamImpl: setPriority validates input range", "[Connection][Stream][Priority]")
 {
     Config cfg;
@@ -813,6 +926,75 @@ TEST_CASE("StreamImpl: coalescing defers tiny payload within window", "[Connecti
     REQUIRE(stream.coalesceDelayRemainingUs(nowUs) > 0);
 }
 
+TEST_CASE("ConnectionImpl: deferred streams are released by deadline order", "[Connection][Stream][Coalescing]")
+{
+    Config cfg;
+    cfg.stream_enable_coalescing = true;
+    cfg.stream_min_payload_before_immediate_send = 512;
+    cfg.stream_coalesce_delay_us = 5000;
+    ev::EventLoop loop;
+    ContextImpl ctx(loop.loop(), &cfg);
+
+    ConnectionImpl conn(&ctx, nullptr, 1021);
+    conn.m_state = ConnectionImpl::kStateConnected;
+    conn.m_networkPath.m_state = decltype(conn.m_networkPath)::kPathValidated;
+    conn.m_bytesIn = 4096;
+
+    // 截止时刻 = 写入时刻 + 合并延迟, 写入晚于 nowUs, 因此不论建流耗时多久都尚未到期
+    const utp_time_t nowUs = eular::utp::time::MonotonicUs();
+    std::vector<StreamImpl::SP> streams;
+    const char payload[32] = {0};
+    for (uint32_t i = 0; i < 1000; ++i) {
+        StreamImpl::SP stream = std::make_shared<StreamImpl>(&conn, i * 4, 4);
+        conn.m_streams.emplace(stream->id(), stream);
+        streams.push_back(stream);
+        REQUIRE(stream->write(payload, sizeof(payload), false) == static_cast<int32_t>(sizeof(payload)));
+    }
+
+    // 合并窗口内全部移入延迟队列, 队首为最早到期者
+    REQUIRE(conn.pickNextWritableStream(nowUs) == nullptr);
+    REQUIRE(DeferredStreamCount(conn) == streams.size());
+    REQUIRE(conn.m_activeStreamCount == 0);
+    REQUIRE(TAILQ_FIRST(&conn.m_deferredStreams) == streams[0].get());
+    REQUIRE(DeferredStreamsSorted(conn));
+
+    // 未到期时选流不遍历也不放行延迟队列
+    REQUIRE(conn.pickNextWritableStream(nowUs) == nullptr);
+    REQUIRE(DeferredStreamCount(conn) == streams.size());
+
+    // 截止时刻早于队尾的 stream 插入到队列中间, 仍保持升序
+    StreamImpl::SP early = std::make_shared<StreamImpl>(&conn, 4000, 4);
+    conn.m_streams.emplace(early->id(), early);
+    REQUIRE(early->write(payload, sizeof(payload), false) == static_cast<int32_t>(sizeof(payload)));
+    early->m_lastSendQueuedAtUs = streams[500]->m_lastSendQueuedAtUs;
+    REQUIRE(conn.pickNextWritableStream(nowUs) == nullptr);
+    REQUIRE(DeferredStreamCount(conn) == streams.size() + 1);
+    REQUIRE(TAILQ_LAST(&conn.m_deferredStreams, ConnectionImpl::StreamQueue) != early.get());
+    REQUIRE(DeferredStreamsSorted(conn));
+    conn.m_streams.erase(early->id());
+    early.reset();
+    REQUIRE(DeferredStreamCount(conn) == streams.size());
+
+    // 达到立即发送门限的 stream 立刻离开延迟队列
+    std::vector<char> large(cfg.stream_min_payload_before_immediate_send, 0);
+    REQUIRE(streams[3]->write(large.data(), large.size(), false) == static_cast<int32_t>(large.size()));
+    REQUIRE(DeferredStreamCount(conn) == streams.size() - 1);
+    REQUIRE(conn.pickNextWritableStream(nowUs) == streams[3]);
+
+    // 到期后全部回到活跃队列
+    REQUIRE(conn.pickNextWritableStream(streams.back()->coalesceDeadlineUs()) != nullptr);
+    REQUIRE(TAILQ_EMPTY(&conn.m_deferredStreams));
+    REQUIRE(conn.m_activeStreamCount == streams.size());
+
+    // 析构时从延迟队列摘除
+    REQUIRE(conn.pickNextWritableStream(nowUs) == streams[3]);
+    REQUIRE(DeferredStreamCount(conn) == streams.size() - 1);
+    conn.m_streams.clear();
+    streams.clear();
+    REQUIRE(TAILQ_EMPTY(&conn.m_deferredStreams));
+    REQUIRE(conn.m_activeStreamCount == 0);
+}
+
 TEST_CASE("StreamImpl: coalescing bypasses threshold and expired window", "[Connection][Stream][Coalescing]")
 {
     Config cfg;
@@ -927,13 +1109,15 @@ TEST_CASE("ConnectionImpl: scheduler skips deferred streams", "[Connection][Stre
     ready->m_lastSendQueuedAtUs = nowUs - 6000;
 
     conn.m_streams.emplace(deferred->id(), deferred);
+    conn.activateStream(deferred.get());
     conn.m_streams.emplace(ready->id(), ready);
+    conn.activateStream(ready.get());
 
-    StreamImpl::SP selected = conn.pickNextWritableStream();
+    StreamImpl::SP selected = conn.pickNextWritableStream(eular::utp::time::MonotonicUs());
     REQUIRE(selected != nullptr);
     REQUIRE(selected->id() == ready->id());
 
     ready->m_lastSendQueuedAtUs = nowUs - 500;
-    selected = conn.pickNextWritableStream();
+    selected = conn.pickNextWritableStream(eular::utp::time::MonotonicUs());
     REQUIRE(selected == nullptr);
 }
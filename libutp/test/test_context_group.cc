@@ -0,0 +1,202 @@
+/*************************************************************************
+    > File Name: test_context_group.cc
+    > Author: eular
+    > Brief: SO_REUSEPORT 分片上下文组
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include <catch2/catch.hpp>
+#include "util/status.h"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <event2/event.h>
+#include <event/loop.h>
+#include <utils/serialize.hpp>
+
+#define private public
+#include "context/context_impl.h"
+#undef private
+
+#include "utp/context_group.h"
+#include "proto/proto.h"
+
+using eular::Serialize;
+using eular::utp::Config;
+using eular::utp::Connection;
+using eular::utp::ConnectionImpl;
+using eular::utp::Context;
+using eular::utp::ContextGroup;
+using eular::utp::ContextImpl;
+using eular::utp::UdpSocket;
+
+namespace {
+
+std::vector<uint8_t> BuildHeader(uint32_t scid, uint32_t dcid, uint8_t packetType)
+{
+    std::vector<uint8_t> wire(UTP_HEADER_SIZE, 0);
+    uint8_t *offset = wire.data();
+    size_t left = wire.size();
+    offset = Serialize::SerializeTo(offset, left, scid);
+    offset = Serialize::SerializeTo(offset, left, dcid);
+    offset = Serialize::SerializeTo(offset, left, static_cast<uint64_t>(1));
+    offset = Serialize::SerializeTo(offset, left, static_cast<uint16_t>(0));
+    offset = Serialize::SerializeTo(offset, left, packetType);
+    offset = Serialize::SerializeTo(offset, left, static_cast<uint8_t>(0));
+    REQUIRE(offset != nullptr);
+    return wire;
+}
+
+bool PumpUntil(ev::EventLoop &loop, const std::function<bool()> &done, int32_t maxRounds)
+{
+    for (int32_t i = 0; i < maxRounds; ++i) {
+        loop.dispatch(EVLOOP_NONBLOCK | EVLOOP_ONCE);
+        if (done()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return done();
+}
+
+size_t CountConnected(const ContextImpl &ctx)
+{
+    size_t count = 0;
+    for (const auto &entry : ctx.m_connections) {
+        if (entry.second && entry.second->state() == ConnectionImpl::kStateConnected) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void RunGroupHandshakes(bool attachCbpf)
+{
+    constexpr uint32_t kShards = 4;
+    constexpr size_t kClients = 8;
+
+    Config cfg;
+    cfg.handshake_timeout = 500;
+    cfg.enable_reuseport_cbpf = attachCbpf;
+
+    std::mutex mutex;
+    std::vector<std::pair<uint32_t, uint32_t>> accepted; // shard -> local cid
+
+    ContextGroup group(kShards, &cfg);
+    group.setOnShardStart([&] (uint32_t shard, Context &ctx) {
+        Context *self = &ctx;
+        ctx.setOnNewConnection([self] (const Context::NewConnectionInfo &) {
+            self->accept();
+            return true;
+        });
+        ctx.setOnConnected([&mutex, &accepted, shard] (Connection::Ptr conn) {
+            std::lock_guard<std::mutex> lock(mutex);
+            accepted.emplace_back(shard, conn->description().scid);
+        });
+    });
+    REQUIRE(group.start("127.0.0.1", 0) == 0);
+    REQUIRE(group.port() != 0);
+    REQUIRE(group.shardCount() == kShards);
+    if (!attachCbpf) {
+        REQUIRE_FALSE(group.cbpfAttached());
+    }
+
+    ev::EventLoop loop;
+    std::vector<std::unique_ptr<ContextImpl>> clients;
+    for (size_t i = 0; i < kClients; ++i) {
+        clients.emplace_back(new ContextImpl(loop.loop(), &cfg));
+        REQUIRE(clients.back()->bind("127.0.0.1", 0, "").ok());
+        Context::ConnectInfo info;
+        info.ip = "127.0.0.1";
+        info.port = group.port();
+        info.timeout = 500;
+        REQUIRE(clients.back()->connect(info).ok());
+    }
+
+    REQUIRE(PumpUntil(loop, [&] () {
+        for (const auto &client : clients) {
+            if (CountConnected(*client) != 1) {
+                return false;
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        return accepted.size() == kClients;
+    }, 2000));
+
+    group.stop();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &entry : accepted) {
+        // 连接只在分配 CID 的分片上建立
+        REQUIRE((entry.second >> ContextImpl::kShardCidShift) == entry.first);
+    }
+}
+
+} // namespace
+
+TEST_CASE("ContextImpl: shard mapping follows CID layout", "[ContextGroup]")
+{
+    REQUIRE(ContextImpl::ShardOfPacket(123, 0, 1) == 0);
+    REQUIRE(ContextImpl::ShardOfPacket(5, 0, 4) == 1);
+    REQUIRE(ContextImpl::ShardOfPacket(5, (3u << 24) | 0x1234, 4) == 3);
+    REQUIRE(ContextImpl::ShardOfPacket(5, (6u << 24) | 0x1234, 4) == 2);
+
+    ev::EventLoop loop;
+    Config cfg;
+    ContextImpl ctx(loop.loop(), &cfg);
+    ctx.setShard(2, 4, nullptr);
+    for (int32_t i = 0; i < 64; ++i) {
+        uint32_t cid = 0;
+        REQUIRE(ctx.allocLocalCid(cid));
+        REQUIRE(cid != 0);
+        REQUIRE((cid >> ContextImpl::kShardCidShift) == 2);
+    }
+}
+
+TEST_CASE("ContextImpl: misrouted packets are forwarded to owner shard", "[ContextGroup]")
+{
+    ev::EventLoop loop;
+    Config cfg;
+    ContextImpl ctx(loop.loop(), &cfg);
+
+    std::vector<uint32_t> targets;
+    ctx.setShard(0, 4, [&targets] (uint32_t shard, const UdpSocket::MsgMetaInfo &) {
+        targets.push_back(shard);
+        return targets.size() < 3;
+    });
+
+    const std::vector<uint8_t> initial = BuildHeader(5, 0, UTP_TYPE_INITIAL);
+    const std::vector<uint8_t> ctrl = BuildHeader(7, (2u << 24) | 0x42, UTP_TYPE_CTRL);
+    const std::vector<uint8_t> local = BuildHeader(7, (4u << 24) | 0x42, UTP_TYPE_CTRL);
+    std::vector<UdpSocket::MsgMetaInfo> msgs(4);
+    const std::vector<uint8_t> *wires[] = {&initial, &ctrl, &local, &ctrl};
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        msgs[i].data = wires[i]->data();
+        msgs[i].len = wires[i]->size();
+        msgs[i].slice_count = 0;
+    }
+
+    ctx.processIncomingPackets(msgs.data(), msgs.size(), false);
+    REQUIRE(targets == std::vector<uint32_t>({1, 2, 2}));
+    REQUIRE(ctx.statistic().reuseport_forwarded == 2);
+    REQUIRE(ctx.statistic().reuseport_forward_dropped == 1);
+
+    // 已转发过的数据报不再二次转发
+    targets.clear();
+    ctx.onForwardedPackets(msgs.data(), msgs.size());
+    REQUIRE(targets.empty());
+}
+
+TEST_CASE("ContextGroup: connections stay on the shard encoded in their CID", "[ContextGroup][Integration]")
+{
+    SECTION("kernel cBPF steering") {
+        RunGroupHandshakes(true);
+    }
+    SECTION("user-space forwarding fallback") {
+        RunGroupHandshakes(false);
+    }
+}
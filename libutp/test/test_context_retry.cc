@@ -0,0 +1,167 @@
+/*************************************************************************
+    > File Name: test_context_retry.cc
+    > Author: eular
+    > Brief: 负载触发的无状态 Retry 地址校验
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include <catch2/catch.hpp>
+#include "util/status.h"
+
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <event2/event.h>
+#include <event/loop.h>
+
+#define private public
+#include "context/context_impl.h"
+#undef private
+
+#include "crypto/token.h"
+#include "util/time.h"
+
+using eular::utp::Address;
+using eular::utp::Config;
+using eular::utp::ConnectionImpl;
+using eular::utp::Context;
+using eular::utp::ContextImpl;
+using eular::utp::TokenAuth;
+using eular::utp::TokenMeta;
+using eular::utp::TokenType;
+
+namespace {
+
+bool PumpUntil(ev::EventLoop &loop, const std::function<bool()> &done, const std::function<void()> &tick)
+{
+    for (int32_t i = 0; i < 200; ++i) {
+        if (tick) {
+            tick();
+        }
+        if (done()) {
+            return true;
+        }
+        loop.dispatch(EVLOOP_NONBLOCK | EVLOOP_ONCE);
+        if (done()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return done();
+}
+
+uint16_t BoundPort(const ContextImpl &ctx)
+{
+    return ctx.m_udpSocket.m_localAddr.port();
+}
+
+bool HasConnectedConnection(const ContextImpl &ctx)
+{
+    for (const auto &entry : ctx.m_connections) {
+        if (entry.second && entry.second->state() == ConnectionImpl::kStateConnected) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<uint8_t> BuildZeroRttTicket(ContextImpl &ctx, const Address &address, uint32_t cid)
+{
+    TokenMeta meta;
+    meta.token_type = static_cast<uint8_t>(TokenType::kZeroRttResumption);
+    meta.timestamp = static_cast<uint32_t>(eular::utp::time::RealtimeMs() / 1000);
+    meta.cid = cid;
+    meta.family = static_cast<uint16_t>(address.family());
+    sockaddr_in addr4{};
+    REQUIRE(address.toSockAddrIn(addr4));
+    meta.host_v4 = addr4.sin_addr;
+
+    TokenAuth::TokenBuf tokenBuf{};
+    REQUIRE(ctx.tokenAuth()->seal(meta, tokenBuf));
+    return std::vector<uint8_t>(tokenBuf.begin(), tokenBuf.end());
+}
+
+} // namespace
+
+TEST_CASE("ContextImpl: pending handshakes above threshold require a retry token", "[Context][Retry]")
+{
+    Config serverCfg;
+    serverCfg.handshake_timeout = 200;
+    serverCfg.retry_pending_threshold = 1;
+    Config clientCfg;
+    clientCfg.handshake_timeout = 200;
+
+    ev::EventLoop loop;
+    ContextImpl server(loop.loop(), &serverCfg);
+    ContextImpl client1(loop.loop(), &clientCfg);
+    ContextImpl client2(loop.loop(), &clientCfg);
+
+    REQUIRE(server.bind("127.0.0.1", 0, "").ok());
+    REQUIRE(client1.bind("127.0.0.1", 0, "").ok());
+    REQUIRE(client2.bind("127.0.0.1", 0, "").ok());
+
+    int32_t notified = 0;
+    server.setOnNewConnection([&notified](const Context::NewConnectionInfo &) {
+        ++notified;
+        return true;
+    });
+
+    Context::ConnectInfo info;
+    info.ip = "127.0.0.1";
+    info.port = BoundPort(server);
+    info.timeout = 200;
+
+    // 首个握手未 accept, 占住一个 pending 名额
+    REQUIRE(client1.connect(info).ok());
+    REQUIRE(PumpUntil(loop, [&]() { return server.m_pendingIncoming.size() == 1; }, nullptr));
+    REQUIRE(server.statistic().retry_sent == 0);
+
+    // 第二个握手先收到 Retry, 回显令牌后才建立 pending
+    REQUIRE(client2.connect(info).ok());
+    REQUIRE(PumpUntil(loop, [&]() { return server.m_pendingIncoming.size() == 2; }, nullptr));
+    Context::Statistic stat = server.statistic();
+    REQUIRE(stat.retry_sent == 1);
+    REQUIRE(stat.retry_token_accepted == 1);
+    REQUIRE(stat.retry_token_rejected == 0);
+    REQUIRE(notified == 2);
+
+    const bool ok = PumpUntil(
+        loop,
+        [&]() { return HasConnectedConnection(client1) && HasConnectedConnection(client2); },
+        [&]() {
+            while (!server.m_pendingIncomingQueue.empty()) {
+                REQUIRE(server.accept().ok());
+            }
+        });
+    REQUIRE(ok);
+    REQUIRE(server.statistic().retry_sent == 1);
+}
+
+TEST_CASE("ContextImpl: retry token is bound to peer address and initiator cid", "[Context][Retry]")
+{
+    Config cfg;
+    cfg.retry_token_lifetime = 10;
+
+    ev::EventLoop loop;
+    ContextImpl ctx(loop.loop(), &cfg);
+
+    Address peer("127.0.0.1", 9000);
+    std::vector<uint8_t> token;
+    REQUIRE(ctx.buildRetryToken(peer, 4242, token));
+    REQUIRE(token.size() == eular::utp::TOKEN_SIZE);
+
+    REQUIRE(ctx.validateRetryToken(peer, 4242, token));
+    // 端口变化不影响, 地址或 cid 不同则拒绝
+    REQUIRE(ctx.validateRetryToken(Address("127.0.0.1", 9001), 4242, token));
+    REQUIRE_FALSE(ctx.validateRetryToken(Address("127.0.0.2", 9000), 4242, token));
+    REQUIRE_FALSE(ctx.validateRetryToken(peer, 4243, token));
+
+    // 0-RTT 票据不能充当 Retry 令牌
+    const std::vector<uint8_t> ticket = BuildZeroRttTicket(ctx, peer, 4242);
+    REQUIRE_FALSE(ctx.validateRetryToken(peer, 4242, ticket));
+
+    token[eular::utp::TOKEN_SIZE - 1] ^= 0x01;
+    REQUIRE_FALSE(ctx.validateRetryToken(peer, 4242, token));
+}
@@ -137,6 +137,11 @@ TEST_CASE("ContextImpl: rememberZeroRttNonce rejects duplicates within replay wi
     REQUIRE(ctx.rememberZeroRttNonce(777, 1001, 1000));
     REQUIRE_FALSE(ctx.rememberZeroRttNonce(777, 1001, 1001));
 
-    ctx.purgeZeroRttReplayCache(2501);
-    REQUIRE(ctx.rememberZeroRttNonce(777, 1001, 2502));
+    REQUIRE(ctx.rememberZeroRttNonce(777, 1002, 1002));
+
+    // 记录至少保留一个窗口, 轮换后仍在上一窗口的过滤器中
+    REQUIRE_FALSE(ctx.rememberZeroRttNonce(777, 1001, 2500));
+    // 两个窗口后过期
+    REQUIRE(ctx.rememberZeroRttNonce(777, 1001, 3001));
+    REQUIRE(ctx.statistic().zero_rtt_replay_fp_rate < 0.001);
 }
@@ -8,6 +8,8 @@
 #include <catch2/catch.hpp>
 #include "util/status.h"
 
+#include <vector>
+
 #include "congestion/cubic.h"
 #include "utp/config.h"
 
@@ -30,6 +32,25 @@ PacketInfo MakePacket(uint64_t packetNo, uint64_t sendTimeUs, uint32_t packetSiz
     info.packetState = nullptr;
     return info;
 }
+
+// 发出 count 个包, 每个包在 rttUs 之后被确认, 返回本轮结束时间
+uint64_t RunRound(Cubic &cubic, uint64_t &packetNo, uint64_t nowUs, size_t count, uint64_t rttUs)
+{
+    std::vector<PacketInfo> packets;
+    for (size_t i = 0; i < count; ++i) {
+        packets.push_back(MakePacket(packetNo++, nowUs + i * 100, 1200));
+        cubic.onPacketSent(&packets.back(), 0, 0);
+    }
+
+    uint64_t ackTime = nowUs;
+    cubic.onBeginAck(nowUs + rttUs, 0);
+    for (PacketInfo &pkt : packets) {
+        ackTime = pkt.sendTimeUs + rttUs;
+        cubic.onAck(&pkt, ackTime, 0);
+    }
+    cubic.onEndAck(0);
+    return ackTime;
+}
 } // namespace
 
 TEST_CASE("Cubic: slow start grows by acked bytes", "[Cubic]")
@@ -77,6 +98,26 @@ TEST_CASE("Cubic: loss reduces cwnd and later ack increases it", "[Cubic]")
     REQUIRE(cubic.getCwnd() > afterLoss);
 }
 
+TEST_CASE("Cubic: ECN CE feedback reduces cwnd like a loss", "[Cubic][ECN]")
+{
+    RttStats rtt;
+    rtt.update(25000);
+
+    Cubic byLoss;
+    byLoss.onInit(&rtt);
+    Cubic byEcn;
+    byEcn.onInit(&rtt);
+
+    PacketInfo lost = MakePacket(10, 1000, 1460);
+    byLoss.onLost(&lost);
+    byEcn.onBeginAck(2000, 0);
+    byEcn.onEcnCe();
+    byEcn.onEndAck(0);
+
+    REQUIRE(byEcn.getCwnd() < 32 * 1460);
+    REQUIRE(byEcn.getCwnd() == byLoss.getCwnd());
+}
+
 TEST_CASE("Cubic: timeout resets cwnd to min and pacing rate stays positive", "[Cubic]")
 {
     RttStats rtt;
@@ -115,3 +156,99 @@ TEST_CASE("Cubic: configurable init/min cwnd are applied", "[Cubic]")
     cubic.onTimeout();
     REQUIRE(cubic.getCwnd() == 8 * 1460);
 }
+
+TEST_CASE("Cubic: HyStart++ enters CSS on RTT increase and exits to congestion avoidance", "[Cubic][HyStart]")
+{
+    RttStats rtt;
+    rtt.update(20000);
+
+    Config cfg;
+    cfg.cubic_hystart = true;
+    Cubic cubic(&cfg);
+    cubic.onInit(&rtt);
+    REQUIRE(cubic.hystartState() == Cubic::HyStartState::SlowStart);
+
+    uint64_t packetNo = 1;
+    uint64_t now = 1000;
+    now = RunRound(cubic, packetNo, now, 10, 20000);
+    now = RunRound(cubic, packetNo, now, 10, 20000);
+    REQUIRE(cubic.hystartState() == Cubic::HyStartState::SlowStart);
+
+    // 最小 RTT 增长 10ms, 超过 clamp(20ms / 8, 4ms, 16ms)
+    now = RunRound(cubic, packetNo, now, 10, 30000);
+    REQUIRE(cubic.hystartState() == Cubic::HyStartState::Css);
+    REQUIRE(cubic.slowStartStats().cssEntries == 1);
+
+    // CSS 中增速降为 1/4
+    uint64_t before = cubic.getCwnd();
+    now = RunRound(cubic, packetNo, now, 10, 30000);
+    REQUIRE(cubic.getCwnd() - before == 10 * 1200 / 4);
+
+    for (int i = 0; i < 4; ++i) {
+        now = RunRound(cubic, packetNo, now, 10, 30000);
+    }
+    REQUIRE(cubic.hystartState() == Cubic::HyStartState::Done);
+    REQUIRE(cubic.slowStartStats().delayExits == 1);
+    REQUIRE(cubic.slowStartStats().exitCwnd != 0);
+
+    // 进入拥塞避免后每轮增长远小于慢启动
+    before = cubic.getCwnd();
+    RunRound(cubic, packetNo, now, 10, 30000);
+    REQUIRE(cubic.getCwnd() - before < 10 * 1200 / 4);
+}
+
+TEST_CASE("Cubic: HyStart++ resumes slow start when RTT falls back in CSS", "[Cubic][HyStart]")
+{
+    RttStats rtt;
+    rtt.update(20000);
+
+    Config cfg;
+    cfg.cubic_hystart = true;
+    Cubic cubic(&cfg);
+    cubic.onInit(&rtt);
+
+    uint64_t packetNo = 1;
+    uint64_t now = 1000;
+    now = RunRound(cubic, packetNo, now, 10, 20000);
+    now = RunRound(cubic, packetNo, now, 10, 20000);
+    now = RunRound(cubic, packetNo, now, 10, 30000);
+    REQUIRE(cubic.hystartState() == Cubic::HyStartState::Css);
+
+    now = RunRound(cubic, packetNo, now, 10, 22000);
+    REQUIRE(cubic.hystartState() == Cubic::HyStartState::SlowStart);
+    REQUIRE(cubic.slowStartStats().cssSpurious == 1);
+
+    const uint64_t before = cubic.getCwnd();
+    RunRound(cubic, packetNo, now, 10, 22000);
+    REQUIRE(cubic.getCwnd() - before == 10 * 1200);
+}
+
+TEST_CASE("Cubic: HyStart++ is off by default and loss records the exit cwnd", "[Cubic][HyStart]")
+{
+    RttStats rtt;
+    rtt.update(20000);
+
+    // 默认关闭, 慢启动行为与引入 HyStart++ 之前一致
+    REQUIRE_FALSE(Config().cubic_hystart);
+    Config cfg;
+    Cubic disabled(&cfg);
+    disabled.onInit(&rtt);
+    REQUIRE(disabled.hystartState() == Cubic::HyStartState::Done);
+
+    uint64_t packetNo = 1;
+    uint64_t now = 1000;
+    now = RunRound(disabled, packetNo, now, 10, 20000);
+    now = RunRound(disabled, packetNo, now, 10, 20000);
+    const uint64_t before = disabled.getCwnd();
+    RunRound(disabled, packetNo, now, 10, 40000);
+    REQUIRE(disabled.getCwnd() - before == 10 * 1200);
+    REQUIRE(disabled.slowStartStats().cssEntries == 0);
+
+    Cubic cubic;
+    cubic.onInit(&rtt);
+    const uint64_t cwnd = cubic.getCwnd();
+    PacketInfo lost = MakePacket(1, 1000, 1200);
+    cubic.onLost(&lost);
+    REQUIRE(cubic.hystartState() == Cubic::HyStartState::Done);
+    REQUIRE(cubic.slowStartStats().exitCwnd == cwnd);
+}
@@ -13,11 +13,14 @@
 #include <utils/serialize.hpp>
 
 #include "proto/frame/ack.h"
+#include "util/receive_history.h"
 
 using eular::Serialize;
 using eular::utp::AckInfo;
+using eular::utp::EcnCounts;
 using eular::utp::FrameAck;
 using eular::utp::FrameType;
+using eular::utp::ReceiveHistory;
 using eular::utp::Status;
 using eular::utp::TransportParams;
 
@@ -73,3 +76,56 @@ TEST_CASE("Ack frame decode sets largest ack and ranges", "[FrameAck]")
 
     REQUIRE(ackInfo.ack_delay == (static_cast<utp_time_t>(5) << params.ack_delay_exponent));
 }
+
+TEST_CASE("Ack frame carries ECN counts only when any count is non-zero", "[FrameAck][ECN]")
+{
+    ReceiveHistory history;
+    history.insert(10, 1000);
+    history.insert(11, 1000);
+    history.insert(14, 1000);
+
+    TransportParams params;
+    params.ack_delay_exponent = 3;
+
+    EcnCounts counts;
+    FrameAck encoder;
+    encoder._history = &history;
+    encoder._ecn = &counts;
+    encoder._params = &params;
+    encoder._now = 2000;
+
+    // 全 0 计数时仍编码为普通 ACK 帧
+    std::array<uint8_t, 128> bytes{};
+    Status st;
+    const int32_t plainLen = encoder.encode(bytes.data(), bytes.size(), st);
+    REQUIRE(st.ok());
+    REQUIRE(plainLen == FRAME_ACK_HDR_SIZE + FRAME_ACK_RANGE_SIZE);
+    REQUIRE(bytes[0] == static_cast<uint8_t>(FrameType::kFrameAck));
+
+    counts.ect0 = 2;
+    counts.ce = 1;
+    const int32_t ecnLen = encoder.encode(bytes.data(), bytes.size(), st);
+    REQUIRE(st.ok());
+    REQUIRE(ecnLen == plainLen + FRAME_ACK_ECN_SIZE);
+    REQUIRE(ecnLen == encoder.frameSize());
+    REQUIRE(bytes[0] == static_cast<uint8_t>(FrameType::kFrameAckEcn));
+
+    AckInfo ackInfo;
+    ackInfo.reset();
+    FrameAck decoder;
+    decoder._ackInfo = &ackInfo;
+    decoder._params = &params;
+    REQUIRE(decoder.decode(bytes.data(), static_cast<size_t>(ecnLen), st) == ecnLen);
+    REQUIRE(st.ok());
+    REQUIRE(ackInfo.largest_ack_packno == 14);
+    REQUIRE(ackInfo.range_size == 2);
+    REQUIRE(ackInfo.has_ecn);
+    REQUIRE(ackInfo.ecn.ect0 == 2);
+    REQUIRE(ackInfo.ecn.ect1 == 0);
+    REQUIRE(ackInfo.ecn.ce == 1);
+
+    // 截断的 ECN 计数
+    ackInfo.reset();
+    REQUIRE(decoder.decode(bytes.data(), static_cast<size_t>(ecnLen - 1), st) < 0);
+    REQUIRE_FALSE(st.ok());
+}
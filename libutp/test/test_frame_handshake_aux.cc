@@ -12,9 +12,11 @@
 
 #include "proto/frame/handshake_done.h"
 #include "proto/frame/handshake_delay.h"
+#include "proto/frame/retry_token.h"
 
 using eular::utp::FrameHandshakeDelay;
 using eular::utp::FrameHandshakeDone;
+using eular::utp::FrameRetryToken;
 using eular::utp::Status;
 
 TEST_CASE("HandshakeDone frame encode/decode", "[FrameHandshakeDone]")
@@ -48,3 +50,25 @@ TEST_CASE("HandshakeDelay frame encode/decode", "[FrameHandshakeDelay]")
     REQUIRE(st.ok());
     REQUIRE(decoded.delay_time_us == frame.delay_time_us);
 }
+
+TEST_CASE("RetryToken frame encode/decode", "[FrameRetryToken]")
+{
+    FrameRetryToken frame;
+    frame.token.assign(64, 0x5A);
+    frame.token[0] = 0x01;
+
+    std::array<uint8_t, FRAME_RETRY_TOKEN_HDR_SIZE + 64> bytes{};
+    Status st;
+    REQUIRE(frame.encode(bytes.data(), bytes.size(), st) == frame.frameSize());
+    REQUIRE(st.ok());
+
+    FrameRetryToken decoded;
+    REQUIRE(decoded.decode(bytes.data(), bytes.size(), st) == frame.frameSize());
+    REQUIRE(st.ok());
+    REQUIRE(decoded.token == frame.token);
+
+    // 截断与空令牌均视为格式错误
+    REQUIRE(decoded.decode(bytes.data(), bytes.size() - 1, st) < 0);
+    FrameRetryToken empty;
+    REQUIRE(empty.encode(bytes.data(), bytes.size(), st) < 0);
+}
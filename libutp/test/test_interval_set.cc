@@ -0,0 +1,115 @@
+/*************************************************************************
+    > File Name: test_interval_set.cc
+    > Author: eular
+    > Brief: 有序数组区间集合
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include <catch2/catch.hpp>
+
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "util/interval_set.h"
+
+using eular::utp::IntervalSet;
+
+namespace {
+
+template <size_t N>
+std::vector<std::pair<uint64_t, uint64_t>> Dump(const IntervalSet<N> &set)
+{
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    for (const auto &range : set) {
+        ranges.emplace_back(range.start, range.end);
+    }
+    return ranges;
+}
+
+// 与 std::map 实现的合并语义逐一对照
+void MapInsert(std::map<uint64_t, uint64_t> &ranges, uint64_t start, uint64_t end)
+{
+    auto it = ranges.lower_bound(start);
+    if (it != ranges.begin()) {
+        auto prev = std::prev(it);
+        if (prev->second >= start) {
+            start = prev->first;
+            end = std::max(end, prev->second);
+            it = ranges.erase(prev);
+        }
+    }
+    while (it != ranges.end() && it->first <= end) {
+        end = std::max(end, it->second);
+        it = ranges.erase(it);
+    }
+    ranges[start] = end;
+}
+
+} // namespace
+
+TEST_CASE("IntervalSet: merges overlapping and adjacent ranges", "[IntervalSet]")
+{
+    IntervalSet<2> set;
+    REQUIRE(set.empty());
+    REQUIRE(set.insert(10, 20));
+    REQUIRE(set.insert(30, 40));
+    REQUIRE(set.insert(50, 60));
+    REQUIRE_FALSE(set.inlined());
+    REQUIRE(Dump(set) == std::vector<std::pair<uint64_t, uint64_t>>({{10, 20}, {30, 40}, {50, 60}}));
+
+    // 空区间忽略, 相邻区间合并
+    REQUIRE(set.insert(5, 5));
+    REQUIRE(set.insert(20, 30));
+    REQUIRE(Dump(set) == std::vector<std::pair<uint64_t, uint64_t>>({{10, 40}, {50, 60}}));
+
+    REQUIRE(set.insert(0, 100));
+    REQUIRE(set.size() == 1);
+    REQUIRE(set.front().start == 0);
+    REQUIRE(set.front().end == 100);
+
+    set.clear();
+    REQUIRE(set.empty());
+    REQUIRE(set.capacity() >= 3);
+}
+
+TEST_CASE("IntervalSet: eraseBelow drops fully covered ranges only", "[IntervalSet]")
+{
+    IntervalSet<4> set;
+    REQUIRE(set.insert(0, 10));
+    REQUIRE(set.insert(20, 30));
+    REQUIRE(set.insert(40, 50));
+
+    set.eraseBelow(5);
+    REQUIRE(set.size() == 3);
+    set.eraseBelow(30);
+    REQUIRE(Dump(set) == std::vector<std::pair<uint64_t, uint64_t>>({{40, 50}}));
+    set.eraseBelow(100);
+    REQUIRE(set.empty());
+    REQUIRE(set.inlined());
+}
+
+TEST_CASE("IntervalSet: random inserts match std::map merging", "[IntervalSet]")
+{
+    std::mt19937_64 rng(7);
+    IntervalSet<4> set;
+    std::map<uint64_t, uint64_t> expected;
+    for (int32_t i = 0; i < 5000; ++i) {
+        const uint64_t start = rng() % 4096;
+        const uint64_t end = start + 1 + rng() % 24;
+        REQUIRE(set.insert(start, end));
+        MapInsert(expected, start, end);
+
+        if (i % 97 == 0) {
+            const uint64_t floor = rng() % 4096;
+            set.eraseBelow(floor);
+            while (!expected.empty() && expected.begin()->second <= floor) {
+                expected.erase(expected.begin());
+            }
+        }
+
+        REQUIRE(set.size() == expected.size());
+    }
+    REQUIRE(Dump(set) == std::vector<std::pair<uint64_t, uint64_t>>(expected.begin(), expected.end()));
+}
@@ -10,7 +10,9 @@
 
 #include <array>
 #include <cstring>
+#include <memory>
 
+#include "mtu/mtu.h"
 #include "proto/frame/version.h"
 #include "proto/packet_in.h"
 #include "proto/packet_out.h"
@@ -70,6 +72,45 @@ TEST_CASE("MemoryManager: PacketIn allocates decode buffer", "[MemoryManager][Pa
     mm.putPacketIn(reused);
 }
 
+TEST_CASE("MemoryManager: jumbo datagrams use the jumbo bucket", "[MemoryManager][PacketIn][PacketOut]")
+{
+    MemoryManager mm;
+
+    // 9000 字节巨帧落在 UTP_JUMBO_MTU 档, 不再直接分配 64K
+    PacketIn *ethernet = mm.getPacketIn(UTP_ETHERNET_MTU + 1);
+    PacketIn *jumbo = mm.getPacketIn(UTP_JUMBO_MTU);
+    PacketIn *huge = mm.getPacketIn(UTP_JUMBO_MTU + 1);
+    REQUIRE(ethernet != nullptr);
+    REQUIRE(jumbo != nullptr);
+    REQUIRE(huge != nullptr);
+    REQUIRE(ethernet->alloc_size == UTP_JUMBO_MTU);
+    REQUIRE(jumbo->alloc_size == UTP_JUMBO_MTU);
+    REQUIRE(huge->alloc_size == 0xffff);
+    mm.putPacketIn(ethernet);
+    mm.putPacketIn(jumbo);
+    mm.putPacketIn(huge);
+
+    const uint32_t jumboPayload = UTP_JUMBO_MTU - IPV4_HEADER_SIZE - UDP_HEADER_SIZE - UTP_HEADER_SIZE;
+    PacketOut *mid = mm.getPacketOut(4097);
+    PacketOut *out = mm.getPacketOut(jumboPayload);
+    PacketOut *big = mm.getPacketOut(jumboPayload + 1);
+    REQUIRE(mid != nullptr);
+    REQUIRE(out != nullptr);
+    REQUIRE(big != nullptr);
+    REQUIRE(mid->alloc_size == jumboPayload);
+    REQUIRE(out->alloc_size == jumboPayload);
+    REQUIRE(big->alloc_size == 0xffff);
+    mm.putPacketOut(mid);
+    mm.putPacketOut(out);
+    mm.putPacketOut(big);
+
+    // 回收后同档复用, 缓存字节数按档位大小统计
+    REQUIRE(mm.bytesCached() == 2ull * UTP_JUMBO_MTU + 0xffff + 2ull * jumboPayload + 0xffff);
+    PacketIn *reused = mm.getPacketIn(UTP_JUMBO_MTU);
+    REQUIRE(reused->alloc_size == UTP_JUMBO_MTU);
+    mm.putPacketIn(reused);
+}
+
 TEST_CASE("MemoryManager: putPacketIn duplicate release is idempotent", "[MemoryManager][PacketIn]")
 {
     MemoryManager mm;
@@ -103,3 +144,151 @@ TEST_CASE("MemoryManager: putPacketOut duplicate release is idempotent", "[Memor
     REQUIRE(reused->raw_data != nullptr);
     mm.putPacketOut(reused);
 }
+
+TEST_CASE("MemoryManager: zerocopy pinned PacketOut defers release until completion", "[MemoryManager][PacketOut][ZeroCopy]")
+{
+    MemoryManager mm;
+    PacketOut *packet = mm.getPacketOut(256);
+    REQUIRE(packet != nullptr);
+    uint8_t *raw = packet->raw_data;
+
+    packet->zc_pending = 2;
+    mm.putPacketOut(packet);
+    REQUIRE(packet->raw_data == raw);
+    REQUIRE(mm.zc_deferred_count == 1);
+
+    // 重复回收不应重复入队
+    mm.putPacketOut(packet);
+    REQUIRE(mm.zc_deferred_count == 1);
+
+    mm.releaseZeroCopy(packet);
+    REQUIRE(mm.zc_deferred_count == 1);
+    REQUIRE(packet->raw_data == raw);
+
+    mm.releaseZeroCopy(packet);
+    REQUIRE(mm.zc_deferred_count == 0);
+    REQUIRE(packet->raw_data == nullptr);
+
+    PacketOut *reused = mm.getPacketOut(256);
+    REQUIRE(reused != nullptr);
+    REQUIRE(reused->raw_data == raw);
+    REQUIRE(reused->zc_pending == 0);
+    mm.putPacketOut(reused);
+}
+
+TEST_CASE("MemoryManager: zerocopy completion before release keeps PacketOut usable", "[MemoryManager][PacketOut][ZeroCopy]")
+{
+    MemoryManager mm;
+    PacketOut *packet = mm.getPacketOut(256);
+    REQUIRE(packet != nullptr);
+
+    packet->zc_pending = 1;
+    mm.releaseZeroCopy(packet);
+    REQUIRE_FALSE(packet->zeroCopyPinned());
+    REQUIRE(packet->raw_data != nullptr);
+    REQUIRE(mm.zc_deferred_count == 0);
+
+    mm.putPacketOut(packet);
+    REQUIRE(packet->raw_data == nullptr);
+}
+
+TEST_CASE("MemoryManager: shared pool views recycle buffers across connections", "[MemoryManager][SharedPool]")
+{
+    std::shared_ptr<MemoryManager> shared = std::make_shared<MemoryManager>();
+    MemoryManager lhs;
+    MemoryManager rhs;
+    REQUIRE(lhs.attachSharedPool(shared, 0));
+    REQUIRE(rhs.attachSharedPool(shared, 0));
+    REQUIRE(lhs.sharedPool() == shared.get());
+    REQUIRE_FALSE(lhs.attachSharedPool(shared, 0));
+
+    PacketOut *out = lhs.getPacketOut(256);
+    REQUIRE(out != nullptr);
+    uint8_t *raw = out->raw_data;
+    REQUIRE(lhs.bytes_inuse == out->alloc_size);
+    REQUIRE(shared->bytes_inuse == out->alloc_size);
+    lhs.putPacketOut(out);
+    REQUIRE(lhs.bytes_inuse == 0);
+    REQUIRE(shared->bytes_inuse == 0);
+    REQUIRE(shared->bytesCached() > 0);
+
+    // 另一个连接直接复用前一个连接归还的缓冲
+    PacketOut *reused = rhs.getPacketOut(256);
+    REQUIRE(reused != nullptr);
+    REQUIRE(reused->raw_data == raw);
+    rhs.putPacketOut(reused);
+
+    PacketIn *in = rhs.getPacketIn(128);
+    REQUIRE(in != nullptr);
+    rhs.retainPacketIn(in);
+    rhs.releasePacketIn(in);
+    REQUIRE(rhs.bytes_inuse == in->alloc_size);
+    rhs.releasePacketIn(in);
+    REQUIRE(rhs.bytes_inuse == 0);
+    REQUIRE(shared->bytes_inuse == 0);
+
+    // 已经借出过对象的实例不能再切换
+    MemoryManager standalone;
+    PacketOut *local = standalone.getPacketOut(64);
+    REQUIRE_FALSE(standalone.attachSharedPool(shared, 0));
+    standalone.putPacketOut(local);
+    REQUIRE_FALSE(standalone.attachSharedPool(std::shared_ptr<MemoryManager>(), 0));
+}
+
+TEST_CASE("MemoryManager: shared pool view enforces per-connection quota", "[MemoryManager][SharedPool]")
+{
+    std::shared_ptr<MemoryManager> shared = std::make_shared<MemoryManager>();
+    MemoryManager conn;
+    PacketOut *probe = shared->getPacketOut(256);
+    REQUIRE(probe != nullptr);
+    const uint32_t bucket = probe->alloc_size;
+    shared->putPacketOut(probe);
+
+    REQUIRE(conn.attachSharedPool(shared, bucket * 2));
+    PacketOut *first = conn.getPacketOut(256);
+    PacketOut *second = conn.getPacketOut(256);
+    REQUIRE(first != nullptr);
+    REQUIRE(second != nullptr);
+    REQUIRE(conn.getPacketOut(256) == nullptr);
+    REQUIRE(conn.quota_rejected == 1);
+
+    // 解码用的 PacketIn 不受配额限制, 否则占满配额的在途包等不到释放它们的 ACK
+    PacketIn *in = conn.getPacketIn(128);
+    REQUIRE(in != nullptr);
+    REQUIRE(conn.bytes_inuse == bucket * 2);
+    REQUIRE_FALSE(conn.retainPacketIn(in));
+    REQUIRE(in->refcnt == 1);
+    REQUIRE(conn.quota_rejected == 2);
+    REQUIRE(shared->quota_rejected == 2);
+    conn.releasePacketIn(in);
+    REQUIRE(conn.bytes_inuse == bucket * 2);
+
+    // 零拷贝延迟回收的包在完成通知前仍计入配额
+    second->zc_pending = 1;
+    conn.putPacketOut(second);
+    REQUIRE(conn.zc_deferred_count == 1);
+    REQUIRE(conn.getPacketOut(256) == nullptr);
+    conn.releaseZeroCopy(second);
+    REQUIRE(conn.zc_deferred_count == 0);
+
+    PacketOut *third = conn.getPacketOut(256);
+    REQUIRE(third != nullptr);
+    conn.putPacketOut(first);
+    conn.putPacketOut(third);
+    REQUIRE(conn.bytes_inuse == 0);
+    REQUIRE(conn.bytes_inuse_max == bucket * 2);
+    REQUIRE(shared->bytes_inuse == 0);
+
+    // 被重组保留的 PacketIn 计入配额一次, 最后一个引用释放时归还
+    in = conn.getPacketIn(128);
+    REQUIRE(in != nullptr);
+    REQUIRE(conn.retainPacketIn(in));
+    REQUIRE(conn.retainPacketIn(in));
+    REQUIRE(conn.bytes_inuse == in->alloc_size);
+    conn.releasePacketIn(in);
+    conn.releasePacketIn(in);
+    REQUIRE(conn.bytes_inuse == in->alloc_size);
+    conn.releasePacketIn(in);
+    REQUIRE(conn.bytes_inuse == 0);
+    REQUIRE(shared->bytes_inuse == 0);
+}
@@ -249,3 +249,89 @@ TEST_CASE("MtuDiscovery: integration path switch 1500 to 1280 recovers quickly",
     REQUIRE(mtu.shouldProbe(switchAtMs + 1200));
     REQUIRE(mtu.nextProbeMtu() == 1380);
 }
+
+TEST_CASE("MtuDiscovery: jumbo mtu_max is reached by ladder jump", "[Mtu]")
+{
+    Config cfg;
+    cfg.enable_dplpmtud = true;
+    cfg.mtu_min = 1280;
+    cfg.mtu_max = 9000;
+    cfg.mtu_base = 1400;
+    cfg.mtu_probe_step = 16;
+    cfg.mtu_probe_timeout = 100;
+
+    MtuDiscovery mtu;
+    mtu.init(&cfg, Address::IPv4);
+    REQUIRE(MtuDiscovery::NormalizeMtu(9000, Address::IPv4) == 9000);
+    REQUIRE(MtuDiscovery::NormalizeMtu(20000, Address::IPv4) == UTP_JUMBO_MTU);
+    REQUIRE(mtu.absoluteMaxPacketSize() == 9000 - 20 - 8);
+
+    // 梯队 1450/1492/1500 之后直接跳到 mtu_max
+    const uint16_t expected[] = {1450, 1492, 1500, 9000};
+    utp_packno_t probeNo = 100;
+    utp_time_t nowMs = 0;
+    for (uint16_t target : expected) {
+        REQUIRE(mtu.shouldProbe(nowMs));
+        REQUIRE(mtu.nextProbeMtu() == target);
+        REQUIRE(mtu.onProbeSent(++probeNo, target, nowMs));
+        nowMs += 10;
+        REQUIRE(mtu.onProbeAck(probeNo, nowMs));
+        nowMs += 1;
+    }
+    REQUIRE(mtu.pathMtu() == 9000);
+    REQUIRE(mtu.currentMaxPacketSize() == 9000 - 20 - 8);
+    REQUIRE_FALSE(mtu.shouldProbe(nowMs));
+
+    // 非巨帧路径: 9000 丢失后在 [1500, 9000) 内二分, 探测次数有限
+    MtuDiscovery lossy;
+    lossy.init(&cfg, Address::IPv4);
+    const uint16_t pathMtu = 1500;
+    nowMs = 0;
+    int probes = 0;
+    while (lossy.shouldProbe(nowMs) && probes < 32) {
+        const uint16_t probeMtu = lossy.nextProbeMtu();
+        REQUIRE(lossy.onProbeSent(++probeNo, probeMtu, nowMs));
+        nowMs += 10;
+        if (probeMtu <= pathMtu) {
+            REQUIRE(lossy.onProbeAck(probeNo, nowMs));
+        } else {
+            REQUIRE(lossy.onProbeLost(probeNo, nowMs));
+        }
+        nowMs += 1;
+        ++probes;
+    }
+    REQUIRE(lossy.pathMtu() == pathMtu);
+    REQUIRE(probes <= 16);
+}
+
+TEST_CASE("MtuDiscovery: configured probe ladder is filtered and sorted", "[Mtu]")
+{
+    Config cfg;
+    cfg.enable_dplpmtud = true;
+    cfg.mtu_min = 1280;
+    cfg.mtu_max = 1492;
+    cfg.mtu_base = 1300;
+    cfg.mtu_probe_step = 16;
+    cfg.mtu_probe_ladder = {1500, 1452, 1200, 1400, 1452};
+
+    MtuDiscovery mtu;
+    mtu.init(&cfg, Address::IPv4);
+
+    // 超出 [mtu_min, mtu_max] 的候选被忽略, mtu_max 追加为最后一级
+    REQUIRE(mtu.nextProbeMtu() == 1400);
+    REQUIRE(mtu.onProbeSent(1, 1400, 0));
+    REQUIRE(mtu.onProbeAck(1, 10));
+    REQUIRE(mtu.nextProbeMtu() == 1452);
+    REQUIRE(mtu.onProbeSent(2, 1452, 11));
+    REQUIRE(mtu.onProbeAck(2, 20));
+    REQUIRE(mtu.nextProbeMtu() == 1492);
+    REQUIRE(mtu.onProbeSent(3, 1492, 21));
+    REQUIRE(mtu.onProbeAck(3, 30));
+    REQUIRE(mtu.pathMtu() == 1492);
+
+    // 接收缓冲按 mtu_max 放大, 但不小于以太网 MTU
+    REQUIRE(MtuDiscovery::MaxRecvPayloadSize(&cfg) == 1500 - 20 - 8);
+    cfg.mtu_max = 9000;
+    REQUIRE(MtuDiscovery::MaxRecvPayloadSize(&cfg) == 9000 - 20 - 8);
+    REQUIRE(MtuDiscovery::MaxRecvPayloadSize(nullptr) == 1500 - 20 - 8);
+}
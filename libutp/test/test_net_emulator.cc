@@ -0,0 +1,169 @@
+/*************************************************************************
+    > File Name: test_net_emulator.cc
+    > Author: eular
+    > Brief: 进程内网络仿真与拥塞控制评估
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "net_emulator.h"
+
+using eular::utp::Config;
+using eular::utp::netem::CcSimulator;
+using eular::utp::netem::ContextPair;
+using eular::utp::netem::EvalResult;
+using eular::utp::netem::FormatResult;
+using eular::utp::netem::LinkConfig;
+using eular::utp::netem::MakeCongestion;
+using eular::utp::netem::VirtualLink;
+
+namespace {
+
+// 20 Mbit/s, 40 ms RTT 的瓶颈, 队列为 1 个 BDP (100 KB)
+LinkConfig BottleneckLink()
+{
+    LinkConfig link;
+    link.bandwidthBps = 20 * 1000 * 1000;
+    link.rttMs = 40;
+    link.queueBytes = 100 * 1000;
+    return link;
+}
+
+EvalResult Simulate(int32_t ccAlgorithm, const LinkConfig &link, uint64_t durationMs)
+{
+    Config cfg;
+    cfg.cc_algorithm = ccAlgorithm;
+    CcSimulator sim(link, MakeCongestion, &cfg);
+    const EvalResult result = sim.run(durationMs);
+    UNSCOPED_INFO(FormatResult(std::to_string(ccAlgorithm), result));
+    return result;
+}
+
+} // namespace
+
+TEST_CASE("VirtualLink: bottleneck serializes packets and tail-drops on overflow", "[NetEmulator]")
+{
+    LinkConfig cfg;
+    cfg.bandwidthBps = 9600 * 1000; // 1200 字节恰好 1 ms
+    cfg.rttMs = 20;
+    cfg.queueBytes = 6000;
+    VirtualLink link(cfg);
+
+    std::vector<VirtualLink::Verdict> verdicts;
+    for (int32_t i = 0; i < 8; ++i) {
+        verdicts.push_back(link.submit(0, 1200));
+    }
+
+    // 队列只容得下 5 个包, 其余尾部丢弃
+    for (size_t i = 0; i < verdicts.size(); ++i) {
+        REQUIRE(verdicts[i].dropped == (i >= 5));
+        if (!verdicts[i].dropped) {
+            REQUIRE(verdicts[i].deliverAtUs == (i + 1) * 1000 + 10000);
+        }
+    }
+    REQUIRE(link.stats().queueDrops == 3);
+    REQUIRE(link.stats().queueDelayUs == std::vector<uint64_t>({0, 1000, 2000, 3000, 4000}));
+
+    // 队列排空后重新接收, 无排队时延
+    const VirtualLink::Verdict later = link.submit(10000, 1200);
+    REQUIRE_FALSE(later.dropped);
+    REQUIRE(later.deliverAtUs == 11000 + 10000);
+}
+
+TEST_CASE("VirtualLink: burst loss and reordering follow the configured rates", "[NetEmulator]")
+{
+    LinkConfig cfg;
+    cfg.bandwidthBps = 0;
+    cfg.rttMs = 20;
+    cfg.burstEnter = 0.01;
+    cfg.burstExit = 0.25;
+    cfg.reorderRate = 0.1;
+    cfg.reorderDelayMs = 5;
+    cfg.seed = 7;
+    VirtualLink link(cfg);
+
+    constexpr int32_t kPackets = 100000;
+    int32_t lost = 0;
+    int32_t runs = 0;
+    int32_t reordered = 0;
+    bool lastLost = false;
+    for (int32_t i = 0; i < kPackets; ++i) {
+        const VirtualLink::Verdict verdict = link.submit(static_cast<uint64_t>(i) * 100, 1200);
+        if (verdict.dropped) {
+            ++lost;
+            runs += lastLost ? 0 : 1;
+        } else if (verdict.deliverAtUs > static_cast<uint64_t>(i) * 100 + 10000) {
+            ++reordered;
+        }
+        lastLost = verdict.dropped;
+    }
+
+    // 稳态 Bad 概率 = enter / (enter + exit) ≈ 3.8%, 平均突发长度 = 1 / exit = 4
+    const double lossRate = static_cast<double>(lost) / kPackets;
+    REQUIRE(lossRate > 0.03);
+    REQUIRE(lossRate < 0.05);
+    REQUIRE(static_cast<double>(lost) / runs > 3.0);
+    REQUIRE(link.stats().lossDrops == static_cast<uint64_t>(lost));
+    REQUIRE(static_cast<double>(reordered) / (kPackets - lost) == Approx(0.1).margin(0.01));
+}
+
+TEST_CASE("CcSimulator: BBR and Cubic fill a bottleneck in simulated time", "[NetEmulator]")
+{
+    const LinkConfig link = BottleneckLink();
+    const EvalResult bbr = Simulate(1, link, 10000);
+    const EvalResult cubic = Simulate(2, link, 10000);
+    const EvalResult bbr2 = Simulate(3, link, 10000);
+
+    // Cubic 每个丢失的包都会做一次乘性减小, 利用率低于 BBR, 这里只要求占满大部分带宽
+    for (const EvalResult *result : {&bbr, &cubic, &bbr2}) {
+        REQUIRE(result->goodputMbps() > 12.0);
+        REQUIRE(result->goodputMbps() <= 20.0);
+        REQUIRE(result->retransRatio() < 0.05);
+    }
+
+    // Cubic 以丢包为信号, 会把瓶颈队列填满; BBR 按 BDP 控制在途量, 排队时延明显更低
+    REQUIRE(cubic.queueDelayP95Ms > bbr.queueDelayP95Ms);
+    REQUIRE(cubic.queueDrops > 0);
+}
+
+TEST_CASE("CcSimulator: random loss shows up as retransmissions", "[NetEmulator]")
+{
+    LinkConfig link = BottleneckLink();
+    link.lossRate = 0.02;
+    const EvalResult bbr = Simulate(1, link, 5000);
+
+    REQUIRE(bbr.lossDrops > 0);
+    REQUIRE(bbr.retransRatio() > 0.01);
+    REQUIRE(bbr.retransRatio() < 0.1);
+    // BBR 不以随机丢包为拥塞信号, 仍能保持大部分带宽
+    REQUIRE(bbr.goodputMbps() > 12.0);
+}
+
+TEST_CASE("ContextPair: two contexts transfer over the emulated link", "[NetEmulator][Integration]")
+{
+    LinkConfig forward;
+    forward.bandwidthBps = 10 * 1000 * 1000;
+    forward.rttMs = 20;
+    forward.queueBytes = 50 * 1000;
+    LinkConfig reverse = forward;
+    reverse.bandwidthBps = 0;
+
+    Config cfg;
+    cfg.cc_algorithm = 1;
+    ContextPair pair(forward, reverse, cfg);
+    EvalResult result;
+    REQUIRE(pair.runBulkTransfer(1500, result));
+    INFO(FormatResult("bbr", result));
+
+    // 链路是唯一瓶颈: 吞吐不超过 10 Mbit/s 且数据确实穿过了排队
+    REQUIRE(result.deliveredBytes > 0);
+    REQUIRE(result.goodputMbps() > 2.0);
+    REQUIRE(result.goodputMbps() <= 10.5);
+    REQUIRE(result.txBytes >= result.deliveredBytes);
+    REQUIRE(pair.forwardStats().packets > 0);
+    REQUIRE(result.queueDelayP95Ms > 0.0);
+}
@@ -0,0 +1,136 @@
+/*************************************************************************
+    > File Name: test_reassembly_ring.cc
+    > Author: eular
+    > Brief: 接收重组环
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "util/reassembly_ring.h"
+
+using eular::utp::ReassemblyRing;
+using eular::utp::Stream;
+
+namespace {
+
+std::vector<uint8_t> Pattern(uint64_t offset, size_t len)
+{
+    std::vector<uint8_t> data(len);
+    for (size_t i = 0; i < len; ++i) {
+        data[i] = static_cast<uint8_t>((offset + i) * 7u);
+    }
+    return data;
+}
+
+} // namespace
+
+TEST_CASE("ReassemblyRing: out-of-order writes become contiguous once the gap fills", "[ReassemblyRing]")
+{
+    ReassemblyRing ring;
+    ring.reset(256, 1000);
+    REQUIRE(ring.allocated());
+    REQUIRE(ring.baseOffset() == 1000);
+
+    size_t added = 0;
+    const auto tail = Pattern(1100, 50);
+    REQUIRE(ring.write(1100, tail.data(), tail.size(), &added));
+    REQUIRE(added == 50);
+    REQUIRE(ring.contiguousBytes() == 0);
+    REQUIRE(ring.bufferedBytes() == 50);
+
+    // 重叠的重复数据只计新增部分
+    const auto overlap = Pattern(1080, 40);
+    REQUIRE(ring.write(1080, overlap.data(), overlap.size(), &added));
+    REQUIRE(added == 20);
+    REQUIRE(ring.contiguousBytes() == 0);
+
+    const auto head = Pattern(1000, 80);
+    REQUIRE(ring.write(1000, head.data(), head.size(), &added));
+    REQUIRE(added == 80);
+    REQUIRE(ring.contiguousBytes() == 150);
+    REQUIRE(ring.bufferedBytes() == 150);
+
+    Stream::ConstBufferView views[2];
+    REQUIRE(ring.readableViews(views, 1024) == 150);
+    REQUIRE(views[0].len == 150);
+    REQUIRE(views[1].len == 0);
+    const auto expected = Pattern(1000, 150);
+    REQUIRE(std::memcmp(views[0].data, expected.data(), expected.size()) == 0);
+
+    // 超出窗口的数据被拒绝
+    const auto beyond = Pattern(1000 + 250, 10);
+    REQUIRE_FALSE(ring.write(1250, beyond.data(), beyond.size(), &added));
+    REQUIRE(added == 0);
+}
+
+TEST_CASE("ReassemblyRing: consume slides the window across the wrap point", "[ReassemblyRing]")
+{
+    ReassemblyRing ring;
+    ring.reset(100, 0);
+
+    const auto first = Pattern(0, 90);
+    REQUIRE(ring.write(0, first.data(), first.size()));
+    ring.consume(70);
+    REQUIRE(ring.baseOffset() == 70);
+    REQUIRE(ring.contiguousBytes() == 20);
+
+    // [160, 170) 先到, [90, 160) 跨越环尾后补齐
+    const auto late = Pattern(160, 10);
+    REQUIRE(ring.write(160, late.data(), late.size()));
+    REQUIRE(ring.contiguousBytes() == 20);
+    const auto gap = Pattern(90, 70);
+    REQUIRE(ring.write(90, gap.data(), gap.size()));
+    REQUIRE(ring.contiguousBytes() == 100);
+
+    Stream::ConstBufferView views[2];
+    REQUIRE(ring.readableViews(views, 100) == 100);
+    REQUIRE(views[0].len == 30);
+    REQUIRE(views[1].len == 70);
+
+    std::vector<uint8_t> out(100);
+    REQUIRE(ring.read(out.data(), out.size()) == 100);
+    REQUIRE(out == Pattern(70, 100));
+    REQUIRE(ring.bufferedBytes() == 0);
+    REQUIRE(ring.baseOffset() == 170);
+}
+
+TEST_CASE("ReassemblyRing: shuffled segments reassemble in order", "[ReassemblyRing]")
+{
+    constexpr size_t kCapacity = 64 * 1024;
+    constexpr size_t kSegment = 1200;
+    constexpr size_t kSegments = 200;
+
+    ReassemblyRing ring;
+    ring.reset(kCapacity, 0);
+
+    // 按 40 段一组乱序到达, 一组的跨度小于容量; 每组读空后窗口前移
+    constexpr size_t kGroup = 40;
+    std::mt19937 rng(7);
+    std::vector<uint8_t> received;
+    for (size_t group = 0; group < kSegments; group += kGroup) {
+        std::vector<size_t> order(kGroup);
+        std::iota(order.begin(), order.end(), group);
+        std::shuffle(order.begin(), order.end(), rng);
+
+        for (size_t seg : order) {
+            const auto data = Pattern(seg * kSegment, kSegment);
+            REQUIRE(ring.write(seg * kSegment, data.data(), data.size()));
+            REQUIRE(ring.baseOffset() + ring.contiguousBytes() <= (group + kGroup) * kSegment);
+        }
+
+        REQUIRE(ring.contiguousBytes() == kGroup * kSegment);
+        std::vector<uint8_t> out(ring.contiguousBytes());
+        REQUIRE(ring.read(out.data(), out.size()) == out.size());
+        received.insert(received.end(), out.begin(), out.end());
+    }
+
+    REQUIRE(received == Pattern(0, kSegments * kSegment));
+}
@@ -0,0 +1,86 @@
+/*************************************************************************
+    > File Name: test_replay_filter.cc
+    > Author: eular
+    > Brief: 0-RTT 抗重放过滤器
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+
+#include "util/replay_filter.h"
+
+using eular::utp::ReplayFilter;
+
+TEST_CASE("ReplayFilter: duplicates are rejected and distinct keys accepted", "[ReplayFilter]")
+{
+    ReplayFilter filter;
+    REQUIRE_FALSE(filter.allocated());
+    REQUIRE(filter.falsePositiveRate() == 0.0);
+
+    filter.reset(1000, 1024, 0x1234);
+    REQUIRE(filter.allocated());
+
+    REQUIRE(filter.checkAndInsert(7, 100, 10));
+    REQUIRE_FALSE(filter.checkAndInsert(7, 100, 11));
+    // 同一 nonce 不同票据互不影响
+    REQUIRE(filter.checkAndInsert(8, 100, 12));
+    REQUIRE(filter.checkAndInsert(7, 101, 13));
+    REQUIRE(filter.falsePositiveRate() > 0.0);
+}
+
+TEST_CASE("ReplayFilter: entries live for one to two windows", "[ReplayFilter]")
+{
+    ReplayFilter filter;
+    filter.reset(1000, 1024, 42);
+
+    REQUIRE(filter.checkAndInsert(1, 1, 0));
+    REQUIRE(filter.checkAndInsert(1, 2, 900));
+
+    // 第一次轮换: 两条记录移入上一窗口, 仍可拦截
+    REQUIRE(filter.checkAndInsert(1, 3, 1000));
+    REQUIRE_FALSE(filter.checkAndInsert(1, 1, 1500));
+    REQUIRE_FALSE(filter.checkAndInsert(1, 2, 1999));
+
+    // 第二次轮换: 最早窗口被清除, [1000, 2000) 插入的记录仍在
+    REQUIRE(filter.checkAndInsert(1, 1, 2000));
+    REQUIRE_FALSE(filter.checkAndInsert(1, 3, 2001));
+
+    // 时钟回拨不触发轮换
+    REQUIRE_FALSE(filter.checkAndInsert(1, 3, 100));
+
+    // 长时间空闲后两个窗口同时过期
+    REQUIRE(filter.checkAndInsert(1, 3, 10000));
+    REQUIRE(filter.checkAndInsert(1, 1, 10001));
+}
+
+TEST_CASE("ReplayFilter: false positive rate stays low at the configured load", "[ReplayFilter]")
+{
+    constexpr size_t kEntries = 20000;
+    // 未命中的探测也会写入, 探测数保持在容量的 10% 以内
+    constexpr size_t kProbes = 2000;
+
+    ReplayFilter filter;
+    filter.reset(1000, kEntries, 0x9e3779b97f4a7c15ULL);
+
+    // 连续的 nonce 与少量票据, 与实际 0-RTT 包号分布相近; 填充过程中本身也可能出现少量假阳性
+    size_t fillRejected = 0;
+    for (size_t i = 0; i < kEntries; ++i) {
+        if (!filter.checkAndInsert(static_cast<uint32_t>(1 + i % 16), i / 16, 0)) {
+            ++fillRejected;
+        }
+    }
+    REQUIRE(fillRejected < kEntries / 100);
+
+    size_t falsePositives = 0;
+    for (size_t i = 0; i < kProbes; ++i) {
+        if (!filter.checkAndInsert(static_cast<uint32_t>(100 + i % 16), i, 1)) {
+            ++falsePositives;
+        }
+    }
+
+    const double measured = static_cast<double>(falsePositives) / kProbes;
+    REQUIRE(measured < 0.01);
+    REQUIRE(filter.falsePositiveRate() < 0.01);
+}
@@ -436,3 +436,65 @@ TEST_CASE("Retrans repack: mixed frames keep mandatory control frame and drop tr
                                              beforePackNo,
                                              (1u << static_cast<uint32_t>(FrameType::kFrameStream))) >= 1);
 }
+
+TEST_CASE("Retrans repack: zerocopy-pinned lost packet does not block the packets behind it", "[Retrans][Repack][ZeroCopy]")
+{
+    Config cfg;
+    cfg.handshake_timeout = 200;
+
+    ev::EventLoop loop;
+    ContextImpl server(loop.loop(), &cfg);
+    ContextImpl client(loop.loop(), &cfg);
+
+    REQUIRE(server.bind("127.0.0.1", 0, "")  == 0);
+    REQUIRE(client.bind("127.0.0.1", 0, "")  == 0);
+
+    ConnectionImpl::SP clientConn;
+    ConnectionImpl::SP serverConn;
+    REQUIRE(ConnectPair(loop, server, client, clientConn, serverConn));
+
+    clientConn->m_handshakeDonePending = false;
+    clientConn->m_handshakeDoneSent = false;
+
+    const std::string pinnedData = "zerocopy-pinned";
+    const std::string freeData = "zerocopy-free";
+    std::vector<uint8_t> pinnedBytes = BuildStreamPayload(111, 0, pinnedData);
+    std::vector<uint8_t> freeBytes = BuildStreamPayload(113, 0, freeData);
+
+    std::vector<eular::utp::FrameMetaInfo> metas(1);
+    metas[0].offset = UTP_HEADER_SIZE;
+    metas[0].frame_type = FrameType::kFrameStream;
+    metas[0].frame_flags = static_cast<uint8_t>(eular::utp::kFMRetransMustKeep | eular::utp::kFMSplittable);
+    metas[0].fmi_u.data = 0;
+
+    metas[0].length = static_cast<uint16_t>(pinnedBytes.size());
+    PacketOut *pinnedPkt = BuildLostPacket(clientConn,
+                                           pinnedBytes,
+                                           metas,
+                                           (1u << static_cast<uint32_t>(FrameType::kFrameStream)),
+                                           pinnedData.size(),
+                                           0);
+    metas[0].length = static_cast<uint16_t>(freeBytes.size());
+    PacketOut *freePkt = BuildLostPacket(clientConn,
+                                         freeBytes,
+                                         metas,
+                                         (1u << static_cast<uint32_t>(FrameType::kFrameStream)),
+                                         freeData.size(),
+                                         0);
+
+    // 队首包的上一次零拷贝发送尚未完成
+    pinnedPkt->zc_pending = 1;
+
+    bool sentAny = false;
+    REQUIRE(clientConn->m_sendCtl->retransmitLostBatch(eular::utp::time::MonotonicUs(), 8, sentAny) == 1);
+    REQUIRE(sentAny);
+    REQUIRE(TAILQ_FIRST(&clientConn->m_sendCtl->m_lostPackets) == pinnedPkt);
+    REQUIRE(TAILQ_NEXT(pinnedPkt, po_next) == nullptr);
+    REQUIRE((freePkt->po_flags & eular::utp::PacketOutFlags::kPoLost) == 0);
+
+    // 完成通知到达后, 下一次重传即可发出
+    pinnedPkt->zc_pending = 0;
+    sentAny = false;
+    REQUIRE(clientConn->m_sendCtl->retransmitLostBatch(eular::utp::time::MonotonicUs(), 8, sentAny) == 1);
+    REQUIRE(TAILQ_EMPTY(&clientConn->m_sendCtl->m_lostPackets));
+}
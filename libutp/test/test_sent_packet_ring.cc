@@ -0,0 +1,116 @@
+/*************************************************************************
+    > File Name: test_sent_packet_ring.cc
+    > Author: eular
+    > Brief: 按包号索引的已发送包环形表
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+#include "proto/packet_out.h"
+#include "util/sent_packet_ring.h"
+
+using eular::utp::PacketOut;
+using eular::utp::SentPacketRing;
+
+namespace {
+
+std::vector<PacketOut> MakePackets(utp_packno_t first, size_t count)
+{
+    std::vector<PacketOut> packets(count);
+    for (size_t i = 0; i < count; ++i) {
+        packets[i].packno = first + i;
+    }
+    return packets;
+}
+
+} // namespace
+
+TEST_CASE("SentPacketRing: find and erase shrink the window", "[SentPacketRing]")
+{
+    std::vector<PacketOut> packets = MakePackets(100, 8);
+    SentPacketRing ring;
+    REQUIRE(ring.empty());
+    REQUIRE(ring.find(100) == nullptr);
+
+    for (PacketOut &pkt : packets) {
+        REQUIRE(ring.insert(&pkt));
+    }
+    REQUIRE(ring.size() == 8);
+    REQUIRE(ring.lowest() == 100);
+    REQUIRE(ring.highest() == 107);
+    REQUIRE(ring.find(99) == nullptr);
+    REQUIRE(ring.find(104) == &packets[4]);
+    REQUIRE(ring.find(108) == nullptr);
+
+    // 重复包号与不在表内的包
+    PacketOut dup;
+    dup.packno = 103;
+    REQUIRE_FALSE(ring.insert(&dup));
+    REQUIRE_FALSE(ring.erase(&dup));
+    REQUIRE(ring.find(103) == &packets[3]);
+
+    // 中间空洞不移动窗口, 删除边界时跳过空洞
+    REQUIRE(ring.erase(&packets[1]));
+    REQUIRE(ring.erase(&packets[2]));
+    REQUIRE(ring.lowest() == 100);
+    REQUIRE(ring.erase(&packets[0]));
+    REQUIRE(ring.lowest() == 103);
+    REQUIRE(ring.erase(&packets[7]));
+    REQUIRE(ring.erase(&packets[6]));
+    REQUIRE(ring.highest() == 105);
+    REQUIRE(ring.size() == 3);
+
+    for (size_t i = 3; i < 6; ++i) {
+        REQUIRE(ring.erase(&packets[i]));
+    }
+    REQUIRE(ring.empty());
+    REQUIRE(ring.find(104) == nullptr);
+}
+
+TEST_CASE("SentPacketRing: grows across wrap and accepts lower packet numbers", "[SentPacketRing]")
+{
+    const size_t count = SentPacketRing::kInitialCapacity * 3 + 5;
+    std::vector<PacketOut> packets = MakePackets(1000, count);
+    SentPacketRing ring;
+
+    // 先插入后半段, 再倒序补入前半段, 窗口下界需要向下扩展
+    for (size_t i = count / 2; i < count; ++i) {
+        REQUIRE(ring.insert(&packets[i]));
+    }
+    for (size_t i = count / 2; i-- > 0;) {
+        REQUIRE(ring.insert(&packets[i]));
+    }
+    REQUIRE(ring.size() == count);
+    REQUIRE(ring.capacity() >= count);
+    REQUIRE(ring.lowest() == 1000);
+    REQUIRE(ring.highest() == 1000 + count - 1);
+    for (size_t i = 0; i < count; ++i) {
+        REQUIRE(ring.find(packets[i].packno) == &packets[i]);
+    }
+
+    // 保留最后一个在途包, 其余确认后继续发送, 槽位回绕复用而不再扩容
+    for (size_t i = 0; i + 1 < count; ++i) {
+        REQUIRE(ring.erase(&packets[i]));
+    }
+    const size_t capacity = ring.capacity();
+    std::vector<PacketOut> more = MakePackets(1000 + count, capacity - 1);
+    for (PacketOut &pkt : more) {
+        REQUIRE(ring.insert(&pkt));
+    }
+    REQUIRE(ring.capacity() == capacity);
+    REQUIRE(ring.find(packets.back().packno) == &packets.back());
+    REQUIRE(ring.find(more.back().packno) == &more.back());
+
+    // 超出最大跨度时拒绝插入
+    PacketOut far;
+    far.packno = packets.back().packno + SentPacketRing::kMaxCapacity;
+    REQUIRE_FALSE(ring.insert(&far));
+    REQUIRE(ring.find(far.packno) == nullptr);
+
+    ring.clear();
+    REQUIRE(ring.empty());
+    REQUIRE(ring.find(more.back().packno) == nullptr);
+}
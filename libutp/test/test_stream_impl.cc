@@ -9,22 +9,57 @@
 #include "util/status.h"
 
 #include <array>
+#include <cstdio>
 #include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include "utp/errno.h"
+#include "utp/platform.h"
 
 #include <event/loop.h>
 #define private public
 #include "context/context_impl.h"
 #include "context/connection_impl.h"
 #include "context/stream_impl.h"
+#include "context/send_ctl.h"
 #undef private
+#include "proto/packet_out.h"
 
 using eular::utp::FrameStream;
 using eular::utp::Status;
 using eular::utp::StreamImpl;
 using eular::utp::Status;
 
+namespace {
+
+// 创建内容为 i & 0xFF 的临时文件, fclose 时自动删除
+std::FILE *CreatePatternFile(size_t size)
+{
+    std::FILE *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+
+    std::vector<uint8_t> content(size);
+    for (size_t i = 0; i < size; ++i) {
+        content[i] = static_cast<uint8_t>(i & 0xFFu);
+    }
+    REQUIRE(std::fwrite(content.data(), 1, content.size(), file) == content.size());
+    REQUIRE(std::fflush(file) == 0);
+    return file;
+}
+
+int PatternFileFd(std::FILE *file)
+{
+#if defined(OS_WINDOWS)
+    return ::_fileno(file);
+#else
+    return ::fileno(file);
+#endif
+}
+
+} // namespace
+
 struct StreamTestCtx {
     eular::utp::Config      cfg;
     ev::EventLoop           loop;
@@ -89,6 +124,66 @@ TEST_CASE("StreamImpl: out-of-order frame is rejected for now", "[Stream]")
     REQUIRE(out[1] == 8);
 }
 
+TEST_CASE("StreamImpl: ring receive mode reassembles out-of-order frames in place", "[Stream][RecvRing]")
+{
+    eular::utp::Config cfg;
+    cfg.stream_recv_mode = eular::utp::kStreamRecvRing;
+    cfg.initial_max_stream_data_bidi_remote = 4096;
+    ev::EventLoop loop;
+    eular::utp::ContextImpl ctx(loop.loop(), &cfg);
+    eular::utp::ConnectionImpl conn(&ctx, nullptr, 9998);
+    StreamImpl stream(&conn, 13);
+    REQUIRE(stream.m_recvRingMode);
+
+    std::vector<uint8_t> payload(3000);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<uint8_t>(i * 13u);
+    }
+    auto frameAt = [&](uint64_t offset, uint16_t len, bool fin) {
+        FrameStream frame;
+        frame.stream_id = 13;
+        frame.stream_offset = offset;
+        frame.stream_data_length = len;
+        frame.stream_data = payload.data() + offset;
+        frame.stream_flag = fin ? 0x01 : 0x00;
+        return frame;
+    };
+
+    // 乱序到达且带 FIN 的尾部, 以及一段重复数据
+    REQUIRE(stream.onFrame(frameAt(2000, 1000, true)) == 0);
+    REQUIRE(stream.onFrame(frameAt(1000, 1000, false)) == 0);
+    REQUIRE(stream.onFrame(frameAt(1500, 500, false)) == 0);
+    REQUIRE_FALSE(stream.readable());
+    REQUIRE(stream.m_recvBufferedBytes == 2000);
+    REQUIRE(stream.m_recvRing.capacity() == 4096);
+    REQUIRE(stream.firstFragment() == nullptr);
+
+    REQUIRE(stream.onFrame(frameAt(0, 1000, false)) == 0);
+    REQUIRE(stream.readable());
+
+    eular::utp::Stream::ConstBufferView views[2];
+    REQUIRE(stream.acquireReadViews(views, 2500) == 2500);
+    REQUIRE(views[0].len == 2500);
+    REQUIRE(std::memcmp(views[0].data, payload.data(), 2500) == 0);
+    REQUIRE(stream.commitReadViews(2500) == 2500);
+    REQUIRE(stream.state() == eular::utp::Stream::kStateOpen);
+
+    std::array<uint8_t, 1024> out{};
+    REQUIRE(stream.read(out.data(), out.size()) == 500);
+    REQUIRE(std::memcmp(out.data(), payload.data() + 2500, 500) == 0);
+    REQUIRE(stream.state() == eular::utp::Stream::kStateHalfClosedRemote);
+    REQUIRE(stream.read(out.data(), out.size()) == 0);
+
+    // 超出接收窗口的数据视为流控违规
+    std::vector<uint8_t> far(16, 0xAA);
+    FrameStream beyond;
+    beyond.stream_id = 13;
+    beyond.stream_offset = 3000 + 4096;
+    beyond.stream_data_length = static_cast<uint16_t>(far.size());
+    beyond.stream_data = far.data();
+    REQUIRE(stream.onFrame(beyond).code() == UTP_ERR_STREAM_DATA_LIMITED);
+}
+
 TEST_CASE("StreamImpl: peer fin returns EOF on empty read", "[Stream]")
 {
     StreamTestCtx _fix_11; StreamImpl stream(&_fix_11.conn, 11);
@@ -223,3 +318,222 @@ TEST_CASE("StreamImpl: queued local fin is not fully closed before send", "[Stre
     stream.m_localFinSent = true;
     REQUIRE(stream.state() == eular::utp::Stream::kStateClosed);
 }
+
+TEST_CASE("StreamImpl: sendFile frames stream data from mapped file pages", "[Stream][SendFile]")
+{
+    eular::utp::Config cfg;
+    ev::EventLoop loop;
+    eular::utp::ContextImpl ctx(loop.loop(), &cfg);
+    eular::utp::UdpSocket sock(cfg);
+
+    eular::utp::UdpSocket peer(cfg);
+
+    REQUIRE(sock.bind("127.0.0.1", 0, "")  == 0);
+    REQUIRE(peer.bind("127.0.0.1", 0, "")  == 0);
+
+    eular::utp::ConnectionImpl conn(&ctx, &sock, 1023);
+    conn.m_state = eular::utp::ConnectionImpl::kStateConnected;
+    conn.m_peerAddress = peer.m_localAddr;
+    conn.m_networkPath.m_state = decltype(conn.m_networkPath)::kPathValidated;
+    conn.m_bytesIn = 4096;
+
+    std::FILE *file = CreatePatternFile(16 * 1024);
+    const int fd = PatternFileFd(file);
+
+    StreamImpl stream(&conn, 4);
+
+    // 环形缓冲区数据与映射数据按流偏移交错: [0, 100) 拷贝, [100, 3100) 文件偏移 5000 起, [3100, 3200) 拷贝
+    std::vector<uint8_t> expected;
+    std::array<uint8_t, 100> head{};
+    head.fill(0xA5);
+    REQUIRE(stream.write(head.data(), head.size(), false) == 100);
+    expected.insert(expected.end(), head.begin(), head.end());
+
+    REQUIRE(stream.sendFile(fd, 5000, 3000, false) == 3000);
+    for (size_t i = 0; i < 3000; ++i) {
+        expected.push_back(static_cast<uint8_t>((5000 + i) & 0xFFu));
+    }
+
+    std::array<uint8_t, 100> tail{};
+    tail.fill(0x5A);
+    REQUIRE(stream.write(tail.data(), tail.size(), true) == 100);
+    expected.insert(expected.end(), tail.begin(), tail.end());
+
+    // 映射数据不占用写缓冲区额度, 也不拷贝进环形缓冲区
+    REQUIRE(stream.m_sendBuffer.size() == 200);
+    REQUIRE(stream.m_sendExtentBytes == 3000);
+    REQUIRE(stream.appWriteCredit() == cfg.stream_send_buffer_limit - 200);
+
+    REQUIRE(stream.flushPendingSends() == 0);
+    REQUIRE(stream.m_nextSendOffset == expected.size());
+    REQUIRE(stream.m_localFinSent);
+
+    std::vector<uint8_t> wire(expected.size(), 0);
+    size_t wireBytes = 0;
+    eular::utp::PacketOut *pkt = nullptr;
+    TAILQ_FOREACH(pkt, &conn.m_sendCtl->m_unackedPackets, po_next) {
+        if (pkt->stream_id != 4 || pkt->stream_data_size == 0) {
+            continue;
+        }
+        for (uint8_t i = 0; i < pkt->frame_meta_count; ++i) {
+            if (pkt->frame_meta[i].frame_type != eular::utp::kFrameStream) {
+                continue;
+            }
+            const uint8_t *data = pkt->raw_data + pkt->frame_meta[i].offset + FRAME_STREAM_HDR_SIZE;
+            REQUIRE(pkt->stream_offset + pkt->stream_data_size <= wire.size());
+            std::memcpy(wire.data() + pkt->stream_offset, data, pkt->stream_data_size);
+            wireBytes += pkt->stream_data_size;
+        }
+    }
+    REQUIRE(wireBytes == expected.size());
+    REQUIRE(wire == expected);
+
+    // 确认推进时裁剪映射区间, 全部确认后解除映射
+    stream.onPacketAcked(0, 1500);
+    REQUIRE(stream.m_sendAckedOffset == 1500);
+    REQUIRE(stream.m_sendExtentBytes == 1600);
+    REQUIRE(stream.m_sendBuffer.size() == 100);
+    REQUIRE(stream.m_sendExtents.front().offset == 1500);
+
+    stream.onPacketAcked(1500, expected.size() - 1500);
+    REQUIRE(stream.m_sendAckedOffset == expected.size());
+    REQUIRE(stream.m_sendExtents.empty());
+    REQUIRE(stream.m_sendExtentBytes == 0);
+    REQUIRE(stream.m_sendBuffer.empty());
+    REQUIRE(stream.m_sendInFlightBytes == 0);
+
+    std::fclose(file);
+}
+
+TEST_CASE("StreamImpl: sendFile is limited by stream_send_file_window", "[Stream][SendFile]")
+{
+    eular::utp::Config cfg;
+    cfg.stream_send_file_window = 4096;
+    ev::EventLoop loop;
+    eular::utp::ContextImpl ctx(loop.loop(), &cfg);
+
+    eular::utp::ConnectionImpl conn(&ctx, nullptr, 1024);
+    StreamImpl stream(&conn, 4);
+
+    std::FILE *file = CreatePatternFile(16 * 1024);
+    const int fd = PatternFileFd(file);
+
+    // 超出文件范围与无效 fd 直接拒绝, 不建立映射
+    REQUIRE(stream.sendFile(fd, 16 * 1024 - 10, 100, false) == -1);
+    REQUIRE(utp_get_last_error() == UTP_ERR_INVALID_PARAM);
+    REQUIRE(stream.sendFile(-1, 0, 100, false) == -1);
+    REQUIRE(stream.m_sendExtents.empty());
+
+    // 部分接受时不携带 FIN
+    REQUIRE(stream.sendFile(fd, 0, 8000, true) == 4096);
+    REQUIRE_FALSE(stream.m_localFinQueued);
+    REQUIRE(stream.sendBufferedEndOffset() == 4096);
+    REQUIRE(stream.sendFile(fd, 4096, 1000, false) == -1);
+    REQUIRE(utp_get_last_error() == UTP_ERR_WOULD_BLOCK);
+    REQUIRE(stream.writable());
+
+    // 已映射数据被确认后窗口恢复
+    stream.m_nextSendOffset = 4096;
+    stream.m_sendQueuedBytes = 0;
+    stream.m_sendInFlightBytes = 4096;
+    stream.onPacketAcked(0, 4096);
+    REQUIRE(stream.m_sendExtentBytes == 0);
+    REQUIRE(stream.sendFile(fd, 4096, 1000, true) == 1000);
+    REQUIRE(stream.m_localFinQueued);
+    REQUIRE(stream.m_sendExtents.front().offset == 4096);
+
+    std::fclose(file);
+}
+
+TEST_CASE("StreamImpl: writev references caller buffers until acknowledged", "[Stream][Writev]")
+{
+    StreamTestCtx _fix_4; StreamImpl stream(&_fix_4.conn, 4);
+
+    std::array<uint8_t, 100> a{};
+    std::array<uint8_t, 300> b{};
+    a.fill(1);
+    b.fill(2);
+    eular::utp::Stream::ConstBufferView views[3] = {{a.data(), a.size()}, {nullptr, 0}, {b.data(), b.size()}};
+
+    int released = 0;
+    REQUIRE(stream.write("xy", 2, false) == 2);
+    REQUIRE(stream.writev(views, 3, [&released]() { ++released; }, false) == 400);
+    REQUIRE(stream.write("z", 1, false) == 1);
+
+    // 分片按顺序接在已有数据之后, 直接引用调用方内存
+    REQUIRE(stream.m_sendBuffer.size() == 3);
+    REQUIRE(stream.m_sendExtentBytes == 400);
+    REQUIRE(stream.m_sendExtents.size() == 2);
+    REQUIRE(stream.m_sendExtents[0].offset == 2);
+    REQUIRE(stream.m_sendExtents[0].data == a.data());
+    REQUIRE(stream.m_sendExtents[1].offset == 102);
+    REQUIRE(stream.m_sendExtents[1].data == b.data());
+    REQUIRE(stream.sendBufferedEndOffset() == 403);
+
+    uint64_t next = 0;
+    REQUIRE(stream.findSendExtent(1, &next) == nullptr);
+    REQUIRE(next == 2);
+    REQUIRE(stream.findSendExtent(150, nullptr) == &stream.m_sendExtents[1]);
+    REQUIRE(stream.sendExtentBytesBetween(0, 150) == 148);
+
+    stream.m_nextSendOffset = 403;
+    stream.m_sendQueuedBytes = 0;
+    stream.m_sendInFlightBytes = 403;
+
+    // 部分确认只裁剪区间, 全部确认后回调一次
+    stream.onPacketAcked(0, 200);
+    REQUIRE(released == 0);
+    REQUIRE(stream.m_sendExtents.size() == 1);
+    REQUIRE(stream.m_sendExtents[0].data == b.data() + 98);
+    REQUIRE(stream.m_sendBuffer.size() == 1);
+
+    stream.onPacketAcked(200, 203);
+    REQUIRE(released == 1);
+    REQUIRE(stream.m_sendExtents.empty());
+    REQUIRE(stream.m_sendBuffer.empty());
+    REQUIRE(stream.m_sendInFlightBytes == 0);
+}
+
+TEST_CASE("StreamImpl: writev rejects oversize batch and releases on reset", "[Stream][Writev]")
+{
+    eular::utp::Config cfg;
+    cfg.stream_send_file_window = 1024;
+    ev::EventLoop loop;
+    eular::utp::ContextImpl ctx(loop.loop(), &cfg);
+    eular::utp::ConnectionImpl conn(&ctx, nullptr, 9999);
+    StreamImpl stream(&conn, 4);
+
+    std::vector<uint8_t> big(2048, 7);
+    eular::utp::Stream::ConstBufferView view{big.data(), big.size()};
+
+    // 超出整个窗口时返回 OVERFLOW 而不是 WOULD_BLOCK, 所有权仍归调用方
+    int released = 0;
+    REQUIRE(stream.writev(&view, 1, [&released]() { ++released; }, false) == -1);
+    REQUIRE(utp_get_last_error() == UTP_ERR_OVERFLOW);
+    REQUIRE(released == 0);
+    REQUIRE(stream.m_sendExtents.empty());
+
+    eular::utp::Stream::ConstBufferView bad{nullptr, 10};
+    REQUIRE(stream.writev(&bad, 1, nullptr, false) == -1);
+    REQUIRE(utp_get_last_error() == UTP_ERR_INVALID_PARAM);
+
+    view.len = 512;
+    REQUIRE(stream.writev(&view, 1, [&released]() { ++released; }, false) == 512);
+    REQUIRE(released == 0);
+
+    // 不超过窗口但余量不足时等待确认
+    eular::utp::Stream::ConstBufferView rest(big.data() + 512, 1000);
+    REQUIRE(stream.writev(&rest, 1, nullptr, false) == -1);
+    REQUIRE(utp_get_last_error() == UTP_ERR_WOULD_BLOCK);
+
+    // 无数据的 FIN 写入立即回调
+    int finReleased = 0;
+    REQUIRE(stream.writev(nullptr, 0, [&finReleased]() { ++finReleased; }, true) == 0);
+    REQUIRE(finReleased == 1);
+    REQUIRE(stream.m_localFinQueued);
+
+    REQUIRE(stream.onReset(UTP_ERR_CANCELLED, true) == 0);
+    REQUIRE(released == 1);
+    REQUIRE(stream.m_sendExtents.empty());
+    REQUIRE(stream.m_sendExtentBytes == 0);
+}
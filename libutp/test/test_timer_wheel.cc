@@ -0,0 +1,166 @@
+/*************************************************************************
+    > File Name: test_timer_wheel.cc
+    > Author: eular
+    > Brief: 分层时间轮
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include <catch2/catch.hpp>
+
+#include <memory>
+#include <vector>
+
+#include <event2/event.h>
+#include <event/loop.h>
+
+#include "util/time.h"
+#include "util/timer_wheel.h"
+
+using eular::utp::TimerWheel;
+using eular::utp::WheelTimer;
+
+namespace {
+
+constexpr uint64_t kMsUs = 1000;
+constexpr uint64_t kHourUs = 3600ULL * 1000 * 1000;
+
+} // namespace
+
+TEST_CASE("TimerWheel: timers fire in deadline order from the event loop", "[TimerWheel]")
+{
+    ev::EventLoop loop;
+    TimerWheel wheel(loop.loop(), 1);
+
+    std::vector<int32_t> fired;
+    WheelTimer timers[4];
+    const uint64_t delays[4] = {30, 2, 300, 10};
+    for (int32_t i = 0; i < 4; ++i) {
+        REQUIRE(timers[i].reset(&wheel, [&fired, i] () { fired.push_back(i); }));
+        REQUIRE(timers[i].start(delays[i]));
+        REQUIRE(timers[i].isActive());
+    }
+    REQUIRE(wheel.size() == 4);
+
+    for (int32_t round = 0; round < 1000 && fired.size() < 4; ++round) {
+        loop.dispatch(EVLOOP_ONCE);
+    }
+    REQUIRE(fired == std::vector<int32_t>({1, 3, 0, 2}));
+    REQUIRE(wheel.size() == 0);
+    for (const WheelTimer &timer : timers) {
+        REQUIRE_FALSE(timer.isActive());
+    }
+}
+
+TEST_CASE("TimerWheel: stop and restart move the deadline", "[TimerWheel]")
+{
+    ev::EventLoop loop;
+    TimerWheel wheel(loop.loop(), 1);
+
+    int32_t count = 0;
+    WheelTimer timer;
+    REQUIRE(timer.reset(&wheel, [&count] () { ++count; }));
+    REQUIRE(timer.start(50));
+    timer.stop();
+    REQUIRE_FALSE(timer.isActive());
+    REQUIRE(wheel.size() == 0);
+
+    const uint64_t base = eular::utp::time::MonotonicUs();
+    REQUIRE(timer.start(50));
+    REQUIRE(timer.start(500));
+    REQUIRE(wheel.size() == 1);
+    wheel.advance(base + 100 * kMsUs);
+    REQUIRE(count == 0);
+    wheel.advance(base + 600 * kMsUs);
+    REQUIRE(count == 1);
+
+    WheelTimer unbound;
+    REQUIRE_FALSE(unbound.start(1));
+    REQUIRE_FALSE(unbound.reset(&wheel, nullptr));
+}
+
+TEST_CASE("TimerWheel: cascades across levels and beyond the wheel span", "[TimerWheel]")
+{
+    ev::EventLoop loop;
+    TimerWheel wheel(loop.loop(), 1);
+
+    std::vector<int32_t> fired;
+    WheelTimer nearTimer;
+    WheelTimer midTimer;
+    WheelTimer farTimer;
+    REQUIRE(nearTimer.reset(&wheel, [&fired] () { fired.push_back(0); }));
+    REQUIRE(midTimer.reset(&wheel, [&fired] () { fired.push_back(1); }));
+    REQUIRE(farTimer.reset(&wheel, [&fired] () { fired.push_back(2); }));
+
+    const uint64_t base = eular::utp::time::MonotonicUs();
+    REQUIRE(nearTimer.start(70));                   // 第 2 层
+    REQUIRE(midTimer.start(30 * 60 * 1000));        // 第 3 层
+    REQUIRE(farTimer.start(2 * 3600 * 1000));       // 超出 2^32 tick, 需要二次放置
+
+    wheel.advance(base + 69 * kMsUs);
+    REQUIRE(fired.empty());
+    wheel.advance(base + 71 * kMsUs);
+    REQUIRE(fired == std::vector<int32_t>({0}));
+    wheel.advance(base + kHourUs);
+    REQUIRE(fired == std::vector<int32_t>({0, 1}));
+    wheel.advance(base + 2 * kHourUs - 1000 * kMsUs);
+    REQUIRE(fired == std::vector<int32_t>({0, 1}));
+    REQUIRE(farTimer.isActive());
+    wheel.advance(base + 2 * kHourUs + 1000 * kMsUs);
+    REQUIRE(fired == std::vector<int32_t>({0, 1, 2}));
+    REQUIRE(wheel.size() == 0);
+}
+
+TEST_CASE("TimerWheel: repeat, self re-arm and self destruction in callbacks", "[TimerWheel]")
+{
+    ev::EventLoop loop;
+    TimerWheel wheel(loop.loop(), 1000);
+
+    int32_t repeats = 0;
+    WheelTimer repeating;
+    REQUIRE(repeating.reset(&wheel, [&repeats] () { ++repeats; }));
+    REQUIRE(repeating.start(10, 10));
+
+    // 回调内以 0 延迟重挂, 每次推进只触发一次
+    int32_t rearmed = 0;
+    WheelTimer rearming;
+    REQUIRE(rearming.reset(&wheel, [&rearmed, &rearming] () {
+        ++rearmed;
+        rearming.start(0);
+    }));
+    REQUIRE(rearming.start(0));
+
+    int32_t destroyed = 0;
+    std::unique_ptr<WheelTimer> owned(new WheelTimer());
+    REQUIRE(owned->reset(&wheel, [&destroyed, &owned] () {
+        ++destroyed;
+        owned.reset();
+    }));
+    REQUIRE(owned->start(5));
+
+    const uint64_t base = eular::utp::time::MonotonicUs();
+    wheel.advance(base + 35 * kMsUs);
+    REQUIRE(repeats == 1);
+    REQUIRE(rearmed == 1);
+    REQUIRE(destroyed == 1);
+    REQUIRE(owned == nullptr);
+
+    wheel.advance(base + 36 * kMsUs);
+    REQUIRE(rearmed == 2);
+    REQUIRE(repeating.isActive());
+    repeating.stop();
+    rearming.stop();
+    REQUIRE(wheel.size() == 0);
+}
+
+TEST_CASE("TimerWheel: destroying the wheel detaches pending timers", "[TimerWheel]")
+{
+    ev::EventLoop loop;
+    WheelTimer timer;
+    {
+        TimerWheel wheel(loop.loop(), 1);
+        REQUIRE(timer.reset(&wheel, [] () {}));
+        REQUIRE(timer.start(1000));
+    }
+    REQUIRE_FALSE(timer.isActive());
+    REQUIRE_FALSE(timer.start(1));
+}
@@ -0,0 +1,159 @@
+/*************************************************************************
+    > File Name: test_trace_recorder.cc
+    > Author: eular
+    > Brief: 事件追踪环与 qlog 导出
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include <catch2/catch.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <event/loop.h>
+
+#define private public
+#include "context/context_impl.h"
+#include "context/send_ctl.h"
+#undef private
+
+#include "congestion/congestion.h"
+#include "util/trace_recorder.h"
+
+using eular::utp::Config;
+using eular::utp::ConnectionImpl;
+using eular::utp::ContextImpl;
+using eular::utp::TraceRecorder;
+
+namespace {
+
+// cwnd 与 pacing rate 由测试直接设置
+class FixedCongestion : public eular::utp::Congestion {
+public:
+    void        onInit(eular::utp::RttStats *) override {}
+    uint64_t    getPacingRate(int32_t) override { return pacingRate; }
+    uint64_t    getCwnd() override { return cwnd; }
+    void        onBeginAck(uint64_t, uint64_t) override {}
+    void        onAck(eular::utp::PacketInfo *, uint64_t, int32_t) override {}
+    void        onLost(eular::utp::PacketInfo *) override {}
+    void        onPacketSent(eular::utp::PacketInfo *, uint64_t, int32_t) override {}
+    void        wasQuiet(uint64_t, uint64_t) override {}
+    void        onEndAck(uint64_t) override {}
+
+    uint64_t    cwnd{20000};
+    uint64_t    pacingRate{1000000};
+};
+
+} // namespace
+
+TEST_CASE("TraceRecorder: ring keeps the most recent records in order", "[Trace]")
+{
+    TraceRecorder trace(20);
+    REQUIRE(trace.capacity() == 32);
+    REQUIRE(trace.snapshot().empty());
+
+    for (uint64_t i = 0; i < 10; ++i) {
+        trace.record(eular::utp::kTracePacketSent, 1000 + i, i, 0, 1200);
+    }
+    auto records = trace.snapshot();
+    REQUIRE(records.size() == 10);
+    REQUIRE(records.front().a == 0);
+    REQUIRE(records.back().a == 9);
+
+    // 写满后覆盖最旧的记录
+    for (uint64_t i = 10; i < 100; ++i) {
+        trace.record(eular::utp::kTracePacketAcked, 1000 + i, i, 0, 1200);
+    }
+    records = trace.snapshot();
+    REQUIRE(trace.written() == 100);
+    REQUIRE(records.size() == 32);
+    for (size_t i = 0; i < records.size(); ++i) {
+        REQUIRE(records[i].a == 68 + i);
+        REQUIRE(records[i].type == eular::utp::kTracePacketAcked);
+    }
+}
+
+TEST_CASE("TraceRecorder: qlog export maps records to qlog events", "[Trace]")
+{
+    TraceRecorder trace(16);
+    trace.record(eular::utp::kTracePacketSent, 5000, 1, 1200, 1200);
+    trace.record(eular::utp::kTraceCongestionUpdate, 5500, 20000, 1000000, 1200);
+    trace.record(eular::utp::kTracePacketLost, 30250, 1, 5000, 1200);
+    trace.record(eular::utp::kTraceTimerFired, 31000, 2, 0, 0, eular::utp::kTraceTimerRetrans);
+    trace.record(eular::utp::kTraceTimerFired, 32000, 0, 0, 0, eular::utp::kTraceTimerKeepalive);
+
+    const std::string qlog = TraceRecorder::ToQlog(trace.snapshot(), "conn \"a\"", 0x1234, 7);
+    REQUIRE(qlog.find("\"qlog_version\":\"0.3\"") != std::string::npos);
+    REQUIRE(qlog.find("\"title\":\"conn \\\"a\\\"\"") != std::string::npos);
+    REQUIRE(qlog.find("\"group_id\":\"00001234\"") != std::string::npos);
+    REQUIRE(qlog.find("\"dropped_events\":7") != std::string::npos);
+    REQUIRE(qlog.find("{\"time\":0.000,\"name\":\"transport:packet_sent\"") != std::string::npos);
+    REQUIRE(qlog.find("\"congestion_window\":20000,\"pacing_rate\":8000000") != std::string::npos);
+    REQUIRE(qlog.find("{\"time\":25.250,\"name\":\"recovery:packet_lost\"") != std::string::npos);
+    REQUIRE(qlog.find("\"name\":\"recovery:loss_timer_updated\",\"data\":{\"event_type\":\"expired\","
+                      "\"timer_type\":\"retransmission\",\"mode\":2}") != std::string::npos);
+    // 非重传定时器不冒充 loss timer
+    REQUIRE(qlog.find("\"name\":\"utp:timer_fired\",\"data\":{\"timer_type\":\"keepalive\"") != std::string::npos);
+    REQUIRE(qlog.find("loss_timer_updated") == qlog.rfind("loss_timer_updated"));
+    REQUIRE(qlog.substr(qlog.size() - 4) == "]}]}");
+
+    REQUIRE(TraceRecorder::ToQlog({}, "empty", 1).find("\"events\":[]") != std::string::npos);
+}
+
+TEST_CASE("ConnectionImpl: exportTrace requires trace_ring_events", "[Trace][Connection]")
+{
+    Config cfg;
+    ev::EventLoop loop;
+    {
+        ContextImpl ctx(loop.loop(), &cfg);
+        auto conn = std::make_shared<ConnectionImpl>(&ctx, nullptr, 1401);
+        REQUIRE(conn->trace() == nullptr);
+        std::string qlog;
+        REQUIRE(conn->exportTrace(qlog) == -1);
+    }
+
+    cfg.trace_ring_events = 64;
+    ContextImpl ctx(loop.loop(), &cfg);
+    auto conn = std::make_shared<ConnectionImpl>(&ctx, nullptr, 1402);
+    REQUIRE(conn->trace() != nullptr);
+
+    conn->traceTimerFired(eular::utp::kTraceTimerAck);
+    conn->m_sendCtl->traceCongestion(1000);
+    // cwnd 与 pacing rate 均未变化时不重复记录
+    conn->m_sendCtl->traceCongestion(2000);
+    REQUIRE(conn->trace()->written() == 2);
+
+    std::string qlog;
+    REQUIRE(conn->exportTrace(qlog) == 0);
+    REQUIRE(qlog.find("\"name\":\"utp:timer_fired\",\"data\":{\"timer_type\":\"ack\"") != std::string::npos);
+    REQUIRE(qlog.find("loss_timer_updated") == std::string::npos);
+    REQUIRE(qlog.find("recovery:metrics_updated") != std::string::npos);
+}
+
+TEST_CASE("SendControl: pacing-rate-only changes are traced", "[Trace][Connection]")
+{
+    Config cfg;
+    cfg.trace_ring_events = 64;
+    ev::EventLoop loop;
+    ContextImpl ctx(loop.loop(), &cfg);
+    auto conn = std::make_shared<ConnectionImpl>(&ctx, nullptr, 1403);
+    auto cc = std::make_shared<FixedCongestion>();
+    conn->m_sendCtl->m_congestion = cc;
+
+    conn->m_sendCtl->traceCongestion(1000);
+    REQUIRE(conn->trace()->written() == 1);
+
+    // cwnd 不变, 仅 pacing rate 随增益循环变化
+    cc->pacingRate = 1250000;
+    conn->m_sendCtl->traceCongestion(2000);
+    REQUIRE(conn->trace()->written() == 2);
+
+    conn->m_sendCtl->traceCongestion(3000);
+    REQUIRE(conn->trace()->written() == 2);
+
+    const auto records = conn->trace()->snapshot();
+    REQUIRE(records.back().type == eular::utp::kTraceCongestionUpdate);
+    REQUIRE(records.back().a == 20000);
+    REQUIRE(records.back().b == 1250000);
+}
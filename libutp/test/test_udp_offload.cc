@@ -0,0 +1,278 @@
+/*************************************************************************
+    > File Name: test_udp_offload.cc
+    > Author: eular
+    > Brief: UDP GSO 合并发送 / GRO 合并接收 / SO_TXTIME 定时发送 / ECN 标记
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include <catch2/catch.hpp>
+#include "util/status.h"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "utp/config.h"
+#include "utp/platform.h"
+#include "socket/udp.h"
+#include "congestion/pacer.h"
+#include "util/time.h"
+
+using eular::utp::Address;
+using eular::utp::Config;
+using eular::utp::Pacer;
+using eular::utp::Status;
+using eular::utp::UdpSocket;
+
+namespace {
+
+uint16_t LocalPort(const UdpSocket &sock)
+{
+    Address addr;
+    addr.fromSocket(sock.fd());
+    return addr.port();
+}
+
+std::vector<size_t> RecvAll(UdpSocket &sock, size_t expected)
+{
+    std::vector<size_t> sizes;
+    std::vector<UdpSocket::MsgMetaInfo> msgs;
+    for (int32_t i = 0; i < 200 && sizes.size() < expected; ++i) {
+        Status st;
+        const int32_t n = sock.recv(msgs, st);
+        if (n <= 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+        for (int32_t k = 0; k < n; ++k) {
+            sizes.push_back(msgs[static_cast<size_t>(k)].len);
+        }
+    }
+    return sizes;
+}
+
+} // namespace
+
+TEST_CASE("UdpSocket: GSO coalesces equal-sized datagrams", "[UDP][GSO]")
+{
+    Config cfg;
+    cfg.enable_gso = true;
+
+    UdpSocket receiver(cfg);
+    REQUIRE(receiver.bind("127.0.0.1", 0, "").ok());
+    UdpSocket sender(cfg);
+    REQUIRE(sender.bind("127.0.0.1", 0, "").ok());
+    const Address peer("127.0.0.1", LocalPort(receiver));
+
+    std::vector<uint8_t> payload(1000, 0x11);
+    std::vector<UdpSocket::MsgMetaInfo> msgs(6);
+    const size_t lens[6] = {1000, 1000, 1000, 1000, 500, 1000};
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        msgs[i].data = payload.data();
+        msgs[i].len = lens[i];
+        msgs[i].slice_count = 0;
+        msgs[i].metaInfo.peerAddress = peer;
+    }
+
+    Status st;
+    REQUIRE(sender.send(msgs, st) == 6);
+
+    const std::vector<size_t> sizes = RecvAll(receiver, 6);
+    REQUIRE(sizes.size() == 6);
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        REQUIRE(sizes[i] == lens[i]);
+    }
+
+    if (sender.gsoEnabled()) {
+        // 前 5 条(最后一段较短)合并为一次发送, 第 6 条单独发送
+        REQUIRE(sender.gsoBatches() == 1);
+        REQUIRE(sender.gsoSegments() == 5);
+    } else {
+        REQUIRE(sender.gsoBatches() == 0);
+    }
+}
+
+TEST_CASE("UdpSocket: GSO does not merge datagrams for different peers", "[UDP][GSO]")
+{
+    Config cfg;
+    cfg.enable_gso = true;
+
+    UdpSocket receiverA(cfg);
+    REQUIRE(receiverA.bind("127.0.0.1", 0, "").ok());
+    UdpSocket receiverB(cfg);
+    REQUIRE(receiverB.bind("127.0.0.1", 0, "").ok());
+    UdpSocket sender(cfg);
+    REQUIRE(sender.bind("127.0.0.1", 0, "").ok());
+
+    std::vector<uint8_t> payload(800, 0x22);
+    std::vector<UdpSocket::MsgMetaInfo> msgs(4);
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        msgs[i].data = payload.data();
+        msgs[i].len = payload.size();
+        msgs[i].slice_count = 0;
+        msgs[i].metaInfo.peerAddress = Address("127.0.0.1", LocalPort(i % 2 == 0 ? receiverA : receiverB));
+    }
+
+    Status st;
+    REQUIRE(sender.send(msgs, st) == 4);
+    REQUIRE(sender.gsoBatches() == 0);
+    REQUIRE(RecvAll(receiverA, 2).size() == 2);
+    REQUIRE(RecvAll(receiverB, 2).size() == 2);
+}
+
+TEST_CASE("UdpSocket: GRO splits coalesced datagrams by segment size", "[UDP][GRO]")
+{
+    Config sendCfg;
+    sendCfg.enable_gso = true;
+    Config recvCfg;
+    recvCfg.enable_gro = true;
+
+    UdpSocket receiver(recvCfg);
+    REQUIRE(receiver.bind("127.0.0.1", 0, "").ok());
+    UdpSocket sender(sendCfg);
+    REQUIRE(sender.bind("127.0.0.1", 0, "").ok());
+    const Address peer("127.0.0.1", LocalPort(receiver));
+
+    std::vector<uint8_t> payload(1200);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<uint8_t>(i);
+    }
+    std::vector<UdpSocket::MsgMetaInfo> msgs(8);
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        msgs[i].data = payload.data();
+        msgs[i].len = i + 1 == msgs.size() ? 300 : payload.size();
+        msgs[i].slice_count = 0;
+        msgs[i].metaInfo.peerAddress = peer;
+    }
+
+    Status st;
+    REQUIRE(sender.send(msgs, st) == 8);
+
+    std::vector<UdpSocket::MsgMetaInfo> recvMsgs;
+    size_t total = 0;
+    size_t lastLen = 0;
+    for (int32_t i = 0; i < 200 && total < msgs.size(); ++i) {
+        const int32_t n = receiver.recv(recvMsgs, st);
+        if (n <= 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+        for (int32_t k = 0; k < n; ++k) {
+            const UdpSocket::MsgMetaInfo &m = recvMsgs[static_cast<size_t>(k)];
+            REQUIRE(m.metaInfo.peerAddress.port() == LocalPort(sender));
+            REQUIRE(std::memcmp(m.data, payload.data(), m.len) == 0);
+            lastLen = m.len;
+            ++total;
+        }
+    }
+    REQUIRE(total == msgs.size());
+    REQUIRE(lastLen == 300);
+
+    if (receiver.groEnabled() && sender.gsoEnabled()) {
+        REQUIRE(receiver.groBatches() >= 1);
+        REQUIRE(receiver.groSegments() >= 2);
+    }
+}
+
+TEST_CASE("UdpSocket: SO_TXTIME only coalesces datagrams with the same departure", "[UDP][TXTIME]")
+{
+    Config cfg;
+    cfg.enable_gso = true;
+    cfg.enable_txtime = true;
+
+    UdpSocket receiver(cfg);
+    REQUIRE(receiver.bind("127.0.0.1", 0, "").ok());
+    UdpSocket sender(cfg);
+    REQUIRE(sender.bind("127.0.0.1", 0, "").ok());
+    const Address peer("127.0.0.1", LocalPort(receiver));
+
+    // 回环口默认无 fq, 时间戳不会推迟发送, 只验证分组与投递
+    const uint64_t nowNs = eular::utp::time::MonotonicUs() * 1000;
+    std::vector<uint8_t> payload(1000, 0x33);
+    std::vector<UdpSocket::MsgMetaInfo> msgs(6);
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        msgs[i].data = payload.data();
+        msgs[i].len = payload.size();
+        msgs[i].slice_count = 0;
+        msgs[i].metaInfo.peerAddress = peer;
+        msgs[i].txtime_ns = nowNs + (i < 3 ? 0 : 100000);
+    }
+
+    Status st;
+    REQUIRE(sender.send(msgs, st) == 6);
+    REQUIRE(RecvAll(receiver, 6).size() == 6);
+    if (sender.gsoEnabled()) {
+        REQUIRE(sender.gsoBatches() == 2);
+        REQUIRE(sender.gsoSegments() == 6);
+    }
+
+    // 单条发送走 sendmsg + SCM_TXTIME
+    REQUIRE(sender.send(msgs[0], st) == 1);
+    REQUIRE(RecvAll(receiver, 1).size() == 1);
+}
+
+TEST_CASE("UdpSocket: ECN marks datagrams ECT(0) and reports the received codepoint", "[UDP][ECN]")
+{
+    Config ecnCfg;
+    ecnCfg.enable_ecn = true;
+    Config plainCfg;
+
+    UdpSocket receiver(ecnCfg);
+    REQUIRE(receiver.bind("127.0.0.1", 0, "").ok());
+    UdpSocket ecnSender(ecnCfg);
+    REQUIRE(ecnSender.bind("127.0.0.1", 0, "").ok());
+    UdpSocket plainSender(plainCfg);
+    REQUIRE(plainSender.bind("127.0.0.1", 0, "").ok());
+    REQUIRE_FALSE(plainSender.ecnEnabled());
+    if (!receiver.ecnEnabled() || !ecnSender.ecnEnabled()) {
+        return;
+    }
+
+    std::vector<uint8_t> payload(200, 0x44);
+    UdpSocket::MsgMetaInfo msg;
+    msg.data = payload.data();
+    msg.len = payload.size();
+    msg.slice_count = 0;
+    msg.metaInfo.peerAddress = Address("127.0.0.1", LocalPort(receiver));
+
+    auto recvEcn = [&receiver] () -> int32_t {
+        std::vector<UdpSocket::MsgMetaInfo> msgs;
+        for (int32_t i = 0; i < 200; ++i) {
+            Status st;
+            if (receiver.recv(msgs, st) > 0) {
+                return msgs[0].metaInfo.ecn;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return -1;
+    };
+
+    Status st;
+    REQUIRE(ecnSender.send(msg, st) == 1);
+    REQUIRE(recvEcn() == eular::utp::kEcnEct0);
+    REQUIRE(plainSender.send(msg, st) == 1);
+    REQUIRE(recvEcn() == eular::utp::kEcnNotEct);
+}
+
+TEST_CASE("Pacer: departure times advance by the pacing gap", "[Pacer][TXTIME]")
+{
+    Pacer pacer;
+    pacer.init(1);
+
+    // 10 Gbit/s 下 1250 字节的间隔为 1 us, 以 ns 计不被截断
+    const uint64_t rate = 1250000000ULL;
+    REQUIRE(Pacer::departureGapNs(1250, rate) == 1000);
+    REQUIRE(Pacer::departureGapNs(1200, rate) == 960);
+    REQUIRE(Pacer::departureGapNs(1200, 0) == 0);
+
+    const utp_time_t nowUs = 5000;
+    REQUIRE(pacer.departureTimeNs(nowUs) == nowUs * 1000);
+    pacer.onDeparture(nowUs * 1000, 1200, rate);
+    REQUIRE(pacer.departureTimeNs(nowUs) == nowUs * 1000 + 960);
+
+    // 较早的时间戳不会让下一发送时间回退; 空闲后不早于当前时间
+    pacer.onDeparture(nowUs * 1000 - 5000, 1200, rate);
+    REQUIRE(pacer.departureTimeNs(nowUs) == nowUs * 1000 + 960);
+    REQUIRE(pacer.departureTimeNs(nowUs + 10) == (nowUs + 10) * 1000);
+}
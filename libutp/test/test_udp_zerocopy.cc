@@ -0,0 +1,236 @@
+/*************************************************************************
+    > File Name: test_udp_zerocopy.cc
+    > Author: eular
+    > Brief: MSG_ZEROCOPY 发送与错误队列完成通知
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include <catch2/catch.hpp>
+#include "util/status.h"
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include "utp/config.h"
+#include "utp/platform.h"
+#include "socket/udp.h"
+#include "proto/packet_out.h"
+#include "util/mm.h"
+
+using eular::utp::Address;
+using eular::utp::Config;
+using eular::utp::MemoryManager;
+using eular::utp::PacketOut;
+using eular::utp::Status;
+using eular::utp::UdpSocket;
+
+namespace {
+
+uint16_t LocalPort(const UdpSocket &sock)
+{
+    Address addr;
+    addr.fromSocket(sock.fd());
+    return addr.port();
+}
+
+UdpSocket::MsgMetaInfo BuildMsg(PacketOut *pkt, MemoryManager *mm, uint16_t len, uint16_t port)
+{
+    std::memset(pkt->raw_data, 0x5a, len);
+    pkt->data_size = len;
+
+    UdpSocket::MsgMetaInfo msg{};
+    msg.data = pkt->raw_data;
+    msg.len = pkt->data_size;
+    msg.metaInfo.peerAddress = Address("127.0.0.1", port);
+    msg.zc_packet = pkt;
+    msg.zc_owner = mm;
+    return msg;
+}
+
+uint32_t WaitZeroCopyCompletions(UdpSocket &sock, uint32_t expected)
+{
+    uint32_t completed = 0;
+    for (int32_t i = 0; i < 200 && completed < expected; ++i) {
+        UdpSocket::ErrorMsg errMsg;
+        Status st;
+        if (sock.recvErrorMsg(errMsg, st) > 0) {
+            completed += errMsg.zc_completed;
+            continue;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return completed;
+}
+
+} // namespace
+
+TEST_CASE("UdpSocket: zerocopy send pins PacketOut until completion", "[UDP][ZeroCopy]")
+{
+    Config cfg;
+    cfg.enable_zerocopy = true;
+    cfg.zerocopy_min_bytes = 1000;
+
+    UdpSocket receiver(cfg);
+    REQUIRE(receiver.bind("127.0.0.1", 0, "").ok());
+    UdpSocket sender(cfg);
+    REQUIRE(sender.bind("127.0.0.1", 0, "").ok());
+
+    MemoryManager mm;
+    PacketOut *pkt = mm.getPacketOut(1400);
+    REQUIRE(pkt != nullptr);
+    uint8_t *raw = pkt->raw_data;
+
+    UdpSocket::MsgMetaInfo msg = BuildMsg(pkt, &mm, 1200, LocalPort(receiver));
+    Status st;
+    REQUIRE(sender.send(msg, st) == 1);
+
+    if (!sender.zeroCopyEnabled()) {
+        // 内核不支持 SO_ZEROCOPY 时回退为普通发送, 不产生 pin
+        REQUIRE_FALSE(pkt->zeroCopyPinned());
+        mm.putPacketOut(pkt);
+        return;
+    }
+
+    REQUIRE(pkt->zeroCopyPinned());
+    REQUIRE(sender.zeroCopyPending() == 1);
+
+    mm.putPacketOut(pkt);
+    REQUIRE(pkt->raw_data == raw);
+    REQUIRE(mm.zc_deferred_count == 1);
+
+    REQUIRE(WaitZeroCopyCompletions(sender, 1) == 1);
+    REQUIRE(sender.zeroCopyPending() == 0);
+    REQUIRE(mm.zc_deferred_count == 0);
+    REQUIRE(pkt->raw_data == nullptr);
+}
+
+TEST_CASE("UdpSocket: zerocopy threshold and batch completions", "[UDP][ZeroCopy]")
+{
+    Config cfg;
+    cfg.enable_zerocopy = true;
+    cfg.zerocopy_min_bytes = 1000;
+
+    UdpSocket receiver(cfg);
+    REQUIRE(receiver.bind("127.0.0.1", 0, "").ok());
+    UdpSocket sender(cfg);
+    REQUIRE(sender.bind("127.0.0.1", 0, "").ok());
+    const uint16_t port = LocalPort(receiver);
+
+    MemoryManager mm;
+    PacketOut *small = mm.getPacketOut(512);
+    PacketOut *large1 = mm.getPacketOut(1400);
+    PacketOut *large2 = mm.getPacketOut(1400);
+    REQUIRE(small != nullptr);
+    REQUIRE(large1 != nullptr);
+    REQUIRE(large2 != nullptr);
+
+    UdpSocket::MsgMetaInfo msgs[3] = {
+        BuildMsg(small, &mm, 200, port),
+        BuildMsg(large1, &mm, 1200, port),
+        BuildMsg(large2, &mm, 1300, port),
+    };
+
+    Status st;
+    REQUIRE(sender.send(msgs, 3, st) == 3);
+    REQUIRE_FALSE(small->zeroCopyPinned());
+
+    if (sender.zeroCopyEnabled()) {
+        REQUIRE(large1->zeroCopyPinned());
+        REQUIRE(large2->zeroCopyPinned());
+        REQUIRE(WaitZeroCopyCompletions(sender, 2) == 2);
+    }
+
+    REQUIRE_FALSE(large1->zeroCopyPinned());
+    REQUIRE_FALSE(large2->zeroCopyPinned());
+    REQUIRE(sender.zeroCopyPending() == 0);
+
+    mm.putPacketOut(small);
+    mm.putPacketOut(large1);
+    mm.putPacketOut(large2);
+    REQUIRE(mm.zc_deferred_count == 0);
+}
+
+TEST_CASE("UdpSocket: zerocopy buffers outlive their MemoryManager until completion", "[UDP][ZeroCopy]")
+{
+    Config cfg;
+    cfg.enable_zerocopy = true;
+    cfg.zerocopy_min_bytes = 1000;
+
+    UdpSocket receiver(cfg);
+    REQUIRE(receiver.bind("127.0.0.1", 0, "").ok());
+    UdpSocket sender(cfg);
+    REQUIRE(sender.bind("127.0.0.1", 0, "").ok());
+    const uint16_t port = LocalPort(receiver);
+
+    {
+        MemoryManager mm;
+        mm.zc_socket = &sender;
+        PacketOut *pkt = mm.getPacketOut(1400);
+        REQUIRE(pkt != nullptr);
+
+        UdpSocket::MsgMetaInfo msg = BuildMsg(pkt, &mm, 1200, port);
+        Status st;
+        REQUIRE(sender.send(msg, st) == 1);
+        if (!sender.zeroCopyEnabled()) {
+            mm.putPacketOut(pkt);
+            return;
+        }
+
+        // 同一个包的重传在完成前再次零拷贝发送
+        REQUIRE(sender.send(msg, st) == 1);
+        REQUIRE(pkt->zc_pending == 2);
+        mm.putPacketOut(pkt);
+        REQUIRE(mm.zc_deferred_count == 1);
+    }
+
+    // 属主析构后缓冲由 socket 接管, 不回到任何池中
+    REQUIRE(sender.zeroCopyPending() == 2);
+    REQUIRE(sender.zeroCopyOrphaned() == 1);
+
+    REQUIRE(WaitZeroCopyCompletions(sender, 2) == 2);
+    REQUIRE(sender.zeroCopyPending() == 0);
+    REQUIRE(sender.zeroCopyOrphaned() == 0);
+}
+
+TEST_CASE("MemoryManager: shared pool view hands pinned buffers to the socket", "[UDP][ZeroCopy][SharedPool]")
+{
+    Config cfg;
+    cfg.enable_zerocopy = true;
+    cfg.zerocopy_min_bytes = 1000;
+
+    UdpSocket receiver(cfg);
+    REQUIRE(receiver.bind("127.0.0.1", 0, "").ok());
+    UdpSocket sender(cfg);
+    REQUIRE(sender.bind("127.0.0.1", 0, "").ok());
+
+    std::shared_ptr<MemoryManager> shared = std::make_shared<MemoryManager>();
+    uint8_t *raw = nullptr;
+    {
+        MemoryManager view;
+        REQUIRE(view.attachSharedPool(shared, 0));
+        view.zc_socket = &sender;
+        PacketOut *pkt = view.getPacketOut(1400);
+        REQUIRE(pkt != nullptr);
+        raw = pkt->raw_data;
+
+        UdpSocket::MsgMetaInfo msg = BuildMsg(pkt, &view, 1200, LocalPort(receiver));
+        Status st;
+        REQUIRE(sender.send(msg, st) == 1);
+        view.putPacketOut(pkt);
+        if (!sender.zeroCopyEnabled()) {
+            return;
+        }
+    }
+
+    // 被内核引用的缓冲不回到共享池, 下一次分配拿到的是新缓冲
+    REQUIRE(shared->bytes_inuse == 0);
+    PacketOut *next = shared->getPacketOut(1400);
+    REQUIRE(next != nullptr);
+    REQUIRE(next->raw_data != raw);
+    shared->putPacketOut(next);
+
+    REQUIRE(WaitZeroCopyCompletions(sender, 1) == 1);
+    REQUIRE(sender.zeroCopyOrphaned() == 0);
+}
@@ -0,0 +1,113 @@
+/*************************************************************************
+    > File Name: test_x25519_key_pool.cc
+    > Author: eular
+    > Brief: X25519 临时密钥对池
+    > Created Time: Fri 16 Oct 2026
+ ************************************************************************/
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <set>
+#include <thread>
+
+#include <event/loop.h>
+
+#define private public
+#include "context/context_impl.h"
+#undef private
+#include "crypto/x25519_key_pool.h"
+
+using eular::utp::Config;
+using eular::utp::ContextImpl;
+using eular::utp::X25519KeyPool;
+using eular::utp::X25519Wrapper;
+
+namespace {
+
+bool WaitAvailable(const X25519KeyPool &pool, size_t count)
+{
+    for (int i = 0; i < 2000; ++i) {
+        if (pool.available() >= count) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+} // namespace
+
+TEST_CASE("X25519KeyPool: disabled pool generates inline without counting misses", "[X25519KeyPool]")
+{
+    X25519KeyPool pool;
+    REQUIRE(pool.capacity() == 0);
+
+    auto key = pool.acquire();
+    REQUIRE(key != nullptr);
+    REQUIRE(pool.hits() == 0);
+    REQUIRE(pool.misses() == 0);
+}
+
+TEST_CASE("X25519KeyPool: helper thread refills below the low watermark", "[X25519KeyPool]")
+{
+    X25519KeyPool pool;
+    pool.resize(8, 2);
+    REQUIRE(WaitAvailable(pool, 8));
+
+    // 高于低水位时不补充, 取到低水位后补满
+    std::set<X25519Wrapper::PublicKey> publicKeys;
+    for (int i = 0; i < 6; ++i) {
+        auto key = pool.acquire();
+        REQUIRE(key != nullptr);
+        publicKeys.insert(key->publicKey());
+    }
+    REQUIRE(publicKeys.size() == 6);
+    REQUIRE(pool.hits() == 6);
+    REQUIRE(WaitAvailable(pool, 8));
+    REQUIRE(pool.available() == 8);
+
+    // 池中的密钥对可正常完成密钥协商
+    auto local = pool.acquire();
+    X25519Wrapper peer;
+    REQUIRE(local->deriveSharedSecret(peer.publicKey()) == peer.deriveSharedSecret(local->publicKey()));
+
+    // 关闭后清空, 回退现场生成
+    pool.resize(0, 0);
+    REQUIRE(pool.available() == 0);
+    REQUIRE(pool.acquire() != nullptr);
+}
+
+TEST_CASE("ContextImpl: handshake keypairs come from the configured pool", "[Context][X25519KeyPool]")
+{
+    Config cfg;
+    ev::EventLoop loop;
+    ContextImpl ctx(loop.loop(), &cfg);
+
+    ctx.setKeyPairPoolSize(4, 1);
+    REQUIRE(WaitAvailable(ctx.m_keyPool, 4));
+
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(ctx.acquireKeyPair() != nullptr);
+    }
+    auto stat = ctx.statistic();
+    REQUIRE(stat.keypair_pool_hits == 3);
+    REQUIRE(stat.keypair_pool_misses == 0);
+}
+
+TEST_CASE("Context: key pair pool refills at half capacity by default", "[Context][X25519KeyPool]")
+{
+    Config cfg;
+    ev::EventLoop loop;
+    eular::utp::Context ctx(loop.loop(), &cfg);
+
+    // 默认低水位为容量的一半, 不必等池取空才补充
+    ctx.setKeyPairPoolSize(8);
+    REQUIRE(ctx.m_impl->m_keyPool.m_lowWatermark == 4);
+
+    // 显式传 0 时仅在取空后补充
+    ctx.setKeyPairPoolSize(8, 0);
+    REQUIRE(ctx.m_impl->m_keyPool.m_lowWatermark == 0);
+
+    ctx.setKeyPairPoolSize(0);
+}